@@ -33,6 +33,15 @@ ifeq ($(strip $(TARGET_BOARD_PLATFORM)),sc8810)
 LOCAL_CFLAGS += -D_DSP_CTRL_CODEC
 endif
 
+# playback resampler quality level, not a tap count:
+# 0 AUDIO_RESAMPLER_QUALITY_LOW, 1 MEDIUM (default), 2 HIGH
+ifneq ($(strip $(BOARD_AUDIO_RESAMPLER_QUALITY)),)
+ifeq ($(filter 0 1 2,$(strip $(BOARD_AUDIO_RESAMPLER_QUALITY))),)
+$(error BOARD_AUDIO_RESAMPLER_QUALITY must be 0, 1 or 2, not $(BOARD_AUDIO_RESAMPLER_QUALITY))
+endif
+LOCAL_CFLAGS += -DAUDIO_RESAMPLER_QUALITY=$(strip $(BOARD_AUDIO_RESAMPLER_QUALITY))
+endif
+
 LOCAL_C_INCLUDES += \
 	external/tinyalsa/include \
 	external/expat/lib \
@@ -43,10 +52,16 @@ LOCAL_C_INCLUDES += \
 	device/samsung/sprd-common/libaudio/vb_pga \
 	device/samsung/sprd-common/libaudio/record_process
 
-LOCAL_SRC_FILES := audio_hw.c tinyalsa_util.c audio_pga.c \
+LOCAL_SRC_FILES := audio_hw.c tinyalsa_util.c audio_pga.c audio_mixer_cfg.c audio_echo_ref.c \
 			record_process/aud_proc_config.c \
 			record_process/aud_filter_calc.c
 
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+LOCAL_SRC_FILES += audio_resampler.c.neon
+else
+LOCAL_SRC_FILES += audio_resampler.c
+endif
+
 LOCAL_SHARED_LIBRARIES := \
 	liblog libcutils libtinyalsa libaudioutils \
 	libexpat libdl \
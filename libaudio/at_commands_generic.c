@@ -4,12 +4,48 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <poll.h>
 #include <cutils/properties.h>
 
+#define AT_CMD_QUEUE_LEN    16
+#define AT_CMD_LEN          48
+#define AT_CMD_TIMEOUT_MS   2000
+
 static int at_cmd_fd = -1;
 static int at_cmd_prefix_len;
 static char at_cmd_prefix[16];
-static pthread_mutex_t  ATlock = PTHREAD_MUTEX_INITIALIZER;         //eng cannot handle many at commands once
+
+/*
+ * eng cannot handle many at commands once, and its replies do not say which
+ * command they answer. So the commands are queued and at_cmd_thread, which
+ * owns the eng session, sends them one at a time and waits for each reply.
+ * The callers do not wait for the modem. A command setting the same state as
+ * one still queued (volume, mute, route) replaces it.
+ */
+struct at_cmd_req {
+    char cmd[AT_CMD_LEN];
+    unsigned int seq;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* a command queued, sent or dequeued */
+    pthread_t thread;
+    bool started;
+    struct at_cmd_req req[AT_CMD_QUEUE_LEN];
+    unsigned int count;
+    unsigned int queued_seq;
+    unsigned int done_seq;
+} at_queue = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static const char *at_cmd_coalesced[] = {
+    "AT+VGR=",
+    "AT+CMUT=",
+    "AT+SSAM=",
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,14 +58,10 @@ extern "C" {
 }
 #endif
 
+static void at_cmd_queue(const char *at_cmd, bool wait);
+
 #define do_cmd(at_cmd) \
-    pthread_mutex_lock(&ATlock);\
-    if (at_cmd && at_cmd_send_recv((void*)at_cmd, strlen(at_cmd), r_buf, sizeof r_buf)) { \
-        ALOGE("do_cmd Switch incall AT command [%s][%s] failed", at_cmd, r_buf); \
-    } else if (at_cmd) { \
-        ALOGW("do_cmd Switch incall AT command [%s][%s] good", at_cmd, r_buf); \
-    }\
-    pthread_mutex_unlock(&ATlock);
+    if (at_cmd) at_cmd_queue(at_cmd, false);
 
 
 int at_cmd_deinit(void)
@@ -67,27 +99,42 @@ int at_cmd_init(void)
     return 0;
 }
 
+/* Only called from at_cmd_thread */
 int at_cmd_send_recv(void *s_buf, size_t s_len, void *r_buf, size_t r_len)
 {
 //  struct iovec iov[2];
 	int ret = 0;
     int len = 0;
     char at_cmd[64];
+    struct pollfd pfd;
 
     at_cmd_init();
 
     if (at_cmd_fd > 0) {
         if (r_buf) memset(r_buf, 0, r_len); // ((char*)r_buf)[0] = 0;
         memset(at_cmd, 0, 64);
-		len = sprintf(at_cmd, "%s%s", at_cmd_prefix, (char*)s_buf);
+		len = snprintf(at_cmd, sizeof(at_cmd), "%s%s", at_cmd_prefix, (char*)s_buf);
         ALOGI("at_cmd_send_recv write incall AT command [%s] at_cmd_prefix:%s at_cmd:%s ", (char*)s_buf,at_cmd_prefix,at_cmd);
 		ret = engapi_write(at_cmd_fd, at_cmd, len);
 		if(ret < 0){
-			at_cmd_fd = -1;
+			at_cmd_deinit();
             ALOGE("at_cmd_send_recv Switch incall AT command s_buf:%s error:%s(%d) failed", (char*)s_buf, strerror(errno),errno);			
-		}else {
-		    engapi_read(at_cmd_fd, r_buf, r_len);
+            return -1;
+		}
+
+        pfd.fd = at_cmd_fd;
+        pfd.events = POLLIN;
+        do {
+            ret = poll(&pfd, 1, AT_CMD_TIMEOUT_MS);
+        } while (ret < 0 && errno == EINTR);
+        if (ret <= 0) {
+            /* a late reply would be taken for the next command's one */
+            ALOGE("at_cmd_send_recv no reply to [%s] in %d ms, reopening", (char*)s_buf, AT_CMD_TIMEOUT_MS);
+            at_cmd_deinit();
+            snprintf((char*)r_buf, r_len, "%s", "timeout");
+            return -1;
         }
+        engapi_read(at_cmd_fd, r_buf, r_len - 1);
 
         //at_cmd_deinit();
         return 0; // strncmp((char*)r_buf, "OK", 2);
@@ -98,9 +145,88 @@ int at_cmd_send_recv(void *s_buf, size_t s_len, void *r_buf, size_t r_len)
     return -1;
 }
 
+static void *at_cmd_thread(void *args)
+{
+    struct at_cmd_req req;
+    char r_buf[256];
+
+    for (;;) {
+        pthread_mutex_lock(&at_queue.lock);
+        while (at_queue.count == 0)
+            pthread_cond_wait(&at_queue.cond, &at_queue.lock);
+        req = at_queue.req[0];
+        at_queue.count--;
+        memmove(&at_queue.req[0], &at_queue.req[1], at_queue.count * sizeof(req));
+        pthread_cond_broadcast(&at_queue.cond);
+        pthread_mutex_unlock(&at_queue.lock);
+
+        if (at_cmd_send_recv(req.cmd, strlen(req.cmd), r_buf, sizeof r_buf)) {
+            ALOGE("do_cmd Switch incall AT command [%s][%s] failed", req.cmd, r_buf);
+        } else {
+            ALOGW("do_cmd Switch incall AT command [%s][%s] good", req.cmd, r_buf);
+        }
+
+        pthread_mutex_lock(&at_queue.lock);
+        at_queue.done_seq = req.seq;
+        pthread_cond_broadcast(&at_queue.cond);
+        pthread_mutex_unlock(&at_queue.lock);
+    }
+    return NULL;
+}
+
+/* Queues a command for the modem, wait returns once the modem answered it */
+static void at_cmd_queue(const char *at_cmd, bool wait)
+{
+    unsigned int i, j, seq;
+    size_t key_len;
+
+    if (strlen(at_cmd) >= AT_CMD_LEN) {
+        ALOGE("at_cmd_queue AT command [%s] too long", at_cmd);
+        return;
+    }
+
+    pthread_mutex_lock(&at_queue.lock);
+    if (!at_queue.started) {
+        if (pthread_create(&at_queue.thread, NULL, at_cmd_thread, NULL)) {
+            ALOGE("at_cmd_queue pthread_create failed, %s", strerror(errno));
+            pthread_mutex_unlock(&at_queue.lock);
+            return;
+        }
+        at_queue.started = true;
+    }
+
+    /* the newer command goes last, after the ones queued since the one it replaces */
+    for (i = 0; i < sizeof(at_cmd_coalesced) / sizeof(at_cmd_coalesced[0]); i++) {
+        key_len = strlen(at_cmd_coalesced[i]);
+        if (strncmp(at_cmd, at_cmd_coalesced[i], key_len))
+            continue;
+        for (j = 0; j < at_queue.count; j++) {
+            if (strncmp(at_queue.req[j].cmd, at_cmd_coalesced[i], key_len) == 0) {
+                ALOGI("at_cmd_queue [%s] replaces [%s]", at_cmd, at_queue.req[j].cmd);
+                at_queue.count--;
+                memmove(&at_queue.req[j], &at_queue.req[j + 1],
+                        (at_queue.count - j) * sizeof(at_queue.req[0]));
+                break;
+            }
+        }
+        break;
+    }
+
+    while (at_queue.count == AT_CMD_QUEUE_LEN)
+        pthread_cond_wait(&at_queue.cond, &at_queue.lock);
+    seq = ++at_queue.queued_seq;
+    strcpy(at_queue.req[at_queue.count].cmd, at_cmd);
+    at_queue.req[at_queue.count].seq = seq;
+    at_queue.count++;
+    pthread_cond_broadcast(&at_queue.cond);
+
+    while (wait && (int)(at_queue.done_seq - seq) < 0)
+        pthread_cond_wait(&at_queue.cond, &at_queue.lock);
+    pthread_mutex_unlock(&at_queue.lock);
+}
+
 static int at_cmd_route(struct tiny_audio_device *adev)
 {
-    char r_buf[32];
     const char *at_cmd = NULL;
     if (adev->mode != AUDIO_MODE_IN_CALL) {
         ALOGE("Error: NOT mode_in_call, current mode(%d)", adev->mode);
@@ -130,7 +256,6 @@ static int at_cmd_route(struct tiny_audio_device *adev)
 #define AT_CMD_INCALL_STOP  "AT+STONE=0"
 int at_cmd_incall_tone(int type)
 {
-    char r_buf[32];
     do_cmd(AT_CMD_INCALL_FREQ2);
     usleep(100*1000);
     do_cmd(AT_CMD_INCALL_FREQ1);
@@ -236,7 +361,6 @@ void *at_incall_tone_thread(void *args)
 
 int at_cmd_headset_volume_max(void)
 {
-    char r_buf[32];
     const char *at_cmd = "AT+CLVL=7";
     ALOGW("audio at_cmd_headset_volume_max");
     do_cmd(at_cmd);
@@ -247,7 +371,6 @@ int at_cmd_headset_volume_max(void)
 #define VOICECALL_VOLUME_MAX_UI	6
 int at_cmd_volume(float vol, int mode)
 {
-    char r_buf[256];
     char buf[16];
     char *at_cmd = buf;
     int ret = 0;
@@ -263,7 +386,6 @@ int at_cmd_volume(float vol, int mode)
 
 int at_cmd_mic_mute(bool mute)
 {
-    char r_buf[32];
     const char *at_cmd;
     ALOGW("audio at_cmd_mic_mute %d", mute);
     if (mute) at_cmd = "AT+CMUT=1";
@@ -274,8 +396,7 @@ int at_cmd_mic_mute(bool mute)
 
 int at_cmd_audio_loop(int enable, int mode, int volume,int loopbacktype,int voiceformat,int delaytime)
 {
-    char r_buf[60];
-    char buf[89];
+    char buf[AT_CMD_LEN];
     char *at_cmd = buf;
 	if(volume >9) {
 		volume = 9;
@@ -283,6 +404,7 @@ int at_cmd_audio_loop(int enable, int mode, int volume,int loopbacktype,int voic
     ALOGW("audio at_cmd_audio_loop enable:%d,mode:%d,voluem:%d,loopbacktype:%d,voiceformat:%d,delaytime:%d",enable,mode,volume,loopbacktype,voiceformat,delaytime);
 
     snprintf(at_cmd, sizeof buf, "AT+SPVLOOP=%d,%d,%d,%d,%d,%d", enable,mode,volume,loopbacktype,voiceformat,delaytime);
-    do_cmd(at_cmd);
+    /* the loop test drives the modem in steps */
+    at_cmd_queue(at_cmd, true);
     return 0;
 }
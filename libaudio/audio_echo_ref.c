@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_echo_ref"
+/*#define LOG_NDEBUG 0*/
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/atomic.h>
+#include <cutils/log.h>
+
+#include "audio_echo_ref.h"
+#include "audio_resampler.h"
+
+/*
+ * The ring holds about one second of reference at the capture rate. Every
+ * write stamps the ring position of its first frame with its render time, and
+ * every read stamps its capture position with its capture time. A line fitted
+ * through the last stamps of each side gives its clock: the fit smooths the
+ * jitter of the time stamps, and its slope follows the drift. A capture frame
+ * is thus mapped to a fractional ring position, read with linear interpolation.
+ *
+ * The writer publishes the frames and then the stamp with release stores; the
+ * reader copies the stamps it needs and drops the ones overwritten meanwhile.
+ */
+#define ER_CHUNK_FRAMES 256
+#define ER_STAMPS 256                /* power of 2 */
+#define ER_STAMP_MASK (ER_STAMPS - 1)
+#define ER_MAX_CHANNELS 2
+/* a fitted slope further than this from the nominal rate means a broken clock */
+#define ER_MAX_SLOPE_ERROR 0.005
+
+struct er_stamp {
+    int64_t ns;
+    uint32_t pos;
+    uint32_t start;             /* first stamp after a stop */
+};
+
+/* time(pos) = t_ref + a + b * (pos - pos_ref) */
+struct er_fit {
+    int64_t t_ref;
+    uint32_t pos_ref;
+    double a;
+    double b;
+};
+
+struct audio_echo_ref {
+    uint32_t channels;
+    uint32_t rate;
+    uint32_t wr_channels;
+    uint32_t wr_rate;
+    double frame_ns;
+    int16_t *ring;
+    uint32_t size;
+    volatile int32_t wr_pos;
+    struct er_stamp stamps[ER_STAMPS];
+    volatile int32_t stamp_wr;
+
+    /* writer only */
+    struct audio_resampler *resampler;
+    int16_t *mix;
+    int16_t *conv;
+    size_t conv_frames;
+    int restart;
+
+    /* reader only */
+    struct er_stamp cap[ER_STAMPS];
+    uint32_t cap_wr;
+    uint32_t cap_pos;
+    uint32_t play_seen;
+    double play_sq;
+    uint32_t play_n;
+    double cap_sq;
+    uint32_t cap_n;
+    struct audio_echo_ref_stats stats;
+};
+
+int audio_echo_ref_create(uint32_t rd_channels, uint32_t rd_rate,
+                          uint32_t wr_channels, uint32_t wr_rate,
+                          struct audio_echo_ref **ref)
+{
+    struct audio_echo_ref *er;
+
+    *ref = NULL;
+    if (!rd_channels || rd_channels > ER_MAX_CHANNELS || !rd_rate ||
+        !wr_channels || wr_channels > ER_MAX_CHANNELS || !wr_rate)
+        return -EINVAL;
+
+    er = calloc(1, sizeof(struct audio_echo_ref));
+    if (!er)
+        return -ENOMEM;
+
+    er->channels = rd_channels;
+    er->rate = rd_rate;
+    er->wr_channels = wr_channels;
+    er->wr_rate = wr_rate;
+    er->frame_ns = 1000000000.0 / rd_rate;
+    for (er->size = 1; er->size < rd_rate; er->size <<= 1)
+        ;
+    er->conv_frames = (size_t)ER_CHUNK_FRAMES * rd_rate / wr_rate + 16;
+    er->ring = calloc(er->size, rd_channels * sizeof(int16_t));
+    er->mix = malloc(ER_CHUNK_FRAMES * rd_channels * sizeof(int16_t));
+    er->conv = malloc(er->conv_frames * rd_channels * sizeof(int16_t));
+    if (!er->ring || !er->mix || !er->conv)
+        goto err;
+
+    if (rd_rate != wr_rate &&
+        audio_resampler_create(wr_rate, rd_rate, rd_channels,
+                               AUDIO_RESAMPLER_QUALITY_LOW, &er->resampler) != 0)
+        goto err;
+
+    er->restart = 1;
+    *ref = er;
+    return 0;
+
+err:
+    audio_echo_ref_release(er);
+    return -ENOMEM;
+}
+
+void audio_echo_ref_release(struct audio_echo_ref *er)
+{
+    if (!er)
+        return;
+    if (er->resampler)
+        audio_resampler_release(er->resampler);
+    free(er->ring);
+    free(er->mix);
+    free(er->conv);
+    free(er);
+}
+
+static void er_ring_put(struct audio_echo_ref *er, uint32_t pos,
+                        const int16_t *frames, size_t count)
+{
+    uint32_t idx = pos & (er->size - 1);
+    size_t n = er->size - idx;
+
+    if (n > count)
+        n = count;
+    memcpy(er->ring + idx * er->channels, frames, n * er->channels * sizeof(int16_t));
+    if (count > n)
+        memcpy(er->ring, frames + n * er->channels,
+               (count - n) * er->channels * sizeof(int16_t));
+}
+
+static void er_downmix(struct audio_echo_ref *er, const int16_t *src, int16_t *dst,
+                       size_t count)
+{
+    size_t i;
+
+    if (er->wr_channels == er->channels) {
+        memcpy(dst, src, count * er->channels * sizeof(int16_t));
+    } else if (er->wr_channels == 2) {
+        for (i = 0; i < count; i++)
+            dst[i] = (int16_t)(((int32_t)src[2 * i] + src[2 * i + 1]) >> 1);
+    } else {
+        for (i = 0; i < count; i++)
+            dst[2 * i] = dst[2 * i + 1] = src[i];
+    }
+}
+
+int audio_echo_ref_write(struct audio_echo_ref *er, const int16_t *frames,
+                         size_t count, int64_t render_ns)
+{
+    uint32_t pos = (uint32_t)er->wr_pos;
+    uint32_t first = pos;
+    int64_t first_ns = 0;
+    int32_t stamp_wr;
+    struct er_stamp *st;
+    size_t n, in_n, out_n, done;
+
+    while (count) {
+        n = count < ER_CHUNK_FRAMES ? count : ER_CHUNK_FRAMES;
+        er_downmix(er, frames, er->mix, n);
+
+        if (!er->resampler) {
+            if (pos == first)
+                first_ns = render_ns;
+            er_ring_put(er, pos, er->mix, n);
+            pos += n;
+        }
+        for (done = 0; er->resampler && done < n; done += in_n) {
+            in_n = n - done;
+            out_n = er->conv_frames;
+            audio_resampler_process(er->resampler, er->mix + done * er->channels, &in_n,
+                                    er->conv, &out_n);
+            if (pos == first && out_n) {
+                /* back from the render time of the last frame taken */
+                first_ns = render_ns +
+                           (int64_t)(done + in_n - 1) * 1000000000LL / er->wr_rate -
+                           audio_resampler_delay_ns(er->resampler) -
+                           (int64_t)(out_n * er->frame_ns);
+            }
+            er_ring_put(er, pos, er->conv, out_n);
+            pos += out_n;
+        }
+
+        frames += n * er->wr_channels;
+        count -= n;
+        render_ns += (int64_t)n * 1000000000LL / er->wr_rate;
+    }
+    if (pos == first)
+        return 0;
+
+    android_atomic_release_store((int32_t)pos, &er->wr_pos);
+    stamp_wr = er->stamp_wr;
+    st = &er->stamps[stamp_wr & ER_STAMP_MASK];
+    st->ns = first_ns;
+    st->pos = first;
+    st->start = er->restart;
+    er->restart = 0;
+    android_atomic_release_store(stamp_wr + 1, &er->stamp_wr);
+    return 0;
+}
+
+void audio_echo_ref_write_stop(struct audio_echo_ref *er)
+{
+    er->restart = 1;
+    if (er->resampler)
+        audio_resampler_reset(er->resampler);
+}
+
+/* st is ordered from the oldest, the slope falls back to the nominal one when
+ * there are too few stamps or they do not make a sane clock
+ */
+static void er_fit(const struct er_stamp *st, int n, double nominal, struct er_fit *fit)
+{
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, x, y, den;
+    int i;
+
+    fit->t_ref = st[n - 1].ns;
+    fit->pos_ref = st[n - 1].pos;
+    fit->a = 0;
+    fit->b = nominal;
+    if (n < 2)
+        return;
+
+    for (i = 0; i < n; i++) {
+        x = (int32_t)(st[i].pos - fit->pos_ref);
+        y = (double)(st[i].ns - fit->t_ref);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    den = n * sxx - sx * sx;
+    if (den > 0)
+        fit->b = (n * sxy - sx * sy) / den;
+    if (fabs(fit->b / nominal - 1.0) > ER_MAX_SLOPE_ERROR)
+        fit->b = nominal;
+    fit->a = (sy - fit->b * sx) / n;
+}
+
+static double er_fit_residual(const struct er_fit *fit, const struct er_stamp *st)
+{
+    return (double)(st->ns - fit->t_ref) -
+           (fit->a + fit->b * (int32_t)(st->pos - fit->pos_ref));
+}
+
+static void er_jitter(double r, double *sq, uint32_t *n, int32_t *max_us)
+{
+    r = fabs(r) / 1000.0;
+    *sq += r * r;
+    (*n)++;
+    if (r > *max_us)
+        *max_us = (int32_t)r;
+}
+
+/* copies the playback stamps of the current clock, returns how many */
+static int er_play_stamps(struct audio_echo_ref *er, struct er_stamp *st, int32_t *last)
+{
+    int32_t wr, wr2, i, first;
+    int n = 0, k;
+
+    wr = android_atomic_acquire_load(&er->stamp_wr);
+    first = wr > ER_STAMPS ? wr - ER_STAMPS : 0;
+    for (i = first; i < wr; i++)
+        st[n++] = er->stamps[i & ER_STAMP_MASK];
+
+    /* the slots the writer moved on to meanwhile are stale */
+    wr2 = android_atomic_acquire_load(&er->stamp_wr);
+    k = wr2 - ER_STAMPS + 1 - first;
+    if (k > 0) {
+        if (k > n)
+            k = n;
+        memmove(st, st + k, (n - k) * sizeof(struct er_stamp));
+        n -= k;
+        first += k;
+    }
+
+    /* keep the stamps from the last start */
+    for (k = n - 1; k > 0 && !st[k].start; k--)
+        ;
+    if (k > 0) {
+        memmove(st, st + k, (n - k) * sizeof(struct er_stamp));
+        n -= k;
+        first += k;
+    }
+    *last = first + n;
+    return n;
+}
+
+size_t audio_echo_ref_read(struct audio_echo_ref *er, int16_t *frames,
+                           size_t count, int64_t capture_ns)
+{
+    struct er_stamp play[ER_STAMPS];
+    struct er_stamp cap[ER_STAMPS];
+    struct er_fit play_fit, cap_fit;
+    int32_t play_last, wr_pos;
+    double pos, step;
+    size_t i, got = 0;
+    uint32_t c, n, k;
+    int np;
+
+    er->stats.reads++;
+
+    /* capture clock */
+    er->cap[er->cap_wr & ER_STAMP_MASK].ns = capture_ns;
+    er->cap[er->cap_wr & ER_STAMP_MASK].pos = er->cap_pos;
+    er->cap_wr++;
+    n = er->cap_wr < ER_STAMPS ? er->cap_wr : ER_STAMPS;
+    for (k = 0; k < n; k++)
+        cap[k] = er->cap[(er->cap_wr - n + k) & ER_STAMP_MASK];
+    er_fit(cap, n, er->frame_ns, &cap_fit);
+    if (n > 2)
+        er_jitter(er_fit_residual(&cap_fit, &cap[n - 1]), &er->cap_sq, &er->cap_n,
+                  &er->stats.cap_jitter_max_us);
+
+    /* playback clock */
+    wr_pos = android_atomic_acquire_load(&er->wr_pos);
+    np = er_play_stamps(er, play, &play_last);
+    if (np == 0) {
+        memset(frames, 0, count * er->channels * sizeof(int16_t));
+        er->stats.underrun_frames += count;
+        er->cap_pos += count;
+        return 0;
+    }
+    er_fit(play, np, er->frame_ns, &play_fit);
+    for (k = 0; k < (uint32_t)np; k++) {
+        if (np > 2 && play_last - np + (int32_t)k >= (int32_t)er->play_seen)
+            er_jitter(er_fit_residual(&play_fit, &play[k]), &er->play_sq, &er->play_n,
+                      &er->stats.play_jitter_max_us);
+    }
+    er->play_seen = play_last;
+
+    /* ring position, relative to wr_pos, of the first capture frame and the
+     * ring frames per capture frame
+     */
+    pos = (double)(cap_fit.t_ref - play_fit.t_ref) + cap_fit.a +
+          cap_fit.b * (int32_t)(er->cap_pos - cap_fit.pos_ref);
+    pos = (int32_t)(play_fit.pos_ref - (uint32_t)wr_pos) + (pos - play_fit.a) / play_fit.b;
+    step = cap_fit.b / play_fit.b;
+    er->stats.drift_ppm = (int32_t)((step - 1.0) * 1000000.0);
+
+    for (i = 0; i < count; i++, pos += step) {
+        int16_t *dst = frames + i * er->channels;
+        double ip = floor(pos);
+        uint32_t idx0, idx1;
+        float f;
+
+        if (ip + 1 >= 0) {
+            er->stats.underrun_frames++;
+            memset(dst, 0, er->channels * sizeof(int16_t));
+            continue;
+        }
+        if (ip < -(double)(er->size / 2)) {
+            er->stats.overrun_frames++;
+            memset(dst, 0, er->channels * sizeof(int16_t));
+            continue;
+        }
+        f = (float)(pos - ip);
+        idx0 = ((uint32_t)wr_pos + (int32_t)ip) & (er->size - 1);
+        idx1 = (idx0 + 1) & (er->size - 1);
+        for (c = 0; c < er->channels; c++) {
+            float s0 = er->ring[idx0 * er->channels + c];
+            float s1 = er->ring[idx1 * er->channels + c];
+            dst[c] = (int16_t)lrintf(s0 + f * (s1 - s0));
+        }
+        got++;
+    }
+    er->cap_pos += count;
+    return got;
+}
+
+void audio_echo_ref_read_stop(struct audio_echo_ref *er)
+{
+    /* the next read starts a new capture clock */
+    er->cap_wr = 0;
+}
+
+void audio_echo_ref_get_stats(struct audio_echo_ref *er,
+                              struct audio_echo_ref_stats *stats)
+{
+    *stats = er->stats;
+    stats->play_jitter_rms_us = er->play_n ? (int32_t)sqrt(er->play_sq / er->play_n) : 0;
+    stats->cap_jitter_rms_us = er->cap_n ? (int32_t)sqrt(er->cap_sq / er->cap_n) : 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_ECHO_REF_H
+#define AUDIO_ECHO_REF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* One playback writer and one capture reader, neither takes a lock. The
+ * playback frames are converted to the capture format when written, and read
+ * back at the playback position rendered when each capture frame was taken.
+ * The times are CLOCK_MONOTONIC nanoseconds.
+ */
+struct audio_echo_ref;
+
+struct audio_echo_ref_stats {
+    uint32_t reads;
+    uint32_t underrun_frames;   /* reference not written yet */
+    uint32_t overrun_frames;    /* reference already overwritten */
+    int32_t play_jitter_rms_us; /* time stamps against their fitted clock */
+    int32_t play_jitter_max_us;
+    int32_t cap_jitter_rms_us;
+    int32_t cap_jitter_max_us;
+    int32_t drift_ppm;          /* playback clock against capture clock */
+};
+
+int audio_echo_ref_create(uint32_t rd_channels, uint32_t rd_rate,
+                          uint32_t wr_channels, uint32_t wr_rate,
+                          struct audio_echo_ref **ref);
+void audio_echo_ref_release(struct audio_echo_ref *ref);
+
+/* render_ns is the time the first frame is heard. The next write after
+ * audio_echo_ref_write_stop() starts a new playback clock.
+ */
+int audio_echo_ref_write(struct audio_echo_ref *ref, const int16_t *frames,
+                         size_t count, int64_t render_ns);
+void audio_echo_ref_write_stop(struct audio_echo_ref *ref);
+
+/* capture_ns is the time the first frame was captured, the frames follow the
+ * ones of the previous read. Returns the frames which got a reference, the
+ * others are zeroed.
+ */
+size_t audio_echo_ref_read(struct audio_echo_ref *ref, int16_t *frames,
+                           size_t count, int64_t capture_ns);
+void audio_echo_ref_read_stop(struct audio_echo_ref *ref);
+
+/* capture side only */
+void audio_echo_ref_get_stats(struct audio_echo_ref *ref,
+                              struct audio_echo_ref_stats *stats);
+
+#endif
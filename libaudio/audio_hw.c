@@ -21,6 +21,7 @@
 #include <pthread.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -29,19 +30,20 @@
 #include <cutils/log.h>
 #include <cutils/str_parms.h>
 #include <cutils/properties.h>
+#include <cutils/atomic.h>
 
 #include <hardware/hardware.h>
 #include <system/audio.h>
 #include <hardware/audio.h>
 
-#include <expat.h>
-
 #include <tinyalsa/asoundlib.h>
 #include <audio_utils/resampler.h>
-#include <audio_utils/echo_reference.h>
 #include <hardware/audio_effect.h>
 #include <audio_effects/effect_aec.h>
+#include "audio_mixer_cfg.h"
 #include "audio_pga.h"
+#include "audio_resampler.h"
+#include "audio_echo_ref.h"
 #include "vb_effect_if.h"
 #include "vb_pga.h"
 
@@ -60,7 +62,14 @@
 //#define AUDIO_DUMP
 #define AUDIO_OUT_FILE_PATH    "data/audio_out.pcm"
 
-#define PRIVATE_NAME_LEN 60
+/* the paths can be given on the command line, for hal_test on the host */
+#ifndef MIXER_CFG_XML_PATH
+#define MIXER_CFG_XML_PATH      "/system/etc/tiny_hw.xml"
+#endif
+/* the xml compiled for the mixer of this device, see audio_mixer_cfg.h */
+#ifndef MIXER_CFG_IMAGE_PATH
+#define MIXER_CFG_IMAGE_PATH    "/data/misc/media/tiny_hw.bin"
+#endif
 
 #define CTL_TRACE(exp) ALOGW(#exp" is %s", ((exp) != NULL) ? "successful" : "failure")
 
@@ -97,6 +106,8 @@
 #define CAPTURE_PERIOD_COUNT 2
 /* minimum sleep time in out_write() when write threshold is not reached */
 #define MIN_WRITE_SLEEP_US 5000
+/* a pacing deadline later than this in the past is restarted from now */
+#define MAX_PACE_LATE_NS 100000000LL
 
 #define RESAMPLER_BUFFER_FRAMES (SHORT_PERIOD_SIZE * 2)
 #define RESAMPLER_BUFFER_SIZE (4 * RESAMPLER_BUFFER_FRAMES)
@@ -158,23 +169,6 @@ struct pcm_config pcm_config_vplayback = {
 
 #define MIN(x, y) ((x) > (y) ? (y) : (x))
 
-struct route_setting
-{
-    char *ctl_name;
-    int intval;
-    char *strval;
-};
-
-struct tiny_dev_cfg {
-    int mask;
-
-    struct route_setting *on;
-    unsigned int on_len;
-
-    struct route_setting *off;
-    unsigned int off_len;
-};
-
 struct tiny_private_ctl {
     struct mixer_ctl *mic_bias_switch;
     struct mixer_ctl *vbc_switch;
@@ -184,13 +178,60 @@ struct tiny_private_ctl {
     struct mixer_ctl *internal_pa;
 };
 
+/*
+ * Mixer controls written outside the xml routes. They are looked up once when the
+ * mixer is opened, and the last value written is kept so that an unchanged value
+ * is not written again. set_route_by_array() forgets the value of any of them a
+ * route writes.
+ */
+enum tiny_ctl_id {
+    TINY_CTL_SPEAKER_MUTE,
+    TINY_CTL_EARPIECE_MUTE,
+    TINY_CTL_HEADPHONE_MUTE,
+    TINY_CTL_INTER_PA_VOLUME,
+    TINY_CTL_MIC_FUNCTION,
+    TINY_CTL_MAX
+};
+
+static const char * const tiny_ctl_names[TINY_CTL_MAX] = {
+    [TINY_CTL_SPEAKER_MUTE]     = "Speaker Mute",
+    [TINY_CTL_EARPIECE_MUTE]    = "Earpiece Mute",
+    [TINY_CTL_HEADPHONE_MUTE]   = "HeadPhone Mute",
+    [TINY_CTL_INTER_PA_VOLUME]  = "Inter PA Playback Volume",
+    [TINY_CTL_MIC_FUNCTION]     = "Mic Function",
+};
+
+struct tiny_ctl {
+    struct mixer_ctl *ctl;
+    bool cached;
+    int value;
+    uint32_t sets;
+    uint32_t writes;
+    uint32_t max_write_us;
+    uint64_t total_write_us;
+};
+
 struct stream_routing_manager {
     pthread_t        routing_switch_thread;
     pthread_mutex_t  device_switch_mutex;
     pthread_cond_t   device_switch_cv;
     bool             is_exit;
+    bool             pending;   /* a switch was asked for since the thread last looked */
 };
 
+/*
+ * Snapshot of the device state used by out_write(), so that a steady-state write only
+ * takes the output stream mutex. Whoever changes one of the fields below calls
+ * publish_out_state() afterwards.
+ */
+#define OUT_STATE_CALL_START        (1 << 0)
+#define OUT_STATE_CALL_CONNECTED    (1 << 1)
+#define OUT_STATE_CALL_PRESTOP      (1 << 2)
+#define OUT_STATE_MODE_IN_CALL      (1 << 3)
+#define OUT_STATE_DEVICE_SCO        (1 << 4)
+#define OUT_STATE_LOW_POWER         (1 << 5)
+#define OUT_STATE_INPUT_ACTIVE      (1 << 6)
+
 struct tiny_audio_device {
     struct audio_hw_device hw_device;
 
@@ -207,14 +248,17 @@ struct tiny_audio_device {
     struct tiny_stream_in *active_input;
     struct tiny_stream_out *active_output;
     bool mic_mute;
-    struct echo_reference_itfe *echo_reference;
+    struct audio_echo_ref *echo_reference;
     bool bluetooth_nrec;
     bool low_power;
 
-    struct tiny_dev_cfg *dev_cfgs;
+    struct mixer_cfg mixer_cfg;
+    struct tiny_dev_cfg *dev_cfgs;      /* mixer_cfg.dev_cfgs */
     unsigned int num_dev_cfgs;
 
     struct tiny_private_ctl private_ctl;
+    pthread_mutex_t ctl_lock;   /* protects ctls, taken last */
+    struct tiny_ctl ctls[TINY_CTL_MAX];
     struct audio_pga *pga;
     bool eq_available;
     
@@ -222,6 +266,9 @@ struct tiny_audio_device {
 
     struct stream_routing_manager  routing_mgr;
     pthread_mutex_t               device_lock;
+
+    pthread_mutex_t state_lock;     /* serializes the writers of out_state */
+    volatile int32_t out_state;     /* OUT_STATE_xxx */
 };
 
 struct tiny_stream_out {
@@ -231,16 +278,19 @@ struct tiny_stream_out {
     struct pcm_config config;
     struct pcm *pcm;
     struct pcm *pcm_vplayback;
-    struct resampler_itfe  *resampler_vplayback;
-    struct resampler_itfe *resampler;
+    struct audio_resampler *resampler_vplayback;
+    struct audio_resampler *resampler;
     char *buffer;
     char * buffer_vplayback;
     int standby;
-    struct echo_reference_itfe *echo_reference;
+    struct audio_echo_ref *echo_reference;
     struct tiny_audio_device *dev;
     int write_threshold;
     bool low_power;
     FILE * out_dump_fd;
+    struct timespec pace_time;      /* deadline of the data written without a pcm */
+    clockid_t tstamp_clock;         /* clock of pcm_get_htimestamp() */
+    bool tstamp_clock_known;
 };
 
 #define MAX_PREPROCESSORS 3 /* maximum one AGC + one NS + one AEC per input stream */
@@ -259,12 +309,13 @@ struct tiny_stream_in {
     unsigned int requested_rate;
     int standby;
     int source;
-    struct echo_reference_itfe *echo_reference;
+    struct audio_echo_ref *echo_reference;
     bool need_echo_reference;
     effect_handle_t preprocessors[MAX_PREPROCESSORS];
     int num_preprocessors;
-    int16_t *proc_buf;
+    int16_t *proc_buf;          /* ring of the frames not yet taken by the pre processings */
     size_t proc_buf_size;
+    size_t proc_rd;
     size_t proc_frames_in;
     int16_t *ref_buf;
     size_t ref_buf_size;
@@ -275,21 +326,7 @@ struct tiny_stream_in {
     int active_rec_proc;
 };
 
-struct config_parse_state {
-    struct tiny_audio_device *adev;
-    struct tiny_dev_cfg *dev;
-    bool on;
-
-    struct route_setting *path;
-    unsigned int path_len;
-
-    char private_name[PRIVATE_NAME_LEN];
-};
-
-static const struct {
-    int mask;
-    const char *name;
-} dev_names[] = {
+static const struct mixer_cfg_dev_name dev_names[] = {
     { AUDIO_DEVICE_OUT_SPEAKER | AUDIO_DEVICE_OUT_FM_SPEAKER, "speaker" },
     { AUDIO_DEVICE_OUT_WIRED_HEADSET | AUDIO_DEVICE_OUT_WIRED_HEADPHONE |AUDIO_DEVICE_OUT_FM_HEADSET,
           "headphone" },
@@ -321,11 +358,14 @@ extern int get_snd_card_number(const char *card_name);
 int set_call_route(struct tiny_audio_device *adev, int device, int on);
 static void select_devices_signal(struct tiny_audio_device *adev);
 static void do_select_devices(struct tiny_audio_device *adev);
-static int set_route_by_array(struct mixer *mixer, struct route_setting *route,unsigned int len);
+static int set_route_by_array(struct tiny_audio_device *adev, struct route_setting *route,unsigned int len);
+static int tiny_ctl_set(struct tiny_audio_device *adev, enum tiny_ctl_id id, int value);
+void codec_mute_set(struct tiny_audio_device *adev);
 static int adev_set_voice_volume(struct audio_hw_device *dev, float volume);
 static int do_input_standby(struct tiny_stream_in *in);
 static int do_output_standby(struct tiny_stream_out *out);
 static void force_all_standby(struct tiny_audio_device *adev);
+static void publish_out_state(struct tiny_audio_device *adev);
 static struct route_setting * get_route_setting (
     struct tiny_audio_device *adev,
     int devices,
@@ -402,7 +442,7 @@ int set_call_route(struct tiny_audio_device *adev, int device, int on)
     cur_setting = get_route_setting(adev, device, on);
     cur_depth = get_route_depth(adev, device, on);
     if (adev->mixer && cur_setting)
-        set_route_by_array(adev->mixer, cur_setting, cur_depth);
+        set_route_by_array(adev, cur_setting, cur_depth);
 #ifdef _VOICE_CALL_VIA_LINEIN
     //open Mic Bias
     mixer_ctl_set_value(adev->private_ctl.mic_bias_switch, 0, on);
@@ -448,22 +488,31 @@ static int get_route_depth (
 
 /* The enable flag when 0 makes the assumption that enums are disabled by
  * "Off" and integers/booleans by 0 */
-static int set_route_by_array(struct mixer *mixer, struct route_setting *route,
+static int set_route_by_array(struct tiny_audio_device *adev, struct route_setting *route,
 			      unsigned int len)
 {
     struct mixer_ctl *ctl;
-    unsigned int i, j, ret;
+    unsigned int i, j, k, ret;
 
     /* Go through the route array and set each value */
     for (i = 0; i < len; i++) {
-        ctl = mixer_get_ctl_by_name(mixer, route[i].ctl_name);
-        if (!ctl) {
-            ALOGE("Unknown control '%s'\n", route[i].ctl_name);
+        ctl = route[i].ctl;
+        if (!ctl)
             continue;
+
+        pthread_mutex_lock(&adev->ctl_lock);
+        for (k = 0; k < TINY_CTL_MAX; k++) {
+            if (adev->ctls[k].ctl == ctl)
+                adev->ctls[k].cached = false;
         }
+        pthread_mutex_unlock(&adev->ctl_lock);
 
         if (route[i].strval) {
-            ret = mixer_ctl_set_enum_by_string(ctl, route[i].strval);
+            /* the item was looked up when the config was loaded */
+            if (route[i].enum_item >= 0)
+                ret = mixer_ctl_set_value(ctl, 0, route[i].enum_item);
+            else
+                ret = mixer_ctl_set_enum_by_string(ctl, route[i].strval);
             if (ret != 0) {
                 ALOGE("Failed to set '%s' to '%s'\n",
                 route[i].ctl_name, route[i].strval);
@@ -489,51 +538,71 @@ static int set_route_by_array(struct mixer *mixer, struct route_setting *route,
     return 0;
 }
 
-void codec_mute_set(struct tiny_audio_device *adev)
+static void tiny_ctls_resolve(struct tiny_audio_device *adev)
 {
-    if(adev->codec_mute == 1){
-       struct mixer_ctl* ctl = NULL;
-
-       ctl =mixer_get_ctl_by_name(adev->mixer, "Speaker Mute");
-       if(ctl)
-           mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-       else
-           ALOGE("Speaker Mute error");
+    unsigned int i;
 
-       ctl = mixer_get_ctl_by_name(adev->mixer, "Earpiece Mute");
-       if(ctl)
-           mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-       else
-           ALOGE("Earpiece Mute error");
+    pthread_mutex_lock(&adev->ctl_lock);
+    for (i = 0; i < TINY_CTL_MAX; i++) {
+        adev->ctls[i].ctl = mixer_get_ctl_by_name(adev->mixer, tiny_ctl_names[i]);
+        adev->ctls[i].cached = false;
+        if (!adev->ctls[i].ctl)
+            ALOGW("mixer control '%s' not found", tiny_ctl_names[i]);
+    }
+    pthread_mutex_unlock(&adev->ctl_lock);
+}
 
-       ctl = mixer_get_ctl_by_name(adev->mixer, "HeadPhone Mute");
-       if(ctl)
-           mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-       else
-           ALOGE("HeadPhone Mute error");
+/* Writes the first value of a control unless it already holds value */
+static int tiny_ctl_set(struct tiny_audio_device *adev, enum tiny_ctl_id id, int value)
+{
+    struct tiny_ctl *c = &adev->ctls[id];
+    struct timespec t0, t1;
+    uint32_t us;
+    int ret = 0;
 
-       } else if (adev->codec_mute == 0){
-           struct mixer_ctl* ctl = NULL;
+    pthread_mutex_lock(&adev->ctl_lock);
+    c->sets++;
+    if (!c->ctl) {
+        ALOGE("%s error", tiny_ctl_names[id]);
+        ret = -ENODEV;
+    } else if (!c->cached || c->value != value) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        ret = mixer_ctl_set_value(c->ctl, 0, value);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        us = (t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_nsec - t0.tv_nsec) / 1000;
+        c->writes++;
+        c->total_write_us += us;
+        if (us > c->max_write_us)
+            c->max_write_us = us;
+        c->cached = (ret == 0);
+        c->value = value;
+    }
+    pthread_mutex_unlock(&adev->ctl_lock);
 
-           ctl = mixer_get_ctl_by_name(adev->mixer, "Speaker Mute");
-           if(ctl)
-               mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-           else
-               ALOGE("Speaker Mute error");
+    return ret;
+}
 
-           ctl = mixer_get_ctl_by_name(adev->mixer, "Earpiece Mute");
-           if(ctl)
-               mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-           else
-               ALOGE("Earpiece Mute error");
+static void tiny_ctls_dump(struct tiny_audio_device *adev, int fd)
+{
+    struct tiny_ctl *c;
+    unsigned int i;
 
-           ctl = mixer_get_ctl_by_name(adev->mixer, "HeadPhone Mute");
-           if(ctl)
-               mixer_ctl_set_value(ctl, 0, adev->codec_mute);
-           else
-               ALOGE("HeadPhone Mute error");
-       }
+    dprintf(fd, "mixer controls:               sets  writes  avg_us  max_us\n");
+    pthread_mutex_lock(&adev->ctl_lock);
+    for (i = 0; i < TINY_CTL_MAX; i++) {
+        c = &adev->ctls[i];
+        dprintf(fd, "  %-26s %6u %7u %7u %7u%s\n", tiny_ctl_names[i], c->sets, c->writes,
+                c->writes ? (uint32_t)(c->total_write_us / c->writes) : 0,
+                c->max_write_us, c->ctl ? "" : " (not found)");
+    }
+    pthread_mutex_unlock(&adev->ctl_lock);
+}
 
+void codec_mute_set(struct tiny_audio_device *adev)
+{
+    tiny_ctl_set(adev, TINY_CTL_SPEAKER_MUTE, adev->codec_mute);
+    tiny_ctl_set(adev, TINY_CTL_EARPIECE_MUTE, adev->codec_mute);
+    tiny_ctl_set(adev, TINY_CTL_HEADPHONE_MUTE, adev->codec_mute);
 }
 
 /* Must be called with route_lock */
@@ -566,7 +635,7 @@ static void do_select_devices(struct tiny_audio_device *adev)
 	        continue;
 	    }
 #endif
-	    set_route_by_array(adev->mixer, adev->dev_cfgs[i].on,
+	    set_route_by_array(adev, adev->dev_cfgs[i].on,
 			       adev->dev_cfgs[i].on_len);
     }
 
@@ -580,7 +649,7 @@ static void do_select_devices(struct tiny_audio_device *adev)
 	        continue;
 	    }
 #endif
-	    set_route_by_array(adev->mixer, adev->dev_cfgs[i].off,
+	    set_route_by_array(adev, adev->dev_cfgs[i].off,
 			       adev->dev_cfgs[i].off_len);
     }
 
@@ -593,10 +662,12 @@ static void do_select_devices(struct tiny_audio_device *adev)
 	pthread_mutex_unlock(&adev->device_lock);
 }
 
+/* does not wait for a switch in progress, the ones asked for meanwhile are done as one */
 static void select_devices_signal(struct tiny_audio_device *adev)
 {
     ALOGI("select_devices_signal starting...");
     pthread_mutex_lock(&adev->routing_mgr.device_switch_mutex);
+    adev->routing_mgr.pending = true;
     pthread_cond_signal(&adev->routing_mgr.device_switch_cv);
     pthread_mutex_unlock(&adev->routing_mgr.device_switch_mutex);
     ALOGI("select_devices_signal finished.");
@@ -656,6 +727,29 @@ static void force_all_standby(struct tiny_audio_device *adev)
     }
 }
 
+static void publish_out_state(struct tiny_audio_device *adev)
+{
+    int32_t state = 0;
+
+    pthread_mutex_lock(&adev->state_lock);
+    if (adev->call_start)
+        state |= OUT_STATE_CALL_START;
+    if (adev->call_connected)
+        state |= OUT_STATE_CALL_CONNECTED;
+    if (adev->call_prestop)
+        state |= OUT_STATE_CALL_PRESTOP;
+    if (adev->mode == AUDIO_MODE_IN_CALL)
+        state |= OUT_STATE_MODE_IN_CALL;
+    if (adev->devices & AUDIO_DEVICE_OUT_ALL_SCO)
+        state |= OUT_STATE_DEVICE_SCO;
+    if (adev->low_power)
+        state |= OUT_STATE_LOW_POWER;
+    if (adev->active_input)
+        state |= OUT_STATE_INPUT_ACTIVE;
+    android_atomic_release_store(state, &adev->out_state);
+    pthread_mutex_unlock(&adev->state_lock);
+}
+
 static void select_mode(struct tiny_audio_device *adev)
 {
     if (adev->mode == AUDIO_MODE_IN_CALL) {
@@ -666,6 +760,7 @@ static void select_mode(struct tiny_audio_device *adev)
             adev->call_start = 1;
         }
 #endif
+        publish_out_state(adev);
     } else {
         ALOGE("Leaving IN_CALL state, call_start=%d, mode=%d devices:0x%x ",
 	            adev->call_start, adev->mode,adev->devices);
@@ -675,6 +770,7 @@ static void select_mode(struct tiny_audio_device *adev)
             adev->call_start = 0;
         }
 #endif
+        publish_out_state(adev);
     }
 }
 
@@ -715,12 +811,11 @@ static int start_output_stream(struct tiny_stream_out *out)
             return 0;
         }
         else {
-            ret = create_resampler( DEFAULT_OUT_SAMPLING_RATE,
-                                    out->config .rate,
-                                    out->config.channels,
-                                    RESAMPLER_QUALITY_DEFAULT,
-                                    NULL,
-                                    &out->resampler_vplayback);
+            ret = audio_resampler_create(DEFAULT_OUT_SAMPLING_RATE,
+                                         out->config.rate,
+                                         out->config.channels,
+                                         AUDIO_RESAMPLER_QUALITY,
+                                         &out->resampler_vplayback);
             if (ret != 0) {
                 ALOGE("can't  create_resampler");
                 pcm_close(out->pcm_vplayback);
@@ -752,7 +847,7 @@ static int start_output_stream(struct tiny_stream_out *out)
     if (adev->echo_reference != NULL)
         out->echo_reference = adev->echo_reference;
 
-    out->resampler->reset(out->resampler);
+    audio_resampler_reset(out->resampler);
 #ifdef AUDIO_DUMP
     out_dump_create(&out->out_dump_fd, AUDIO_OUT_FILE_PATH);
 #endif
@@ -803,7 +898,7 @@ static size_t get_input_buffer_size(uint32_t sample_rate, int format, int channe
 }
 
 static void add_echo_reference(struct tiny_stream_out *out,
-                               struct echo_reference_itfe *reference)
+                               struct audio_echo_ref *reference)
 {
     pthread_mutex_lock(&out->lock);
     out->echo_reference = reference;
@@ -811,30 +906,37 @@ static void add_echo_reference(struct tiny_stream_out *out,
 }
 
 static void remove_echo_reference(struct tiny_stream_out *out,
-                                  struct echo_reference_itfe *reference)
+                                  struct audio_echo_ref *reference)
 {
     pthread_mutex_lock(&out->lock);
     if (out->echo_reference == reference) {
         /* stop writing to echo reference */
-        reference->write(reference, NULL);
+        audio_echo_ref_write_stop(reference);
         out->echo_reference = NULL;
     }
     pthread_mutex_unlock(&out->lock);
 }
 
 static void put_echo_reference(struct tiny_audio_device *adev,
-                          struct echo_reference_itfe *reference)
+                          struct audio_echo_ref *reference)
 {
+    struct audio_echo_ref_stats stats;
+
     if (adev->echo_reference != NULL &&
             reference == adev->echo_reference) {
         if (adev->active_output != NULL)
             remove_echo_reference(adev->active_output, reference);
-        release_echo_reference(reference);
+        audio_echo_ref_get_stats(reference, &stats);
+        ALOGI("echo reference: %u reads, %u underrun %u overrun frames, "
+              "jitter rms playback %d us capture %d us, drift %d ppm",
+              stats.reads, stats.underrun_frames, stats.overrun_frames,
+              stats.play_jitter_rms_us, stats.cap_jitter_rms_us, stats.drift_ppm);
+        audio_echo_ref_release(reference);
         adev->echo_reference = NULL;
     }
 }
 
-static struct echo_reference_itfe *get_echo_reference(struct tiny_audio_device *adev,
+static struct audio_echo_ref *get_echo_reference(struct tiny_audio_device *adev,
                                                audio_format_t format,
                                                uint32_t channel_count,
                                                uint32_t sampling_rate)
@@ -845,10 +947,8 @@ static struct echo_reference_itfe *get_echo_reference(struct tiny_audio_device *
         uint32_t wr_channel_count = popcount(stream->get_channels(stream));
         uint32_t wr_sampling_rate = stream->get_sample_rate(stream);
 
-        int status = create_echo_reference(AUDIO_FORMAT_PCM_16_BIT,
-                                           channel_count,
+        int status = audio_echo_ref_create(channel_count,
                                            sampling_rate,
-                                           AUDIO_FORMAT_PCM_16_BIT,
                                            wr_channel_count,
                                            wr_sampling_rate,
                                            &adev->echo_reference);
@@ -858,30 +958,53 @@ static struct echo_reference_itfe *get_echo_reference(struct tiny_audio_device *
     return adev->echo_reference;
 }
 
-static int get_playback_delay(struct tiny_stream_out *out,
-                       size_t frames,
-                       struct echo_reference_buffer *buffer)
+static int64_t timespec_to_ns(const struct timespec *ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+static void ns_to_timespec(int64_t ns, struct timespec *ts)
+{
+    ts->tv_sec = (time_t)(ns / 1000000000LL);
+    ts->tv_nsec = (long)(ns % 1000000000LL);
+}
+
+/* pcm_get_htimestamp() returns CLOCK_MONOTONIC or CLOCK_REALTIME depending on
+ * the kernel, the echo reference works on CLOCK_MONOTONIC */
+static int64_t pcm_tstamp_to_monotonic_ns(const struct timespec *tstamp)
+{
+    struct timespec now_mono, now_real;
+    int64_t ts_ns, mono_ns, real_ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &now_mono);
+    clock_gettime(CLOCK_REALTIME, &now_real);
+    ts_ns = timespec_to_ns(tstamp);
+    mono_ns = timespec_to_ns(&now_mono);
+    real_ns = timespec_to_ns(&now_real);
+
+    if (llabs(real_ns - ts_ns) < llabs(mono_ns - ts_ns))
+        return ts_ns - real_ns + mono_ns;
+    return ts_ns;
+}
+
+/* time at which the first frame written next is rendered */
+static int get_playback_delay(struct tiny_stream_out *out, int64_t *render_ns)
 {
-    size_t kernel_frames;
+    unsigned int kernel_frames;
+    struct timespec tstamp;
     int status;
 
-    status = pcm_get_htimestamp(out->pcm, &kernel_frames, &buffer->time_stamp);
+    status = pcm_get_htimestamp(out->pcm, &kernel_frames, &tstamp);
     if (status < 0) {
-        buffer->time_stamp.tv_sec  = 0;
-        buffer->time_stamp.tv_nsec = 0;
-        buffer->delay_ns           = 0;
-        ALOGV("get_playback_delay(): pcm_get_htimestamp error,"
-                "setting playbackTimestamp to 0");
+        ALOGV("get_playback_delay(): pcm_get_htimestamp error");
         return status;
     }
 
     kernel_frames = pcm_get_buffer_size(out->pcm) - kernel_frames;
 
-    /* adjust render time stamp with delay added by current driver buffer.
-     * Add the duration of current frame as we want the render time of the last
-     * sample being written. */
-    buffer->delay_ns = (long)(((int64_t)(kernel_frames + frames)* 1000000000)/
-                            DEFAULT_OUT_SAMPLING_RATE);
+    /* the frames queued in the driver are rendered first */
+    *render_ns = pcm_tstamp_to_monotonic_ns(&tstamp) +
+            (int64_t)kernel_frames * 1000000000LL / out->config.rate;
 
     return 0;
 }
@@ -945,13 +1068,13 @@ static int do_output_standby(struct tiny_stream_out *out)
                 out->buffer_vplayback = 0;
             }
             if(out->resampler_vplayback) {
-                release_resampler(out->resampler_vplayback);
+                audio_resampler_release(out->resampler_vplayback);
                 out->resampler_vplayback = 0;
             }
         }
         /* stop writing to echo reference */
         if (out->echo_reference != NULL) {
-            out->echo_reference->write(out->echo_reference, NULL);
+            audio_echo_ref_write_stop(out->echo_reference);
             out->echo_reference = NULL;
         }
 #ifdef AUDIO_DUMP
@@ -1000,18 +1123,18 @@ static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
     if (ret >= 0) {
         val = atoi(value);
         ALOGW("[out_set_parameters],after str_parms_get_str,val(0x%x) ",val);
+        /* the route is device state, a write in progress on the stream does not hold it up */
         pthread_mutex_lock(&adev->lock);
-        pthread_mutex_lock(&out->lock);
         if ((((adev->devices & AUDIO_DEVICE_OUT_ALL) != val) && (val != 0)) || (AUDIO_MODE_IN_CALL == adev->mode)) {
             adev->devices &= ~AUDIO_DEVICE_OUT_ALL;
             adev->devices |= val;
+            publish_out_state(adev);
             ALOGW("out_set_parameters want to set devices:0x%x old_mode:%d new_mode:%d call_start:%d ",adev->devices,cur_mode,adev->mode,adev->call_start);
             cur_mode = adev->mode;
             #ifndef _VOICE_CALL_VIA_LINEIN
             if(!adev->call_start)
             #endif
                 select_devices_signal(adev);
-            pthread_mutex_unlock(&out->lock);
             pthread_mutex_unlock(&adev->lock);
 
             if (AUDIO_MODE_IN_CALL == adev->mode) {
@@ -1022,7 +1145,6 @@ static int out_set_parameters(struct audio_stream *stream, const char *kvpairs)
                 }
             }
         }else{
-            pthread_mutex_unlock(&out->lock);
             pthread_mutex_unlock(&adev->lock);
             ALOGW("the same devices(0x%x) with val(0x%x) val is zero...",adev->devices,val);
         }
@@ -1051,26 +1173,99 @@ static int out_set_volume(struct audio_stream_out *stream, float left,
     return -ENOSYS;
 }
 
-static bool out_bypass_data(struct tiny_audio_device *adev,uint32_t frame_size, uint32_t sample_rate, size_t bytes)
+static bool out_bypass_data(int32_t state)
 {
     /*
         1. There is some time between call_start and call_connected, we should throw away some data here.
         2. During in  AUDIO_MODE_IN_CALL and not in call_start, we should throw away some data in BT device.
     */
-       if (( (!adev->call_start) && (adev->mode == AUDIO_MODE_IN_CALL) && (adev->devices & AUDIO_DEVICE_OUT_ALL_SCO) )
-        || (adev->call_start && (!adev->call_connected)) || adev->call_prestop) {
-//           ALOGI("out_write throw away data call_start(%d) mode(%d) devices(0x%x) call_connected(%d)...",adev->call_start,adev->mode,adev->devices,adev->call_connected);
-           usleep(bytes * 1000000 / frame_size / sample_rate);
-           return true;
-       }else{
-         return false;
-       }
+    if (((!(state & OUT_STATE_CALL_START)) && (state & OUT_STATE_MODE_IN_CALL) && (state & OUT_STATE_DEVICE_SCO))
+        || ((state & OUT_STATE_CALL_START) && !(state & OUT_STATE_CALL_CONNECTED))
+        || (state & OUT_STATE_CALL_PRESTOP)) {
+        return true;
+    } else {
+        return false;
+    }
+}
+
+/* must be called with output stream mutex locked, the caller sleeps until the returned deadline */
+static void out_pace_deadline(struct tiny_stream_out *out, size_t frames, uint32_t rate,
+                              struct timespec *deadline)
+{
+    struct timespec now;
+    int64_t now_ns, pace_ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    now_ns = timespec_to_ns(&now);
+    pace_ns = timespec_to_ns(&out->pace_time);
+    /* the stream was not paced for a while, start again from now */
+    if (now_ns - pace_ns > MAX_PACE_LATE_NS)
+        pace_ns = now_ns;
+    pace_ns += (int64_t)frames * 1000000000LL / rate;
+    ns_to_timespec(pace_ns, &out->pace_time);
+    *deadline = out->pace_time;
+}
+
+/* the kernel may stamp with either clock, it is told by the first time stamp of the stream */
+static clockid_t out_tstamp_clock(struct tiny_stream_out *out, const struct timespec *time_stamp)
+{
+    struct timespec mono, real;
+    int64_t ts_ns;
+
+    if (!out->tstamp_clock_known) {
+        clock_gettime(CLOCK_MONOTONIC, &mono);
+        clock_gettime(CLOCK_REALTIME, &real);
+        ts_ns = timespec_to_ns(time_stamp);
+        out->tstamp_clock = (llabs(ts_ns - timespec_to_ns(&mono)) <= llabs(ts_ns - timespec_to_ns(&real))) ?
+                            CLOCK_MONOTONIC : CLOCK_REALTIME;
+        out->tstamp_clock_known = true;
+    }
+    return out->tstamp_clock;
+}
+
+/*
+ * must be called with output stream mutex locked
+ * do not allow more than out->write_threshold frames in kernel pcm driver buffer: sleeps until
+ * the time the hw pointer is due to reach the threshold, counted from the time stamp of its
+ * last update rather than from now.
+ */
+static void out_wait_write_threshold(struct tiny_stream_out *out)
+{
+    unsigned int avail;
+    int kernel_frames;
+    struct timespec time_stamp, now, wake;
+    clockid_t clock;
+    int64_t wake_ns, now_ns;
+
+    for (;;) {
+        if (pcm_get_htimestamp(out->pcm, &avail, &time_stamp) < 0)
+            break;
+
+        kernel_frames = pcm_get_buffer_size(out->pcm) - avail;
+        XRUN_TRACE("buffer_size =%d, kernel_frames=%d, wirte_threshold=%d",
+                pcm_get_buffer_size(out->pcm),kernel_frames, out->write_threshold);
+        if (kernel_frames <= out->write_threshold)
+            break;
+
+        clock = out_tstamp_clock(out, &time_stamp);
+        clock_gettime(clock, &now);
+        now_ns = timespec_to_ns(&now);
+        /* rounded up, waking a ns early would find the pointer where it was */
+        wake_ns = timespec_to_ns(&time_stamp) +
+                  ((int64_t)(kernel_frames - out->write_threshold) * 1000000000LL +
+                   out->config.rate - 1) / out->config.rate;
+        /* the hw pointer has not moved since the time stamp */
+        if (wake_ns <= now_ns)
+            wake_ns = now_ns + MIN_WRITE_SLEEP_US * 1000LL;
+        ns_to_timespec(wake_ns, &wake);
+        clock_nanosleep(clock, TIMER_ABSTIME, &wake, NULL);
+    }
 }
 
 static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
                          size_t bytes)
 {
-    int ret;
+    int ret = 0;
     struct tiny_stream_out *out = (struct tiny_stream_out *)stream;
     struct tiny_audio_device *adev = out->dev;
     size_t frame_size = 0;
@@ -1078,51 +1273,63 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
     size_t out_frames =0;
     struct tiny_stream_in *in;
     bool low_power;
-    int kernel_frames;
+    bool pace = false;
+    struct timespec pace_deadline;
+    int32_t state;
     void *buf;
 
-    /* acquiring hw device mutex systematically is useful if a low priority thread is waiting
-     * on the output stream mutex - e.g. executing select_mode() while holding the hw device
-     * mutex
+    /* the device state comes from the snapshot published by publish_out_state(), the hw
+     * device mutex is only needed to leave standby.
      */
-
-    pthread_mutex_lock(&adev->lock);
     pthread_mutex_lock(&out->lock);
+    state = android_atomic_acquire_load(&adev->out_state);
 #ifndef _VOICE_CALL_VIA_LINEIN
-    if (out_bypass_data(adev,audio_stream_frame_size(&stream->common),out_get_sample_rate(&stream->common),bytes)) {
-        pthread_mutex_unlock(&adev->lock);
+    if (out_bypass_data(state)) {
+        frame_size = audio_stream_frame_size(&stream->common);
+        out_pace_deadline(out, bytes / frame_size, out_get_sample_rate(&stream->common), &pace_deadline);
         pthread_mutex_unlock(&out->lock);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &pace_deadline, NULL);
         return bytes;
     }
 #endif
     if (out->standby) {
-        ret = start_output_stream(out);
-        if (ret != 0) {
-            pthread_mutex_unlock(&adev->lock);
-            goto exit;
+        /* respect the hw device > out stream order */
+        pthread_mutex_unlock(&out->lock);
+        pthread_mutex_lock(&adev->lock);
+        pthread_mutex_lock(&out->lock);
+        if (out->standby) {
+            ret = start_output_stream(out);
+            if (ret != 0) {
+                pthread_mutex_unlock(&adev->lock);
+                goto exit;
+            }
+            out->standby = 0;
         }
-        out->standby = 0;
+        pthread_mutex_unlock(&adev->lock);
+        state = android_atomic_acquire_load(&adev->out_state);
     }
-    low_power = adev->low_power && !adev->active_input;
-    pthread_mutex_unlock(&adev->lock);
+    low_power = (state & OUT_STATE_LOW_POWER) && !(state & OUT_STATE_INPUT_ACTIVE);
 
-    if (adev->call_connected) {
-        BLUE_TRACE("vplayback out_write call_start(%d) call_connected(%d) ...in....",adev->call_start,adev->call_connected);
+    if (state & OUT_STATE_CALL_CONNECTED) {
+        BLUE_TRACE("vplayback out_write call_start(%d) call_connected(%d) ...in....",
+                   !!(state & OUT_STATE_CALL_START), !!(state & OUT_STATE_CALL_CONNECTED));
         frame_size = audio_stream_frame_size(&out->stream.common);
         in_frames = bytes / frame_size;
         out_frames = RESAMPLER_BUFFER_SIZE / frame_size;
 
         if(out->pcm_vplayback) {
-            out->resampler_vplayback->resample_from_input(out->resampler_vplayback,
-                                                                (int16_t *)buffer,
-                                                                &in_frames,
-                                                                (int16_t *)out->buffer_vplayback,
-                                                                &out_frames);
+            audio_resampler_process(out->resampler_vplayback,
+                                    (const int16_t *)buffer,
+                                    &in_frames,
+                                    (int16_t *)out->buffer_vplayback,
+                                    &out_frames);
             buf = out->buffer_vplayback;
             ret = pcm_mmap_write(out->pcm_vplayback, (void *)buf, out_frames*frame_size);
         }
-        else
-            usleep(out_frames*1000*1000/out->config.rate);
+        else {
+            out_pace_deadline(out, out_frames, out->config.rate, &pace_deadline);
+            pace = true;
+        }
 
         BLUE_TRACE("vplayback write over result is %d,frame_size is %d in frames %d, out frames %d",ret,frame_size,in_frames,out_frames);
     }
@@ -1145,47 +1352,27 @@ static ssize_t out_write(struct audio_stream_out *stream, const void* buffer,
 
 	    /* only use resampler if required */
 	    if (out->config.rate != DEFAULT_OUT_SAMPLING_RATE) {
-	        out->resampler->resample_from_input(out->resampler,
-	                                            (int16_t *)buffer,
-	                                            &in_frames,
-	                                            (int16_t *)out->buffer,
-	                                            &out_frames);
+	        audio_resampler_process(out->resampler,
+	                                (const int16_t *)buffer,
+	                                &in_frames,
+	                                (int16_t *)out->buffer,
+	                                &out_frames);
 	        buf = out->buffer;
 	    } else {
 	        out_frames = in_frames;
 	        buf = (void *)buffer;
 	    }
 	    if (out->echo_reference != NULL) {
-	        struct echo_reference_buffer b;
-	        b.raw = (void *)buffer;
-	        b.frame_count = in_frames;
+	        int64_t render_ns;
 
-	        get_playback_delay(out, out_frames, &b);
-	        out->echo_reference->write(out->echo_reference, &b);
+	        if (get_playback_delay(out, &render_ns) == 0)
+	            audio_echo_ref_write(out->echo_reference, (const int16_t *)buffer,
+	                                 in_frames, render_ns);
 	    }
 	    XRUN_TRACE("in_frames=%d, out_frames=%d", in_frames, out_frames);
 	    XRUN_TRACE("out->write_threshold=%d, config.avail_min=%d, start_threshold=%d",
 	                out->write_threshold,out->config.avail_min, out->config.start_threshold);
-	    /* do not allow more than out->write_threshold frames in kernel pcm driver buffer */
-	    do {
-	        struct timespec time_stamp;
-
-	        if (pcm_get_htimestamp(out->pcm, (unsigned int *)&kernel_frames, &time_stamp) < 0)
-	            break;
-	        XRUN_TRACE("src_kernel_frames=%d, out_frames=%d", kernel_frames, out_frames);
-
-	        kernel_frames = pcm_get_buffer_size(out->pcm) - kernel_frames;
-	        XRUN_TRACE("buffer_size =%d, kernel_frames=%d, wirte_threshold=%d",
-	                pcm_get_buffer_size(out->pcm),kernel_frames, out->write_threshold);
-	        if (kernel_frames > out->write_threshold) {
-	            unsigned long time = (unsigned long)
-	                    (((int64_t)(kernel_frames - out->write_threshold) * 1000000) /
-	                          DEFAULT_OUT_SAMPLING_RATE);
-	            if (time < MIN_WRITE_SLEEP_US)
-	                time = MIN_WRITE_SLEEP_US;
-	            usleep(time);
-	        }
-	    } while (kernel_frames > out->write_threshold);
+	    out_wait_write_threshold(out);
 
 	    ret = pcm_mmap_write(out->pcm, (void *)buf, out_frames * frame_size);
 #ifdef AUDIO_DUMP
@@ -1202,6 +1389,8 @@ exit:
         do_output_standby(out);
     }
     pthread_mutex_unlock(&out->lock);
+    if (pace)
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &pace_deadline, NULL);
     return bytes;
 }
 
@@ -1230,6 +1419,7 @@ static int start_input_stream(struct tiny_stream_in *in)
     struct tiny_audio_device *adev = in->dev;
 
     adev->active_input = in;
+    publish_out_state(adev);
     ALOGW("start_input_stream in mode:0x%x devices:0x%x call_start:%d ",adev->mode,adev->devices,adev->call_start);
     if (!adev->call_start) {
         adev->devices &= ~AUDIO_DEVICE_IN_ALL;
@@ -1254,6 +1444,7 @@ static int start_input_stream(struct tiny_stream_in *in)
             ALOGE("voice-call rec cannot open pcm_in driver: %s", pcm_get_error(in->pcm));
             pcm_close(in->pcm);
             adev->active_input = NULL;
+            publish_out_state(adev);
             return -ENOMEM;
         }
     } else {
@@ -1262,6 +1453,7 @@ static int start_input_stream(struct tiny_stream_in *in)
             ALOGE("normal rec cannot open pcm_in driver: %s", pcm_get_error(in->pcm));
             pcm_close(in->pcm);
             adev->active_input = NULL;
+            publish_out_state(adev);
             return -ENOMEM;
         }
         /* start to process pcm data captured, such as noise suppression.*/
@@ -1339,6 +1531,7 @@ static int do_input_standby(struct tiny_stream_in *in)
             in->pcm = NULL;
         }
         adev->active_input = 0;
+        publish_out_state(adev);
         if (adev->mode != AUDIO_MODE_IN_CALL) {
             adev->devices &= ~AUDIO_DEVICE_IN_ALL;
             select_devices_signal(adev);
@@ -1346,9 +1539,10 @@ static int do_input_standby(struct tiny_stream_in *in)
 
         if (in->echo_reference != NULL) {
             /* stop reading from echo reference */
-            in->echo_reference->read(in->echo_reference, NULL);
+            audio_echo_ref_read_stop(in->echo_reference);
             put_echo_reference(adev, in->echo_reference);
             in->echo_reference = NULL;
+            in->ref_frames_in = 0;
         }
         if (in->active_rec_proc) {
             AUDPROC_DeInitDp();
@@ -1374,6 +1568,22 @@ static int in_standby(struct audio_stream *stream)
 
 static int in_dump(const struct audio_stream *stream, int fd)
 {
+    struct tiny_stream_in *in = (struct tiny_stream_in *)stream;
+    struct audio_echo_ref_stats stats;
+
+    /* do not wait behind a blocked read */
+    if (pthread_mutex_trylock(&in->lock) != 0)
+        return 0;
+    if (in->echo_reference != NULL) {
+        audio_echo_ref_get_stats(in->echo_reference, &stats);
+        dprintf(fd, "  echo reference: reads %u underrun %u overrun %u frames\n"
+                "    playback jitter rms %d max %d us, capture jitter rms %d max %d us\n"
+                "    drift %d ppm\n",
+                stats.reads, stats.underrun_frames, stats.overrun_frames,
+                stats.play_jitter_rms_us, stats.play_jitter_max_us,
+                stats.cap_jitter_rms_us, stats.cap_jitter_max_us, stats.drift_ppm);
+    }
+    pthread_mutex_unlock(&in->lock);
     return 0;
 }
 
@@ -1433,84 +1643,41 @@ static int in_set_gain(struct audio_stream_in *stream, float gain)
     return 0;
 }
 
-static void get_capture_delay(struct tiny_stream_in *in,
-                       size_t frames,
-                       struct echo_reference_buffer *buffer)
+/* time at which the frame at offset in the process input ring was captured */
+static int get_capture_delay(struct tiny_stream_in *in,
+                       size_t offset,
+                       int64_t *capture_ns)
 {
-
     /* read frames available in kernel driver buffer */
-    size_t kernel_frames;
+    unsigned int kernel_frames;
     struct timespec tstamp;
-    long buf_delay;
-    long rsmp_delay;
-    long kernel_delay;
-    long delay_ns;
+    int64_t kernel_delay;
+    int64_t buf_delay;
+    int64_t rsmp_delay;
+    int64_t proc_delay;
 
     if (pcm_get_htimestamp(in->pcm, &kernel_frames, &tstamp) < 0) {
-        buffer->time_stamp.tv_sec  = 0;
-        buffer->time_stamp.tv_nsec = 0;
-        buffer->delay_ns           = 0;
         ALOGW("read get_capture_delay(): pcm_htimestamp error");
-        return;
+        return -EIO;
     }
 
-    /* read frames available in audio HAL input buffer
-     * add number of frames being read as we want the capture time of first sample
-     * in current buffer */
-    buf_delay = (long)(((int64_t)(in->frames_in + in->proc_frames_in) * 1000000000)
-                                    / in->config.rate);
-    /* add delay introduced by resampler */
+    /* going back from the time stamp: the frames still in the kernel, the ones
+     * read but not resampled yet, the resampler and the frames of the ring
+     * from offset on, the ring runs at the requested rate */
+    kernel_delay = (int64_t)kernel_frames * 1000000000LL / in->config.rate;
+    buf_delay = (int64_t)in->frames_in * 1000000000LL / in->config.rate;
     rsmp_delay = 0;
-    if (in->resampler) {
+    if (in->resampler)
         rsmp_delay = in->resampler->delay_ns(in->resampler);
-    }
-
-    kernel_delay = (long)(((int64_t)kernel_frames * 1000000000) / in->config.rate);
-
-    delay_ns = kernel_delay + buf_delay + rsmp_delay;
-
-    buffer->time_stamp = tstamp;
-    buffer->delay_ns   = delay_ns;
-    ALOGV("get_capture_delay time_stamp = [%ld].[%ld], delay_ns: [%d],"
-         " kernel_delay:[%ld], buf_delay:[%ld], rsmp_delay:[%ld], kernel_frames:[%d], "
-         "in->frames_in:[%d], in->proc_frames_in:[%d], frames:[%d]",
-         buffer->time_stamp.tv_sec , buffer->time_stamp.tv_nsec, buffer->delay_ns,
-         kernel_delay, buf_delay, rsmp_delay, kernel_frames,
-         in->frames_in, in->proc_frames_in, frames);
-
-}
-
-static int32_t update_echo_reference(struct tiny_stream_in *in, size_t frames)
-{
-    struct echo_reference_buffer b;
-    b.delay_ns = 0;
-
-    ALOGV("update_echo_reference, frames = [%d], in->ref_frames_in = [%d],  "
-          "b.frame_count = [%d]",
-         frames, in->ref_frames_in, frames - in->ref_frames_in);
-    if (in->ref_frames_in < frames) {
-        if (in->ref_buf_size < frames) {
-            in->ref_buf_size = frames;
-            in->ref_buf = (int16_t *)realloc(in->ref_buf,
-                                             in->ref_buf_size *
-                                                 in->config.channels * sizeof(int16_t));
-        }
-
-        b.frame_count = frames - in->ref_frames_in;
-        b.raw = (void *)(in->ref_buf + in->ref_frames_in * in->config.channels);
-
-        get_capture_delay(in, frames, &b);
-
-        if (in->echo_reference->read(in->echo_reference, &b) == 0)
-        {
-            in->ref_frames_in += b.frame_count;
-            ALOGV("update_echo_reference: in->ref_frames_in:[%d], "
-                    "in->ref_buf_size:[%d], frames:[%d], b.frame_count:[%d]",
-                 in->ref_frames_in, in->ref_buf_size, frames, b.frame_count);
-        }
-    } else
-        ALOGW("update_echo_reference: NOT enough frames to read ref buffer");
-    return b.delay_ns;
+    proc_delay = (int64_t)(in->proc_frames_in - offset) * 1000000000LL /
+            in->requested_rate;
+
+    *capture_ns = pcm_tstamp_to_monotonic_ns(&tstamp) -
+            kernel_delay - buf_delay - rsmp_delay - proc_delay;
+    ALOGV("get_capture_delay kernel_delay:[%lld], buf_delay:[%lld], "
+          "rsmp_delay:[%lld], proc_delay:[%lld]",
+          kernel_delay, buf_delay, rsmp_delay, proc_delay);
+    return 0;
 }
 
 static int set_preprocessor_param(effect_handle_t handle,
@@ -1546,19 +1713,23 @@ static int set_preprocessor_echo_delay(effect_handle_t handle,
     return set_preprocessor_param(handle, param);
 }
 
+/* in->ref_frames_in frames at the start of the process input ring already had
+ * their reference pushed, the reference of the ones after is read in place at
+ * their capture time, which leaves no echo delay to the AEC */
 static void push_echo_reference(struct tiny_stream_in *in, size_t frames)
 {
-    /* read frames from echo reference buffer and update echo delay
-     * in->ref_frames_in is updated with frames available in in->ref_buf */
-    int32_t delay_us = update_echo_reference(in, frames)/1000;
-    int i;
+    int64_t capture_ns;
     audio_buffer_t buf;
+    int i;
 
-    if (in->ref_frames_in < frames)
-        frames = in->ref_frames_in;
+    if (frames <= in->ref_frames_in)
+        return;
+    if (get_capture_delay(in, in->ref_frames_in, &capture_ns) != 0)
+        return;
 
-    buf.frameCount = frames;
-    buf.raw = in->ref_buf;
+    buf.frameCount = frames - in->ref_frames_in;
+    buf.s16 = in->ref_buf;
+    audio_echo_ref_read(in->echo_reference, in->ref_buf, buf.frameCount, capture_ns);
 
     for (i = 0; i < in->num_preprocessors; i++) {
         if ((*in->preprocessors[i])->process_reverse == NULL)
@@ -1567,15 +1738,10 @@ static void push_echo_reference(struct tiny_stream_in *in, size_t frames)
         (*in->preprocessors[i])->process_reverse(in->preprocessors[i],
                                                &buf,
                                                NULL);
-        set_preprocessor_echo_delay(in->preprocessors[i], delay_us);
+        set_preprocessor_echo_delay(in->preprocessors[i], 0);
     }
 
-    in->ref_frames_in -= buf.frameCount;
-    if (in->ref_frames_in) {
-        memcpy(in->ref_buf,
-               in->ref_buf + buf.frameCount * in->config.channels,
-               in->ref_frames_in * in->config.channels * sizeof(int16_t));
-    }
+    in->ref_frames_in = frames;
 }
 
 static int get_next_buffer(struct resampler_buffer_provider *buffer_provider,
@@ -1651,6 +1817,21 @@ static ssize_t read_frames(struct tiny_stream_in *in, void *buffer, ssize_t fram
                     (int16_t *)((char *)buffer +
                             frames_wr * audio_stream_frame_size(&in->stream.common)),
                     &frames_rd);
+        } else if (in->pcm != NULL && in->frames_in == 0 &&
+                   frames_rd >= in->config.period_size) {
+            /* whole periods go from the driver to the caller without in->buffer */
+            void *dst = (char *)buffer +
+                    frames_wr * audio_stream_frame_size(&in->stream.common);
+            size_t bytes = in->config.period_size *
+                    audio_stream_frame_size(&in->stream.common);
+
+            in->read_status = pcm_read(in->pcm, dst, bytes);
+            if (in->read_status != 0)
+                ALOGE("read_frames() pcm_read status=%d, error: %s",
+                                in->read_status, pcm_get_error(in->pcm));
+            else if (in->active_rec_proc)
+                aud_rec_do_process(dst, bytes);
+            frames_rd = in->config.period_size;
         } else {
             struct resampler_buffer buf = {
                     { raw : NULL, },
@@ -1684,29 +1865,23 @@ static ssize_t process_frames(struct tiny_stream_in *in, void* buffer, ssize_t f
     ssize_t frames_wr = 0;
     audio_buffer_t in_buf;
     audio_buffer_t out_buf;
+    size_t frames_rq, wr, len;
     int i;
 
+    /* in->proc_buf was sized at stream open for twice the stream buffer size */
+    frames_rq = (size_t)frames < in->proc_buf_size ? (size_t)frames : in->proc_buf_size;
     while (frames_wr < frames) {
-        /* first reload enough frames at the end of process input buffer */
-        if (in->proc_frames_in < (size_t)frames) {
+        /* first reload enough frames after the ones left in process input ring */
+        while (in->proc_frames_in < frames_rq) {
             ssize_t frames_rd;
 
-            if (in->proc_buf_size < (size_t)frames) {
-                in->proc_buf_size = (size_t)frames;
-                in->proc_buf = (int16_t *)realloc(in->proc_buf,
-                                         in->proc_buf_size *
-                                             in->config.channels * sizeof(int16_t));
-                ALOGV("process_frames(): in->proc_buf %p size extended to %d frames",
-                     in->proc_buf, in->proc_buf_size);
-            }
-            frames_rd = read_frames(in,
-                                    in->proc_buf +
-                                        in->proc_frames_in * in->config.channels,
-                                    frames - in->proc_frames_in);
-            if (frames_rd < 0) {
-                frames_wr = frames_rd;
-                break;
-            }
+            wr = (in->proc_rd + in->proc_frames_in) % in->proc_buf_size;
+            len = frames_rq - in->proc_frames_in;
+            if (len > in->proc_buf_size - wr)
+                len = in->proc_buf_size - wr;
+            frames_rd = read_frames(in, in->proc_buf + wr * in->config.channels, len);
+            if (frames_rd < 0)
+                return frames_rd;
             in->proc_frames_in += frames_rd;
         }
 
@@ -1714,9 +1889,12 @@ static ssize_t process_frames(struct tiny_stream_in *in, void* buffer, ssize_t f
             push_echo_reference(in, in->proc_frames_in);
 
          /* in_buf.frameCount and out_buf.frameCount indicate respectively
-          * the maximum number of frames to be consumed and produced by process() */
-        in_buf.frameCount = in->proc_frames_in;
-        in_buf.s16 = in->proc_buf;
+          * the maximum number of frames to be consumed and produced by process().
+          * The frames after the end of the ring are passed on the next turn. */
+        in_buf.frameCount = in->proc_buf_size - in->proc_rd;
+        if (in_buf.frameCount > in->proc_frames_in)
+            in_buf.frameCount = in->proc_frames_in;
+        in_buf.s16 = in->proc_buf + in->proc_rd * in->config.channels;
         out_buf.frameCount = frames - frames_wr;
         out_buf.s16 = (int16_t *)buffer + frames_wr * in->config.channels;
 
@@ -1727,13 +1905,13 @@ static ssize_t process_frames(struct tiny_stream_in *in, void* buffer, ssize_t f
 
         /* process() has updated the number of frames consumed and produced in
          * in_buf.frameCount and out_buf.frameCount respectively
-         * move remaining frames to the beginning of in->proc_buf */
+         * the remaining frames stay in place in the ring */
         in->proc_frames_in -= in_buf.frameCount;
-        if (in->proc_frames_in) {
-            memcpy(in->proc_buf,
-                   in->proc_buf + in_buf.frameCount * in->config.channels,
-                   in->proc_frames_in * in->config.channels * sizeof(int16_t));
-        }
+        in->proc_rd = (in->proc_rd + in_buf.frameCount) % in->proc_buf_size;
+        if (in->ref_frames_in > in_buf.frameCount)
+            in->ref_frames_in -= in_buf.frameCount;
+        else
+            in->ref_frames_in = 0;
 
         /* if not enough frames were passed to process(), read more and retry. */
         if (out_buf.frameCount == 0)
@@ -1921,12 +2099,11 @@ static int adev_open_output_stream(struct audio_hw_device *dev,
     if (!out)
         return -ENOMEM;
     memset(out, 0, sizeof(struct tiny_stream_out));
-    ret = create_resampler(DEFAULT_OUT_SAMPLING_RATE,
-                           MM_FULL_POWER_SAMPLING_RATE,
-                           2,
-                           RESAMPLER_QUALITY_DEFAULT,
-                           NULL,
-                           &out->resampler);
+    ret = audio_resampler_create(DEFAULT_OUT_SAMPLING_RATE,
+                                 MM_FULL_POWER_SAMPLING_RATE,
+                                 2,
+                                 AUDIO_RESAMPLER_QUALITY,
+                                 &out->resampler);
     if (ret != 0)
         goto err_open;
     out->buffer = malloc(RESAMPLER_BUFFER_SIZE); /* todo: allow for reallocing */
@@ -1985,12 +2162,12 @@ static void adev_close_output_stream(struct audio_hw_device *dev,
     if (out->buffer)
         free(out->buffer);
     if (out->resampler)
-        release_resampler(out->resampler);
+        audio_resampler_release(out->resampler);
 
     if(out->buffer_vplayback)
         free(out->buffer_vplayback);
     if(out->resampler_vplayback)
-        release_resampler(out->resampler_vplayback);
+        audio_resampler_release(out->resampler_vplayback);
     free(stream);
 }
 
@@ -2013,12 +2190,19 @@ static int adev_set_parameters(struct audio_hw_device *dev, const char *kvpairs)
             adev->bluetooth_nrec = false;
     }
 
+    /* sent after codec_pga.xml was rewritten, streams keep playing meanwhile */
+    ret = str_parms_get_str(parms, "pga_reload", value, sizeof(value));
+    if (ret >= 0) {
+        audio_pga_reload(adev->pga);
+    }
+
     ret = str_parms_get_str(parms, "screen_state", value, sizeof(value));
     if (ret >= 0) {
         if (strcmp(value, AUDIO_PARAMETER_VALUE_ON) == 0)
             adev->low_power = false;
         else
             adev->low_power = true;
+        publish_out_state(adev);
     }
 
     str_parms_destroy(parms);
@@ -2152,17 +2336,28 @@ static int adev_open_input_stream(struct audio_hw_device *dev,
         memcpy(&in->config, &pcm_config_mm_ul, sizeof(pcm_config_mm_ul));
     in->config.channels = channel_count;
 
+    /* the capture pipeline is sized once here, in_read() does not allocate: one
+     * period for the driver reads, and a ring of two stream buffers for the
+     * frames waiting for the pre processings, with their echo reference
+     */
+    in->buffer = malloc(in->config.period_size *
+            audio_stream_frame_size(&in->stream.common));
+    in->proc_buf_size = 2 * in_get_buffer_size(&in->stream.common) /
+            audio_stream_frame_size(&in->stream.common);
+    in->proc_buf = malloc(in->proc_buf_size *
+            audio_stream_frame_size(&in->stream.common));
+    in->ref_buf_size = in->proc_buf_size;
+    in->ref_buf = malloc(in->ref_buf_size *
+            audio_stream_frame_size(&in->stream.common));
+    if (!in->buffer || !in->proc_buf || !in->ref_buf) {
+        ret = -ENOMEM;
+        goto err;
+    }
+
     if (in->requested_rate != in->config.rate) {
         in->buf_provider.get_next_buffer = get_next_buffer;
         in->buf_provider.release_buffer = release_buffer;
 
-        in->buffer = malloc(in->config.period_size *
-                audio_stream_frame_size(&in->stream.common));
-        if (!in->buffer) {
-            ret = -ENOMEM;
-            goto err;
-        }
-
         ret = create_resampler(in->config.rate,
                                in->requested_rate,
                                in->config.channels,
@@ -2187,6 +2382,10 @@ err:
     BLUE_TRACE("Failed(%d), adev_open_input_stream.", ret);
     if (in->buffer)
         free(in->buffer);
+    if (in->proc_buf)
+        free(in->proc_buf);
+    if (in->ref_buf)
+        free(in->ref_buf);
     if (in->resampler)
         release_resampler(in->resampler);
 
@@ -2202,10 +2401,10 @@ static void adev_close_input_stream(struct audio_hw_device *dev,
 
     in_standby(&stream->common);
 
-    if (in->resampler) {
-        free(in->buffer);
+    if (in->resampler)
         release_resampler(in->resampler);
-    }
+    if (in->buffer)
+        free(in->buffer);
     if (in->proc_buf)
         free(in->proc_buf);
     if (in->ref_buf)
@@ -2217,34 +2416,28 @@ static void adev_close_input_stream(struct audio_hw_device *dev,
 
 static int adev_dump(const audio_hw_device_t *device, int fd)
 {
+    struct tiny_audio_device *adev = (struct tiny_audio_device *)device;
+
+    tiny_ctls_dump(adev, fd);
+#ifndef _VOICE_CALL_VIA_LINEIN
+    vbc_ctrl_dump(fd);
+#endif
     return 0;
 }
 
 static int adev_close(hw_device_t *device)
 {
-    unsigned int i, j;
     struct tiny_audio_device *adev = (struct tiny_audio_device *)device;
+    /* the routing thread uses the mixer and the config */
+    stream_routing_manager_close(adev);
     /* free audio PGA */
     audio_pga_free(adev->pga);
 #ifndef _VOICE_CALL_VIA_LINEIN
     vbc_ctrl_close();
 #endif
-    //Need to free mixer configs here.
-    for (i=0; i < adev->num_dev_cfgs; i++) {
-        for (j=0; j < adev->dev_cfgs->on_len; j++) {
-            free(adev->dev_cfgs[i].on[j].ctl_name);
-            //Is there a string of strval?
-        };
-        free(adev->dev_cfgs[i].on);
-        for (j=0; j < adev->dev_cfgs->off_len; j++) {
-            free(adev->dev_cfgs[i].off[j].ctl_name);
-        };
-        free(adev->dev_cfgs[i].off);
-    };
-    free(adev->dev_cfgs);
+    mixer_cfg_free(&adev->mixer_cfg);
 
     mixer_close(adev->mixer);
-    stream_routing_manager_close(adev);
     free(device);
     return 0;
 }
@@ -2274,242 +2467,56 @@ static uint32_t adev_get_supported_devices(const struct audio_hw_device *dev)
             AUDIO_DEVICE_IN_DEFAULT);
 }
 
-/* parse the private field of xml config file. */
-static void adev_config_parse_private(struct config_parse_state *s, const XML_Char *name)
-{
-    if (s && name) {
-        if (strcmp(s->private_name, PRIVATE_VBC_CONTROL) == 0) {
-            s->adev->private_ctl.vbc_switch =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.vbc_switch);
-        } else if (strcmp(s->private_name, PRIVATE_VBC_EQ_SWITCH) == 0) {
-            s->adev->private_ctl.vbc_eq_switch =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.vbc_eq_switch);
-        } else if (strcmp(s->private_name, PRIVATE_VBC_EQ_UPDATE) == 0) {
-            s->adev->private_ctl.vbc_eq_update =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.vbc_eq_update);
-        } else if (strcmp(s->private_name, PRIVATE_VBC_EQ_PROFILE) == 0) {
-            s->adev->private_ctl.vbc_eq_profile_select =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.vbc_eq_profile_select);
-        } else if (strcmp(s->private_name, PRIVATE_MIC_BIAS) == 0) {
-            s->adev->private_ctl.mic_bias_switch =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.mic_bias_switch);
-        } else if (strcmp(s->private_name, PRIVATE_INTERNAL_PA) == 0) {
-            s->adev->private_ctl.internal_pa =
-                 mixer_get_ctl_by_name(s->adev->mixer, name);
-            CTL_TRACE(s->adev->private_ctl.internal_pa);
-        }
-    }
-}
-
-static void adev_config_start(void *data, const XML_Char *elem,
-			      const XML_Char **attr)
+/* the controls named by <private> in the xml config file. */
+static void adev_config_private(struct tiny_audio_device *adev,
+                                const struct mixer_cfg_private *p)
 {
-    struct config_parse_state *s = data;
-    struct tiny_dev_cfg *dev_cfg;
-    const XML_Char *name = NULL;
-    const XML_Char *val = NULL;
-    unsigned int i, j;
-
-    for (i = 0; attr[i]; i += 2) {
-	if (strcmp(attr[i], "name") == 0)
-	    name = attr[i + 1];
-
-	if (strcmp(attr[i], "val") == 0)
-	    val = attr[i + 1];
-    }
-
-    if (strcmp(elem, "device") == 0) {
-	if (!name) {
-	    ALOGE("Unnamed device\n");
-	    return;
-	}
-
-	for (i = 0; i < sizeof(dev_names) / sizeof(dev_names[0]); i++) {
-	    if (strcmp(dev_names[i].name, name) == 0) {
-		ALOGI("Allocating device %s\n", name);
-		dev_cfg = realloc(s->adev->dev_cfgs,
-				  (s->adev->num_dev_cfgs + 1)
-				  * sizeof(*dev_cfg));
-		if (!dev_cfg) {
-		    ALOGE("Unable to allocate dev_cfg\n");
-		    return;
-		}
-
-		s->dev = &dev_cfg[s->adev->num_dev_cfgs];
-		memset(s->dev, 0, sizeof(*s->dev));
-		s->dev->mask = dev_names[i].mask;
-
-		s->adev->dev_cfgs = dev_cfg;
-		s->adev->num_dev_cfgs++;
-	    }
-	}
-
-    } else if (strcmp(elem, "path") == 0) {
-	if (s->path_len)
-	    ALOGW("Nested paths\n");
-
-	/* If this a path for a device it must have a role */
-	if (s->dev) {
-	    /* Need to refactor a bit... */
-	    if (strcmp(name, "on") == 0) {
-		s->on = true;
-	    } else if (strcmp(name, "off") == 0) {
-		s->on = false;
-	    } else {
-		ALOGW("Unknown path name %s\n", name);
-	    }
-	}
-
-    } else if (strcmp(elem, "ctl") == 0) {
-	struct route_setting *r;
-
-	if (!name) {
-	    ALOGE("Unnamed control\n");
-	    return;
-	}
-
-	if (!val) {
-	    ALOGE("No value specified for %s\n", name);
-	    return;
-	}
-
-	ALOGI("Parsing control %s => %s\n", name, val);
-
-	r = realloc(s->path, sizeof(*r) * (s->path_len + 1));
-	if (!r) {
-	    ALOGE("Out of memory handling %s => %s\n", name, val);
-	    return;
-	}
-
-	r[s->path_len].ctl_name = strdup(name);
-	r[s->path_len].strval = NULL;
-
-	/* This can be fooled but it'll do */
-	r[s->path_len].intval = atoi(val);
-	if (!r[s->path_len].intval && strcmp(val, "0") != 0)
-	    r[s->path_len].strval = strdup(val);
-
-	s->path = r;
-	s->path_len++;
-        ALOGI("s->path_len=%d", s->path_len);
-    }
-    else if (strcmp(elem, "private") == 0) {
-        memset(s->private_name, 0, PRIVATE_NAME_LEN);
-        memcpy(s->private_name, name, strlen(name));
-    }
-    else if (strcmp(elem, "func") == 0) {
-        adev_config_parse_private(s, name);
-    }
-}
-
-static void adev_config_end(void *data, const XML_Char *name)
-{
-    struct config_parse_state *s = data;
-    unsigned int i;
-
-    if (strcmp(name, "path") == 0) {
-	if (!s->path_len)
-	    ALOGW("Empty path\n");
-
-	if (!s->dev) {
-	    ALOGI("Applying %d element default route\n", s->path_len);
-
-	    set_route_by_array(s->adev->mixer, s->path, s->path_len);
-
-	    for (i = 0; i < s->path_len; i++) {
-		free(s->path[i].ctl_name);
-		free(s->path[i].strval);
-	    }
-
-	    free(s->path);
-
-	    /* Refactor! */
-	} else if (s->on) {
-	    ALOGI("%d element on sequence\n", s->path_len);
-	    s->dev->on = s->path;
-	    s->dev->on_len = s->path_len;
-
-	} else {
-	    ALOGI("%d element off sequence\n", s->path_len);
-
-	    /* Apply it, we'll reenable anything that's wanted later */
-	    set_route_by_array(s->adev->mixer, s->path, s->path_len);
-
-	    s->dev->off = s->path;
-	    s->dev->off_len = s->path_len;
-	}
-
-	s->path_len = 0;
-	s->path = NULL;
-
-    } else if (strcmp(name, "device") == 0) {
-	s->dev = NULL;
+    if (strcmp(p->name, PRIVATE_VBC_CONTROL) == 0) {
+        adev->private_ctl.vbc_switch = p->ctl;
+        CTL_TRACE(adev->private_ctl.vbc_switch);
+    } else if (strcmp(p->name, PRIVATE_VBC_EQ_SWITCH) == 0) {
+        adev->private_ctl.vbc_eq_switch = p->ctl;
+        CTL_TRACE(adev->private_ctl.vbc_eq_switch);
+    } else if (strcmp(p->name, PRIVATE_VBC_EQ_UPDATE) == 0) {
+        adev->private_ctl.vbc_eq_update = p->ctl;
+        CTL_TRACE(adev->private_ctl.vbc_eq_update);
+    } else if (strcmp(p->name, PRIVATE_VBC_EQ_PROFILE) == 0) {
+        adev->private_ctl.vbc_eq_profile_select = p->ctl;
+        CTL_TRACE(adev->private_ctl.vbc_eq_profile_select);
+    } else if (strcmp(p->name, PRIVATE_MIC_BIAS) == 0) {
+        adev->private_ctl.mic_bias_switch = p->ctl;
+        CTL_TRACE(adev->private_ctl.mic_bias_switch);
+    } else if (strcmp(p->name, PRIVATE_INTERNAL_PA) == 0) {
+        adev->private_ctl.internal_pa = p->ctl;
+        CTL_TRACE(adev->private_ctl.internal_pa);
     }
 }
 
 static int adev_config_parse(struct tiny_audio_device *adev)
 {
-    struct config_parse_state s;
-    FILE *f;
-    XML_Parser p;
-    char property[PROPERTY_VALUE_MAX];
-    char file[80];
-    int ret = 0;
-    bool eof = false;
-    int len;
-
-    //property_get("ro.product.device", property, "tiny_hw");
-    snprintf(file, sizeof(file), "/system/etc/%s", "tiny_hw.xml");
-
-    ALOGV("Reading configuration from %s\n", file);
-    f = fopen(file, "r");
-    if (!f) {
-        ALOGE("Failed to open %s\n", file);
-        return -ENODEV;
-    }
-
-    p = XML_ParserCreate(NULL);
-    if (!p) {
-        ALOGE("Failed to create XML parser\n");
-        ret = -ENOMEM;
-        goto out;
-    }
-
-    memset(&s, 0, sizeof(s));
-    s.adev = adev;
-    XML_SetUserData(p, &s);
-
-    XML_SetElementHandler(p, adev_config_start, adev_config_end);
+    struct mixer_cfg *cfg = &adev->mixer_cfg;
+    unsigned int i;
+    int ret;
 
-    while (!eof) {
-        len = fread(file, 1, sizeof(file), f);
-        if (ferror(f)) {
-            ALOGE("I/O error reading config\n");
-            ret = -EIO;
-            goto out_parser;
-        }
-        eof = feof(f);
+    ret = mixer_cfg_load(adev->mixer, MIXER_CFG_XML_PATH, dev_names,
+                         sizeof(dev_names) / sizeof(dev_names[0]),
+                         MIXER_CFG_IMAGE_PATH, cfg);
+    if (ret)
+        return ret;
 
-        if (XML_Parse(p, file, len, eof) == XML_STATUS_ERROR) {
-            ALOGE("Parse error at line %u:\n%s\n",
-        	 (unsigned int)XML_GetCurrentLineNumber(p),
-        	 XML_ErrorString(XML_GetErrorCode(p)));
-            ret = -EINVAL;
-            goto out_parser;
-        }
+    /* The default routes and the off sequences, in the order of the xml.
+     * Anything that's wanted is reenabled later.
+     */
+    for (i = 0; i < cfg->num_init; i++) {
+        ALOGI("Applying %d element route\n", cfg->init[i].len);
+        set_route_by_array(adev, cfg->init[i].route, cfg->init[i].len);
     }
+    for (i = 0; i < cfg->num_privates; i++)
+        adev_config_private(adev, &cfg->privates[i]);
 
- out_parser:
-    XML_ParserFree(p);
- out:
-    fclose(f);
-
-    return ret;
+    adev->dev_cfgs = cfg->dev_cfgs;
+    adev->num_dev_cfgs = cfg->num_dev_cfgs;
+    return 0;
 }
 
 static void aud_vb_effect_start(struct tiny_audio_device *adev)
@@ -2588,38 +2595,36 @@ static int init_rec_process(int rec_mode, int sample_rate)
     return (ret0 || ret1);
 }
 
+/* AUDPROC_ProcessDp() reads each sample before writing it, so it runs in place */
 static int aud_rec_do_process(void * buffer, size_t bytes)
 {
-    int16_t *temp_buf = NULL;
-    size_t read_bytes = bytes;
     unsigned int dest_count = 0;
 
-    temp_buf = (int16_t *) malloc(read_bytes);
-    if (temp_buf) {
-        AUDPROC_ProcessDp((int16 *) buffer, (int16 *) buffer, read_bytes >> 1, temp_buf, temp_buf, &dest_count);
-        memcpy(buffer, temp_buf, read_bytes);
-    } else {
-        ALOGE("temp_buf malloc failed.(len=%d)", (int) read_bytes);
-        return -1;
-    }
-    if (temp_buf)
-        free(temp_buf);
+    AUDPROC_ProcessDp((int16 *) buffer, (int16 *) buffer, bytes >> 1,
+                      (int16 *) buffer, (int16 *) buffer, &dest_count);
     return 0;
 }
 
 static void *stream_routing_thread_entry(void * adev)
 {
     struct tiny_audio_device *cur_adev = (struct tiny_audio_device *)adev;
-    while(!cur_adev->routing_mgr.is_exit) {
+    struct stream_routing_manager *mgr = &cur_adev->routing_mgr;
+
+    pthread_mutex_lock(&mgr->device_switch_mutex);
+    while (!mgr->is_exit) {
+        if (!mgr->pending) {
+            pthread_cond_wait(&mgr->device_switch_cv, &mgr->device_switch_mutex);
+            continue;
+        }
+        mgr->pending = false;
+        /* switch device routing here, select_devices_signal() may be called meanwhile */
+        pthread_mutex_unlock(&mgr->device_switch_mutex);
         ALOGI("stream_routing_thread looping now...");
-        pthread_mutex_lock(&cur_adev->routing_mgr.device_switch_mutex);
-        pthread_cond_wait(&cur_adev->routing_mgr.device_switch_cv,
-                            &cur_adev->routing_mgr.device_switch_mutex);
-        /* switch device routing here.*/
         do_select_devices(cur_adev);
-        pthread_mutex_unlock(&cur_adev->routing_mgr.device_switch_mutex);
         ALOGI("stream_routing_thread looping done.");
+        pthread_mutex_lock(&mgr->device_switch_mutex);
     }
+    pthread_mutex_unlock(&mgr->device_switch_mutex);
     ALOGW("stream_routing_thread_entry exit!!!");
     return 0;
 }
@@ -2629,22 +2634,28 @@ static int stream_routing_manager_create(struct tiny_audio_device *adev)
     int ret;
 
     adev->routing_mgr.is_exit = false;
+    /* initialize mutex and condition variable objects */
+    pthread_mutex_init(&adev->routing_mgr.device_switch_mutex, NULL);
+    pthread_cond_init(&adev->routing_mgr.device_switch_cv, NULL);
     /* create a thread to manager the device routing switch.*/
     ret = pthread_create(&adev->routing_mgr.routing_switch_thread, NULL,
                             stream_routing_thread_entry, (void *)adev);
     if (ret) {
         ALOGE("pthread_create falied, code is %d", ret);
+        pthread_mutex_destroy(&adev->routing_mgr.device_switch_mutex);
+        pthread_cond_destroy(&adev->routing_mgr.device_switch_cv);
         return ret;
     }
-    /* initialize mutex and condition variable objects */
-    pthread_mutex_init(&adev->routing_mgr.device_switch_mutex, NULL);
-    pthread_cond_init(&adev->routing_mgr.device_switch_cv, NULL);
     return ret;
 }
 
 static void stream_routing_manager_close(struct tiny_audio_device *adev)
 {
+    pthread_mutex_lock(&adev->routing_mgr.device_switch_mutex);
     adev->routing_mgr.is_exit = true;
+    pthread_cond_signal(&adev->routing_mgr.device_switch_cv);
+    pthread_mutex_unlock(&adev->routing_mgr.device_switch_mutex);
+    pthread_join(adev->routing_mgr.routing_switch_thread, NULL);
     /* release associated thread resource.*/
     pthread_mutex_destroy(&adev->routing_mgr.device_switch_mutex);
     pthread_cond_destroy(&adev->routing_mgr.device_switch_cv);
@@ -2698,6 +2709,7 @@ static int adev_open(const hw_module_t* module, const char* name,
         ALOGE("Unable to open the mixer, aborting.");
         goto ERROR;
     }
+    tiny_ctls_resolve(adev);
     /* parse mixer ctl */
     ret = adev_config_parse(adev);
     if (ret < 0) {
@@ -2739,6 +2751,7 @@ static int adev_open(const hw_module_t* module, const char* name,
     adev->call_prestop = 0;
     adev->voice_volume = 1.0f;
     adev->bluetooth_nrec = false;
+    publish_out_state(adev);
 
     pthread_mutex_unlock(&adev->lock);
 
@@ -2760,6 +2773,7 @@ static int adev_open(const hw_module_t* module, const char* name,
 
 ERROR:
     if (adev->pga)    audio_pga_free(adev->pga);
+    mixer_cfg_free(&adev->mixer_cfg);
     if (adev->mixer)  mixer_close(adev->mixer);
     if (adev)         free(adev);
     return -EINVAL;
@@ -0,0 +1,921 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_mixer_cfg"
+/*#define LOG_NDEBUG 0*/
+
+#include <errno.h>
+#include <expat.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+
+#include <tinyalsa/asoundlib.h>
+
+#include "audio_mixer_cfg.h"
+
+#define CONFIG_PARSE_BUF_SIZE   1024
+#define PRIVATE_NAME_LEN        60
+
+/*
+ * The image is the parsed config laid out flat: the header, the devices, the
+ * init paths, the private controls, the routes and then the names. Paths are
+ * ranges of the routes, controls are indices of the mixer, names are offsets
+ * into the names. It is only read on the device that wrote it, so the fields
+ * are in its byte order. /data can be written half or damaged, the image
+ * then fails its own hash and the xml is read again.
+ */
+#define MIXER_IMAGE_MAGIC       0x4943584d  /* "MXCI" */
+#define MIXER_IMAGE_VERSION     1
+#define MIXER_IMAGE_NONE        0xffffffffu
+
+struct mixer_image_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t xml_size;
+    int64_t xml_mtime;
+    uint32_t xml_hash;
+    uint32_t mixer_hash;        /* the names, types and enum items of the controls */
+    uint32_t dev_names_hash;
+    uint32_t image_hash;        /* everything after the header */
+    uint32_t num_devs;
+    uint32_t num_init;
+    uint32_t num_privates;
+    uint32_t num_routes;
+    uint32_t names_size;
+};
+
+struct mixer_image_dev {
+    int32_t mask;
+    uint32_t on;
+    uint32_t on_len;
+    uint32_t off;
+    uint32_t off_len;
+};
+
+struct mixer_image_path {
+    uint32_t first;
+    uint32_t len;
+};
+
+struct mixer_image_private {
+    uint32_t name;
+    uint32_t ctl;
+};
+
+struct mixer_image_route {
+    uint32_t ctl;
+    uint32_t name;
+    uint32_t strval;
+    int32_t intval;
+    int32_t enum_item;
+};
+
+/* what the image is valid for */
+struct mixer_image_id {
+    uint32_t xml_size;
+    int64_t xml_mtime;
+    uint32_t xml_hash;
+    uint32_t mixer_hash;
+    uint32_t dev_names_hash;
+};
+
+struct config_parse_state {
+    struct mixer *mixer;
+    struct mixer_cfg *cfg;
+    const struct mixer_cfg_dev_name *dev_names;
+    unsigned int num_dev_names;
+
+    struct tiny_dev_cfg *dev;
+    bool on;
+
+    struct route_setting *path;
+    unsigned int path_len;
+
+    char private_name[PRIVATE_NAME_LEN];
+    bool failed;
+};
+
+/* FNV-1a */
+static uint32_t cfg_hash(uint32_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    while (len--) {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t cfg_hash_str(uint32_t hash, const char *s)
+{
+    return cfg_hash(hash, s, strlen(s) + 1);
+}
+
+static uint32_t cfg_mixer_hash(struct mixer *mixer)
+{
+    uint32_t hash = 2166136261u;
+    uint32_t num = mixer_get_num_ctls(mixer);
+    uint32_t i, e, type;
+    struct mixer_ctl *ctl;
+
+    hash = cfg_hash(hash, &num, sizeof(num));
+    for (i = 0; i < num; i++) {
+        ctl = mixer_get_ctl(mixer, i);
+        type = mixer_ctl_get_type(ctl);
+        hash = cfg_hash_str(hash, mixer_ctl_get_name(ctl));
+        hash = cfg_hash(hash, &type, sizeof(type));
+        if (type != MIXER_CTL_TYPE_ENUM)
+            continue;
+        for (e = 0; e < mixer_ctl_get_num_enums(ctl); e++)
+            hash = cfg_hash_str(hash, mixer_ctl_get_enum_string(ctl, e));
+    }
+    return hash;
+}
+
+static uint32_t cfg_dev_names_hash(const struct mixer_cfg_dev_name *dev_names,
+                                   unsigned int num_dev_names)
+{
+    uint32_t hash = 2166136261u;
+    unsigned int i;
+
+    for (i = 0; i < num_dev_names; i++) {
+        hash = cfg_hash(hash, &dev_names[i].mask, sizeof(dev_names[i].mask));
+        hash = cfg_hash_str(hash, dev_names[i].name);
+    }
+    return hash;
+}
+
+/* The mtime alone is not enough: a system image gives all its files the
+ * same one, so the xml is hashed as well.
+ */
+static int cfg_xml_id(const char *xml_path, struct mixer_image_id *id)
+{
+    struct stat st;
+    char buf[CONFIG_PARSE_BUF_SIZE];
+    uint32_t hash = 2166136261u;
+    ssize_t len;
+    int fd, ret = 0;
+
+    fd = open(xml_path, O_RDONLY);
+    if (fd < 0)
+        return -errno;
+    if (fstat(fd, &st) < 0) {
+        ret = -errno;
+        goto out;
+    }
+    while ((len = read(fd, buf, sizeof(buf))) > 0)
+        hash = cfg_hash(hash, buf, len);
+    if (len < 0) {
+        ret = -errno;
+        goto out;
+    }
+    id->xml_size = (uint32_t)st.st_size;
+    id->xml_mtime = (int64_t)st.st_mtime;
+    id->xml_hash = hash;
+out:
+    close(fd);
+    return ret;
+}
+
+static int cfg_enum_item(struct mixer_ctl *ctl, const char *strval)
+{
+    unsigned int i;
+
+    if (!ctl || !strval || mixer_ctl_get_type(ctl) != MIXER_CTL_TYPE_ENUM)
+        return -1;
+    for (i = 0; i < mixer_ctl_get_num_enums(ctl); i++) {
+        if (strcmp(mixer_ctl_get_enum_string(ctl, i), strval) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static void route_free(struct route_setting *route, unsigned int len)
+{
+    unsigned int i;
+
+    for (i = 0; i < len; i++) {
+        free(route[i].ctl_name);
+        free(route[i].strval);
+    }
+    free(route);
+}
+
+static bool cfg_is_off(const struct mixer_cfg *cfg, const struct route_setting *route)
+{
+    unsigned int i;
+
+    for (i = 0; i < cfg->num_dev_cfgs; i++) {
+        if (route && cfg->dev_cfgs[i].off == route)
+            return true;
+    }
+    return false;
+}
+
+void mixer_cfg_free(struct mixer_cfg *cfg)
+{
+    unsigned int i;
+
+    if (cfg->image) {
+        munmap(cfg->image, cfg->image_size);
+        free(cfg->mem);
+        memset(cfg, 0, sizeof(*cfg));
+        return;
+    }
+
+    /* the off sequences are in init too, they are freed with their device */
+    for (i = 0; i < cfg->num_init; i++) {
+        if (!cfg_is_off(cfg, cfg->init[i].route))
+            route_free(cfg->init[i].route, cfg->init[i].len);
+    }
+    for (i = 0; i < cfg->num_dev_cfgs; i++) {
+        route_free(cfg->dev_cfgs[i].on, cfg->dev_cfgs[i].on_len);
+        route_free(cfg->dev_cfgs[i].off, cfg->dev_cfgs[i].off_len);
+    }
+    for (i = 0; i < cfg->num_privates; i++)
+        free(cfg->privates[i].name);
+    free(cfg->init);
+    free(cfg->dev_cfgs);
+    free(cfg->privates);
+    memset(cfg, 0, sizeof(*cfg));
+}
+
+static bool cfg_add_init(struct config_parse_state *s)
+{
+    struct mixer_cfg *cfg = s->cfg;
+    struct mixer_cfg_path *init;
+
+    init = realloc(cfg->init, (cfg->num_init + 1) * sizeof(*init));
+    if (!init) {
+        s->failed = true;
+        return false;
+    }
+    init[cfg->num_init].route = s->path;
+    init[cfg->num_init].len = s->path_len;
+    cfg->init = init;
+    cfg->num_init++;
+    return true;
+}
+
+static void cfg_add_private(struct config_parse_state *s, const XML_Char *name)
+{
+    struct mixer_cfg *cfg = s->cfg;
+    struct mixer_cfg_private *p;
+
+    p = realloc(cfg->privates, (cfg->num_privates + 1) * sizeof(*p));
+    if (!p) {
+        s->failed = true;
+        return;
+    }
+    cfg->privates = p;
+    p = &p[cfg->num_privates];
+    p->name = strdup(s->private_name);
+    p->ctl = mixer_get_ctl_by_name(s->mixer, name);
+    if (!p->name) {
+        s->failed = true;
+        return;
+    }
+    cfg->num_privates++;
+}
+
+static void cfg_start(void *data, const XML_Char *elem, const XML_Char **attr)
+{
+    struct config_parse_state *s = data;
+    struct mixer_cfg *cfg = s->cfg;
+    struct tiny_dev_cfg *dev_cfg;
+    const XML_Char *name = NULL;
+    const XML_Char *val = NULL;
+    unsigned int i;
+
+    for (i = 0; attr[i]; i += 2) {
+        if (strcmp(attr[i], "name") == 0)
+            name = attr[i + 1];
+
+        if (strcmp(attr[i], "val") == 0)
+            val = attr[i + 1];
+    }
+
+    if (strcmp(elem, "device") == 0) {
+        if (!name) {
+            ALOGE("Unnamed device\n");
+            return;
+        }
+
+        for (i = 0; i < s->num_dev_names; i++) {
+            if (strcmp(s->dev_names[i].name, name) == 0) {
+                ALOGI("Allocating device %s\n", name);
+                dev_cfg = realloc(cfg->dev_cfgs, (cfg->num_dev_cfgs + 1) * sizeof(*dev_cfg));
+                if (!dev_cfg) {
+                    ALOGE("Unable to allocate dev_cfg\n");
+                    s->failed = true;
+                    return;
+                }
+
+                s->dev = &dev_cfg[cfg->num_dev_cfgs];
+                memset(s->dev, 0, sizeof(*s->dev));
+                s->dev->mask = s->dev_names[i].mask;
+
+                cfg->dev_cfgs = dev_cfg;
+                cfg->num_dev_cfgs++;
+            }
+        }
+
+    } else if (strcmp(elem, "path") == 0) {
+        if (s->path_len)
+            ALOGW("Nested paths\n");
+
+        /* If this a path for a device it must have a role */
+        if (s->dev) {
+            if (name && strcmp(name, "on") == 0) {
+                s->on = true;
+            } else if (name && strcmp(name, "off") == 0) {
+                s->on = false;
+            } else {
+                ALOGW("Unknown path name %s\n", name ? name : "");
+            }
+        }
+
+    } else if (strcmp(elem, "ctl") == 0) {
+        struct route_setting *r;
+
+        if (!name) {
+            ALOGE("Unnamed control\n");
+            return;
+        }
+
+        if (!val) {
+            ALOGE("No value specified for %s\n", name);
+            return;
+        }
+
+        ALOGI("Parsing control %s => %s\n", name, val);
+
+        r = realloc(s->path, sizeof(*r) * (s->path_len + 1));
+        if (!r) {
+            ALOGE("Out of memory handling %s => %s\n", name, val);
+            s->failed = true;
+            return;
+        }
+        s->path = r;
+        r = &r[s->path_len];
+
+        r->ctl_name = strdup(name);
+        r->strval = NULL;
+        r->ctl = mixer_get_ctl_by_name(s->mixer, name);
+        if (!r->ctl)
+            ALOGE("Unknown control '%s'\n", name);
+
+        /* This can be fooled but it'll do */
+        r->intval = atoi(val);
+        if (!r->intval && strcmp(val, "0") != 0)
+            r->strval = strdup(val);
+        r->enum_item = cfg_enum_item(r->ctl, r->strval);
+
+        s->path_len++;
+        if (!r->ctl_name || (!r->intval && strcmp(val, "0") != 0 && !r->strval))
+            s->failed = true;
+
+    } else if (strcmp(elem, "private") == 0) {
+        memset(s->private_name, 0, PRIVATE_NAME_LEN);
+        if (name)
+            strncpy(s->private_name, name, PRIVATE_NAME_LEN - 1);
+
+    } else if (strcmp(elem, "func") == 0) {
+        if (name)
+            cfg_add_private(s, name);
+    }
+}
+
+static void cfg_end(void *data, const XML_Char *name)
+{
+    struct config_parse_state *s = data;
+
+    if (strcmp(name, "path") == 0) {
+        if (!s->path_len)
+            ALOGW("Empty path\n");
+
+        if (!s->dev) {
+            ALOGI("%d element default route\n", s->path_len);
+            if (!cfg_add_init(s))
+                route_free(s->path, s->path_len);
+        } else if (s->on) {
+            ALOGI("%d element on sequence\n", s->path_len);
+            route_free(s->dev->on, s->dev->on_len);
+            s->dev->on = s->path;
+            s->dev->on_len = s->path_len;
+        } else {
+            ALOGI("%d element off sequence\n", s->path_len);
+
+            /* Applied at open, we'll reenable anything that's wanted later */
+            cfg_add_init(s);
+            s->dev->off = s->path;
+            s->dev->off_len = s->path_len;
+        }
+        s->path_len = 0;
+        s->path = NULL;
+
+    } else if (strcmp(name, "device") == 0) {
+        s->dev = NULL;
+    }
+}
+
+int mixer_cfg_parse(struct mixer *mixer, const char *xml_path,
+                    const struct mixer_cfg_dev_name *dev_names,
+                    unsigned int num_dev_names, struct mixer_cfg *cfg)
+{
+    struct config_parse_state s;
+    FILE *f;
+    XML_Parser p;
+    void *buf;
+    int ret = 0;
+    bool eof = false;
+    int len;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    ALOGV("Reading configuration from %s\n", xml_path);
+    f = fopen(xml_path, "r");
+    if (!f) {
+        ALOGE("Failed to open %s\n", xml_path);
+        return -ENODEV;
+    }
+
+    p = XML_ParserCreate(NULL);
+    if (!p) {
+        ALOGE("Failed to create XML parser\n");
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    memset(&s, 0, sizeof(s));
+    s.mixer = mixer;
+    s.cfg = cfg;
+    s.dev_names = dev_names;
+    s.num_dev_names = num_dev_names;
+    XML_SetUserData(p, &s);
+
+    XML_SetElementHandler(p, cfg_start, cfg_end);
+
+    while (!eof) {
+        buf = XML_GetBuffer(p, CONFIG_PARSE_BUF_SIZE);
+        if (!buf) {
+            ret = -ENOMEM;
+            goto out_parser;
+        }
+        len = fread(buf, 1, CONFIG_PARSE_BUF_SIZE, f);
+        if (ferror(f)) {
+            ALOGE("I/O error reading config\n");
+            ret = -EIO;
+            goto out_parser;
+        }
+        eof = feof(f);
+
+        if (XML_ParseBuffer(p, len, eof) == XML_STATUS_ERROR) {
+            ALOGE("Parse error at line %u:\n%s\n",
+                  (unsigned int)XML_GetCurrentLineNumber(p),
+                  XML_ErrorString(XML_GetErrorCode(p)));
+            ret = -EINVAL;
+            goto out_parser;
+        }
+    }
+    if (s.failed)
+        ret = -ENOMEM;
+
+ out_parser:
+    /* a path left open by an error */
+    route_free(s.path, s.path_len);
+    XML_ParserFree(p);
+ out:
+    fclose(f);
+
+    if (ret)
+        mixer_cfg_free(cfg);
+    return ret;
+}
+
+static int cfg_image_id(struct mixer *mixer, const char *xml_path,
+                        const struct mixer_cfg_dev_name *dev_names,
+                        unsigned int num_dev_names, struct mixer_image_id *id)
+{
+    int ret = cfg_xml_id(xml_path, id);
+
+    if (ret)
+        return ret;
+    id->mixer_hash = cfg_mixer_hash(mixer);
+    id->dev_names_hash = cfg_dev_names_hash(dev_names, num_dev_names);
+    return 0;
+}
+
+static uint32_t cfg_ctl_index(struct mixer *mixer, struct mixer_ctl *ctl)
+{
+    unsigned int i, num = mixer_get_num_ctls(mixer);
+
+    for (i = 0; ctl && i < num; i++) {
+        if (mixer_get_ctl(mixer, i) == ctl)
+            return i;
+    }
+    return MIXER_IMAGE_NONE;
+}
+
+/* the off sequences are stored once, init refers to the routes of the device */
+static uint32_t cfg_image_path(const struct mixer_cfg *cfg, const struct route_setting *route,
+                               uint32_t first)
+{
+    uint32_t i, at = 0;
+
+    for (i = 0; i < cfg->num_dev_cfgs; i++) {
+        at += cfg->dev_cfgs[i].on_len;
+        if (route && cfg->dev_cfgs[i].off == route)
+            return at;
+        at += cfg->dev_cfgs[i].off_len;
+    }
+    return first;
+}
+
+static uint32_t cfg_image_name(char *names, uint32_t *names_len, const char *s)
+{
+    uint32_t at = *names_len;
+
+    if (!s)
+        return MIXER_IMAGE_NONE;
+    strcpy(names + at, s);
+    *names_len += strlen(s) + 1;
+    return at;
+}
+
+static void cfg_image_routes(struct mixer_image_route *out, const struct route_setting *route,
+                             unsigned int len, struct mixer *mixer, char *names,
+                             uint32_t *names_len)
+{
+    unsigned int i;
+
+    for (i = 0; i < len; i++) {
+        out[i].ctl = cfg_ctl_index(mixer, route[i].ctl);
+        out[i].name = cfg_image_name(names, names_len, route[i].ctl_name);
+        out[i].strval = cfg_image_name(names, names_len, route[i].strval);
+        out[i].intval = route[i].intval;
+        out[i].enum_item = route[i].enum_item;
+    }
+}
+
+static size_t cfg_routes_names(const struct route_setting *route, unsigned int len)
+{
+    size_t size = 0;
+    unsigned int i;
+
+    for (i = 0; i < len; i++) {
+        size += strlen(route[i].ctl_name) + 1;
+        if (route[i].strval)
+            size += strlen(route[i].strval) + 1;
+    }
+    return size;
+}
+
+int mixer_cfg_image_write(const struct mixer_cfg *cfg, struct mixer *mixer,
+                          const char *xml_path,
+                          const struct mixer_cfg_dev_name *dev_names,
+                          unsigned int num_dev_names, const char *image_path)
+{
+    struct mixer_image_id id;
+    struct mixer_image_header *hdr;
+    struct mixer_image_dev *dev;
+    struct mixer_image_path *init;
+    struct mixer_image_private *priv;
+    struct mixer_image_route *route;
+    char tmp_path[PATH_MAX];
+    char *image, *names;
+    uint32_t num_routes = 0, names_len = 0, at;
+    size_t names_size = 0, size, done;
+    unsigned int i;
+    ssize_t len;
+    int fd, ret;
+
+    ret = cfg_image_id(mixer, xml_path, dev_names, num_dev_names, &id);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < cfg->num_dev_cfgs; i++) {
+        num_routes += cfg->dev_cfgs[i].on_len + cfg->dev_cfgs[i].off_len;
+        names_size += cfg_routes_names(cfg->dev_cfgs[i].on, cfg->dev_cfgs[i].on_len);
+        names_size += cfg_routes_names(cfg->dev_cfgs[i].off, cfg->dev_cfgs[i].off_len);
+    }
+    for (i = 0; i < cfg->num_init; i++) {
+        if (cfg_is_off(cfg, cfg->init[i].route))
+            continue;
+        num_routes += cfg->init[i].len;
+        names_size += cfg_routes_names(cfg->init[i].route, cfg->init[i].len);
+    }
+    for (i = 0; i < cfg->num_privates; i++)
+        names_size += strlen(cfg->privates[i].name) + 1;
+
+    size = sizeof(*hdr) + cfg->num_dev_cfgs * sizeof(*dev) + cfg->num_init * sizeof(*init)
+            + cfg->num_privates * sizeof(*priv) + num_routes * sizeof(*route) + names_size;
+    image = calloc(1, size);
+    if (!image)
+        return -ENOMEM;
+
+    hdr = (struct mixer_image_header *)image;
+    dev = (struct mixer_image_dev *)(hdr + 1);
+    init = (struct mixer_image_path *)(dev + cfg->num_dev_cfgs);
+    priv = (struct mixer_image_private *)(init + cfg->num_init);
+    route = (struct mixer_image_route *)(priv + cfg->num_privates);
+    names = (char *)(route + num_routes);
+
+    hdr->magic = MIXER_IMAGE_MAGIC;
+    hdr->version = MIXER_IMAGE_VERSION;
+    hdr->size = size;
+    hdr->xml_size = id.xml_size;
+    hdr->xml_mtime = id.xml_mtime;
+    hdr->xml_hash = id.xml_hash;
+    hdr->mixer_hash = id.mixer_hash;
+    hdr->dev_names_hash = id.dev_names_hash;
+    hdr->num_devs = cfg->num_dev_cfgs;
+    hdr->num_init = cfg->num_init;
+    hdr->num_privates = cfg->num_privates;
+    hdr->num_routes = num_routes;
+    hdr->names_size = names_size;
+
+    for (i = 0, at = 0; i < cfg->num_dev_cfgs; i++) {
+        const struct tiny_dev_cfg *d = &cfg->dev_cfgs[i];
+
+        dev[i].mask = d->mask;
+        dev[i].on = at;
+        dev[i].on_len = d->on_len;
+        cfg_image_routes(route + at, d->on, d->on_len, mixer, names, &names_len);
+        at += d->on_len;
+        dev[i].off = at;
+        dev[i].off_len = d->off_len;
+        cfg_image_routes(route + at, d->off, d->off_len, mixer, names, &names_len);
+        at += d->off_len;
+    }
+    for (i = 0; i < cfg->num_init; i++) {
+        init[i].first = cfg_image_path(cfg, cfg->init[i].route, at);
+        init[i].len = cfg->init[i].len;
+        if (init[i].first != at)
+            continue;
+        cfg_image_routes(route + at, cfg->init[i].route, cfg->init[i].len, mixer, names,
+                         &names_len);
+        at += cfg->init[i].len;
+    }
+    for (i = 0; i < cfg->num_privates; i++) {
+        priv[i].name = cfg_image_name(names, &names_len, cfg->privates[i].name);
+        priv[i].ctl = cfg_ctl_index(mixer, cfg->privates[i].ctl);
+    }
+
+    hdr->image_hash = cfg_hash(2166136261u, hdr + 1, size - sizeof(*hdr));
+
+    /* written aside and renamed, an open never sees half an image */
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", image_path);
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        ret = -errno;
+        goto out;
+    }
+    for (done = 0; done < size; done += len) {
+        len = write(fd, image + done, size - done);
+        if (len < 0) {
+            if (errno == EINTR) {
+                len = 0;
+                continue;
+            }
+            ret = -errno;
+            break;
+        }
+    }
+    if (close(fd) < 0 && !ret)
+        ret = -errno;
+    if (!ret && rename(tmp_path, image_path) < 0)
+        ret = -errno;
+    if (ret)
+        unlink(tmp_path);
+out:
+    free(image);
+    return ret;
+}
+
+static bool cfg_image_span(uint32_t first, uint32_t len, uint32_t num)
+{
+    return first <= num && len <= num - first;
+}
+
+static bool cfg_image_str(const struct mixer_image_header *hdr, uint32_t at, bool none_ok)
+{
+    return (none_ok && at == MIXER_IMAGE_NONE) || at < hdr->names_size;
+}
+
+static bool cfg_image_ctl(uint32_t ctl, uint32_t num_ctls)
+{
+    return ctl == MIXER_IMAGE_NONE || ctl < num_ctls;
+}
+
+/* checks every index and offset, the routes are then built without checks */
+static bool cfg_image_check(const struct mixer_image_header *hdr, uint32_t num_ctls)
+{
+    const struct mixer_image_dev *dev = (const struct mixer_image_dev *)(hdr + 1);
+    const struct mixer_image_path *init = (const struct mixer_image_path *)(dev + hdr->num_devs);
+    const struct mixer_image_private *priv =
+            (const struct mixer_image_private *)(init + hdr->num_init);
+    const struct mixer_image_route *route =
+            (const struct mixer_image_route *)(priv + hdr->num_privates);
+    const char *names = (const char *)(route + hdr->num_routes);
+    uint32_t i;
+
+    if (hdr->names_size == 0 || names[hdr->names_size - 1] != '\0')
+        return hdr->names_size == 0 && hdr->num_routes == 0 && hdr->num_privates == 0;
+    for (i = 0; i < hdr->num_devs; i++) {
+        if (!cfg_image_span(dev[i].on, dev[i].on_len, hdr->num_routes) ||
+                !cfg_image_span(dev[i].off, dev[i].off_len, hdr->num_routes))
+            return false;
+    }
+    for (i = 0; i < hdr->num_init; i++) {
+        if (!cfg_image_span(init[i].first, init[i].len, hdr->num_routes))
+            return false;
+    }
+    for (i = 0; i < hdr->num_privates; i++) {
+        if (!cfg_image_str(hdr, priv[i].name, false) || !cfg_image_ctl(priv[i].ctl, num_ctls))
+            return false;
+    }
+    for (i = 0; i < hdr->num_routes; i++) {
+        if (!cfg_image_str(hdr, route[i].name, false) ||
+                !cfg_image_str(hdr, route[i].strval, true) ||
+                !cfg_image_ctl(route[i].ctl, num_ctls))
+            return false;
+    }
+    return true;
+}
+
+static struct mixer_ctl *cfg_image_get_ctl(struct mixer *mixer, uint32_t ctl)
+{
+    return ctl == MIXER_IMAGE_NONE ? NULL : mixer_get_ctl(mixer, ctl);
+}
+
+int mixer_cfg_image_load(struct mixer *mixer, const char *xml_path,
+                         const struct mixer_cfg_dev_name *dev_names,
+                         unsigned int num_dev_names, const char *image_path,
+                         struct mixer_cfg *cfg)
+{
+    const struct mixer_image_header *hdr;
+    const struct mixer_image_dev *dev;
+    const struct mixer_image_path *init;
+    const struct mixer_image_private *priv;
+    const struct mixer_image_route *route;
+    const char *names;
+    struct route_setting *r;
+    struct mixer_image_id id;
+    struct stat st;
+    void *image;
+    size_t size;
+    uint32_t i;
+    int fd, ret;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    fd = open(image_path, O_RDONLY);
+    if (fd < 0)
+        return -errno;
+    if (fstat(fd, &st) < 0) {
+        ret = -errno;
+        close(fd);
+        return ret;
+    }
+    size = st.st_size;
+    if (size < sizeof(*hdr)) {
+        close(fd);
+        return -ESTALE;
+    }
+    image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        return -errno;
+    hdr = image;
+
+    ret = -ESTALE;
+    if (hdr->magic != MIXER_IMAGE_MAGIC || hdr->version != MIXER_IMAGE_VERSION ||
+            hdr->size != size)
+        goto err;
+    /* the counts are checked one by one so the sum can not wrap */
+    if (hdr->num_devs > size / sizeof(*dev) || hdr->num_init > size / sizeof(*init) ||
+            hdr->num_privates > size / sizeof(*priv) ||
+            hdr->num_routes > size / sizeof(*route) || hdr->names_size > size ||
+            sizeof(*hdr) + hdr->num_devs * sizeof(*dev) + hdr->num_init * sizeof(*init)
+            + hdr->num_privates * sizeof(*priv) + hdr->num_routes * sizeof(*route)
+            + hdr->names_size != size)
+        goto err;
+    if (hdr->image_hash != cfg_hash(2166136261u, hdr + 1, size - sizeof(*hdr)))
+        goto err;
+
+    /* the size and the mtime first, they do not need the xml to be read */
+    if (stat(xml_path, &st) < 0 || (uint32_t)st.st_size != hdr->xml_size ||
+            (int64_t)st.st_mtime != hdr->xml_mtime)
+        goto err;
+    if (cfg_image_id(mixer, xml_path, dev_names, num_dev_names, &id) ||
+            id.xml_size != hdr->xml_size || id.xml_mtime != hdr->xml_mtime ||
+            id.xml_hash != hdr->xml_hash || id.mixer_hash != hdr->mixer_hash ||
+            id.dev_names_hash != hdr->dev_names_hash)
+        goto err;
+    if (!cfg_image_check(hdr, mixer_get_num_ctls(mixer)))
+        goto err;
+
+    dev = (const struct mixer_image_dev *)(hdr + 1);
+    init = (const struct mixer_image_path *)(dev + hdr->num_devs);
+    priv = (const struct mixer_image_private *)(init + hdr->num_init);
+    route = (const struct mixer_image_route *)(priv + hdr->num_privates);
+    names = (const char *)(route + hdr->num_routes);
+
+    cfg->mem = calloc(1, hdr->num_devs * sizeof(struct tiny_dev_cfg)
+            + hdr->num_init * sizeof(struct mixer_cfg_path)
+            + hdr->num_privates * sizeof(struct mixer_cfg_private)
+            + hdr->num_routes * sizeof(struct route_setting));
+    if (!cfg->mem) {
+        ret = -ENOMEM;
+        goto err;
+    }
+    cfg->dev_cfgs = cfg->mem;
+    cfg->init = (struct mixer_cfg_path *)(cfg->dev_cfgs + hdr->num_devs);
+    cfg->privates = (struct mixer_cfg_private *)(cfg->init + hdr->num_init);
+    r = (struct route_setting *)(cfg->privates + hdr->num_privates);
+
+    for (i = 0; i < hdr->num_routes; i++) {
+        r[i].ctl_name = (char *)names + route[i].name;
+        r[i].strval = route[i].strval == MIXER_IMAGE_NONE ? NULL : (char *)names + route[i].strval;
+        r[i].intval = route[i].intval;
+        r[i].enum_item = route[i].enum_item;
+        r[i].ctl = cfg_image_get_ctl(mixer, route[i].ctl);
+    }
+    for (i = 0; i < hdr->num_devs; i++) {
+        cfg->dev_cfgs[i].mask = dev[i].mask;
+        cfg->dev_cfgs[i].on = dev[i].on_len ? r + dev[i].on : NULL;
+        cfg->dev_cfgs[i].on_len = dev[i].on_len;
+        cfg->dev_cfgs[i].off = dev[i].off_len ? r + dev[i].off : NULL;
+        cfg->dev_cfgs[i].off_len = dev[i].off_len;
+    }
+    for (i = 0; i < hdr->num_init; i++) {
+        cfg->init[i].route = init[i].len ? r + init[i].first : NULL;
+        cfg->init[i].len = init[i].len;
+    }
+    for (i = 0; i < hdr->num_privates; i++) {
+        cfg->privates[i].name = (char *)names + priv[i].name;
+        cfg->privates[i].ctl = cfg_image_get_ctl(mixer, priv[i].ctl);
+    }
+    cfg->num_dev_cfgs = hdr->num_devs;
+    cfg->num_init = hdr->num_init;
+    cfg->num_privates = hdr->num_privates;
+    cfg->image = image;
+    cfg->image_size = size;
+    return 0;
+
+err:
+    munmap(image, size);
+    return ret;
+}
+
+int mixer_cfg_load(struct mixer *mixer, const char *xml_path,
+                   const struct mixer_cfg_dev_name *dev_names,
+                   unsigned int num_dev_names, const char *image_path,
+                   struct mixer_cfg *cfg)
+{
+    int ret;
+
+    if (image_path) {
+        ret = mixer_cfg_image_load(mixer, xml_path, dev_names, num_dev_names, image_path, cfg);
+        if (ret == 0) {
+            ALOGI("Configuration from %s\n", image_path);
+            return 0;
+        }
+        ALOGI("%s not used (%d), reading %s\n", image_path, ret, xml_path);
+    }
+
+    ret = mixer_cfg_parse(mixer, xml_path, dev_names, num_dev_names, cfg);
+    if (ret || !image_path)
+        return ret;
+
+    ret = mixer_cfg_image_write(cfg, mixer, xml_path, dev_names, num_dev_names, image_path);
+    if (ret)
+        ALOGW("Unable to write %s (%d)\n", image_path, ret);
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_MIXER_CFG_H
+#define AUDIO_MIXER_CFG_H
+
+#include <stddef.h>
+
+struct mixer;
+struct mixer_ctl;
+
+struct route_setting
+{
+    char *ctl_name;
+    int intval;
+    char *strval;
+    struct mixer_ctl *ctl;      /* resolved when the config is loaded */
+    int enum_item;              /* strval as an item of ctl, -1 if it names none */
+};
+
+struct tiny_dev_cfg {
+    int mask;
+
+    struct route_setting *on;
+    unsigned int on_len;
+
+    struct route_setting *off;
+    unsigned int off_len;
+};
+
+struct mixer_cfg_path {
+    struct route_setting *route;
+    unsigned int len;
+};
+
+/* <private name="..."><func name="control"/></private> */
+struct mixer_cfg_private {
+    char *name;
+    struct mixer_ctl *ctl;
+};
+
+struct mixer_cfg_dev_name {
+    int mask;
+    const char *name;
+};
+
+/* What tiny_hw.xml sets up. init holds the paths the xml applies while it is
+ * read, in its order: the ones outside a device and the off sequences.
+ */
+struct mixer_cfg {
+    struct tiny_dev_cfg *dev_cfgs;
+    unsigned int num_dev_cfgs;
+    struct mixer_cfg_path *init;
+    unsigned int num_init;
+    struct mixer_cfg_private *privates;
+    unsigned int num_privates;
+
+    /* the mapped image the names point into, NULL when parsed */
+    void *image;
+    size_t image_size;
+    void *mem;
+};
+
+/* Reads the xml, the controls are looked up by name. 0 on success. */
+int mixer_cfg_parse(struct mixer *mixer, const char *xml_path,
+                    const struct mixer_cfg_dev_name *dev_names,
+                    unsigned int num_dev_names, struct mixer_cfg *cfg);
+
+/* Writes cfg as a binary image with the control indices and enum items
+ * resolved. It holds the mtime, size and hash of the xml, and a hash of the
+ * controls of the mixer and of dev_names; a change of any of them makes the
+ * image invalid.
+ */
+int mixer_cfg_image_write(const struct mixer_cfg *cfg, struct mixer *mixer,
+                          const char *xml_path,
+                          const struct mixer_cfg_dev_name *dev_names,
+                          unsigned int num_dev_names, const char *image_path);
+
+/* Maps the image if it is valid for the xml, the mixer and dev_names.
+ * 0 on success, -ESTALE when it is out of date.
+ */
+int mixer_cfg_image_load(struct mixer *mixer, const char *xml_path,
+                         const struct mixer_cfg_dev_name *dev_names,
+                         unsigned int num_dev_names, const char *image_path,
+                         struct mixer_cfg *cfg);
+
+/* The image when it is valid, else the xml, which is then written to the
+ * image for the next open. image_path may be NULL.
+ */
+int mixer_cfg_load(struct mixer *mixer, const char *xml_path,
+                   const struct mixer_cfg_dev_name *dev_names,
+                   unsigned int num_dev_names, const char *image_path,
+                   struct mixer_cfg *cfg);
+
+void mixer_cfg_free(struct mixer_cfg *cfg);
+
+#endif
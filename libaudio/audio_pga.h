@@ -21,6 +21,9 @@
 struct audio_pga *audio_pga_init(struct mixer *mixer);
 void audio_pga_free(struct audio_pga *pga);
 
+/* Reads the PGA xml again, audio_pga_apply() may run meanwhile */
+int audio_pga_reload(struct audio_pga *pga);
+
 /* Applies an audio pga by name */
 int audio_pga_apply(struct audio_pga *pga, int val, const char *name);
 
@@ -0,0 +1,438 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_resampler"
+/*#define LOG_NDEBUG 0*/
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/log.h>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "audio_resampler.h"
+
+/*
+ * Rational polyphase resampler. The rates reduce to out/in = L/M, the prototype
+ * low pass runs at L times the input rate and is split into L branches of
+ * taps coefficients, one branch per output phase. Every output frame is one
+ * dot product of a branch with the last taps input frames, the phase then
+ * moves on by M.
+ */
+#define RS_CHUNK_FRAMES 512
+#define RS_MAX_CHANNELS 2
+
+/* the stop band starts at the nyquist of the lower rate, the transition width
+ * follows from the taps and the kaiser beta
+ */
+static const struct {
+    int taps;
+    double beta;
+} rs_quality[] = {
+    { 16, 6.0 },    /* AUDIO_RESAMPLER_QUALITY_LOW, about 60 dB */
+    { 48, 9.0 },    /* AUDIO_RESAMPLER_QUALITY_MEDIUM, about 85 dB */
+    { 96, 11.0 },   /* AUDIO_RESAMPLER_QUALITY_HIGH, about 105 dB */
+};
+
+struct rs_bank {
+    struct rs_bank *next;
+    int refs;
+    uint32_t l;
+    uint32_t m;
+    int quality;
+    int taps;
+    float *coefs;           /* l branches of taps, in the order of the history */
+};
+
+struct audio_resampler {
+    struct rs_bank *bank;
+    uint32_t in_rate;
+    uint32_t channels;
+    uint32_t step;          /* whole input frames per output frame */
+    uint32_t step_frac;     /* and the remainder, in branches */
+    uint32_t phase;         /* branch of the next output frame */
+    size_t base;            /* first history frame of the next output window */
+    size_t filled;
+    size_t size;
+    float *hist[RS_MAX_CHANNELS];
+};
+
+static pthread_mutex_t bank_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rs_bank *bank_list;
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 50; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+static struct rs_bank *rs_bank_create(uint32_t l, uint32_t m, int quality)
+{
+    struct rs_bank *bank;
+    double *h;
+    double beta = rs_quality[quality].beta;
+    double atten, fc, sum, scale, t, r;
+    int base_taps = rs_quality[quality].taps;
+    int taps, n, i, j, p;
+
+    /* a decimator keeps the transition width at the output rate */
+    taps = base_taps * ((m + l - 1) / l);
+    n = taps * l;
+
+    bank = calloc(1, sizeof(struct rs_bank));
+    h = malloc(n * sizeof(double));
+    if (bank)
+        bank->coefs = malloc(n * sizeof(float));
+    if (!bank || !h || !bank->coefs) {
+        if (bank)
+            free(bank->coefs);
+        free(bank);
+        free(h);
+        return NULL;
+    }
+
+    /* kaiser design, the cutoff is normalised to the prototype rate */
+    atten = beta / 0.1102 + 8.7;
+    fc = (0.5 - (atten - 7.95) / (14.36 * base_taps) / 2) / (l > m ? l : m);
+    sum = 0;
+    for (i = 0; i < n; i++) {
+        t = i - (n - 1) / 2.0;
+        r = 2.0 * i / (n - 1) - 1.0;
+        h[i] = 2 * fc * (t == 0 ? 1.0 : sin(2 * M_PI * fc * t) / (2 * M_PI * fc * t));
+        h[i] *= bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+        sum += h[i];
+    }
+
+    /* unity gain once the zero stuffing to the prototype rate is made up for.
+     * The coefficients stay float: rounded to 16 bit, they would bring their own
+     * noise near -80 dB.
+     */
+    scale = l / sum;
+    for (p = 0; p < (int)l; p++) {
+        for (j = 0; j < taps; j++)
+            bank->coefs[p * taps + j] = (float)(h[(taps - 1 - j) * l + p] * scale);
+    }
+    free(h);
+
+    bank->l = l;
+    bank->m = m;
+    bank->quality = quality;
+    bank->taps = taps;
+    ALOGV("bank %u/%u quality %d: %d taps", l, m, quality, taps);
+    return bank;
+}
+
+static struct rs_bank *rs_bank_get(uint32_t l, uint32_t m, int quality)
+{
+    struct rs_bank *bank;
+
+    pthread_mutex_lock(&bank_lock);
+    for (bank = bank_list; bank; bank = bank->next) {
+        if (bank->l == l && bank->m == m && bank->quality == quality)
+            break;
+    }
+    if (!bank) {
+        bank = rs_bank_create(l, m, quality);
+        if (bank) {
+            bank->next = bank_list;
+            bank_list = bank;
+        }
+    }
+    if (bank)
+        bank->refs++;
+    pthread_mutex_unlock(&bank_lock);
+    return bank;
+}
+
+static void rs_bank_put(struct rs_bank *bank)
+{
+    struct rs_bank **pp;
+
+    pthread_mutex_lock(&bank_lock);
+    if (--bank->refs == 0) {
+        for (pp = &bank_list; *pp; pp = &(*pp)->next) {
+            if (*pp == bank) {
+                *pp = bank->next;
+                break;
+            }
+        }
+        free(bank->coefs);
+        free(bank);
+    }
+    pthread_mutex_unlock(&bank_lock);
+}
+
+/* taps is a multiple of 8 */
+static inline float rs_dot(const float *x, const float *c, int taps)
+{
+#if defined(__ARM_NEON__)
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    float32x2_t s;
+
+    for (; taps > 0; taps -= 8, x += 8, c += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(x), vld1q_f32(c));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(x + 4), vld1q_f32(c + 4));
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+    s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+#elif defined(__SSE__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (; taps > 0; taps -= 8, x += 8, c += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x), _mm_loadu_ps(c)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + 4), _mm_loadu_ps(c + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(acc0);
+#else
+    float acc = 0;
+
+    for (; taps > 0; taps--)
+        acc += *x++ * *c++;
+    return acc;
+#endif
+}
+
+/* both channels share the coefficient loads */
+static inline void rs_dot2(const float *xl, const float *xr, const float *c, int taps,
+                           float *left, float *right)
+{
+#if defined(__ARM_NEON__)
+    float32x4_t accl = vdupq_n_f32(0);
+    float32x4_t accr = vdupq_n_f32(0);
+    float32x2_t s;
+
+    for (; taps > 0; taps -= 4, xl += 4, xr += 4, c += 4) {
+        float32x4_t cv = vld1q_f32(c);
+        accl = vmlaq_f32(accl, vld1q_f32(xl), cv);
+        accr = vmlaq_f32(accr, vld1q_f32(xr), cv);
+    }
+    s = vpadd_f32(vadd_f32(vget_low_f32(accl), vget_high_f32(accl)),
+                  vadd_f32(vget_low_f32(accr), vget_high_f32(accr)));
+    *left = vget_lane_f32(s, 0);
+    *right = vget_lane_f32(s, 1);
+#elif defined(__SSE__)
+    __m128 accl = _mm_setzero_ps();
+    __m128 accr = _mm_setzero_ps();
+
+    for (; taps > 0; taps -= 4, xl += 4, xr += 4, c += 4) {
+        __m128 cv = _mm_loadu_ps(c);
+        accl = _mm_add_ps(accl, _mm_mul_ps(_mm_loadu_ps(xl), cv));
+        accr = _mm_add_ps(accr, _mm_mul_ps(_mm_loadu_ps(xr), cv));
+    }
+    /* l0+l2 l1+l3 r0+r2 r1+r3 */
+    accl = _mm_add_ps(_mm_movelh_ps(accl, accr), _mm_movehl_ps(accr, accl));
+    accl = _mm_add_ps(accl, _mm_shuffle_ps(accl, accl, _MM_SHUFFLE(2, 3, 0, 1)));
+    *left = _mm_cvtss_f32(accl);
+    *right = _mm_cvtss_f32(_mm_movehl_ps(accl, accl));
+#else
+    *left = rs_dot(xl, c, taps);
+    *right = rs_dot(xr, c, taps);
+#endif
+}
+
+static inline int16_t rs_round(float v)
+{
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (int16_t)lrintf(v);
+}
+
+int audio_resampler_create(uint32_t in_rate, uint32_t out_rate, uint32_t channels,
+                           int quality, struct audio_resampler **resampler)
+{
+    struct audio_resampler *rs;
+    uint32_t div, c;
+
+    *resampler = NULL;
+    if (!in_rate || !out_rate || !channels || channels > RS_MAX_CHANNELS ||
+        quality < AUDIO_RESAMPLER_QUALITY_LOW || quality > AUDIO_RESAMPLER_QUALITY_HIGH)
+        return -EINVAL;
+
+    div = gcd(in_rate, out_rate);
+    if (out_rate / div > AUDIO_RESAMPLER_MAX_PHASES) {
+        ALOGE("%u to %u needs %u branches", in_rate, out_rate, out_rate / div);
+        return -EINVAL;
+    }
+
+    rs = calloc(1, sizeof(struct audio_resampler));
+    if (!rs)
+        return -ENOMEM;
+
+    rs->bank = rs_bank_get(out_rate / div, in_rate / div, quality);
+    if (!rs->bank) {
+        free(rs);
+        return -ENOMEM;
+    }
+    rs->in_rate = in_rate;
+    rs->channels = channels;
+    rs->step = rs->bank->m / rs->bank->l;
+    rs->step_frac = rs->bank->m % rs->bank->l;
+    rs->size = rs->bank->taps + RS_CHUNK_FRAMES;
+    for (c = 0; c < channels; c++) {
+        rs->hist[c] = malloc(rs->size * sizeof(float));
+        if (!rs->hist[c]) {
+            audio_resampler_release(rs);
+            return -ENOMEM;
+        }
+    }
+    audio_resampler_reset(rs);
+
+    *resampler = rs;
+    return 0;
+}
+
+void audio_resampler_release(struct audio_resampler *rs)
+{
+    uint32_t c;
+
+    if (!rs)
+        return;
+    for (c = 0; c < rs->channels; c++)
+        free(rs->hist[c]);
+    rs_bank_put(rs->bank);
+    free(rs);
+}
+
+void audio_resampler_reset(struct audio_resampler *rs)
+{
+    uint32_t c;
+
+    /* the first window ends on the first input frame */
+    rs->filled = rs->bank->taps - 1;
+    for (c = 0; c < rs->channels; c++)
+        memset(rs->hist[c], 0, rs->filled * sizeof(float));
+    rs->base = 0;
+    rs->phase = 0;
+}
+
+int audio_resampler_process(struct audio_resampler *rs,
+                            const int16_t *in, size_t *in_frames,
+                            int16_t *out, size_t *out_frames)
+{
+    struct rs_bank *bank = rs->bank;
+    int taps = bank->taps;
+    size_t in_left = *in_frames;
+    size_t out_left = *out_frames;
+    size_t n, i, shift;
+    float left, right;
+
+    for (;;) {
+        n = rs->size - rs->filled;
+        if (n > in_left)
+            n = in_left;
+        if (rs->channels == 2) {
+            float *hl = rs->hist[0] + rs->filled;
+            float *hr = rs->hist[1] + rs->filled;
+            for (i = 0; i < n; i++) {
+                hl[i] = in[2 * i];
+                hr[i] = in[2 * i + 1];
+            }
+        } else {
+            float *h = rs->hist[0] + rs->filled;
+            for (i = 0; i < n; i++)
+                h[i] = in[i];
+        }
+        in += n * rs->channels;
+        in_left -= n;
+        rs->filled += n;
+
+        while (out_left && rs->base + taps <= rs->filled) {
+            const float *c = bank->coefs + rs->phase * taps;
+
+            if (rs->channels == 2) {
+                rs_dot2(rs->hist[0] + rs->base, rs->hist[1] + rs->base, c, taps, &left, &right);
+                *out++ = rs_round(left);
+                *out++ = rs_round(right);
+            } else {
+                *out++ = rs_round(rs_dot(rs->hist[0] + rs->base, c, taps));
+            }
+            out_left--;
+            rs->base += rs->step;
+            rs->phase += rs->step_frac;
+            if (rs->phase >= bank->l) {
+                rs->phase -= bank->l;
+                rs->base++;
+            }
+        }
+
+        /* a decimator may step past the frames received so far */
+        shift = rs->base < rs->filled ? rs->base : rs->filled;
+        if (shift) {
+            for (i = 0; i < rs->channels; i++)
+                memmove(rs->hist[i], rs->hist[i] + shift,
+                        (rs->filled - shift) * sizeof(float));
+            rs->base -= shift;
+            rs->filled -= shift;
+        }
+
+        if (!in_left || (!n && !shift))
+            break;
+    }
+
+    *in_frames -= in_left;
+    *out_frames -= out_left;
+    return 0;
+}
+
+int32_t audio_resampler_delay_ns(struct audio_resampler *rs)
+{
+    struct rs_bank *bank = rs->bank;
+    double frames;
+
+    /* from the last input frame to the center of the next output window, the
+     * branch adds phase / l input frames to the window end
+     */
+    frames = (double)rs->filled - 1 - rs->base - (bank->taps - 1) -
+             (double)rs->phase / bank->l + (bank->taps * bank->l - 1) / (2.0 * bank->l);
+    if (frames < 0)
+        frames = 0;
+    return (int32_t)(frames * 1000000000.0 / rs->in_rate);
+}
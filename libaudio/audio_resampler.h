@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* cpu load against stop band attenuation, see rs_quality in audio_resampler.c */
+#define AUDIO_RESAMPLER_QUALITY_LOW    0
+#define AUDIO_RESAMPLER_QUALITY_MEDIUM 1
+#define AUDIO_RESAMPLER_QUALITY_HIGH   2
+
+#ifndef AUDIO_RESAMPLER_QUALITY
+#define AUDIO_RESAMPLER_QUALITY AUDIO_RESAMPLER_QUALITY_MEDIUM
+#elif AUDIO_RESAMPLER_QUALITY < AUDIO_RESAMPLER_QUALITY_LOW || \
+      AUDIO_RESAMPLER_QUALITY > AUDIO_RESAMPLER_QUALITY_HIGH
+#error "AUDIO_RESAMPLER_QUALITY is a quality level from 0 to 2"
+#endif
+
+/* 16 bit interleaved pcm, 1 or 2 channels. The output rate divided by the greatest
+ * common divisor of the rates gives the number of filter branches, which must not
+ * exceed AUDIO_RESAMPLER_MAX_PHASES: any pair of 8k, 16k, 32k, 44.1k and 48k fits.
+ */
+#define AUDIO_RESAMPLER_MAX_PHASES 441
+
+struct audio_resampler;
+
+/* Creates and frees a resampler, the filter banks are shared by the resamplers of
+ * the same ratio and quality.
+ */
+int audio_resampler_create(uint32_t in_rate, uint32_t out_rate, uint32_t channels,
+                           int quality, struct audio_resampler **resampler);
+void audio_resampler_release(struct audio_resampler *resampler);
+
+/* Drops the buffered input, the next output starts from silence */
+void audio_resampler_reset(struct audio_resampler *resampler);
+
+/* in_frames is the input available on entry and the input consumed on return,
+ * out_frames is the room in out on entry and the frames written on return.
+ * The input not consumed is left to the caller when the output is full.
+ */
+int audio_resampler_process(struct audio_resampler *resampler,
+                            const int16_t *in, size_t *in_frames,
+                            int16_t *out, size_t *out_frames);
+
+/* Time from the last input frame back to the next output frame, which covers the
+ * group delay of the filter and the buffered input
+ */
+int32_t audio_resampler_delay_ns(struct audio_resampler *resampler);
+
+#endif
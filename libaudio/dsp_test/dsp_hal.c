@@ -0,0 +1,591 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* stages for the DSP code of the HAL itself: audio_resampler.c and audio_echo_ref.c,
+ * and the tiny_hw.xml loading of audio_mixer_cfg.c from dsp_mixer.c */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/atomic.h>
+
+#include "dsp_test.h"
+#include "audio_echo_ref.h"
+#include "audio_resampler.h"
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+/* the rates audio_hw.c converts between */
+#define HAL_OUT_RATE        44100
+#define HAL_PCM_RATE        48000
+
+/* one bench batch is this much output audio, so the rate reads in ms of audio per second */
+#define RS_BENCH_MS         100
+
+static const struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+} rs_ratios[] = {
+    { 44100, 48000 },
+    { 48000, 44100 },
+    { 8000,  48000 },
+    { 16000, 48000 },
+    { 32000, 48000 },
+    { 48000, 16000 },
+};
+
+/*
+ * Per quality: the pass band as a fraction of the lower rate, which ends
+ * where the kaiser transition of rs_quality[] in audio_resampler.c starts,
+ * and the limits the measurements are held to. A -6 dBFS tone in 16 bit
+ * cannot show much more than 90 dB of SNR.
+ */
+static const struct {
+    const char *name;
+    double pass_band;
+    double snr_min_db;
+    double ripple_max_db;
+} rs_limits[] = {
+    { "low",    0.25,  70.0, 0.02 },
+    { "medium", 0.375, 85.0, 0.01 },
+    { "high",   0.42,  85.0, 0.01 },
+};
+
+#define RS_TONE_AMP         16384
+#define RS_TONE_STEP        1.25
+
+/*
+ * Least squares fit of a cos + b sin + c at w radians per frame. Returns the
+ * amplitude of the tone, and the power of what is left, the noise, aliases and
+ * images the resampler added, in *residual. *phase is that of the tone as a
+ * sine at the first frame.
+ */
+static double tone_fit(const int16_t *y, size_t n, double w, double *residual,
+                       double *phase)
+{
+    double m[3][4];
+    double x[3], v[3], s, f, r = 0;
+    size_t i;
+    int j, k;
+
+    memset(m, 0, sizeof(m));
+    for (i = 0; i < n; i++) {
+        v[0] = cos(w * i);
+        v[1] = sin(w * i);
+        v[2] = 1;
+        for (j = 0; j < 3; j++) {
+            for (k = 0; k < 3; k++)
+                m[j][k] += v[j] * v[k];
+            m[j][3] += v[j] * y[i];
+        }
+    }
+    for (j = 0; j < 3; j++) {
+        for (k = j + 1; k < 3; k++) {
+            f = m[k][j] / m[j][j];
+            m[k][0] -= f * m[j][0];
+            m[k][1] -= f * m[j][1];
+            m[k][2] -= f * m[j][2];
+            m[k][3] -= f * m[j][3];
+        }
+    }
+    for (j = 2; j >= 0; j--) {
+        s = m[j][3];
+        for (k = j + 1; k < 3; k++)
+            s -= m[j][k] * x[k];
+        x[j] = s / m[j][j];
+    }
+    for (i = 0; i < n; i++) {
+        s = y[i] - (x[0] * cos(w * i) + x[1] * sin(w * i) + x[2]);
+        r += s * s;
+    }
+    *residual = r / n;
+    *phase = atan2(x[0], x[1]);
+    return hypot(x[0], x[1]);
+}
+
+/*
+ * Half a second of a tone through a fresh resampler. The first and the last
+ * 50 ms of the output hold the filter's ramp up and down and are left out.
+ */
+static int rs_tone(uint32_t in_rate, uint32_t out_rate, int quality, double hz,
+                   double *gain_db, double *snr_db)
+{
+    struct audio_resampler *rs;
+    size_t in_frames = in_rate / 2, out_frames, n;
+    size_t guard = out_rate / 20;
+    int16_t *in, *out;
+    double amp, residual, phase;
+    size_t i;
+    int ret;
+
+    ret = audio_resampler_create(in_rate, out_rate, 1, quality, &rs);
+    if (ret)
+        return ret;
+    out_frames = in_frames * out_rate / in_rate + 64;
+    in = malloc(in_frames * sizeof(int16_t));
+    out = malloc(out_frames * sizeof(int16_t));
+    if (!in || !out) {
+        ret = -1;
+        goto done;
+    }
+    for (i = 0; i < in_frames; i++)
+        in[i] = (int16_t)lrint(RS_TONE_AMP * sin(2 * M_PI * hz * i / in_rate));
+    n = in_frames;
+    ret = audio_resampler_process(rs, in, &n, out, &out_frames);
+    if (ret || out_frames < 4 * guard) {
+        ret = -1;
+        goto done;
+    }
+
+    amp = tone_fit(out + guard, out_frames - 2 * guard, 2 * M_PI * hz / out_rate,
+                   &residual, &phase);
+    *gain_db = 20 * log10(amp / RS_TONE_AMP);
+    *snr_db = 10 * log10(amp * amp / 2 / residual);
+
+done:
+    free(in);
+    free(out);
+    audio_resampler_release(rs);
+    return ret;
+}
+
+/*
+ * Tones from 100 Hz to the end of the pass band, a quarter of a third octave
+ * apart. The lowest SNR over them and the spread of their gain, the pass band
+ * ripple, are checked against rs_limits[].
+ */
+static int rs_quality_golden(FILE *out)
+{
+    unsigned int r, q;
+    int failed = 0;
+
+    for (r = 0; r < ARRAY_SIZE(rs_ratios); r++) {
+        uint32_t in_rate = rs_ratios[r].in_rate;
+        uint32_t out_rate = rs_ratios[r].out_rate;
+        uint32_t low = in_rate < out_rate ? in_rate : out_rate;
+
+        for (q = 0; q < ARRAY_SIZE(rs_limits); q++) {
+            double edge = rs_limits[q].pass_band * low;
+            double gain, snr, gain_min = 0, gain_max = 0, snr_min = 0;
+            double hz;
+            int first = 1;
+
+            for (hz = 100; hz <= edge; hz *= RS_TONE_STEP) {
+                if (rs_tone(in_rate, out_rate, q, hz, &gain, &snr)) {
+                    fprintf(stderr, "rs_quality: %u to %u %s failed\n",
+                            in_rate, out_rate, rs_limits[q].name);
+                    return -1;
+                }
+                if (first || gain < gain_min)
+                    gain_min = gain;
+                if (first || gain > gain_max)
+                    gain_max = gain;
+                if (first || snr < snr_min)
+                    snr_min = snr;
+                first = 0;
+            }
+
+            fprintf(out, "%u %u %s pass %.0f Hz snr %.1f dB ripple %.4f dB\n",
+                    in_rate, out_rate, rs_limits[q].name, edge, snr_min,
+                    gain_max - gain_min);
+            if (snr_min < rs_limits[q].snr_min_db ||
+                gain_max - gain_min > rs_limits[q].ripple_max_db) {
+                fprintf(stderr, "rs_quality: %u to %u %s, snr %.1f dB ripple %.4f dB,"
+                        " limits %.1f dB %.4f dB\n",
+                        in_rate, out_rate, rs_limits[q].name, snr_min,
+                        gain_max - gain_min, rs_limits[q].snr_min_db,
+                        rs_limits[q].ripple_max_db);
+                failed = 1;
+            }
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+/* stereo, in the blocks out_write() hands over, at the quality the build uses */
+static uint64_t rs_bench_run(struct audio_resampler **rs, uint32_t in_rate,
+                             uint32_t out_rate)
+{
+    static int16_t in[2 * 1024], out[2 * 8192];
+    uint32_t want = out_rate * RS_BENCH_MS / 1000, done = 0;
+    size_t in_frames, out_frames;
+    unsigned int i;
+
+    if (!*rs) {
+        if (audio_resampler_create(in_rate, out_rate, 2, AUDIO_RESAMPLER_QUALITY, rs))
+            return 0;
+        for (i = 0; i < ARRAY_SIZE(in); i++)
+            in[i] = (int16_t)(i * 7919);
+    }
+    while (done < want) {
+        in_frames = 1024;
+        out_frames = 8192;
+        audio_resampler_process(*rs, in, &in_frames, out, &out_frames);
+        done += out_frames;
+    }
+    return (uint64_t)done * 1000 / out_rate;
+}
+
+static uint64_t rs_music_bench(void)
+{
+    static struct audio_resampler *rs;
+
+    return rs_bench_run(&rs, HAL_OUT_RATE, HAL_PCM_RATE);
+}
+
+static uint32_t rs_hash(uint32_t h, const int16_t *s, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        h ^= (uint16_t)s[i];
+        h *= 16777619;
+    }
+    return h;
+}
+
+/*
+ * The signals, planar at DSP_SIGNAL_RATE, interleaved and taken to the pcm
+ * rate in the odd sized blocks of a voice stream. The hash pins the output
+ * down to the sample.
+ */
+static int rs_voice_golden(FILE *out)
+{
+    struct audio_resampler *rs;
+    int16_t in[2 * 160], res[2 * 1024];
+    unsigned int s;
+    uint32_t pos;
+    size_t n, m;
+
+    for (s = 0; s < dsp_signal_num; s++) {
+        const struct dsp_signal *sig = &dsp_signals[s];
+        uint32_t h = 2166136261u, frames = 0;
+
+        if (audio_resampler_create(DSP_SIGNAL_RATE, HAL_PCM_RATE, 2,
+                                   AUDIO_RESAMPLER_QUALITY, &rs))
+            return -1;
+        for (pos = 0; pos < sig->frames; pos += n) {
+            n = sig->frames - pos < 160 ? sig->frames - pos : 160;
+            for (m = 0; m < n; m++) {
+                in[2 * m] = sig->left[pos + m];
+                in[2 * m + 1] = sig->right[pos + m];
+            }
+            m = ARRAY_SIZE(res) / 2;
+            if (audio_resampler_process(rs, in, &n, res, &m)) {
+                audio_resampler_release(rs);
+                return -1;
+            }
+            h = rs_hash(h, res, 2 * m);
+            frames += m;
+        }
+        audio_resampler_release(rs);
+        fprintf(out, "%s %u %08x\n", sig->name, frames, h);
+    }
+    return 0;
+}
+
+static uint64_t rs_voice_bench(void)
+{
+    static struct audio_resampler *rs;
+
+    return rs_bench_run(&rs, DSP_SIGNAL_RATE, HAL_PCM_RATE);
+}
+
+/*
+ * audio_echo_ref.c between a playback and a capture clock which both drift
+ * and jitter. The playback side writes 1024 frame blocks of stereo 44.1 kHz
+ * 60 ms ahead, as out_write() does; the capture side reads mono 20 ms blocks.
+ * Both carry a 50 Hz tone as a function of the time it is heard, so a read
+ * reference should be the tone at its capture time. Its phase gives the
+ * alignment error, without ambiguity up to half a period, 10 ms.
+ */
+#define ER_WR_RATE          HAL_OUT_RATE
+#define ER_WR_BLOCK         1024
+#define ER_LEAD_S           0.06
+#define ER_READ_MS          20
+#define ER_STEP_S           0.005
+#define ER_RUN_S            20.0
+#define ER_TONE_HZ          50.0
+#define ER_TONE_AMP         12000
+/* the clocks a read starts from, the ns stamps are as large as on a device */
+#define ER_T0_S             1000.0
+/* reads this early, or this soon after a playback start, are not measured */
+#define ER_SETTLE_S         2.0
+#define ER_PLAY_SETTLE_S    0.2
+#define ER_GAP_S            0.3
+#define ER_RACE_START_S     8.0
+#define ER_RACE_EVERY       25
+/* every so many races the writer also starts a new clock, ER_RACE_GAP_S on */
+#define ER_RACE_RESTART     4
+#define ER_RACE_GAP_S       0.03
+/*
+ * The alignment error allowed. The fits average the jitter of up to 256
+ * stamps a side down, but a new playback clock has only a few of them.
+ */
+#define ER_MAX_ERR_US(jitter_us)    (100 + (jitter_us))
+
+static const struct er_case {
+    const char *name;
+    uint32_t rd_rate;
+    double play_ppm;
+    double cap_ppm;
+    double jitter_us;
+    int race;           /* run the writer in the middle of some reads */
+    int restart;        /* stop the playback for ER_GAP_S half way */
+} er_cases[] = {
+    { "nominal",        16000,    0,    0,    0, 0, 0 },
+    { "drift",          16000,  100, -100,  200, 0, 0 },
+    { "drift_large",    16000,  300, -200, 1000, 0, 0 },
+    { "race",           16000,   50,    0,  200, 1, 0 },
+    { "restart",        16000,  100,    0,  200, 0, 1 },
+    { "voice_8k",        8000,  100,  -50,  500, 0, 0 },
+    { "capture_48k",    48000,  -80,   60,  200, 1, 0 },
+};
+
+struct er_sim {
+    struct audio_echo_ref *er;
+    double play_rate;
+    double play_t0;
+    uint64_t play_frames;
+    double play_start;
+    double cap_rate;
+    double cap_t0;
+    uint64_t cap_frames;
+    double jitter_us;
+    uint32_t seed;
+};
+
+/*
+ * The read the writer is run in: the second acquire load of
+ * audio_echo_ref_read() is the first of stamp_wr in er_play_stamps(), so
+ * the stamps are copied while the writer overwrites the oldest of them.
+ * Those of a new clock would bring its start into the old one's stamps.
+ */
+static struct er_sim *er_race_sim;
+static int er_race_blocks;
+static int er_race_restart;
+static int er_race_loads;
+static uint32_t er_races;
+
+static void er_sim_block(struct er_sim *sim);
+static void er_sim_restart(struct er_sim *sim, double t0);
+
+int32_t android_atomic_acquire_load(volatile const int32_t *addr)
+{
+    int32_t value = *addr;
+
+    __sync_synchronize();
+    if (er_race_blocks && ++er_race_loads == 2) {
+        if (er_race_restart)
+            er_sim_restart(er_race_sim, er_race_sim->play_t0 + ER_RACE_GAP_S +
+                           er_race_sim->play_frames / er_race_sim->play_rate);
+        while (er_race_blocks) {
+            er_race_blocks--;
+            er_sim_block(er_race_sim);
+        }
+        er_races++;
+    }
+    return value;
+}
+
+void android_atomic_release_store(int32_t value, volatile int32_t *addr)
+{
+    __sync_synchronize();
+    *addr = value;
+}
+
+/* a time stamp error, gaussian, from a fixed sequence */
+static double er_sim_jitter(struct er_sim *sim)
+{
+    double u, v;
+
+    if (sim->jitter_us == 0)
+        return 0;
+    sim->seed = sim->seed * 1664525 + 1013904223;
+    u = (sim->seed + 1.0) / 4294967297.0;
+    sim->seed = sim->seed * 1664525 + 1013904223;
+    v = (sim->seed + 1.0) / 4294967297.0;
+    return sim->jitter_us * 1e-6 * sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static int64_t er_sim_ns(double t)
+{
+    return (int64_t)llrint((ER_T0_S + t) * 1e9);
+}
+
+static int16_t er_sim_tone(double t)
+{
+    return (int16_t)lrint(ER_TONE_AMP * sin(2 * M_PI * ER_TONE_HZ * t));
+}
+
+static void er_sim_block(struct er_sim *sim)
+{
+    int16_t buf[2 * ER_WR_BLOCK];
+    double t = sim->play_t0 + sim->play_frames / sim->play_rate;
+    unsigned int i;
+
+    for (i = 0; i < ER_WR_BLOCK; i++)
+        buf[2 * i] = buf[2 * i + 1] =
+            er_sim_tone(sim->play_t0 + (sim->play_frames + i) / sim->play_rate);
+    audio_echo_ref_write(sim->er, buf, ER_WR_BLOCK, er_sim_ns(t + er_sim_jitter(sim)));
+    sim->play_frames += ER_WR_BLOCK;
+}
+
+static void er_sim_restart(struct er_sim *sim, double t0)
+{
+    audio_echo_ref_write_stop(sim->er);
+    sim->play_t0 = t0;
+    sim->play_frames = 0;
+    sim->play_start = t0;
+}
+
+static void er_sim_play(struct er_sim *sim, double now)
+{
+    while (sim->play_t0 + sim->play_frames / sim->play_rate - ER_LEAD_S <= now)
+        er_sim_block(sim);
+}
+
+/*
+ * The alignment error, in us, of a reference read for the frames from
+ * capture time t on.
+ */
+static double er_sim_error(const struct er_sim *sim, const int16_t *ref, size_t n, double t)
+{
+    double residual, phase, err;
+
+    tone_fit(ref, n, 2 * M_PI * ER_TONE_HZ / sim->cap_rate, &residual, &phase);
+    err = remainder(2 * M_PI * ER_TONE_HZ * t - phase, 2 * M_PI);
+    return fabs(err / (2 * M_PI * ER_TONE_HZ) * 1e6);
+}
+
+static int er_case_run(const struct er_case *c, FILE *out)
+{
+    struct er_sim sim;
+    struct audio_echo_ref_stats stats;
+    int16_t ref[ER_READ_MS * 48];
+    uint32_t rd_frames = c->rd_rate * ER_READ_MS / 1000;
+    uint32_t reads = 0, measured = 0, missing = 0;
+    double start, now, t, err, err_sum = 0, err_max = 0;
+    int stopped = 0;
+    size_t got;
+
+    memset(&sim, 0, sizeof(sim));
+    if (audio_echo_ref_create(1, c->rd_rate, 2, ER_WR_RATE, &sim.er))
+        return -1;
+    sim.play_rate = ER_WR_RATE * (1 + c->play_ppm * 1e-6);
+    sim.cap_rate = c->rd_rate * (1 + c->cap_ppm * 1e-6);
+    sim.cap_t0 = 0.05;
+    sim.jitter_us = c->jitter_us;
+    sim.seed = 1;
+    er_race_sim = &sim;
+    er_races = 0;
+
+    for (now = 0; now < ER_RUN_S; now += ER_STEP_S) {
+        if (c->restart && !stopped && now >= ER_RUN_S / 2) {
+            er_sim_restart(&sim, now + ER_GAP_S);
+            stopped = 1;
+        }
+        er_sim_play(&sim, now);
+
+        while (sim.cap_t0 + (sim.cap_frames + rd_frames) / sim.cap_rate <= now) {
+            t = sim.cap_t0 + sim.cap_frames / sim.cap_rate;
+            if (c->race && now >= ER_RACE_START_S && reads % ER_RACE_EVERY == 0) {
+                er_race_loads = 0;
+                er_race_blocks = 1 + (reads / ER_RACE_EVERY) % 8;
+                er_race_restart = (reads / ER_RACE_EVERY) % ER_RACE_RESTART == 0;
+            }
+            reads++;
+            start = sim.play_start;
+            got = audio_echo_ref_read(sim.er, ref, rd_frames, er_sim_ns(t + er_sim_jitter(&sim)));
+            er_race_blocks = 0;
+            sim.cap_frames += rd_frames;
+
+            if (t < ER_SETTLE_S || t < start + ER_PLAY_SETTLE_S)
+                continue;
+            measured++;
+            if (got < rd_frames) {
+                missing += rd_frames - got;
+                continue;
+            }
+            err = er_sim_error(&sim, ref, rd_frames, t);
+            err_sum += err;
+            if (err > err_max)
+                err_max = err;
+        }
+    }
+
+    audio_echo_ref_get_stats(sim.er, &stats);
+    audio_echo_ref_release(sim.er);
+    fprintf(out, "%s reads %u measured %u missing %u err mean %.1f max %.1f us"
+            " drift %d ppm jitter play %d cap %d us races %u\n",
+            c->name, stats.reads, measured, missing,
+            measured ? err_sum / measured : 0, err_max, stats.drift_ppm,
+            stats.play_jitter_rms_us, stats.cap_jitter_rms_us, er_races);
+    if (missing || err_max > ER_MAX_ERR_US(c->jitter_us) || (c->race && !er_races)) {
+        fprintf(stderr, "echo_ref: %s, %u frames missing, error up to %.1f us\n",
+                c->name, missing, err_max);
+        return -1;
+    }
+    return 0;
+}
+
+static int echo_ref_golden(FILE *out)
+{
+    unsigned int i;
+    int failed = 0;
+
+    for (i = 0; i < ARRAY_SIZE(er_cases); i++) {
+        if (er_case_run(&er_cases[i], out))
+            failed = 1;
+    }
+    return failed ? -1 : 0;
+}
+
+/* a second of both sides of the nominal case a batch, in ms of audio */
+static uint64_t echo_ref_bench(void)
+{
+    static struct er_sim sim;
+    static double now;
+    int16_t ref[ER_READ_MS * 48];
+    uint32_t rd_frames = 16000 * ER_READ_MS / 1000;
+    double end;
+
+    if (!sim.er) {
+        if (audio_echo_ref_create(1, 16000, 2, ER_WR_RATE, &sim.er))
+            return 0;
+        sim.play_rate = ER_WR_RATE;
+        sim.cap_rate = 16000;
+    }
+    for (end = now + 1.0; now < end; now += ER_STEP_S) {
+        er_sim_play(&sim, now);
+        while (sim.cap_t0 + (sim.cap_frames + rd_frames) / sim.cap_rate <= now) {
+            audio_echo_ref_read(sim.er, ref, rd_frames,
+                                er_sim_ns(sim.cap_frames / sim.cap_rate));
+            sim.cap_frames += rd_frames;
+        }
+    }
+    return 1000;
+}
+
+const struct dsp_stage dsp_stages[] = {
+    { "rs_quality",     "audio_ms", rs_quality_golden, rs_music_bench },
+    { "rs_voice",       "audio_ms", rs_voice_golden,   rs_voice_bench },
+    { "echo_ref",       "audio_ms", echo_ref_golden,   echo_ref_bench },
+    { "mixer_xml",      "opens",    dsp_mixer_xml_golden,   dsp_mixer_xml_bench },
+    { "mixer_image",    "opens",    dsp_mixer_image_golden, dsp_mixer_image_bench },
+};
+const unsigned int dsp_stage_num = ARRAY_SIZE(dsp_stages);
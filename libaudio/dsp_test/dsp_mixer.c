@@ -0,0 +1,564 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * stages for audio_mixer_cfg.c: tiny_hw.xml read for a mixer of fixed
+ * controls, and the image compiled from it. The image has to give back what
+ * the xml gives, and has to be refused once the xml, the mixer or the device
+ * names change, or when it is cut short or damaged.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tinyalsa/asoundlib.h>
+
+#include "dsp_test.h"
+#include "audio_mixer_cfg.h"
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+struct mixer_ctl {
+    const char *name;
+    enum mixer_ctl_type type;
+    const char *const *enums;
+    unsigned int num_enums;
+};
+
+struct mixer {
+    struct mixer_ctl *ctls;
+    unsigned int num_ctls;
+};
+
+static const char *const adc_mux[] = { "Off", "Mic", "HP Mic", "Aux Mic", "Line" };
+static const char *const dac_mux[] = { "Off", "DAC", "Line" };
+static const char *const vbc_switch[] = { "arm", "dsp" };
+static const char *const eq_update[] = { "idle", "loading" };
+
+#define MIXER_ENUM(n, e)    { n, MIXER_CTL_TYPE_ENUM, e, ARRAY_SIZE(e) }
+#define MIXER_BOOL(n)       { n, MIXER_CTL_TYPE_BOOL, NULL, 0 }
+#define MIXER_INT(n)        { n, MIXER_CTL_TYPE_INT, NULL, 0 }
+
+static struct mixer_ctl mixer_ctls[] = {
+    MIXER_BOOL("Speaker Switch"),
+    MIXER_BOOL("Earpiece Switch"),
+    MIXER_BOOL("HeadPhone Switch"),
+    MIXER_BOOL("Line Switch"),
+    MIXER_BOOL("Mic Switch"),
+    MIXER_BOOL("HP Mic Switch"),
+    MIXER_BOOL("Aux Mic Switch"),
+    MIXER_ENUM("ADC Mux", adc_mux),
+    MIXER_ENUM("DAC Mux", dac_mux),
+    MIXER_INT("PA Volume"),
+    MIXER_ENUM("VBC Switch", vbc_switch),
+    MIXER_INT("VBC EQ Switch"),
+    MIXER_ENUM("VBC EQ Update", eq_update),
+    MIXER_INT("VBC EQ Profile Select"),
+    MIXER_BOOL("Mic Bias Switch"),
+    MIXER_INT("Inter PA Config"),
+};
+
+static struct mixer mixer = { mixer_ctls, ARRAY_SIZE(mixer_ctls) };
+
+/* the same codec with a driver that lost an item of ADC Mux */
+static struct mixer_ctl other_ctls[ARRAY_SIZE(mixer_ctls)];
+static struct mixer other_mixer = { other_ctls, ARRAY_SIZE(other_ctls) };
+
+unsigned int mixer_get_num_ctls(struct mixer *m)
+{
+    return m->num_ctls;
+}
+
+struct mixer_ctl *mixer_get_ctl(struct mixer *m, unsigned int id)
+{
+    return id < m->num_ctls ? &m->ctls[id] : NULL;
+}
+
+struct mixer_ctl *mixer_get_ctl_by_name(struct mixer *m, const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < m->num_ctls; i++) {
+        if (strcmp(m->ctls[i].name, name) == 0)
+            return &m->ctls[i];
+    }
+    return NULL;
+}
+
+const char *mixer_ctl_get_name(struct mixer_ctl *ctl)
+{
+    return ctl->name;
+}
+
+enum mixer_ctl_type mixer_ctl_get_type(struct mixer_ctl *ctl)
+{
+    return ctl->type;
+}
+
+unsigned int mixer_ctl_get_num_enums(struct mixer_ctl *ctl)
+{
+    return ctl->num_enums;
+}
+
+const char *mixer_ctl_get_enum_string(struct mixer_ctl *ctl, unsigned int enum_id)
+{
+    return enum_id < ctl->num_enums ? ctl->enums[enum_id] : NULL;
+}
+
+/* the masks of audio_hw.c do not matter here, only that they are kept */
+static const struct mixer_cfg_dev_name mixer_dev_names[] = {
+    { 0x00000002, "speaker" },
+    { 0x0000000c, "headphone" },
+    { 0x00000001, "earpiece" },
+    { 0x00000800, "line" },
+    { 0x40000004, "builtin-mic" },
+    { 0x40000010, "headset-in" },
+    { 0x40000080, "back-mic" },
+};
+
+/* a line of each kind the parser knows, "Line Switch" is a bool given a word */
+static const char mixer_xml[] =
+    "<tinyhal>\n"
+    "  <path>\n"
+    "    <ctl name=\"PA Volume\" val=\"4\"/>\n"
+    "    <ctl name=\"DAC Mux\" val=\"DAC\"/>\n"
+    "    <ctl name=\"VBC Switch\" val=\"arm\"/>\n"
+    "  </path>\n"
+    "  <device name=\"speaker\">\n"
+    "    <path name=\"on\"><ctl name=\"Speaker Switch\" val=\"1\"/></path>\n"
+    "    <path name=\"off\"><ctl name=\"Speaker Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <device name=\"headphone\">\n"
+    "    <path name=\"on\">\n"
+    "      <ctl name=\"HeadPhone Switch\" val=\"1\"/>\n"
+    "      <ctl name=\"DAC Mux\" val=\"DAC\"/>\n"
+    "    </path>\n"
+    "    <path name=\"off\"><ctl name=\"HeadPhone Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <device name=\"earpiece\">\n"
+    "    <path name=\"on\"><ctl name=\"Earpiece Switch\" val=\"1\"/></path>\n"
+    "    <path name=\"off\"><ctl name=\"Earpiece Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <device name=\"line\">\n"
+    "    <path name=\"on\">\n"
+    "      <ctl name=\"Line Switch\" val=\"on\"/>\n"
+    "      <ctl name=\"DAC Mux\" val=\"Line\"/>\n"
+    "    </path>\n"
+    "    <path name=\"off\"><ctl name=\"Line Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <device name=\"builtin-mic\">\n"
+    "    <path name=\"on\">\n"
+    "      <ctl name=\"Mic Switch\" val=\"1\"/>\n"
+    "      <ctl name=\"ADC Mux\" val=\"Mic\"/>\n"
+    "    </path>\n"
+    "    <path name=\"off\">\n"
+    "      <ctl name=\"Mic Switch\" val=\"0\"/>\n"
+    "      <ctl name=\"ADC Mux\" val=\"Off\"/>\n"
+    "    </path>\n"
+    "  </device>\n"
+    "  <device name=\"headset-in\">\n"
+    "    <path name=\"on\">\n"
+    "      <ctl name=\"HP Mic Switch\" val=\"1\"/>\n"
+    "      <ctl name=\"ADC Mux\" val=\"HP Mic\"/>\n"
+    "    </path>\n"
+    "    <path name=\"off\"><ctl name=\"HP Mic Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <device name=\"back-mic\">\n"
+    "    <path name=\"on\">\n"
+    "      <ctl name=\"Aux Mic Switch\" val=\"1\"/>\n"
+    "      <ctl name=\"ADC Mux\" val=\"Aux Mic\"/>\n"
+    "    </path>\n"
+    "    <path name=\"off\"><ctl name=\"Aux Mic Switch\" val=\"0\"/></path>\n"
+    "  </device>\n"
+    "  <path>\n"
+    "    <ctl name=\"Mic Bias Switch\" val=\"0\"/>\n"
+    "  </path>\n"
+    "  <private name=\"vb control\"><func name=\"VBC Switch\"/></private>\n"
+    "  <private name=\"eq switch\"><func name=\"VBC EQ Switch\"/></private>\n"
+    "  <private name=\"eq update\"><func name=\"VBC EQ Update\"/></private>\n"
+    "  <private name=\"eq profile\"><func name=\"VBC EQ Profile Select\"/></private>\n"
+    "  <private name=\"mic bias\"><func name=\"Mic Bias Switch\"/></private>\n"
+    "  <private name=\"internal PA\"><func name=\"Inter PA Config\"/></private>\n"
+    "</tinyhal>\n";
+
+static char mixer_dir[64];
+static char xml_path[96];
+static char image_path[96];
+
+static void mixer_files_remove(void)
+{
+    char path[128];
+
+    if (!mixer_dir[0])
+        return;
+    unlink(xml_path);
+    unlink(image_path);
+    snprintf(path, sizeof(path), "%s.tmp", image_path);
+    unlink(path);
+    rmdir(mixer_dir);
+    mixer_dir[0] = '\0';
+}
+
+static int file_write(const char *path, const void *data, size_t len)
+{
+    FILE *fp = fopen(path, "wb");
+    int ret = 0;
+
+    if (!fp)
+        return -1;
+    if (fwrite(data, 1, len, fp) != len)
+        ret = -1;
+    if (fclose(fp))
+        ret = -1;
+    return ret;
+}
+
+static void *file_read(const char *path, size_t *len)
+{
+    struct stat st;
+    void *data;
+    FILE *fp;
+
+    if (stat(path, &st) < 0 || !(data = malloc(st.st_size + 1)))
+        return NULL;
+    fp = fopen(path, "rb");
+    if (!fp || fread(data, 1, st.st_size, fp) != (size_t)st.st_size) {
+        if (fp)
+            fclose(fp);
+        free(data);
+        return NULL;
+    }
+    fclose(fp);
+    *len = st.st_size;
+    return data;
+}
+
+static int mixer_files_create(void)
+{
+    unsigned int i;
+
+    if (mixer_dir[0])
+        return 0;
+    for (i = 0; i < ARRAY_SIZE(mixer_ctls); i++)
+        other_ctls[i] = mixer_ctls[i];
+    other_ctls[7].num_enums--;
+
+    snprintf(mixer_dir, sizeof(mixer_dir), "/tmp/dsp_mixer.XXXXXX");
+    if (!mkdtemp(mixer_dir)) {
+        mixer_dir[0] = '\0';
+        return -1;
+    }
+    snprintf(xml_path, sizeof(xml_path), "%s/tiny_hw.xml", mixer_dir);
+    snprintf(image_path, sizeof(image_path), "%s/tiny_hw.bin", mixer_dir);
+    atexit(mixer_files_remove);
+    return file_write(xml_path, mixer_xml, sizeof(mixer_xml) - 1);
+}
+
+static void route_dump(FILE *out, const char *what, const struct route_setting *route,
+                       unsigned int len)
+{
+    unsigned int i;
+    unsigned long idx;
+
+    fprintf(out, "  %s %u\n", what, len);
+    for (i = 0; i < len; i++) {
+        idx = route[i].ctl ? (unsigned long)(route[i].ctl - mixer_ctls) : ~0ul;
+        if (route[i].strval)
+            fprintf(out, "    %s = \"%s\" ctl %ld item %d\n", route[i].ctl_name,
+                    route[i].strval, (long)idx, route[i].enum_item);
+        else
+            fprintf(out, "    %s = %d ctl %ld\n", route[i].ctl_name, route[i].intval,
+                    (long)idx);
+    }
+}
+
+/* how an off sequence shows up in init is part of what is compared */
+static void cfg_dump(FILE *out, const struct mixer_cfg *cfg)
+{
+    unsigned int i, d;
+
+    for (i = 0; i < cfg->num_dev_cfgs; i++) {
+        fprintf(out, "device %08x\n", cfg->dev_cfgs[i].mask);
+        route_dump(out, "on", cfg->dev_cfgs[i].on, cfg->dev_cfgs[i].on_len);
+        route_dump(out, "off", cfg->dev_cfgs[i].off, cfg->dev_cfgs[i].off_len);
+    }
+    for (i = 0; i < cfg->num_init; i++) {
+        for (d = 0; d < cfg->num_dev_cfgs; d++) {
+            if (cfg->init[i].route && cfg->init[i].route == cfg->dev_cfgs[d].off)
+                break;
+        }
+        if (d < cfg->num_dev_cfgs) {
+            fprintf(out, "init off of %08x\n", cfg->dev_cfgs[d].mask);
+            continue;
+        }
+        fprintf(out, "init\n");
+        route_dump(out, "route", cfg->init[i].route, cfg->init[i].len);
+    }
+    for (i = 0; i < cfg->num_privates; i++)
+        fprintf(out, "private \"%s\" ctl %ld\n", cfg->privates[i].name,
+                cfg->privates[i].ctl ? (long)(cfg->privates[i].ctl - mixer_ctls) : -1l);
+}
+
+static char *cfg_dump_str(const struct mixer_cfg *cfg)
+{
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *fp = open_memstream(&buf, &len);
+
+    if (!fp)
+        return NULL;
+    cfg_dump(fp, cfg);
+    fclose(fp);
+    return buf;
+}
+
+int dsp_mixer_xml_golden(FILE *out)
+{
+    struct mixer_cfg cfg;
+    int ret;
+
+    if (mixer_files_create())
+        return -1;
+    ret = mixer_cfg_parse(&mixer, xml_path, mixer_dev_names, ARRAY_SIZE(mixer_dev_names),
+                          &cfg);
+    if (ret) {
+        fprintf(stderr, "mixer_xml: parse failed %d\n", ret);
+        return -1;
+    }
+    cfg_dump(out, &cfg);
+    mixer_cfg_free(&cfg);
+    return 0;
+}
+
+static const char *ret_name(int ret)
+{
+    switch (ret) {
+    case 0:         return "used";
+    case -ESTALE:   return "stale";
+    case -ENOENT:   return "missing";
+    default:        return "error";
+    }
+}
+
+/* loads the image and, when it is taken, checks it against the xml */
+static int image_case(FILE *out, const char *name, struct mixer *m,
+                      unsigned int num_dev_names, int expect)
+{
+    struct mixer_cfg parsed, loaded;
+    char *want, *got;
+    int ret, failed = 0;
+
+    ret = mixer_cfg_image_load(m, xml_path, mixer_dev_names, num_dev_names, image_path,
+                               &loaded);
+    fprintf(out, "%-16s %s\n", name, ret_name(ret));
+    if (ret != expect) {
+        fprintf(stderr, "mixer_image %s: %d, expected %d\n", name, ret, expect);
+        failed = 1;
+    }
+    if (ret)
+        return failed;
+
+    if (mixer_cfg_parse(m, xml_path, mixer_dev_names, num_dev_names, &parsed)) {
+        mixer_cfg_free(&loaded);
+        return 1;
+    }
+    want = cfg_dump_str(&parsed);
+    got = cfg_dump_str(&loaded);
+    if (!want || !got || strcmp(want, got)) {
+        fprintf(stderr, "mixer_image %s: the image differs from the xml\n", name);
+        failed = 1;
+    }
+    free(want);
+    free(got);
+    mixer_cfg_free(&parsed);
+    mixer_cfg_free(&loaded);
+    return failed;
+}
+
+static int image_write(void)
+{
+    struct mixer_cfg cfg;
+    int ret;
+
+    unlink(image_path);
+    ret = mixer_cfg_load(&mixer, xml_path, mixer_dev_names, ARRAY_SIZE(mixer_dev_names),
+                         image_path, &cfg);
+    if (ret == 0) {
+        if (cfg.image)
+            ret = -EEXIST;
+        mixer_cfg_free(&cfg);
+    }
+    return ret;
+}
+
+/* rewrites the image through fn, which may change it or its length */
+static int image_patch(void (*fn)(unsigned char *image, size_t *len))
+{
+    unsigned char *image;
+    size_t len;
+    int ret;
+
+    image = file_read(image_path, &len);
+    if (!image)
+        return -1;
+    fn(image, &len);
+    ret = file_write(image_path, image, len);
+    free(image);
+    return ret;
+}
+
+static void patch_truncate(unsigned char *image, size_t *len)
+{
+    (void)image;
+    *len -= 7;
+}
+
+/* one bit of the last name, a place nothing but the hash looks at */
+static void patch_corrupt(unsigned char *image, size_t *len)
+{
+    image[*len - 2] ^= 0x20;
+}
+
+static void patch_version(unsigned char *image, size_t *len)
+{
+    (void)len;
+    image[4]++;
+}
+
+static int xml_set(const char *text, const struct timespec *mtime)
+{
+    struct timespec times[2];
+
+    if (file_write(xml_path, text, strlen(text)))
+        return -1;
+    if (!mtime)
+        return 0;
+    times[0] = *mtime;
+    times[1] = *mtime;
+    return utimensat(AT_FDCWD, xml_path, times, 0);
+}
+
+int dsp_mixer_image_golden(FILE *out)
+{
+    struct stat st;
+    struct timespec mtime, later;
+    struct mixer_cfg cfg;
+    char *edited;
+    unsigned int all = ARRAY_SIZE(mixer_dev_names);
+    int failed = 0;
+
+    if (mixer_files_create())
+        return -1;
+    /* a second apart, the image keeps the mtime in seconds */
+    mtime.tv_sec = 1325376000;
+    mtime.tv_nsec = 0;
+    later.tv_sec = mtime.tv_sec + 1;
+    later.tv_nsec = 0;
+    if (xml_set(mixer_xml, &mtime))
+        return -1;
+
+    unlink(image_path);
+    failed |= image_case(out, "no image", &mixer, all, -ENOENT);
+    if (image_write()) {
+        fprintf(stderr, "mixer_image: the image was not written\n");
+        return -1;
+    }
+    failed |= image_case(out, "written", &mixer, all, 0);
+
+    /* mixer_cfg_load() takes it from now on */
+    if (mixer_cfg_load(&mixer, xml_path, mixer_dev_names, all, image_path, &cfg) == 0) {
+        fprintf(out, "%-16s %s\n", "load", cfg.image ? "image" : "xml");
+        failed |= !cfg.image;
+        mixer_cfg_free(&cfg);
+    } else {
+        failed = 1;
+    }
+
+    failed |= xml_set(mixer_xml, &later);
+    failed |= image_case(out, "touched", &mixer, all, -ESTALE);
+    failed |= xml_set(mixer_xml, &mtime);
+    failed |= image_case(out, "untouched", &mixer, all, 0);
+
+    /* an edit of the same size under the old mtime, only the hash sees it */
+    edited = strdup(mixer_xml);
+    if (!edited)
+        return -1;
+    strstr(edited, "val=\"4\"")[5] = '5';
+    failed |= xml_set(edited, &mtime);
+    if (stat(xml_path, &st) < 0 || st.st_size != (off_t)(sizeof(mixer_xml) - 1))
+        failed = 1;
+    failed |= image_case(out, "edited", &mixer, all, -ESTALE);
+    free(edited);
+    failed |= xml_set(mixer_xml, &mtime);
+
+    failed |= image_case(out, "other mixer", &other_mixer, all, -ESTALE);
+    failed |= image_case(out, "other devices", &mixer, all - 1, -ESTALE);
+
+    failed |= image_patch(patch_truncate);
+    failed |= image_case(out, "truncated", &mixer, all, -ESTALE);
+    failed |= image_write();
+    failed |= image_patch(patch_corrupt);
+    failed |= image_case(out, "corrupt", &mixer, all, -ESTALE);
+    failed |= image_write();
+    failed |= image_patch(patch_version);
+    failed |= image_case(out, "version", &mixer, all, -ESTALE);
+
+    /* refused images are replaced by the next load */
+    if (mixer_cfg_load(&mixer, xml_path, mixer_dev_names, all, image_path, &cfg) == 0) {
+        fprintf(out, "%-16s %s\n", "reload", cfg.image ? "image" : "xml");
+        failed |= cfg.image != NULL;
+        mixer_cfg_free(&cfg);
+    } else {
+        failed = 1;
+    }
+    failed |= image_case(out, "rewritten", &mixer, all, 0);
+
+    return failed ? -1 : 0;
+}
+
+/* an open of the HAL, from the xml */
+uint64_t dsp_mixer_xml_bench(void)
+{
+    struct mixer_cfg cfg;
+
+    if (mixer_files_create() ||
+            mixer_cfg_parse(&mixer, xml_path, mixer_dev_names, ARRAY_SIZE(mixer_dev_names),
+                            &cfg))
+        return 0;
+    mixer_cfg_free(&cfg);
+    return 1;
+}
+
+/* an open of the HAL, from the image, its validation included */
+uint64_t dsp_mixer_image_bench(void)
+{
+    struct mixer_cfg cfg;
+
+    if (mixer_files_create())
+        return 0;
+    if (mixer_cfg_image_load(&mixer, xml_path, mixer_dev_names, ARRAY_SIZE(mixer_dev_names),
+                             image_path, &cfg)) {
+        if (image_write())
+            return 0;
+        return 1;
+    }
+    mixer_cfg_free(&cfg);
+    return 1;
+}
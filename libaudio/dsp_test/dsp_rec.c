@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* stages for record_process: the record EQ coefficients and AUDPROC_ProcessDp */
+
+#include <string.h>
+
+#include "dsp_test.h"
+#include "aud_proc.h"
+#include "aud_filter_calc.h"
+
+/* audio_hw.c hands the record path buffers of about this size */
+#define REC_BLOCK_FRAMES    256
+
+static const int32_t rec_fs[] = { 8000, 16000, 44100, 48000 };
+static const int16_t rec_fo[] = { 100, 500, 1000, 3000, 6000 };
+static const int16_t rec_boost[] = { -120, 0, 60, 120 };
+static const int16_t rec_gain[] = { -60, 0 };
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+static void rec_print_iir(FILE *out, const REC_IIR_FILTER_PARA_T *f,
+                          int16_t gain, BOOLEAN ret)
+{
+    if (out)
+        fprintf(out, " %d %d %d %d %d %d g %d r %d\n",
+                f->B0, f->B1, f->B2, f->A0, f->A1, f->A2, gain, ret);
+}
+
+static uint64_t rec_filter_calc_run(FILE *out)
+{
+    REC_FILTER_LCF_CALC_PARA_T lcf;
+    REC_IIR_FILTER_PARA_T f;
+    unsigned int a, b, c, d;
+    uint64_t calcs = 0;
+    int16_t gain;
+    BOOLEAN ret;
+
+    for (a = 0; a < ARRAY_SIZE(rec_fs); a++) {
+        for (b = 0; b < ARRAY_SIZE(rec_fo); b++) {
+            if (rec_fo[b] * 2 >= rec_fs[a])
+                continue;
+            for (c = 0; c < ARRAY_SIZE(rec_boost); c++) {
+                for (d = 0; d < ARRAY_SIZE(rec_gain); d++) {
+                    memset(&f, 0, sizeof(f));
+                    gain = 0;
+                    ret = Rec_Filter_CalcEqCoeffs_Ex(rec_fo[b], rec_fo[b] / 2,
+                            rec_boost[c], rec_gain[d], rec_fs[a], &f, &gain);
+                    if (out)
+                        fprintf(out, "eq %d %d %d %d:", rec_fs[a], rec_fo[b],
+                                rec_boost[c], rec_gain[d]);
+                    rec_print_iir(out, &f, gain, ret);
+
+                    memset(&f, 0, sizeof(f));
+                    gain = 0;
+                    ret = Filter_CalcRecordEq(TRUE, rec_fo[b], rec_fo[b] / 2,
+                            rec_boost[c], rec_gain[d], rec_fs[a], &f, &gain);
+                    if (out)
+                        fprintf(out, "receq %d %d %d %d:", rec_fs[a], rec_fo[b],
+                                rec_boost[c], rec_gain[d]);
+                    rec_print_iir(out, &f, gain, ret);
+                    calcs += 2;
+                }
+            }
+        }
+
+        memset(&lcf, 0, sizeof(lcf));
+        lcf.isFilterOn = TRUE;
+        lcf.eLcfParaType = REC_FILTER_LCFPARA_BUTTERWORTH;
+        lcf.unlcfPara.fp = 150;
+        memset(&f, 0, sizeof(f));
+        gain = 0;
+        ret = Rec_Filter_CalcLCF(&lcf, 16384, rec_fs[a], &f, &gain);
+        if (out)
+            fprintf(out, "lcf butterworth %d:", rec_fs[a]);
+        rec_print_iir(out, &f, gain, ret);
+
+        lcf.eLcfParaType = REC_FILTER_LCFPARA_F1F1;
+        lcf.unlcfPara.lcfPara.f1_g0 = 16384;
+        lcf.unlcfPara.lcfPara.f1_g1 = 4096;
+        lcf.unlcfPara.lcfPara.f1_fp = 200;
+        lcf.unlcfPara.lcfPara.f2_g0 = 16384;
+        lcf.unlcfPara.lcfPara.f2_g1 = 8192;
+        lcf.unlcfPara.lcfPara.f2_fp = 400;
+        memset(&f, 0, sizeof(f));
+        gain = 0;
+        ret = Rec_Filter_CalcLCF(&lcf, 16384, rec_fs[a], &f, &gain);
+        if (out)
+            fprintf(out, "lcf f1f1 %d:", rec_fs[a]);
+        rec_print_iir(out, &f, gain, ret);
+        calcs += 2;
+    }
+    return calcs;
+}
+
+static int rec_filter_calc_golden(FILE *out)
+{
+    rec_filter_calc_run(out);
+    return 0;
+}
+
+static uint64_t rec_filter_calc_bench(void)
+{
+    return rec_filter_calc_run(NULL);
+}
+
+/* DP with compressor, expander, zero cross and LCF, and a 6 band stereo EQ */
+static void rec_dp_init(void)
+{
+    static const RECORDEQ_BAND_INPUT_PARAM_T bands[RECORDEQ_MAX_BAND] = {
+        {   100,   50,  60, 0 },
+        {   300,  150, -30, 0 },
+        {  1000,  500,  30, 0 },
+        {  2000, 1000, -60, 0 },
+        {  4000, 2000,  90, 0 },
+        {  6000, 1500, -90, 0 },
+    };
+    DP_CONTROL_PARAM_T dp;
+    RECORDEQ_CONTROL_PARAM_T eq;
+
+    memset(&dp, 0, sizeof(dp));
+    dp.DP_sw_switch = 0x07;
+    dp.DP_input_gain = 1024 * 2;
+    dp.DP_sdelay = 1;
+    dp.DP_limit_up = -100;
+    dp.DP_limit_down = -4000;
+    dp.COMPRESSOR_threshold = -600;
+    dp.COMPRESSOR_ratio = 8192;
+    dp.COMPRESSOR_attack = 2;
+    dp.COMPRESSOR_hold = 2;
+    dp.COMPRESSOR_release = 20;
+    dp.EXPANDER_threshold = -3000;
+    dp.EXPANDER_ratio = 16384;
+    dp.EXPANDER_attack = 2;
+    dp.EXPANDER_hold = 2;
+    dp.EXPANDER_release = 20;
+    dp.DP_lcf_fp_l = 150;
+    dp.DP_lcf_fp_r = 150;
+    dp.DP_lcf_gain_l = 16384;
+    dp.DP_lcf_gain_r = 16384;
+    AUDPROC_initDp(&dp, DSP_SIGNAL_RATE);
+
+    memset(&eq, 0, sizeof(eq));
+    eq.RECORDEQ_sw_switch = (int16_t)(0x8000 | 0x4000 | 0x3f00);
+    eq.RECORDEQ_master_gain = 1024;
+    memcpy(eq.RECORDEQ_band_para, bands, sizeof(bands));
+    AUDPROC_initRecordEq(&eq, DSP_SIGNAL_RATE);
+}
+
+static int16_t rec_left[DSP_RECORDED_FRAMES_MAX];
+static int16_t rec_right[DSP_RECORDED_FRAMES_MAX];
+
+/* the capture path runs in place, so this does too */
+static uint64_t rec_dp_run(const struct dsp_signal *sig)
+{
+    uint32_t n, count, done;
+    uint32_t frames = sig->frames;
+
+    if (frames > ARRAY_SIZE(rec_left))
+        frames = ARRAY_SIZE(rec_left);
+    memcpy(rec_left, sig->left, frames * sizeof(int16_t));
+    memcpy(rec_right, sig->right, frames * sizeof(int16_t));
+
+    rec_dp_init();
+    for (n = 0; n < frames; n += count) {
+        count = frames - n;
+        if (count > REC_BLOCK_FRAMES)
+            count = REC_BLOCK_FRAMES;
+        AUDPROC_ProcessDp(rec_left + n, rec_right + n, count,
+                          rec_left + n, rec_right + n, &done);
+    }
+    return frames;
+}
+
+static int rec_dp_golden(FILE *out)
+{
+    unsigned int i;
+    uint32_t n, frames;
+
+    for (i = 0; i < dsp_signal_num; i++) {
+        frames = rec_dp_run(&dsp_signals[i]);
+        fprintf(out, "# %s %u\n", dsp_signals[i].name, frames);
+        for (n = 0; n < frames; n++)
+            fprintf(out, "%d %d\n", rec_left[n], rec_right[n]);
+    }
+    return 0;
+}
+
+static uint64_t rec_dp_bench(void)
+{
+    uint64_t frames = 0;
+    unsigned int i;
+
+    for (i = 0; i < dsp_signal_num; i++)
+        frames += rec_dp_run(&dsp_signals[i]);
+    return frames;
+}
+
+const struct dsp_stage dsp_stages[] = {
+    { "rec_filter_calc", "calcs",  rec_filter_calc_golden, rec_filter_calc_bench },
+    { "rec_dp",          "frames", rec_dp_golden,          rec_dp_bench },
+};
+const unsigned int dsp_stage_num = ARRAY_SIZE(dsp_stages);
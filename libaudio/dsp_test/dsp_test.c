@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dsp_test.h"
+
+#define DSP_BENCH_RUNS              5
+
+struct dsp_signal dsp_signals[DSP_SIGNAL_MAX];
+unsigned int dsp_signal_num;
+
+static const char *golden_dir = "golden";
+static const char *baseline_path;
+static const char *throughput_path;
+static int update_golden;
+static int threshold = 20;
+static double bench_seconds = 0.2;
+static volatile int32_t dsp_ref_sink;
+
+/*
+ * sin(pi * x / 32768) for a 16 bit phase, scaled by 16384. A parabola is
+ * close enough for test tones and keeps the signals integer so the golden
+ * vectors come out the same on every host.
+ */
+static int32_t dsp_sin(uint32_t phase)
+{
+    int32_t x = (int16_t)(phase >> 16);
+
+    return (x * (32768 - abs(x))) >> 14;
+}
+
+static uint32_t dsp_phase_inc(uint32_t hz)
+{
+    return (uint32_t)(((uint64_t)hz << 32) / DSP_SIGNAL_RATE);
+}
+
+static int16_t dsp_clip(int32_t v)
+{
+    if (v > 32767)
+        return 32767;
+    if (v < -32768)
+        return -32768;
+    return (int16_t)v;
+}
+
+static struct dsp_signal *dsp_signal_new(const char *name, uint32_t frames)
+{
+    struct dsp_signal *sig;
+
+    if (dsp_signal_num >= DSP_SIGNAL_MAX) {
+        fprintf(stderr, "too many signals, %s dropped\n", name);
+        return NULL;
+    }
+    sig = &dsp_signals[dsp_signal_num];
+    sig->left = calloc(frames, sizeof(int16_t));
+    sig->right = calloc(frames, sizeof(int16_t));
+    if (!sig->left || !sig->right) {
+        free(sig->left);
+        free(sig->right);
+        return NULL;
+    }
+    snprintf(sig->name, sizeof(sig->name), "%s", name);
+    sig->frames = frames;
+    dsp_signal_num++;
+    return sig;
+}
+
+static void dsp_signals_synth(void)
+{
+    static const int32_t steps[4] = { 16384, 4096, 32767, 1024 };
+    struct dsp_signal *sig;
+    uint32_t n, p0 = 0, p1 = 0;
+    uint32_t seed_l = 1, seed_r = 2;
+    const uint32_t frames = DSP_SIGNAL_FRAMES;
+
+    dsp_signal_new("silence", frames);
+
+    /* 1 kHz tone, -6 dBFS then -18, 0 and -30 dBFS, right 6 dB lower */
+    sig = dsp_signal_new("sine_1k_steps", frames);
+    if (sig) {
+        for (n = 0; n < frames; n++, p0 += dsp_phase_inc(1000)) {
+            int32_t s = dsp_sin(p0) * steps[n * 4 / frames] >> 14;
+
+            sig->left[n] = dsp_clip(s);
+            sig->right[n] = dsp_clip(s >> 1);
+        }
+    }
+
+    /* linear sweep 100 Hz to 7 kHz at -6 dBFS */
+    sig = dsp_signal_new("sweep", frames);
+    if (sig) {
+        for (n = 0, p0 = 0; n < frames; n++) {
+            sig->left[n] = sig->right[n] = dsp_clip(dsp_sin(p0));
+            p0 += dsp_phase_inc(100 + 6900 * n / frames);
+        }
+    }
+
+    /* white noise at -6 dBFS, uncorrelated channels */
+    sig = dsp_signal_new("noise", frames);
+    if (sig) {
+        for (n = 0; n < frames; n++) {
+            seed_l = seed_l * 1664525 + 1013904223;
+            seed_r = seed_r * 1664525 + 1013904223;
+            sig->left[n] = (int16_t)(seed_l >> 16) >> 1;
+            sig->right[n] = (int16_t)(seed_r >> 16) >> 1;
+        }
+    }
+
+    /* 300 Hz + 2.2 kHz bursts, 128 frames on and 128 off, ramped */
+    sig = dsp_signal_new("speech_bursts", frames);
+    if (sig) {
+        for (n = 0, p0 = 0, p1 = 0; n < frames; n++) {
+            uint32_t pos = n & 255;
+            int32_t env = 0;
+            int32_t s;
+
+            if (pos < 128)
+                env = pos < 16 ? pos * 1024 : (pos >= 112 ? (127 - pos) * 1024 : 16384);
+            s = (dsp_sin(p0) * 3 + dsp_sin(p1)) >> 2;
+            sig->left[n] = sig->right[n] = dsp_clip(s * env >> 14);
+            p0 += dsp_phase_inc(300);
+            p1 += dsp_phase_inc(2200);
+        }
+    }
+
+    /* full scale 500 Hz square, the limiter's worst case */
+    sig = dsp_signal_new("square_clip", frames);
+    if (sig) {
+        for (n = 0, p0 = 0; n < frames; n++, p0 += dsp_phase_inc(500))
+            sig->left[n] = sig->right[n] = (p0 & 0x80000000) ? -32768 : 32767;
+    }
+}
+
+/* a recorded capture is raw s16le stereo at DSP_SIGNAL_RATE */
+static int dsp_signal_load(const char *path)
+{
+    struct dsp_signal *sig;
+    const char *name;
+    int16_t frame[2];
+    long size;
+    uint32_t frames, n;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    frames = size / sizeof(frame);
+    if (frames > DSP_RECORDED_FRAMES_MAX)
+        frames = DSP_RECORDED_FRAMES_MAX;
+    if (!frames) {
+        fprintf(stderr, "%s: no frames\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    name = strrchr(path, '/');
+    sig = dsp_signal_new(name ? name + 1 : path, frames);
+    if (!sig) {
+        fclose(fp);
+        return -1;
+    }
+    for (n = 0; n < frames && fread(frame, sizeof(frame), 1, fp) == 1; n++) {
+        sig->left[n] = frame[0];
+        sig->right[n] = frame[1];
+    }
+    fclose(fp);
+    return 0;
+}
+
+static char *dsp_read_file(const char *path, size_t *len)
+{
+    char *buf;
+    long size;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = malloc(size + 1);
+    if (buf && fread(buf, 1, size, fp) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(fp);
+    if (buf) {
+        buf[size] = '\0';
+        *len = size;
+    }
+    return buf;
+}
+
+static void dsp_report_diff(const struct dsp_stage *stage,
+                            const char *got, const char *want)
+{
+    unsigned int line = 1;
+    const char *g = got, *w = want;
+
+    while (*g && *g == *w) {
+        if (*g == '\n')
+            line++;
+        g++;
+        w++;
+    }
+    while (g > got && g[-1] != '\n')
+        g--;
+    while (w > want && w[-1] != '\n')
+        w--;
+    fprintf(stderr, "%s: differs from %s/%s.txt at line %u\n"
+            "  got:  %.*s\n  want: %.*s\n",
+            stage->name, golden_dir, stage->name, line,
+            (int)strcspn(g, "\n"), g, (int)strcspn(w, "\n"), w);
+}
+
+static int dsp_check_golden(const struct dsp_stage *stage)
+{
+    char path[256];
+    char *got = NULL, *want;
+    size_t got_len = 0, want_len = 0;
+    FILE *out;
+    int ret;
+
+    out = open_memstream(&got, &got_len);
+    if (!out)
+        return -1;
+    ret = stage->golden(out);
+    fclose(out);
+    if (ret) {
+        fprintf(stderr, "%s: stage failed (%d)\n", stage->name, ret);
+        free(got);
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.txt", golden_dir, stage->name);
+    if (update_golden) {
+        out = fopen(path, "w");
+        if (!out || fwrite(got, 1, got_len, out) != got_len) {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            ret = -1;
+        }
+        if (out)
+            fclose(out);
+        free(got);
+        return ret;
+    }
+
+    want = dsp_read_file(path, &want_len);
+    if (!want) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        free(got);
+        return -1;
+    }
+    if (got_len != want_len || memcmp(got, want, got_len)) {
+        dsp_report_diff(stage, got, want);
+        ret = -1;
+    }
+    free(want);
+    free(got);
+    return ret;
+}
+
+static double dsp_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * A fixed integer loop timed alongside every stage. Its rate tracks how
+ * fast the host is running at that moment, so comparing stage / reference
+ * against the baseline still works on a throttled or shared machine.
+ */
+static uint64_t dsp_ref_bench(void)
+{
+    uint32_t x = 1;
+    int32_t acc = 0;
+    int n;
+
+    for (n = 0; n < 4096; n++) {
+        x = x * 1664525 + 1013904223;
+        acc += ((int16_t)(x >> 16) * (int16_t)x) >> 15;
+    }
+    dsp_ref_sink = acc;
+    return 4096;
+}
+
+static double dsp_bench_once(uint64_t (*bench)(void))
+{
+    double start = dsp_now(), elapsed;
+    uint64_t units = 0;
+
+    do {
+        units += bench();
+        elapsed = dsp_now() - start;
+    } while (elapsed < bench_seconds);
+    return units / elapsed;
+}
+
+/* best of DSP_BENCH_RUNS, so a busy host only ever makes a stage look slow */
+static double dsp_bench(const struct dsp_stage *stage, double *ref)
+{
+    double best = 0, best_ref = 0, rate;
+    int run;
+
+    for (run = 0; run < DSP_BENCH_RUNS; run++) {
+        rate = dsp_bench_once(dsp_ref_bench);
+        if (rate > best_ref)
+            best_ref = rate;
+        rate = dsp_bench_once(stage->bench);
+        if (rate > best)
+            best = rate;
+    }
+    *ref = best_ref;
+    return best;
+}
+
+static int dsp_baseline(const char *name, double *rate, double *ref)
+{
+    char line[128], stage[64];
+    double r, f;
+    int found = 0;
+    FILE *fp;
+
+    if (!baseline_path)
+        return 0;
+    fp = fopen(baseline_path, "r");
+    if (!fp)
+        return 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "%63s %lf %lf", stage, &r, &f) == 3 &&
+            !strcmp(stage, name) && r > 0 && f > 0) {
+            *rate = r;
+            *ref = f;
+            found = 1;
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-u] [-g golden_dir] [-s capture.raw]...\n"
+            "          [-b baseline] [-w throughput] [-t percent] [-T seconds]\n"
+            "  -u  rewrite the golden vectors instead of comparing\n"
+            "  -s  add a recorded s16le stereo %d Hz capture to the signals\n"
+            "  -b  flag stages slower than this throughput file\n"
+            "  -w  write the measured throughput to this file\n"
+            "  -t  allowed slowdown against the baseline, in percent\n"
+            "  -T  time spent on each benchmark run\n",
+            prog, DSP_SIGNAL_RATE);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *tp = NULL;
+    unsigned int i;
+    int failed = 0, regressed = 0;
+    int opt;
+
+    dsp_signals_synth();
+
+    while ((opt = getopt(argc, argv, "ug:s:b:w:t:T:h")) != -1) {
+        switch (opt) {
+        case 'u':
+            update_golden = 1;
+            break;
+        case 'g':
+            golden_dir = optarg;
+            break;
+        case 's':
+            if (dsp_signal_load(optarg))
+                return 1;
+            break;
+        case 'b':
+            baseline_path = optarg;
+            break;
+        case 'w':
+            throughput_path = optarg;
+            break;
+        case 't':
+            threshold = atoi(optarg);
+            break;
+        case 'T':
+            bench_seconds = atof(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (throughput_path) {
+        tp = fopen(throughput_path, "w");
+        if (!tp) {
+            fprintf(stderr, "%s: %s\n", throughput_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    for (i = 0; i < dsp_stage_num; i++) {
+        const struct dsp_stage *stage = &dsp_stages[i];
+        double rate, ref, base, base_ref;
+
+        if (dsp_check_golden(stage)) {
+            failed++;
+            continue;
+        }
+        if (update_golden) {
+            printf("%-16s golden updated\n", stage->name);
+            continue;
+        }
+
+        rate = dsp_bench(stage, &ref);
+        printf("%-16s %14.0f %s/s", stage->name, rate, stage->unit);
+        if (dsp_baseline(stage->name, &base, &base_ref)) {
+            /* the change relative to the reference loop, not in raw rate */
+            double change = (rate / ref) / (base / base_ref) - 1;
+
+            printf("  %+6.1f%%", change * 100);
+            if (change * 100 < -threshold) {
+                printf("  REGRESSION (> %d%% below baseline)", threshold);
+                regressed++;
+            }
+        }
+        printf("\n");
+        if (tp)
+            fprintf(tp, "%s %.0f %.0f\n", stage->name, rate, ref);
+    }
+
+    if (tp)
+        fclose(tp);
+    if (failed)
+        return 1;
+    return regressed ? 2 : 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DSP_TEST_H
+#define DSP_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * A stage is one piece of the DSP code run on the host. golden() prints its
+ * results for the fixed inputs as text, one result per line; dsp_test.c
+ * compares that text with golden/<name>.txt. bench() runs one batch of the
+ * same work and returns how many units, samples or calculations, it did.
+ */
+struct dsp_stage {
+    const char *name;
+    const char *unit;
+    int (*golden)(FILE *out);
+    uint64_t (*bench)(void);
+};
+
+/* each test binary links the stages of one library */
+extern const struct dsp_stage dsp_stages[];
+extern const unsigned int dsp_stage_num;
+
+/* stereo s16 signal, planar like the record path hands it over */
+struct dsp_signal {
+    char name[64];
+    int16_t *left;
+    int16_t *right;
+    uint32_t frames;
+};
+
+#define DSP_SIGNAL_RATE     16000
+#define DSP_SIGNAL_FRAMES   1024
+#define DSP_SIGNAL_MAX      16
+/* a recorded capture is cut to this many frames, about four seconds */
+#define DSP_RECORDED_FRAMES_MAX 65536
+
+/* the synthetic signals, then the recorded ones given with -s */
+extern struct dsp_signal dsp_signals[DSP_SIGNAL_MAX];
+extern unsigned int dsp_signal_num;
+
+/* dsp_mixer.c, linked into dsp_test_hal next to the DSP stages */
+int dsp_mixer_xml_golden(FILE *out);
+uint64_t dsp_mixer_xml_bench(void);
+int dsp_mixer_image_golden(FILE *out);
+uint64_t dsp_mixer_image_bench(void);
+
+#endif
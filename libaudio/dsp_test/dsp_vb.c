@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* stages for vb_effect: filter_calc.c and the VBC EQ register images */
+
+#include <string.h>
+
+#include "dsp_test.h"
+#include "aud_enha.h"
+#include "filter_calc.h"
+
+#define ARRAY_SIZE(a)   (sizeof(a) / sizeof((a)[0]))
+
+/* vb_effect_if.c keeps 61 register words per profile */
+#define VB_PARAS_LEN    61
+
+static const int32_t vb_fs[] = { 8000, 16000, 44100, 48000 };
+static const int16_t vb_fo[] = { 60, 250, 1000, 4000, 12000 };
+static const int16_t vb_boost[] = { -720, -60, 0, 60, 180 };
+static const int16_t vb_gain[] = { -60, 0 };
+
+/* vb_effect_if.c:vbc_reg_default, what each profile starts from */
+static const uint32_t vb_reg_default[VB_PARAS_LEN] = {
+    0x0, 0x1818, 0x7F, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+    0x0, 0x0, 0x0, 0x0, 0x183, 0x183, 0x0, 0x1818,
+};
+
+/*
+ * AUDENHA_SetPara() keeps the buffer address in the 32 bit VB_MAP_BASE and
+ * writes through it, so the buffer must be static and the binary non-PIE
+ * for it to sit below 4 GB.
+ */
+static uint32_t vb_paras[100];
+
+static void vb_print_iir(FILE *out, const IIR_FILTER_PARA_T *f,
+                         int16_t gain, BOOLEAN ret)
+{
+    if (out)
+        fprintf(out, " %d %d %d %d %d %d g %d r %d\n",
+                f->B0, f->B1, f->B2, f->A0, f->A1, f->A2, gain, ret);
+}
+
+static uint64_t vb_filter_calc_run(FILE *out)
+{
+    FILTER_LCF_CALC_PARA_T lcf;
+    IIR_FILTER_PARA_T f;
+    unsigned int a, b, c, d;
+    uint64_t calcs = 0;
+    int16_t gain;
+    BOOLEAN ret;
+
+    for (a = 0; a < ARRAY_SIZE(vb_fs); a++) {
+        for (b = 0; b < ARRAY_SIZE(vb_fo); b++) {
+            if (vb_fo[b] * 2 >= vb_fs[a])
+                continue;
+            for (c = 0; c < ARRAY_SIZE(vb_boost); c++) {
+                for (d = 0; d < ARRAY_SIZE(vb_gain); d++) {
+                    memset(&f, 0, sizeof(f));
+                    gain = 0;
+                    ret = Filter_CalcEqCoeffs_Ex(vb_fo[b], vb_fo[b] / 2,
+                            vb_boost[c], vb_gain[d], vb_fs[a], &f, &gain);
+                    if (out)
+                        fprintf(out, "eq %d %d %d %d:", vb_fs[a], vb_fo[b],
+                                vb_boost[c], vb_gain[d]);
+                    vb_print_iir(out, &f, gain, ret);
+                    calcs++;
+                }
+            }
+        }
+
+        memset(&lcf, 0, sizeof(lcf));
+        lcf.isFilterOn = SCI_TRUE;
+        lcf.eLcfParaType = FILTER_LCFPARA_BUTTERWORTH;
+        lcf.unlcfPara.fp = 150;
+        memset(&f, 0, sizeof(f));
+        gain = 0;
+        ret = Filter_CalcLCF(&lcf, 16384, vb_fs[a], &f, &gain);
+        if (out)
+            fprintf(out, "lcf butterworth %d:", vb_fs[a]);
+        vb_print_iir(out, &f, gain, ret);
+
+        lcf.eLcfParaType = FILTER_LCFPARA_F1F1;
+        lcf.unlcfPara.lcfPara.f1_g0 = 16384;
+        lcf.unlcfPara.lcfPara.f1_g1 = 4096;
+        lcf.unlcfPara.lcfPara.f1_fp = 200;
+        lcf.unlcfPara.lcfPara.f2_g0 = 16384;
+        lcf.unlcfPara.lcfPara.f2_g1 = 8192;
+        lcf.unlcfPara.lcfPara.f2_fp = 400;
+        memset(&f, 0, sizeof(f));
+        gain = 0;
+        ret = Filter_CalcLCF(&lcf, 16384, vb_fs[a], &f, &gain);
+        if (out)
+            fprintf(out, "lcf f1f1 %d:", vb_fs[a]);
+        vb_print_iir(out, &f, gain, ret);
+        calcs += 2;
+    }
+    return calcs;
+}
+
+static int vb_filter_calc_golden(FILE *out)
+{
+    vb_filter_calc_run(out);
+    return 0;
+}
+
+static uint64_t vb_filter_calc_bench(void)
+{
+    return vb_filter_calc_run(NULL);
+}
+
+struct vb_profile {
+    const char *mode;
+    uint16_t eq_switch;         /* eq mode, 0 is off */
+    uint16_t eq_control;        /* bit15: 8 bands */
+    uint16_t band_control;      /* bit15-bit8 band sw, bit1 HS, bit0 LS */
+    uint16_t proc_control;      /* bit8 ALC, bit0 LCF */
+    uint16_t mode_reserve0;     /* r_limit, LCF type, tunable, fm mix */
+};
+
+/* one profile per mode name branch in AUDENHA_GetPara() */
+static const struct vb_profile vb_profiles[] = {
+    { "Headset",  1, 0x0000, 0xf800, 0x0100, 0x0070 },
+    { "Headfree", 2, 0x8000, 0xff03, 0x0101, 0x0050 },
+    { "Handset",  0, 0x0000, 0x0000, 0x0001, 0x0140 },
+    { "Loudspeaker", 6, 0x8000, 0xaa02, 0x0101, 0x5060 },
+};
+
+static const EQ_BAND_INPUT_PARA_T vb_bands[EQ_BAND_MAX] = {
+    {    80,  70,  60, 0 },
+    {   250, 100, -30, 0 },
+    {   800, 100,  30, 0 },
+    {  2000, 150, -60, 0 },
+    {  4000, 150,  90, 0 },
+    {  8000, 200, -90, 0 },
+    { 12000, 200,  60, 0 },
+    { 16000, 300, -30, 0 },
+};
+
+static const VBC_ALC_PARAS_T vb_alc = {
+    24, 4, 4, 32767, 1, 1024, 0, 512, 512, 512, 512,
+};
+
+static AUDIO_TOTAL_T vb_param;
+
+static void vb_profile_fill(const struct vb_profile *p)
+{
+    AUDIO_NV_ARM_MODE_STRUCT_T *mode = &vb_param.audio_nv_arm_mode_info.tAudioNvArmModeStruct;
+    AUDIO_NV_ARM_APP_CONFIG_INFO_T *app = &mode->app_config_info_set.app_config_info[0];
+    unsigned int i;
+
+    memset(&vb_param, 0, sizeof(vb_param));
+    strncpy((char *)vb_param.audio_nv_arm_mode_info.ucModeName, p->mode,
+            AUDIO_NV_ARM_MODE_NAME_MAX_LEN - 1);
+
+    vb_param.audio_enha_eq.eq_control = p->eq_control;
+    for (i = 0; i < EQ_MODE_MAX; i++) {
+        EQ_MODE_PARA_T *eq = &vb_param.audio_enha_eq.eq_modes[i];
+
+        eq->agc_in_gain = 4096 + 512 * i;
+        eq->band_control = p->band_control;
+        memcpy(eq->eq_band, vb_bands, sizeof(vb_bands));
+        eq->eq_band[i].boostdB += 30;
+    }
+
+    mode->app_config_info_set.aud_proc_exp_control[1] = p->proc_control;
+    app->eq_switch = p->eq_switch;
+    app->agc_input_gain[0] = 2048;
+    app->valid_volume_level_count = 5;
+    app->arm_volume[5] = 0x1400 << 16;
+
+    mode->reserve[0] = p->mode_reserve0;
+    mode->reserve[1] = 16384;
+    mode->reserve[2] = 4096;
+    mode->reserve[3] = 200;
+    mode->reserve[4] = 16384;
+    mode->reserve[5] = 8192;
+    mode->reserve[6] = 400;
+    memcpy(&mode->reserve[7], &vb_alc, sizeof(vb_alc));
+}
+
+static int vb_profile_run(const struct vb_profile *p)
+{
+    vb_profile_fill(p);
+    memset(vb_paras, 0, sizeof(vb_paras));
+    memcpy(vb_paras, vb_reg_default, sizeof(vb_reg_default));
+    return AUDENHA_SetPara(&vb_param, vb_paras);
+}
+
+static int vbc_eq_golden(FILE *out)
+{
+    unsigned int i, n;
+    int ret;
+
+    if ((uintptr_t)vb_paras > UINT32_MAX) {
+        fprintf(stderr, "vbc_eq: register buffer above 4 GB, build with -no-pie\n");
+        return -1;
+    }
+    for (i = 0; i < ARRAY_SIZE(vb_profiles); i++) {
+        ret = vb_profile_run(&vb_profiles[i]);
+        fprintf(out, "# %s %d\n", vb_profiles[i].mode, ret);
+        for (n = 0; n < VB_PARAS_LEN; n++)
+            fprintf(out, "%02x %08x\n", n * 4, vb_paras[n]);
+    }
+    return 0;
+}
+
+static uint64_t vbc_eq_bench(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(vb_profiles); i++)
+        vb_profile_run(&vb_profiles[i]);
+    return ARRAY_SIZE(vb_profiles);
+}
+
+const struct dsp_stage dsp_stages[] = {
+    { "vb_filter_calc", "calcs",    vb_filter_calc_golden, vb_filter_calc_bench },
+    { "vbc_eq",         "profiles", vbc_eq_golden,         vbc_eq_bench },
+};
+const unsigned int dsp_stage_num = ARRAY_SIZE(dsp_stages);
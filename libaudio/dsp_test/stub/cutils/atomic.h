@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The two barriers audio_echo_ref.c uses. dsp_hal.c defines them, so it can
+ * run the writer in between the loads of a read.
+ */
+
+#ifndef DSP_TEST_STUB_CUTILS_ATOMIC_H
+#define DSP_TEST_STUB_CUTILS_ATOMIC_H
+
+#include <stdint.h>
+
+int32_t android_atomic_acquire_load(volatile const int32_t *addr);
+void android_atomic_release_store(int32_t value, volatile int32_t *addr);
+
+#endif
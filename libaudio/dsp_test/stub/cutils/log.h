@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* host stand-in for the bionic logging header, errors go to stderr */
+
+#ifndef DSP_TEST_STUB_CUTILS_LOG_H
+#define DSP_TEST_STUB_CUTILS_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define ALOGV(...)  ((void)0)
+#define ALOGD(...)  ((void)0)
+#define ALOGI(...)  ((void)0)
+#define ALOGW(...)  ((void)0)
+#define ALOGE(...)  (fprintf(stderr, __VA_ARGS__), fputc('\n', stderr))
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * libengclient on the host: a scripted modem behind engapi_open(). Each
+ * session is a socketpair served by a thread of its own, which answers each
+ * AT command with "OK" after a set delay, or not at all when told to drop
+ * replies, and logs what it got and when.
+ *
+ * The case drives the in-call commands of at_commands_generic.c as
+ * audiopolicy does during a call: the volume steps of a key press, a volume
+ * ramp with route switches in between, and a modem that stops answering.
+ * The callers must not wait for the modem, the modem must end up with the
+ * last volume and route in the order they were set, and a lost reply must
+ * cost one session, not the commands after it.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <system/audio.h>
+
+#include "hal_test.h"
+
+/* the modem of a call, a round trip over the eng channel */
+#define AT_MODEM_DELAY_US       5000
+/* AT_CMD_TIMEOUT_MS of at_commands_generic.c */
+#define AT_CMD_TIMEOUT_MS       2000
+#define AT_STEPS                100
+#define AT_STEP_MS              10
+#define AT_RAMP_CALLS           300
+#define AT_LOG_SIZE             1024
+/* a volume call queues a command, far from a round trip to the modem */
+#define AT_MAX_CALL_P50_US      (AT_MODEM_DELAY_US / 10)
+
+struct at_log_entry {
+    int64_t ns;
+    char cmd[48];
+};
+
+static pthread_mutex_t s_modem_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int s_modem_delay_us = AT_MODEM_DELAY_US;
+static unsigned int s_modem_drop;       /* replies not to send */
+static uint32_t s_modem_opens;
+static struct at_log_entry s_modem_log[AT_LOG_SIZE];
+static unsigned int s_modem_count;
+
+static void *at_modem_thread(void *arg)
+{
+    int fd = (int)(intptr_t)arg;
+    char buf[128], *cmd;
+    ssize_t len;
+    int drop;
+
+    while ((len = read(fd, buf, sizeof(buf) - 1)) > 0) {
+        buf[len] = '\0';
+        /* "<ENG_AT_NOHANDLE_CMD>,1,AT+..." */
+        cmd = strstr(buf, "AT");
+        pthread_mutex_lock(&s_modem_lock);
+        if (s_modem_count < AT_LOG_SIZE) {
+            s_modem_log[s_modem_count].ns = hal_now_ns();
+            snprintf(s_modem_log[s_modem_count].cmd, sizeof(s_modem_log[0].cmd), "%.47s",
+                     cmd ? cmd : buf);
+            s_modem_count++;
+        }
+        drop = s_modem_drop > 0;
+        if (drop)
+            s_modem_drop--;
+        pthread_mutex_unlock(&s_modem_lock);
+        if (drop)
+            continue;
+        hal_sleep_ns(s_modem_delay_us * 1000LL);
+        if (write(fd, "OK", 2) != 2)
+            break;
+    }
+    close(fd);
+    return NULL;
+}
+
+int engapi_open(int type)
+{
+    pthread_t thread;
+    int sv[2];
+
+    /* one write is one command, as over the eng socket */
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) < 0)
+        return -1;
+    if (pthread_create(&thread, NULL, at_modem_thread, (void *)(intptr_t)sv[1])) {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    pthread_detach(thread);
+    pthread_mutex_lock(&s_modem_lock);
+    s_modem_opens++;
+    pthread_mutex_unlock(&s_modem_lock);
+    return sv[0];
+}
+
+void engapi_close(int fd)
+{
+    close(fd);
+}
+
+int engapi_read(int fd, void *buf, size_t len)
+{
+    return read(fd, buf, len);
+}
+
+int engapi_write(int fd, const void *buf, size_t len)
+{
+    return write(fd, buf, len);
+}
+
+static unsigned int modem_count(void)
+{
+    unsigned int count;
+
+    pthread_mutex_lock(&s_modem_lock);
+    count = s_modem_count;
+    pthread_mutex_unlock(&s_modem_lock);
+    return count;
+}
+
+/* waits for the modem to have got count commands, 0 when it did */
+static int modem_wait(unsigned int count, int timeout_ms)
+{
+    int64_t end = hal_now_ns() + timeout_ms * 1000000LL;
+
+    while (modem_count() < count) {
+        if (hal_now_ns() > end)
+            return -1;
+        hal_sleep_ns(1000000);
+    }
+    return 0;
+}
+
+/* waits until the modem got nothing for a while */
+static void modem_settle(void)
+{
+    unsigned int count;
+
+    do {
+        count = modem_count();
+        hal_sleep_ns(AT_MODEM_DELAY_US * 4000LL);
+    } while (modem_count() != count);
+}
+
+/* the last command from first on starting with prefix, -1 when none */
+static int modem_last(unsigned int first, const char *prefix)
+{
+    unsigned int i;
+    int last = -1;
+
+    pthread_mutex_lock(&s_modem_lock);
+    for (i = first; i < s_modem_count; i++)
+        if (strncmp(s_modem_log[i].cmd, prefix, strlen(prefix)) == 0)
+            last = i;
+    pthread_mutex_unlock(&s_modem_lock);
+    return last;
+}
+
+/* the AT+VGR value of at_cmd_volume() for step */
+static float at_volume(unsigned int step)
+{
+    return ((step % 6) + 0.5f) / 6;
+}
+
+static double ms(int64_t ns)
+{
+    return ns / 1e6;
+}
+
+static int at_steps(struct audio_hw_device *dev, struct hal_samples *call_ns)
+{
+    int64_t sent_ns[AT_STEPS];
+    struct hal_samples lat_ns;
+    unsigned int first, i, j, got;
+    int step, failed = 0;
+
+    if (hal_samples_init(&lat_ns, AT_STEPS)) {
+        fprintf(stderr, "at: out of memory\n");
+        return 1;
+    }
+    first = modem_count();
+    for (i = 0; i < AT_STEPS; i++) {
+        /* the modem may get the command before the call returns */
+        sent_ns[i] = hal_now_ns();
+        dev->set_voice_volume(dev, at_volume(i));
+        hal_samples_add(call_ns, hal_now_ns() - sent_ns[i]);
+        hal_sleep_ns(AT_STEP_MS * 1000000LL);
+    }
+    modem_settle();
+
+    /* the latency of a command is from the call that asked for its value
+     * last to the modem */
+    pthread_mutex_lock(&s_modem_lock);
+    got = s_modem_count - first;
+    for (j = first; j < s_modem_count; j++) {
+        if (sscanf(s_modem_log[j].cmd, "AT+VGR=%d", &step) != 1)
+            continue;
+        for (i = AT_STEPS; i-- > 0;)
+            if (sent_ns[i] <= s_modem_log[j].ns && (int)(i % 6) + 1 == step)
+                break;
+        if (i < AT_STEPS)
+            hal_samples_add(&lat_ns, s_modem_log[j].ns - sent_ns[i]);
+    }
+    pthread_mutex_unlock(&s_modem_lock);
+
+    printf("  %u volume steps %d ms apart: %u commands at the modem, latency p50 %.2f ms"
+           " p99 %.2f ms max %.2f ms\n", AT_STEPS, AT_STEP_MS, got,
+           ms(hal_samples_pct(&lat_ns, 50)), ms(hal_samples_pct(&lat_ns, 99)),
+           ms(hal_samples_pct(&lat_ns, 100)));
+    /* a step each 10 ms is slower than the modem, none may be merged */
+    if (got != AT_STEPS) {
+        fprintf(stderr, "at: %u of %u volume steps reached the modem\n", got, AT_STEPS);
+        failed = 1;
+    }
+    hal_samples_free(&lat_ns);
+    return failed;
+}
+
+/* a ramp of the volume as fast as the caller can, with the headset
+ * plugged in and out in the middle */
+static int at_ramp(struct audio_hw_device *dev, struct audio_stream_out *out,
+                   struct hal_samples *call_ns)
+{
+    unsigned int first, got, i;
+    int64_t start, begin, end, settle;
+    int vgr, ssam, step, route, failed = 0;
+    char kv[32];
+
+    first = modem_count();
+    begin = hal_now_ns();
+    for (i = 0; i < AT_RAMP_CALLS; i++) {
+        start = hal_now_ns();
+        dev->set_voice_volume(dev, at_volume(i));
+        hal_samples_add(call_ns, hal_now_ns() - start);
+        if (i % 100 == 50) {
+            snprintf(kv, sizeof(kv), "%s=%d", AUDIO_PARAMETER_STREAM_ROUTING,
+                     (i / 100) & 1 ? AUDIO_DEVICE_OUT_SPEAKER : AUDIO_DEVICE_OUT_WIRED_HEADSET);
+            out->common.set_parameters(&out->common, kv);
+        }
+    }
+    end = hal_now_ns();
+    modem_settle();
+
+    got = modem_count() - first;
+    vgr = modem_last(first, "AT+VGR=");
+    ssam = modem_last(first, "AT+SSAM=");
+    settle = vgr >= 0 ? s_modem_log[vgr].ns - end : 0;
+    printf("  ramp of %u volume calls and 3 routes in %.2f ms, %.0f calls/s: %u commands at"
+           " the modem, %.0f/s, the last %.2f ms after the calls\n", AT_RAMP_CALLS,
+           ms(end - begin), AT_RAMP_CALLS * 1e9 / (end - begin), got,
+           got * 1e9 / (settle + end - begin), ms(settle));
+
+    if (vgr < 0 || sscanf(s_modem_log[vgr].cmd, "AT+VGR=%d", &step) != 1 ||
+        step != (int)((AT_RAMP_CALLS - 1) % 6) + 1) {
+        fprintf(stderr, "at: the modem did not get the last volume\n");
+        failed = 1;
+    }
+    /* the last route was the headset, AT+SSAM=2 */
+    if (ssam < 0 || sscanf(s_modem_log[ssam].cmd, "AT+SSAM=%d", &route) != 1 || route != 2) {
+        fprintf(stderr, "at: the modem did not get the last route\n");
+        failed = 1;
+    }
+    /* merged, the commands still keep the order of the calls */
+    if (vgr >= 0 && ssam >= 0 && vgr < ssam) {
+        fprintf(stderr, "at: the last route reached the modem after the last volume\n");
+        failed = 1;
+    }
+    if (got >= AT_RAMP_CALLS / 4) {
+        fprintf(stderr, "at: %u commands for %u calls, the queued volumes were not merged\n",
+                got, AT_RAMP_CALLS);
+        failed = 1;
+    }
+    return failed;
+}
+
+/* the modem loses a reply: the HAL gives up on it, opens a new session and
+ * the next command goes through it */
+static int at_lost_reply(struct audio_hw_device *dev)
+{
+    unsigned int first, opens;
+    int64_t start, lost_ns;
+    int failed = 0;
+
+    pthread_mutex_lock(&s_modem_lock);
+    s_modem_drop = 1;
+    opens = s_modem_opens;
+    pthread_mutex_unlock(&s_modem_lock);
+    first = modem_count();
+    start = hal_now_ns();
+    dev->set_voice_volume(dev, at_volume(0));
+    /* sent, or the next one would replace it in the queue */
+    if (modem_wait(first + 1, AT_CMD_TIMEOUT_MS)) {
+        fprintf(stderr, "at: no command for the modem to lose\n");
+        return 1;
+    }
+    dev->set_voice_volume(dev, at_volume(3));
+    if (modem_wait(first + 2, AT_CMD_TIMEOUT_MS * 2)) {
+        fprintf(stderr, "at: no command after a lost reply\n");
+        return 1;
+    }
+    lost_ns = s_modem_log[first + 1].ns - start;
+    modem_settle();
+    printf("  a lost reply held the next command %.1f ms, %u new sessions\n", ms(lost_ns),
+           s_modem_opens - opens);
+    if (s_modem_opens - opens != 1) {
+        fprintf(stderr, "at: %u sessions opened after a lost reply\n", s_modem_opens - opens);
+        failed = 1;
+    }
+    if (lost_ns < AT_CMD_TIMEOUT_MS * 1000000LL ||
+        lost_ns > (AT_CMD_TIMEOUT_MS + 500) * 1000000LL) {
+        fprintf(stderr, "at: the next command waited %.1f ms\n", ms(lost_ns));
+        failed = 1;
+    }
+    if (strcmp(s_modem_log[first + 1].cmd, "AT+VGR=4") != 0) {
+        fprintf(stderr, "at: [%s] after a lost reply\n", s_modem_log[first + 1].cmd);
+        failed = 1;
+    }
+    return failed;
+}
+
+int hal_at_run(struct audio_hw_device *dev)
+{
+    struct audio_config config;
+    struct audio_stream_out *out;
+    struct hal_samples call_ns;
+    int failed = 0;
+
+    memset(&config, 0, sizeof(config));
+    if (dev->open_output_stream(dev, 0, AUDIO_DEVICE_OUT_EARPIECE, AUDIO_OUTPUT_FLAG_PRIMARY,
+                                &config, &out)) {
+        fprintf(stderr, "at: can not open the output\n");
+        return 1;
+    }
+    if (hal_samples_init(&call_ns, AT_STEPS + AT_RAMP_CALLS)) {
+        fprintf(stderr, "at: out of memory\n");
+        return 1;
+    }
+    dev->set_mode(dev, AUDIO_MODE_IN_CALL);
+
+    failed |= at_steps(dev, &call_ns);
+    failed |= at_ramp(dev, out, &call_ns);
+    printf("  set_voice_volume p50 %.3f ms p99 %.3f ms max %.3f ms, the modem takes %.1f ms\n",
+           ms(hal_samples_pct(&call_ns, 50)), ms(hal_samples_pct(&call_ns, 99)),
+           ms(hal_samples_pct(&call_ns, 100)), AT_MODEM_DELAY_US / 1000.0);
+    if (hal_samples_pct(&call_ns, 50) > AT_MAX_CALL_P50_US * 1000LL) {
+        fprintf(stderr, "at: set_voice_volume p50 %.3f ms, it waits for the modem\n",
+                ms(hal_samples_pct(&call_ns, 50)));
+        failed = 1;
+    }
+    failed |= at_lost_reply(dev);
+
+    dev->set_mode(dev, AUDIO_MODE_NORMAL);
+    dev->close_output_stream(dev, out);
+    hal_samples_free(&call_ns);
+    return failed;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Records for a few seconds as the record thread of audioflinger does, one
+ * buffer of the stream at a time, from the tone of the mock capture pcm: at
+ * the 48 kHz of the card and resampled, with and without a pre processing.
+ * Once the stream runs in_read() must not touch the heap nor copy the frames
+ * around, only the pcm, the resampler and the effect write them. Each read
+ * is timed and the tone must come out whole. The reads block on the pcm, so
+ * their times and the overruns of a capture pcm of two periods are those of
+ * the host: they are reported, not checked.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <hardware/audio_effect.h>
+#include <system/audio.h>
+
+#include "hal_test.h"
+#include "mock_alsa.h"
+
+#define CAPTURE_MS              3000
+/* the first read starts the pcm and the record process */
+#define CAPTURE_WARMUP_READS    4
+
+struct capture_mode {
+    const char *name;
+    uint32_t rate;
+    audio_channel_mask_t channel_mask;
+    int effect;
+};
+
+static const struct capture_mode capture_modes[] = {
+    { "48000 Hz stereo", 48000, AUDIO_CHANNEL_IN_STEREO, 0 },
+    { "48000 Hz stereo, pre processed", 48000, AUDIO_CHANNEL_IN_STEREO, 1 },
+    { "44100 Hz stereo, resampled", 44100, AUDIO_CHANNEL_IN_STEREO, 0 },
+    { "16000 Hz mono, resampled and pre processed", 16000, AUDIO_CHANNEL_IN_MONO, 1 },
+};
+
+/* a pre processing that inverts the signal, it takes what fits in the output */
+struct capture_effect {
+    const struct effect_interface_s *itfe;
+    unsigned int channels;
+    uint64_t frames;
+};
+
+static int32_t capture_effect_process(effect_handle_t self, audio_buffer_t *in_buf,
+                                      audio_buffer_t *out_buf)
+{
+    struct capture_effect *fx = (struct capture_effect *)self;
+    size_t frames, i;
+
+    frames = in_buf->frameCount < out_buf->frameCount ? in_buf->frameCount :
+             out_buf->frameCount;
+    for (i = 0; i < frames * fx->channels; i++)
+        out_buf->s16[i] = -in_buf->s16[i];
+    in_buf->frameCount = frames;
+    out_buf->frameCount = frames;
+    fx->frames += frames;
+    return 0;
+}
+
+static int32_t capture_effect_get_descriptor(effect_handle_t self,
+                                             effect_descriptor_t *desc)
+{
+    memset(desc, 0, sizeof(*desc));
+    strcpy(desc->name, "invert");
+    return 0;
+}
+
+static const struct effect_interface_s capture_effect_itfe = {
+    .process = capture_effect_process,
+    .get_descriptor = capture_effect_get_descriptor,
+};
+
+static double ms(int64_t ns)
+{
+    return ns / 1e6;
+}
+
+static int capture_mode_run(struct audio_hw_device *dev, const struct capture_mode *mode)
+{
+    struct audio_config config;
+    struct audio_stream_in *in;
+    struct capture_effect fx;
+    struct hal_alloc_stats warmup, steady;
+    struct hal_lock_stats locks;
+    struct hal_samples call_ns, jitter_ns;
+    struct mock_pcm_stats pcm;
+    int64_t period_ns, end_ns, start, last = 0, now, d, jitter_p99;
+    unsigned int reads = 0, channels, i;
+    size_t bytes;
+    int16_t *buf;
+    int peak = 0, failed = 0;
+
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = mode->rate;
+    config.channel_mask = mode->channel_mask;
+    config.format = AUDIO_FORMAT_PCM_16_BIT;
+    if (dev->open_input_stream(dev, 0, AUDIO_DEVICE_IN_BUILTIN_MIC, &config, &in)) {
+        fprintf(stderr, "capture: can not open the input at %u Hz\n", mode->rate);
+        return 1;
+    }
+    memset(&fx, 0, sizeof(fx));
+    fx.itfe = &capture_effect_itfe;
+    fx.channels = channels = popcount(mode->channel_mask);
+    if (mode->effect)
+        in->common.add_audio_effect(&in->common, (effect_handle_t)&fx);
+
+    bytes = in->common.get_buffer_size(&in->common);
+    buf = malloc(bytes);
+    if (!buf || hal_samples_init(&call_ns, 1024) || hal_samples_init(&jitter_ns, 1024)) {
+        fprintf(stderr, "capture: out of memory\n");
+        return 1;
+    }
+    period_ns = (int64_t)(bytes / channels / 2) * 1000000000LL / mode->rate;
+    memset(&warmup, 0, sizeof(warmup));
+    memset(&steady, 0, sizeof(steady));
+    memset(&locks, 0, sizeof(locks));
+    mock_alsa_reset_stats();
+
+    end_ns = hal_now_ns() + CAPTURE_MS * 1000000LL;
+    while (hal_now_ns() < end_ns) {
+        hal_alloc_track(reads < CAPTURE_WARMUP_READS ? &warmup : &steady);
+        hal_lock_track(reads < CAPTURE_WARMUP_READS ? NULL : &locks);
+        start = hal_now_ns();
+        in->read(in, buf, bytes);
+        now = hal_now_ns();
+        hal_alloc_track(NULL);
+        hal_lock_track(NULL);
+        if (++reads > CAPTURE_WARMUP_READS) {
+            hal_samples_add(&call_ns, now - start);
+            d = now - last - period_ns;
+            hal_samples_add(&jitter_ns, d < 0 ? -d : d);
+            for (i = 0; i < bytes / 2; i++)
+                if (abs(buf[i]) > peak)
+                    peak = abs(buf[i]);
+        }
+        last = now;
+    }
+    in->common.standby(&in->common);
+    mock_pcm_get_stats(0, &pcm);
+    reads -= CAPTURE_WARMUP_READS;
+    jitter_p99 = hal_samples_pct(&jitter_ns, 99);
+
+    printf("  %s: %u reads of %zu bytes, read p50 %.2f ms p99 %.2f ms max %.2f ms,"
+           " jitter p99 %.2f ms\n", mode->name, reads, bytes,
+           ms(hal_samples_pct(&call_ns, 50)), ms(hal_samples_pct(&call_ns, 99)),
+           ms(hal_samples_pct(&call_ns, 100)), ms(jitter_p99));
+    printf("    per read: %.2f allocations, %.2f frees, %.2f memcpy, %.2f memmove,"
+           " %.0f bytes copied (%u allocations to start)\n",
+           (double)steady.allocs / reads, (double)steady.frees / reads,
+           (double)steady.copies / reads, (double)steady.moves / reads,
+           (double)steady.copy_bytes / reads, warmup.allocs);
+    printf("    %u of %u mutex locks contended, max %.3f ms\n", locks.contended,
+           locks.locks, ms(locks.max_wait_ns));
+    printf("    card: %llu frames in %u reads, %u overruns, tone peak %d\n",
+           (unsigned long long)pcm.frames, pcm.transfers, pcm.xruns, peak);
+
+    if (steady.allocs || steady.frees) {
+        fprintf(stderr, "capture: %s: %u allocations and %u frees in %u reads\n",
+                mode->name, steady.allocs, steady.frees, reads);
+        failed = 1;
+    }
+    if (steady.copies || steady.moves) {
+        fprintf(stderr, "capture: %s: %u memcpy and %u memmove in %u reads\n",
+                mode->name, steady.copies, steady.moves, reads);
+        failed = 1;
+    }
+    /* the linear resampler rounds the crest of the 1 kHz tone off a little */
+    if (peak < MOCK_TONE_AMP * 9 / 10 || peak > MOCK_TONE_AMP) {
+        fprintf(stderr, "capture: %s: tone peak %d, %d was captured\n", mode->name,
+                peak, MOCK_TONE_AMP);
+        failed = 1;
+    }
+    if (mode->effect && !fx.frames) {
+        fprintf(stderr, "capture: %s: the pre processing was not called\n", mode->name);
+        failed = 1;
+    }
+
+    if (mode->effect)
+        in->common.remove_audio_effect(&in->common, (effect_handle_t)&fx);
+    dev->close_input_stream(dev, in);
+    hal_samples_free(&call_ns);
+    hal_samples_free(&jitter_ns);
+    free(buf);
+    return failed;
+}
+
+int hal_capture_run(struct audio_hw_device *dev)
+{
+    unsigned int i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(capture_modes) / sizeof(capture_modes[0]); i++)
+        failed |= capture_mode_run(dev, &capture_modes[i]);
+    return failed;
+}
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Plays for a few seconds as the mixer thread of audioflinger does, one
+ * buffer of the stream at a time, while another thread switches the output
+ * between speaker and headphone as fast as audiopolicy could. Each switch
+ * rewrites the codec routes, which takes a while on I2C, and none of it may
+ * reach out_write(): the writer must not wait on a mutex for anything like a
+ * switch, must keep its cadence and must not let the card run dry.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <system/audio.h>
+
+#include "hal_test.h"
+#include "mock_alsa.h"
+
+#define PLAY_MS                 3000
+/* the writes that fill the pcm buffer return at once */
+#define PLAY_WARMUP_WRITES      8
+#define ROUTE_PERIOD_MS         40
+/* a slow codec, a switch writes some 20 controls */
+#define MIXER_WRITE_US          2000
+/* most a write may wait for a mutex, the device and stream mutexes are held
+ * for a few us when a route is set. Both limits leave room for a loaded
+ * host and are still well under the ~30 ms of a switch. */
+#define PLAY_MAX_LOCK_WAIT_MS   5
+#define PLAY_MAX_JITTER_P99_MS  10
+/* nor may a switch wait for a write, it only queues the new route */
+#define ROUTE_MAX_CALL_MS       5
+
+struct play_writer {
+    struct audio_stream_out *out;
+    size_t bytes;
+    int64_t end_ns;
+    unsigned int writes;
+    uint64_t frames;
+    struct hal_samples call_ns;
+    struct hal_samples jitter_ns;
+    struct hal_lock_stats locks;
+};
+
+struct play_router {
+    struct audio_hw_device *dev;
+    struct audio_stream_out *out;
+    volatile int stop;
+    unsigned int changes;
+    int last_device;
+    struct hal_samples call_ns;
+    struct hal_lock_stats locks;
+};
+
+static void *play_writer_thread(void *arg)
+{
+    struct play_writer *w = arg;
+    int64_t period_ns, start, last = 0, end, d;
+    void *buf;
+
+    buf = calloc(1, w->bytes);
+    if (!buf)
+        return NULL;
+    period_ns = (int64_t)(w->bytes / 4) * 1000000000LL / 44100;
+    hal_lock_track(&w->locks);
+    while (hal_now_ns() < w->end_ns) {
+        start = hal_now_ns();
+        w->out->write(w->out, buf, w->bytes);
+        end = hal_now_ns();
+        w->frames += w->bytes / 4;
+        if (++w->writes > PLAY_WARMUP_WRITES) {
+            hal_samples_add(&w->call_ns, end - start);
+            d = end - last - period_ns;
+            hal_samples_add(&w->jitter_ns, d < 0 ? -d : d);
+        }
+        last = end;
+    }
+    hal_lock_track(NULL);
+    free(buf);
+    return NULL;
+}
+
+static void *play_router_thread(void *arg)
+{
+    struct play_router *r = arg;
+    char kv[32];
+    int64_t start;
+
+    hal_lock_track(&r->locks);
+    while (!r->stop) {
+        r->last_device = (r->changes & 1) ? AUDIO_DEVICE_OUT_SPEAKER :
+                         AUDIO_DEVICE_OUT_WIRED_HEADPHONE;
+        snprintf(kv, sizeof(kv), "%s=%d", AUDIO_PARAMETER_STREAM_ROUTING, r->last_device);
+        start = hal_now_ns();
+        r->out->common.set_parameters(&r->out->common, kv);
+        /* audiopolicy tells the device the screen state as well */
+        if ((r->changes & 3) == 0)
+            r->dev->set_parameters(r->dev, "screen_state=on");
+        hal_samples_add(&r->call_ns, hal_now_ns() - start);
+        r->changes++;
+        hal_sleep_ns(ROUTE_PERIOD_MS * 1000000LL);
+    }
+    hal_lock_track(NULL);
+    return NULL;
+}
+
+static double ms(int64_t ns)
+{
+    return ns / 1e6;
+}
+
+int hal_play_run(struct audio_hw_device *dev)
+{
+    struct audio_config config;
+    struct audio_stream_out *out;
+    struct play_writer w;
+    struct play_router r;
+    struct mock_pcm_stats pcm;
+    struct mock_mixer_stats mixer;
+    pthread_t writer, router;
+    int64_t jitter_p99, route_ns;
+    int failed = 0, hp;
+
+    memset(&config, 0, sizeof(config));
+    if (dev->open_output_stream(dev, 0, AUDIO_DEVICE_OUT_SPEAKER, AUDIO_OUTPUT_FLAG_PRIMARY,
+                                &config, &out)) {
+        fprintf(stderr, "play: can not open the output\n");
+        return 1;
+    }
+    dev->set_parameters(dev, "screen_state=on");
+    mock_mixer_set_write_delay(MIXER_WRITE_US);
+    mock_alsa_reset_stats();
+
+    memset(&w, 0, sizeof(w));
+    memset(&r, 0, sizeof(r));
+    w.out = out;
+    w.bytes = out->common.get_buffer_size(&out->common);
+    w.end_ns = hal_now_ns() + PLAY_MS * 1000000LL;
+    r.dev = dev;
+    r.out = out;
+    if (hal_samples_init(&w.call_ns, 1024) || hal_samples_init(&w.jitter_ns, 1024) ||
+        hal_samples_init(&r.call_ns, 1024)) {
+        fprintf(stderr, "play: out of memory\n");
+        return 1;
+    }
+
+    pthread_create(&writer, NULL, play_writer_thread, &w);
+    pthread_create(&router, NULL, play_router_thread, &r);
+    pthread_join(writer, NULL);
+    r.stop = 1;
+    pthread_join(router, NULL);
+    out->common.standby(&out->common);
+    /* let the routing thread of the HAL apply the last switch */
+    hal_sleep_ns(200 * 1000000LL);
+
+    mock_pcm_get_stats(1, &pcm);
+    mock_mixer_get_stats(&mixer);
+    mock_mixer_set_write_delay(0);
+    hp = mock_mixer_value("HeadPhone Switch");
+    route_ns = r.changes ? (int64_t)mixer.write_us * 1000 / r.changes : 0;
+    jitter_p99 = hal_samples_pct(&w.jitter_ns, 99);
+
+    printf("  %u writes of %zu bytes, write p50 %.2f ms max %.2f ms,"
+           " jitter p50 %.2f ms p99 %.2f ms max %.2f ms\n", w.writes, w.bytes,
+           ms(hal_samples_pct(&w.call_ns, 50)), ms(hal_samples_pct(&w.call_ns, 100)),
+           ms(hal_samples_pct(&w.jitter_ns, 50)), ms(jitter_p99),
+           ms(hal_samples_pct(&w.jitter_ns, 100)));
+    printf("  %u route switches, %.1f ms of codec writes each, set_parameters p50 %.2f ms"
+           " max %.2f ms\n", r.changes, ms(route_ns), ms(hal_samples_pct(&r.call_ns, 50)),
+           ms(hal_samples_pct(&r.call_ns, 100)));
+    printf("  writer: %u of %u mutex locks contended, %.3f ms waited, max %.3f ms\n",
+           w.locks.contended, w.locks.locks, ms(w.locks.wait_ns), ms(w.locks.max_wait_ns));
+    printf("  router: %u of %u mutex locks contended, %.3f ms waited, max %.3f ms\n",
+           r.locks.contended, r.locks.locks, ms(r.locks.wait_ns), ms(r.locks.max_wait_ns));
+    printf("  card: %llu frames in %u writes, %u underruns\n",
+           (unsigned long long)pcm.frames, pcm.transfers, pcm.xruns);
+
+    if (pcm.xruns) {
+        fprintf(stderr, "play: the card ran dry %u times\n", pcm.xruns);
+        failed = 1;
+    }
+    if (pcm.frames != w.frames) {
+        fprintf(stderr, "play: %llu frames written, the card got %llu\n",
+                (unsigned long long)w.frames, (unsigned long long)pcm.frames);
+        failed = 1;
+    }
+    if (w.locks.max_wait_ns > PLAY_MAX_LOCK_WAIT_MS * 1000000ULL) {
+        fprintf(stderr, "play: a write waited %.2f ms for a mutex\n", ms(w.locks.max_wait_ns));
+        failed = 1;
+    }
+    if (jitter_p99 > PLAY_MAX_JITTER_P99_MS * 1000000LL) {
+        fprintf(stderr, "play: p99 jitter %.2f ms\n", ms(jitter_p99));
+        failed = 1;
+    }
+    if (hal_samples_pct(&r.call_ns, 100) > ROUTE_MAX_CALL_MS * 1000000LL) {
+        fprintf(stderr, "play: a route switch took %.2f ms\n", ms(hal_samples_pct(&r.call_ns, 100)));
+        failed = 1;
+    }
+    if (!mixer.writes || hp != (r.last_device == AUDIO_DEVICE_OUT_WIRED_HEADPHONE)) {
+        fprintf(stderr, "play: the last route switch did not reach the codec\n");
+        failed = 1;
+    }
+
+    dev->close_output_stream(dev, out);
+    hal_samples_free(&w.call_ns);
+    hal_samples_free(&w.jitter_ns);
+    hal_samples_free(&r.call_ns);
+    return failed;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* host versions of the libraries audio_hw.c links against on the device:
+ * liblog, libcutils, libaudioutils and libvbeffect. libengclient is the
+ * modem of hal_at.c */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <cutils/str_parms.h>
+#include <audio_utils/resampler.h>
+
+#include "vb_effect_if.h"
+
+int hal_log_level = ANDROID_LOG_ERROR + 1;
+
+void hal_log(int prio, const char *tag, const char *fmt, ...)
+{
+    static const char prio_chars[] = "??VDIWE";
+    va_list ap;
+
+    if (prio < hal_log_level)
+        return;
+    va_start(ap, fmt);
+    flockfile(stderr);
+    fprintf(stderr, "%c/%s: ", prio_chars[prio], tag ? tag : "");
+    vfprintf(stderr, fmt, ap);
+    if (!*fmt || fmt[strlen(fmt) - 1] != '\n')
+        fputc('\n', stderr);
+    funlockfile(stderr);
+    va_end(ap);
+}
+
+/* "key=value;key=value" */
+struct str_parms {
+    char *str;
+    int num;
+    char *keys[16];
+    char *values[16];
+};
+
+struct str_parms *str_parms_create_str(const char *_string)
+{
+    struct str_parms *parms;
+    char *kv, *save, *eq;
+
+    parms = calloc(1, sizeof(*parms));
+    if (!parms)
+        return NULL;
+    parms->str = strdup(_string);
+    if (!parms->str) {
+        free(parms);
+        return NULL;
+    }
+    for (kv = strtok_r(parms->str, ";", &save); kv && parms->num < 16;
+         kv = strtok_r(NULL, ";", &save)) {
+        eq = strchr(kv, '=');
+        if (!eq)
+            continue;
+        *eq = '\0';
+        parms->keys[parms->num] = kv;
+        parms->values[parms->num++] = eq + 1;
+    }
+    return parms;
+}
+
+void str_parms_destroy(struct str_parms *str_parms)
+{
+    if (!str_parms)
+        return;
+    free(str_parms->str);
+    free(str_parms);
+}
+
+int str_parms_get_str(struct str_parms *str_parms, const char *key, char *out_val, int len)
+{
+    int i;
+
+    for (i = 0; i < str_parms->num; i++) {
+        if (strcmp(str_parms->keys[i], key) == 0) {
+            snprintf(out_val, len, "%s", str_parms->values[i]);
+            return strlen(out_val);
+        }
+    }
+    return -ENOENT;
+}
+
+int str_parms_get_int(struct str_parms *str_parms, const char *key, int *out_val)
+{
+    char value[32];
+    char *end;
+
+    if (str_parms_get_str(str_parms, key, value, sizeof(value)) < 0)
+        return -ENOENT;
+    *out_val = (int)strtol(value, &end, 0);
+    return *end ? -EINVAL : 0;
+}
+
+#define NUM_PROPERTIES  16
+
+static pthread_mutex_t s_property_lock = PTHREAD_MUTEX_INITIALIZER;
+static char s_property_keys[NUM_PROPERTIES][PROPERTY_KEY_MAX];
+static char s_property_values[NUM_PROPERTIES][PROPERTY_VALUE_MAX];
+
+int property_get(const char *key, char *value, const char *default_value)
+{
+    int i;
+
+    pthread_mutex_lock(&s_property_lock);
+    for (i = 0; i < NUM_PROPERTIES; i++) {
+        if (strcmp(s_property_keys[i], key) == 0) {
+            strcpy(value, s_property_values[i]);
+            pthread_mutex_unlock(&s_property_lock);
+            return strlen(value);
+        }
+    }
+    pthread_mutex_unlock(&s_property_lock);
+    snprintf(value, PROPERTY_VALUE_MAX, "%s", default_value ? default_value : "");
+    return strlen(value);
+}
+
+int property_set(const char *key, const char *value)
+{
+    int i, free_slot = -1;
+
+    pthread_mutex_lock(&s_property_lock);
+    for (i = 0; i < NUM_PROPERTIES; i++) {
+        if (strcmp(s_property_keys[i], key) == 0)
+            break;
+        if (free_slot < 0 && !s_property_keys[i][0])
+            free_slot = i;
+    }
+    if (i == NUM_PROPERTIES)
+        i = free_slot;
+    if (i >= 0) {
+        snprintf(s_property_keys[i], PROPERTY_KEY_MAX, "%s", key);
+        snprintf(s_property_values[i], PROPERTY_VALUE_MAX, "%s", value);
+    }
+    pthread_mutex_unlock(&s_property_lock);
+    return i >= 0 ? 0 : -ENOMEM;
+}
+
+/*
+ * A linear resampler behind the libaudioutils interface, for the capture
+ * path. phase counts in units of out_rate: a new input frame is taken each
+ * time it reaches out_rate.
+ */
+struct linear_resampler {
+    struct resampler_itfe itfe;
+    struct resampler_buffer_provider *provider;
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t channels;
+    uint32_t phase;
+    int16_t prev[2];
+    int16_t cur[2];
+};
+
+static void linear_reset(struct resampler_itfe *resampler)
+{
+    struct linear_resampler *rsmp = (struct linear_resampler *)resampler;
+
+    rsmp->phase = rsmp->out_rate;
+    memset(rsmp->prev, 0, sizeof(rsmp->prev));
+    memset(rsmp->cur, 0, sizeof(rsmp->cur));
+}
+
+static void linear_next(struct linear_resampler *rsmp, const int16_t *frame)
+{
+    uint32_t c;
+
+    for (c = 0; c < rsmp->channels; c++) {
+        rsmp->prev[c] = rsmp->cur[c];
+        rsmp->cur[c] = frame[c];
+    }
+    rsmp->phase -= rsmp->out_rate;
+}
+
+static void linear_out(struct linear_resampler *rsmp, int16_t *out)
+{
+    uint32_t c;
+
+    for (c = 0; c < rsmp->channels; c++)
+        out[c] = rsmp->prev[c] + (int32_t)(rsmp->cur[c] - rsmp->prev[c]) *
+                 (int32_t)rsmp->phase / (int32_t)rsmp->out_rate;
+    rsmp->phase += rsmp->in_rate;
+}
+
+static int linear_resample_from_provider(struct resampler_itfe *resampler, int16_t *out,
+                                         size_t *outFrameCount)
+{
+    struct linear_resampler *rsmp = (struct linear_resampler *)resampler;
+    struct resampler_buffer buf = { { NULL }, 0 };
+    size_t used = 0, frames = 0;
+
+    while (frames < *outFrameCount) {
+        if (rsmp->phase >= rsmp->out_rate) {
+            if (used == buf.frame_count) {
+                if (buf.raw) {
+                    rsmp->provider->release_buffer(rsmp->provider, &buf);
+                    buf.raw = NULL;
+                }
+                buf.frame_count = (*outFrameCount - frames) * rsmp->in_rate / rsmp->out_rate + 1;
+                if (rsmp->provider->get_next_buffer(rsmp->provider, &buf) || !buf.raw ||
+                    !buf.frame_count) {
+                    buf.raw = NULL;
+                    buf.frame_count = 0;
+                    break;
+                }
+                used = 0;
+            }
+            linear_next(rsmp, buf.i16 + used++ * rsmp->channels);
+            continue;
+        }
+        linear_out(rsmp, out + frames++ * rsmp->channels);
+    }
+    if (buf.raw) {
+        buf.frame_count = used;
+        rsmp->provider->release_buffer(rsmp->provider, &buf);
+    }
+    *outFrameCount = frames;
+    return 0;
+}
+
+static int linear_resample_from_input(struct resampler_itfe *resampler, int16_t *in,
+                                      size_t *inFrameCount, int16_t *out,
+                                      size_t *outFrameCount)
+{
+    struct linear_resampler *rsmp = (struct linear_resampler *)resampler;
+    size_t used = 0, frames = 0;
+
+    while (frames < *outFrameCount) {
+        if (rsmp->phase >= rsmp->out_rate) {
+            if (used == *inFrameCount)
+                break;
+            linear_next(rsmp, in + used++ * rsmp->channels);
+            continue;
+        }
+        linear_out(rsmp, out + frames++ * rsmp->channels);
+    }
+    *inFrameCount = used;
+    *outFrameCount = frames;
+    return 0;
+}
+
+static int32_t linear_delay_ns(struct resampler_itfe *resampler)
+{
+    struct linear_resampler *rsmp = (struct linear_resampler *)resampler;
+
+    return (int32_t)(1000000000LL / rsmp->in_rate);
+}
+
+int create_resampler(uint32_t inSampleRate, uint32_t outSampleRate, uint32_t channelCount,
+                     uint32_t quality, struct resampler_buffer_provider *provider,
+                     struct resampler_itfe **resampler)
+{
+    struct linear_resampler *rsmp;
+
+    if (channelCount < 1 || channelCount > 2 || !inSampleRate || !outSampleRate)
+        return -EINVAL;
+    rsmp = calloc(1, sizeof(*rsmp));
+    if (!rsmp)
+        return -ENOMEM;
+    rsmp->itfe.reset = linear_reset;
+    rsmp->itfe.resample_from_provider = linear_resample_from_provider;
+    rsmp->itfe.resample_from_input = linear_resample_from_input;
+    rsmp->itfe.delay_ns = linear_delay_ns;
+    rsmp->provider = provider;
+    rsmp->in_rate = inSampleRate;
+    rsmp->out_rate = outSampleRate;
+    rsmp->channels = channelCount;
+    linear_reset(&rsmp->itfe);
+    *resampler = &rsmp->itfe;
+    return 0;
+}
+
+void release_resampler(struct resampler_itfe *resampler)
+{
+    free(resampler);
+}
+
+/* libvbeffect: no EQ parameters on the host, so the HAL runs without EQ */
+int create_vb_effect_params(void)
+{
+    return -1;
+}
+
+void vb_effect_config_mixer_ctl(struct mixer_ctl *eq_update, struct mixer_ctl *profile_select)
+{
+}
+
+void vb_effect_sync_devices(int cur_devices)
+{
+}
+
+int vb_effect_profile_apply(void)
+{
+    return 0;
+}
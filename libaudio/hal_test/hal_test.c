@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs audio_hw.c as audioflinger would, through HAL_MODULE_INFO_SYM, on the
+ * sound card of mock_alsa.c. Each case drives the HAL from several threads
+ * and checks what the card saw and how long the calls took.
+ *
+ *   hal_test [-v] [case...]
+ *
+ * -v prints the log of the HAL.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cutils/log.h>
+#include <hardware/hardware.h>
+
+#include "hal_test.h"
+
+extern struct audio_module HAL_MODULE_INFO_SYM;
+
+static const struct hal_case hal_cases[] = {
+    { "play", hal_play_run },
+    { "capture", hal_capture_run },
+    { "vbc", hal_vbc_run },
+    { "at", hal_at_run },
+};
+
+static __thread struct hal_lock_stats *tl_lock_stats;
+static __thread struct hal_alloc_stats *tl_alloc_stats;
+
+int __real_pthread_mutex_lock(pthread_mutex_t *mutex);
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+void *__real_memcpy(void *dest, const void *src, size_t n);
+void *__real_memmove(void *dest, const void *src, size_t n);
+
+/* audio_hw.c is linked with --wrap=pthread_mutex_lock */
+int __wrap_pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    struct hal_lock_stats *stats = tl_lock_stats;
+    int64_t start, wait;
+    int ret;
+
+    if (!stats)
+        return __real_pthread_mutex_lock(mutex);
+    stats->locks++;
+    if (pthread_mutex_trylock(mutex) == 0)
+        return 0;
+    start = hal_now_ns();
+    ret = __real_pthread_mutex_lock(mutex);
+    wait = hal_now_ns() - start;
+    stats->contended++;
+    stats->wait_ns += wait;
+    if ((uint64_t)wait > stats->max_wait_ns)
+        stats->max_wait_ns = wait;
+    return ret;
+}
+
+void hal_lock_track(struct hal_lock_stats *stats)
+{
+    tl_lock_stats = stats;
+}
+
+/* and with --wrap for the heap and copy calls below */
+void *__wrap_malloc(size_t size)
+{
+    if (tl_alloc_stats)
+        tl_alloc_stats->allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    if (tl_alloc_stats)
+        tl_alloc_stats->allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (tl_alloc_stats)
+        tl_alloc_stats->allocs++;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (tl_alloc_stats && ptr)
+        tl_alloc_stats->frees++;
+    __real_free(ptr);
+}
+
+void *__wrap_memcpy(void *dest, const void *src, size_t n)
+{
+    if (tl_alloc_stats) {
+        tl_alloc_stats->copies++;
+        tl_alloc_stats->copy_bytes += n;
+    }
+    return __real_memcpy(dest, src, n);
+}
+
+void *__wrap_memmove(void *dest, const void *src, size_t n)
+{
+    if (tl_alloc_stats) {
+        tl_alloc_stats->moves++;
+        tl_alloc_stats->copy_bytes += n;
+    }
+    return __real_memmove(dest, src, n);
+}
+
+void hal_alloc_track(struct hal_alloc_stats *stats)
+{
+    tl_alloc_stats = stats;
+}
+
+int64_t hal_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void hal_sleep_ns(int64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+        ;
+}
+
+int hal_samples_init(struct hal_samples *s, unsigned int size)
+{
+    s->ns = malloc(size * sizeof(*s->ns));
+    s->num = 0;
+    s->size = s->ns ? size : 0;
+    return s->ns ? 0 : -ENOMEM;
+}
+
+void hal_samples_add(struct hal_samples *s, int64_t ns)
+{
+    if (s->num < s->size)
+        s->ns[s->num++] = ns;
+}
+
+static int cmp_ns(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+int64_t hal_samples_pct(struct hal_samples *s, double p)
+{
+    unsigned int i;
+
+    if (!s->num)
+        return 0;
+    qsort(s->ns, s->num, sizeof(*s->ns), cmp_ns);
+    i = (unsigned int)(p / 100.0 * (s->num - 1) + 0.5);
+    return s->ns[i];
+}
+
+void hal_samples_free(struct hal_samples *s)
+{
+    free(s->ns);
+    s->ns = NULL;
+    s->num = s->size = 0;
+}
+
+static int hal_open(struct audio_hw_device **dev)
+{
+    hw_device_t *device;
+    int ret;
+
+    /* the mmi loop thread of the HAL waits on this fifo */
+    mkdir("out", 0755);
+    if (mkfifo(MMI_AUDIO_CTRL_PATH, 0600) && errno != EEXIST) {
+        perror(MMI_AUDIO_CTRL_PATH);
+        return -errno;
+    }
+    ret = HAL_MODULE_INFO_SYM.common.methods->open(&HAL_MODULE_INFO_SYM.common,
+            AUDIO_HARDWARE_INTERFACE, &device);
+    if (ret)
+        return ret;
+    *dev = (struct audio_hw_device *)device;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct audio_hw_device *dev = NULL;
+    unsigned int i, num = 0;
+    int failed = 0, ret, arg;
+
+    for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-v") == 0) {
+            hal_log_level = ANDROID_LOG_DEBUG;
+        } else {
+            fprintf(stderr, "usage: %s [-v] [case...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    ret = hal_open(&dev);
+    if (ret) {
+        fprintf(stderr, "hal_test: can not open the HAL (%d)\n", ret);
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(hal_cases) / sizeof(hal_cases[0]); i++) {
+        if (arg < argc) {
+            int j;
+
+            for (j = arg; j < argc; j++)
+                if (strcmp(argv[j], hal_cases[i].name) == 0)
+                    break;
+            if (j == argc)
+                continue;
+        }
+        printf("%s:\n", hal_cases[i].name);
+        fflush(stdout);
+        if (hal_cases[i].run(dev)) {
+            printf("  %s FAILED\n", hal_cases[i].name);
+            failed++;
+        }
+        num++;
+    }
+
+    dev->common.close(&dev->common);
+
+    printf("hal_test: %u cases, %s\n", num, failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HAL_TEST_H
+#define HAL_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <hardware/audio.h>
+
+/* one scenario against the HAL, 0 when it passes */
+struct hal_case {
+    const char *name;
+    int (*run)(struct audio_hw_device *dev);
+};
+
+/* the pthread mutex waits of the threads that ask for it, see hal_lock_track() */
+struct hal_lock_stats {
+    uint32_t locks;
+    uint32_t contended;
+    uint64_t wait_ns;
+    uint64_t max_wait_ns;
+};
+
+/* the heap and copy calls of the threads that ask for it, see hal_alloc_track() */
+struct hal_alloc_stats {
+    uint32_t allocs;            /* malloc(), calloc() and realloc() */
+    uint32_t frees;
+    uint32_t copies;            /* memcpy() */
+    uint32_t moves;             /* memmove() */
+    uint64_t copy_bytes;
+};
+
+/* a list of durations, reported as percentiles */
+struct hal_samples {
+    int64_t *ns;
+    unsigned int num;
+    unsigned int size;
+};
+
+int64_t hal_now_ns(void);
+void hal_sleep_ns(int64_t ns);
+
+/* from now on the mutex waits of the calling thread are added to stats,
+ * NULL stops it */
+void hal_lock_track(struct hal_lock_stats *stats);
+/* the same for the heap and copy calls */
+void hal_alloc_track(struct hal_alloc_stats *stats);
+
+int hal_samples_init(struct hal_samples *s, unsigned int size);
+void hal_samples_add(struct hal_samples *s, int64_t ns);
+/* p in 0..100, sorts the samples */
+int64_t hal_samples_pct(struct hal_samples *s, double p);
+void hal_samples_free(struct hal_samples *s);
+
+int hal_play_run(struct audio_hw_device *dev);
+int hal_capture_run(struct audio_hw_device *dev);
+int hal_vbc_run(struct audio_hw_device *dev);
+int hal_at_run(struct audio_hw_device *dev);
+
+#endif
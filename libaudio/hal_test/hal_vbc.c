@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Plays the modem on the other end of vbpipe, the control channel of
+ * vb_control_parameters.c. Each open() of VBC_PIPE_NAME by the HAL gets one
+ * end of a new socketpair while the modem is up, ENOENT while it is down,
+ * as the spipe device node does across a modem restart. The case sends
+ * set_gain commands, restarts the modem after outages of different lengths
+ * and stalls in the middle of a message, and checks how soon the HAL is
+ * back: never later than its longest backoff after the modem is.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "hal_test.h"
+
+/* VBC_RECONNECT_MAX_MS and VBC_MSG_TIMEOUT_MS of vb_control_parameters.c */
+#define VBC_BACKOFF_MAX_MS      500
+#define VBC_MSG_TIMEOUT_MS      1000
+/* room for the host on top of the limits of the HAL, the fixed sleep(1)
+ * the control thread had still misses them */
+#define VBC_SLACK_MS            250
+#define VBC_CMDS_PER_RESTART    8
+#define VBC_IO_TIMEOUT_MS       2000
+
+/* the wire format of vbpipe */
+#define VBC_CMD_SET_GAIN        3
+#define VBC_CMD_RSP_GAIN        4
+
+struct vbc_head {
+    char tag[4];
+    uint32_t cmd_type;
+    uint32_t paras_size;
+};
+
+struct vbc_mode_gain {
+    uint16_t is_mode;
+    uint16_t is_volume;
+    uint16_t mode_index;
+    uint16_t volume_index;
+    uint16_t dac_set;
+    uint16_t adc_set;
+    uint16_t dac_gain;
+    uint16_t adc_gain;
+    uint16_t path_set;
+    uint16_t pa_setting;
+    uint16_t reserved[16];
+};
+
+static pthread_mutex_t s_modem_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_modem_cond = PTHREAD_COND_INITIALIZER;
+static int s_modem_up;
+static int s_modem_fd = -1;         /* the end of the last vbpipe the HAL opened */
+static int64_t s_modem_open_ns;
+static uint32_t s_modem_opens;
+
+int __real_open(const char *path, int flags, ...);
+
+/* audio_hw.c is linked with --wrap=open */
+int __wrap_open(const char *path, int flags, ...)
+{
+    va_list ap;
+    int mode = 0;
+    int sv[2];
+
+    if (flags & O_CREAT) {
+        va_start(ap, flags);
+        mode = va_arg(ap, int);
+        va_end(ap);
+    }
+    if (strcmp(path, VBC_PIPE_NAME) != 0)
+        return __real_open(path, flags, mode);
+
+    pthread_mutex_lock(&s_modem_lock);
+    if (!s_modem_up) {
+        pthread_mutex_unlock(&s_modem_lock);
+        errno = ENOENT;
+        return -1;
+    }
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        pthread_mutex_unlock(&s_modem_lock);
+        return -1;
+    }
+    if (s_modem_fd >= 0)
+        close(s_modem_fd);
+    s_modem_fd = sv[1];
+    s_modem_open_ns = hal_now_ns();
+    s_modem_opens++;
+    pthread_cond_broadcast(&s_modem_cond);
+    pthread_mutex_unlock(&s_modem_lock);
+    return sv[0];
+}
+
+static void modem_up(void)
+{
+    pthread_mutex_lock(&s_modem_lock);
+    s_modem_up = 1;
+    pthread_mutex_unlock(&s_modem_lock);
+}
+
+/* the HAL reads EOF from its end */
+static void modem_down(void)
+{
+    pthread_mutex_lock(&s_modem_lock);
+    s_modem_up = 0;
+    if (s_modem_fd >= 0)
+        close(s_modem_fd);
+    s_modem_fd = -1;
+    pthread_mutex_unlock(&s_modem_lock);
+}
+
+/* waits for the HAL to open vbpipe after the given count of opens, returns
+ * the end of the modem or -1 after VBC_IO_TIMEOUT_MS */
+static int modem_accept(uint32_t opens, int64_t *open_ns)
+{
+    struct timespec ts;
+    int fd;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += VBC_IO_TIMEOUT_MS / 1000;
+    pthread_mutex_lock(&s_modem_lock);
+    while (s_modem_opens == opens)
+        if (pthread_cond_timedwait(&s_modem_cond, &s_modem_lock, &ts) == ETIMEDOUT)
+            break;
+    fd = s_modem_opens != opens ? s_modem_fd : -1;
+    *open_ns = s_modem_open_ns;
+    pthread_mutex_unlock(&s_modem_lock);
+    return fd;
+}
+
+static uint32_t modem_opens(void)
+{
+    uint32_t opens;
+
+    pthread_mutex_lock(&s_modem_lock);
+    opens = s_modem_opens;
+    pthread_mutex_unlock(&s_modem_lock);
+    return opens;
+}
+
+/* len, 0 on EOF, -1 on a timeout or an error */
+static int modem_read(int fd, void *buf, size_t len, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    size_t got = 0;
+    ssize_t ret;
+
+    while (got < len) {
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return -1;
+        ret = read(fd, (char *)buf + got, len - got);
+        if (ret <= 0)
+            return (int)ret;
+        got += ret;
+    }
+    return (int)got;
+}
+
+static int modem_expect(int fd, uint32_t cmd)
+{
+    struct vbc_head head;
+
+    if (modem_read(fd, &head, sizeof(head), VBC_IO_TIMEOUT_MS) != sizeof(head))
+        return -1;
+    return memcmp(head.tag, "VBC", 3) || head.cmd_type != cmd ? -1 : 0;
+}
+
+/* set_gain as the modem sends it: the HAL answers the head, then the
+ * parameters once it applied them */
+static int modem_set_gain(int fd, unsigned int volume)
+{
+    struct vbc_head head;
+    struct vbc_mode_gain gain;
+
+    memset(&head, 0, sizeof(head));
+    memcpy(head.tag, "VBC", 3);
+    head.cmd_type = VBC_CMD_SET_GAIN;
+    head.paras_size = sizeof(gain);
+    memset(&gain, 0, sizeof(gain));
+    gain.is_volume = 1;
+    gain.volume_index = volume;
+    gain.dac_gain = 0x0808;
+
+    if (write(fd, &head, sizeof(head)) != sizeof(head) || modem_expect(fd, VBC_CMD_RSP_GAIN))
+        return -1;
+    if (write(fd, &gain, sizeof(gain)) != sizeof(gain) || modem_expect(fd, VBC_CMD_RSP_GAIN))
+        return -1;
+    return 0;
+}
+
+static double ms(int64_t ns)
+{
+    return ns / 1e6;
+}
+
+/* the reconnects adev_dump() counts, and its vbc lines when print is set */
+static void vbc_dump(struct audio_hw_device *dev, uint32_t *reconnects, int print)
+{
+    FILE *f = tmpfile();
+    char line[256];
+    int in_vbc = 0;
+
+    *reconnects = 0;
+    if (!f)
+        return;
+    dev->dump(dev, fileno(f));
+    rewind(f);
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "vbc control:", 12) == 0) {
+            in_vbc = 1;
+            sscanf(strstr(line, ", ") + 2, "%u reconnects", reconnects);
+        } else if (line[0] != ' ') {
+            in_vbc = 0;
+        }
+        if (in_vbc && print)
+            printf("  %s", line);
+    }
+    fclose(f);
+}
+
+int hal_vbc_run(struct audio_hw_device *dev)
+{
+    static const int outages_ms[] = { 0, 50, 200, 700, 1500 };
+    struct hal_samples cmd_ns, reconnect_ns;
+    int64_t up_ns, open_ns, start, stall_ns = 0;
+    uint32_t reconnects, base = 0, opens, restarts = 0;
+    unsigned int i, n, cmds = 0;
+    char c;
+    int fd, failed = 0;
+
+    if (hal_samples_init(&cmd_ns, 256) || hal_samples_init(&reconnect_ns, 16)) {
+        fprintf(stderr, "vbc: out of memory\n");
+        return 1;
+    }
+
+    /* the HAL has been knocking at vbpipe since it was opened, then the
+     * modem restarts after each outage */
+    for (i = 0; i <= sizeof(outages_ms) / sizeof(outages_ms[0]); i++) {
+        if (i > 0) {
+            modem_down();
+            hal_sleep_ns(outages_ms[i - 1] * 1000000LL);
+        }
+        opens = modem_opens();
+        up_ns = hal_now_ns();
+        modem_up();
+        fd = modem_accept(opens, &open_ns);
+        if (fd < 0) {
+            fprintf(stderr, "vbc: vbpipe not reopened %d ms after the modem came back\n",
+                    VBC_IO_TIMEOUT_MS);
+            failed = 1;
+            break;
+        }
+        hal_samples_add(&reconnect_ns, open_ns - up_ns);
+        /* a call running on the modem right after it is back */
+        for (n = 0; n < VBC_CMDS_PER_RESTART; n++, cmds++) {
+            start = hal_now_ns();
+            if (modem_set_gain(fd, cmds % 7)) {
+                fprintf(stderr, "vbc: set_gain %u got no answer\n", cmds);
+                failed = 1;
+                break;
+            }
+            hal_samples_add(&cmd_ns, hal_now_ns() - start);
+        }
+        /* the HAL counts from the first command after a restart */
+        if (i == 0)
+            vbc_dump(dev, &base, 0);
+        else
+            restarts++;
+    }
+
+    /* half a head, then nothing: the HAL must drop the link on its own */
+    if (!failed) {
+        opens = modem_opens();
+        start = hal_now_ns();
+        if (write(fd, "VBC", 3) != 3 || modem_read(fd, &c, 1, VBC_IO_TIMEOUT_MS) != 0) {
+            fprintf(stderr, "vbc: a partial message did not reset vbpipe\n");
+            failed = 1;
+        } else {
+            stall_ns = hal_now_ns() - start;
+            restarts++;
+            fd = modem_accept(opens, &open_ns);
+            if (fd < 0 || modem_set_gain(fd, 0)) {
+                fprintf(stderr, "vbc: vbpipe not back after a partial message\n");
+                failed = 1;
+            }
+        }
+    }
+    modem_down();
+
+    printf("  %u set_gain, p50 %.2f ms p99 %.2f ms max %.2f ms\n", cmd_ns.num,
+           ms(hal_samples_pct(&cmd_ns, 50)), ms(hal_samples_pct(&cmd_ns, 99)),
+           ms(hal_samples_pct(&cmd_ns, 100)));
+    printf("  modem up %u times, vbpipe reopened p50 %.1f ms max %.1f ms after,"
+           " partial message dropped after %.1f ms\n", reconnect_ns.num,
+           ms(hal_samples_pct(&reconnect_ns, 50)), ms(hal_samples_pct(&reconnect_ns, 100)),
+           ms(stall_ns));
+    vbc_dump(dev, &reconnects, 1);
+
+    if (hal_samples_pct(&reconnect_ns, 100) > (VBC_BACKOFF_MAX_MS + VBC_SLACK_MS) * 1000000LL) {
+        fprintf(stderr, "vbc: vbpipe reopened %.1f ms after the modem came back\n",
+                ms(hal_samples_pct(&reconnect_ns, 100)));
+        failed = 1;
+    }
+    if (stall_ns && (stall_ns < VBC_MSG_TIMEOUT_MS * 1000000LL ||
+                     stall_ns > (VBC_MSG_TIMEOUT_MS + VBC_SLACK_MS) * 1000000LL)) {
+        fprintf(stderr, "vbc: a partial message held vbpipe for %.1f ms\n", ms(stall_ns));
+        failed = 1;
+    }
+    if (!failed && reconnects - base != restarts) {
+        fprintf(stderr, "vbc: %u reconnects in the dump, the modem came back %u times\n",
+                reconnects - base, restarts);
+        failed = 1;
+    }
+
+    hal_samples_free(&cmd_ns);
+    hal_samples_free(&reconnect_ns);
+    return failed;
+}
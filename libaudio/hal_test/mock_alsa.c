@@ -0,0 +1,501 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <tinyalsa/asoundlib.h>
+
+#include "mock_alsa.h"
+
+struct pcm {
+    unsigned int card;
+    unsigned int flags;
+    struct pcm_config config;
+    unsigned int buffer_size;
+    unsigned int frame_bytes;
+    pthread_mutex_t lock;
+    int running;
+    int64_t start_ns;           /* when the hw pointer was at hw_base */
+    uint64_t hw_base;
+    uint64_t hw;
+    int64_t hw_ns;              /* the last step of the hw pointer */
+    uint64_t appl;
+};
+
+struct mixer_ctl {
+    const char *name;
+    enum mixer_ctl_type type;
+    unsigned int num_values;
+    int min;
+    int max;
+    const char * const *enums;
+    unsigned int num_enums;
+    int value[2];
+};
+
+struct mixer {
+    pthread_mutex_t lock;
+    struct mixer_ctl *ctls;
+    unsigned int num_ctls;
+};
+
+static const char * const vbc_switch_enums[] = { "arm", "dsp" };
+static const char * const vbc_eq_update_enums[] = { "idle", "loading", "done" };
+
+#define BOOL_CTL(n)         { n, MIXER_CTL_TYPE_BOOL, 1, 0, 1, NULL, 0, { 0, 0 } }
+#define INT_CTL(n, v, max)  { n, MIXER_CTL_TYPE_INT, v, 0, max, NULL, 0, { 0, 0 } }
+#define ENUM_CTL(n, e)      { n, MIXER_CTL_TYPE_ENUM, 1, 0, 0, e, \
+                              sizeof(e) / sizeof(e[0]), { 0, 0 } }
+
+/* the controls of the sprdphone codec etc/tiny_hw.xml and etc/codec_pga.xml use */
+static struct mixer_ctl sprdphone_ctls[] = {
+    BOOL_CTL("Speaker Mute"),
+    BOOL_CTL("Earpiece Mute"),
+    BOOL_CTL("HeadPhone Mute"),
+    INT_CTL("Inter PA Playback Volume", 1, 15),
+    INT_CTL("Mic Function", 1, 3),
+    BOOL_CTL("Speaker Switch"),
+    BOOL_CTL("Earpiece Switch"),
+    BOOL_CTL("HeadPhone Switch"),
+    BOOL_CTL("Line Switch"),
+    BOOL_CTL("Mic Switch"),
+    BOOL_CTL("HP Mic Switch"),
+    BOOL_CTL("Aux Mic Switch"),
+    BOOL_CTL("Mic Bias Switch"),
+    BOOL_CTL("ADCL Mixer MainMICADCL Switch"),
+    BOOL_CTL("ADCR Mixer MainMICADCR Switch"),
+    BOOL_CTL("DACL Mixer DACLSPKL Switch"),
+    BOOL_CTL("DACR Mixer DACRSPKL Switch"),
+    BOOL_CTL("DACL Mixer DACLHP Switch"),
+    BOOL_CTL("DACR Mixer DACRHP Switch"),
+    ENUM_CTL("VBC Switch", vbc_switch_enums),
+    BOOL_CTL("VBC EQ Switch"),
+    ENUM_CTL("VBC EQ Update", vbc_eq_update_enums),
+    INT_CTL("VBC EQ Profile Select", 1, 7),
+    INT_CTL("Inter PA Config", 1, 0xffff),
+    INT_CTL("PCM Playback Volume", 2, 63),
+    INT_CTL("Speaker Playback Volume", 2, 15),
+    INT_CTL("HeadPhone Playback Volume", 2, 31),
+    INT_CTL("Earpiece Playback Volume", 1, 15),
+    INT_CTL("Capture Volume", 2, 63),
+};
+
+static struct mixer s_sprdphone = {
+    PTHREAD_MUTEX_INITIALIZER,
+    sprdphone_ctls,
+    sizeof(sprdphone_ctls) / sizeof(sprdphone_ctls[0]),
+};
+
+static unsigned int s_write_delay_us;
+static struct mock_pcm_stats s_pcm_stats[2];
+static struct mock_mixer_stats s_mixer_stats;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static struct mock_pcm_stats *pcm_stats(struct pcm *pcm)
+{
+    return &s_pcm_stats[(pcm->flags & PCM_IN) ? 0 : 1];
+}
+
+static void stat_add32(uint32_t *stat, uint32_t n)
+{
+    __atomic_add_fetch(stat, n, __ATOMIC_RELAXED);
+}
+
+static void stat_add64(uint64_t *stat, uint64_t n)
+{
+    __atomic_add_fetch(stat, n, __ATOMIC_RELAXED);
+}
+
+/* rounded up: the pointer has moved by the time it is stamped */
+static int64_t frames_to_ns(struct pcm *pcm, uint64_t frames)
+{
+    return (int64_t)((frames * 1000000000ULL + pcm->config.rate - 1) / pcm->config.rate);
+}
+
+static void pcm_start(struct pcm *pcm, int64_t now)
+{
+    pcm->running = 1;
+    pcm->start_ns = now;
+    pcm->hw_base = pcm->hw;
+    pcm->hw_ns = now;
+}
+
+/* moves the hw pointer up to now, with pcm->lock held */
+static void pcm_update(struct pcm *pcm, int64_t now)
+{
+    uint64_t steps;
+
+    if (!pcm->running)
+        return;
+
+    steps = (uint64_t)(now - pcm->start_ns) * pcm->config.rate / 1000000000ULL / MOCK_PCM_HW_STEP;
+    pcm->hw = pcm->hw_base + steps * MOCK_PCM_HW_STEP;
+    pcm->hw_ns = pcm->start_ns + frames_to_ns(pcm, steps * MOCK_PCM_HW_STEP);
+
+    if (!(pcm->flags & PCM_IN) && pcm->hw >= pcm->appl) {
+        /* played everything it was given, it stops at the end of the data */
+        stat_add32(&pcm_stats(pcm)->xruns, 1);
+        pcm->hw = pcm->appl;
+        pcm->running = 0;
+    } else if ((pcm->flags & PCM_IN) && pcm->hw - pcm->appl > pcm->buffer_size) {
+        /* the frames not read are lost, tinyalsa starts again */
+        stat_add32(&pcm_stats(pcm)->xruns, 1);
+        pcm->hw = pcm->appl;
+        pcm_start(pcm, now);
+    }
+}
+
+struct pcm *pcm_open(unsigned int card, unsigned int device, unsigned int flags,
+                     struct pcm_config *config)
+{
+    struct pcm *pcm;
+
+    pcm = calloc(1, sizeof(*pcm));
+    if (!pcm)
+        return NULL;
+    pcm->card = card;
+    pcm->flags = flags;
+    pcm->config = *config;
+    pcm->buffer_size = config->period_size * config->period_count;
+    pcm->frame_bytes = config->channels * (config->format == PCM_FORMAT_S32_LE ? 4 : 2);
+    if (!pcm->config.start_threshold)
+        pcm->config.start_threshold = config->period_size;
+    if (pcm->config.avail_min <= 0)
+        pcm->config.avail_min = config->period_size;
+    pthread_mutex_init(&pcm->lock, NULL);
+    stat_add32(&pcm_stats(pcm)->opens, 1);
+    return pcm;
+}
+
+int pcm_close(struct pcm *pcm)
+{
+    if (!pcm)
+        return -EINVAL;
+    pthread_mutex_destroy(&pcm->lock);
+    free(pcm);
+    return 0;
+}
+
+int pcm_is_ready(struct pcm *pcm)
+{
+    return pcm != NULL && pcm->card <= MOCK_CARD_VAUDIO;
+}
+
+const char *pcm_get_error(struct pcm *pcm)
+{
+    return pcm ? "no such card" : "out of memory";
+}
+
+unsigned int pcm_get_buffer_size(struct pcm *pcm)
+{
+    return pcm->buffer_size;
+}
+
+int pcm_set_avail_min(struct pcm *pcm, int avail_min)
+{
+    pthread_mutex_lock(&pcm->lock);
+    pcm->config.avail_min = avail_min;
+    pthread_mutex_unlock(&pcm->lock);
+    return 0;
+}
+
+int pcm_get_htimestamp(struct pcm *pcm, unsigned int *avail, struct timespec *tstamp)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&pcm->lock);
+    pcm_update(pcm, now_ns());
+    if (pcm->running) {
+        if (pcm->flags & PCM_IN)
+            *avail = pcm->hw - pcm->appl;
+        else
+            *avail = pcm->buffer_size - (pcm->appl - pcm->hw);
+        tstamp->tv_sec = pcm->hw_ns / 1000000000LL;
+        tstamp->tv_nsec = pcm->hw_ns % 1000000000LL;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&pcm->lock);
+    return ret;
+}
+
+/* as tinyalsa: waits for avail_min frames of room once running, starts at start_threshold */
+int pcm_mmap_write(struct pcm *pcm, const void *data, unsigned int count)
+{
+    unsigned int frames = count / pcm->frame_bytes;
+    unsigned int avail, n;
+    int64_t now, wake;
+
+    if (pcm->flags & PCM_IN)
+        return -EINVAL;
+
+    pthread_mutex_lock(&pcm->lock);
+    stat_add32(&pcm_stats(pcm)->transfers, 1);
+    while (frames) {
+        now = now_ns();
+        pcm_update(pcm, now);
+        avail = pcm->buffer_size - (pcm->appl - pcm->hw);
+        if (pcm->running && avail < (unsigned int)pcm->config.avail_min) {
+            n = (pcm->config.avail_min - avail + MOCK_PCM_HW_STEP - 1) / MOCK_PCM_HW_STEP;
+            wake = pcm->hw_ns + frames_to_ns(pcm, (uint64_t)n * MOCK_PCM_HW_STEP);
+            pthread_mutex_unlock(&pcm->lock);
+            sleep_until_ns(wake);
+            pthread_mutex_lock(&pcm->lock);
+            continue;
+        }
+        if (!avail) {
+            /* full before reaching start_threshold */
+            pcm_start(pcm, now);
+            continue;
+        }
+        n = frames < avail ? frames : avail;
+        pcm->appl += n;
+        frames -= n;
+        stat_add64(&pcm_stats(pcm)->frames, n);
+        if (!pcm->running && pcm->appl - pcm->hw >= pcm->config.start_threshold)
+            pcm_start(pcm, now);
+    }
+    pthread_mutex_unlock(&pcm->lock);
+    return 0;
+}
+
+int pcm_write(struct pcm *pcm, const void *data, unsigned int count)
+{
+    return pcm_mmap_write(pcm, data, count);
+}
+
+/* a tone, continuous across reads as long as the capture keeps up */
+int pcm_read(struct pcm *pcm, void *data, unsigned int count)
+{
+    unsigned int frames = count / pcm->frame_bytes;
+    int16_t *out = data;
+    unsigned int i, c;
+    uint64_t pos;
+    int64_t now;
+    int16_t s;
+
+    if (!(pcm->flags & PCM_IN))
+        return -EINVAL;
+
+    pthread_mutex_lock(&pcm->lock);
+    stat_add32(&pcm_stats(pcm)->transfers, 1);
+    now = now_ns();
+    if (!pcm->running)
+        pcm_start(pcm, now);
+    for (;;) {
+        pcm_update(pcm, now);
+        if (pcm->hw - pcm->appl >= frames)
+            break;
+        pthread_mutex_unlock(&pcm->lock);
+        sleep_until_ns(pcm->start_ns + frames_to_ns(pcm,
+                (pcm->appl + frames - pcm->hw_base + MOCK_PCM_HW_STEP - 1) /
+                MOCK_PCM_HW_STEP * MOCK_PCM_HW_STEP));
+        pthread_mutex_lock(&pcm->lock);
+        now = now_ns();
+    }
+    for (i = 0; i < frames; i++) {
+        pos = pcm->appl + i;
+        s = (int16_t)(MOCK_TONE_AMP * sin(2 * M_PI * MOCK_TONE_HZ *
+                (double)(pos % pcm->config.rate) / pcm->config.rate));
+        for (c = 0; c < pcm->config.channels; c++)
+            *out++ = s;
+    }
+    pcm->appl += frames;
+    stat_add64(&pcm_stats(pcm)->frames, frames);
+    pthread_mutex_unlock(&pcm->lock);
+    return 0;
+}
+
+int get_snd_card_number(const char *card_name)
+{
+    if (strcmp(card_name, "sprdphone") == 0)
+        return MOCK_CARD_SPRDPHONE;
+    if (strcmp(card_name, "VIRTUAL AUDIO") == 0)
+        return MOCK_CARD_VAUDIO;
+    return -1;
+}
+
+struct mixer *mixer_open(unsigned int card)
+{
+    return card == MOCK_CARD_SPRDPHONE ? &s_sprdphone : NULL;
+}
+
+void mixer_close(struct mixer *mixer)
+{
+}
+
+const char *mixer_get_name(struct mixer *mixer)
+{
+    return "sprdphone";
+}
+
+unsigned int mixer_get_num_ctls(struct mixer *mixer)
+{
+    return mixer->num_ctls;
+}
+
+struct mixer_ctl *mixer_get_ctl(struct mixer *mixer, unsigned int id)
+{
+    return id < mixer->num_ctls ? &mixer->ctls[id] : NULL;
+}
+
+struct mixer_ctl *mixer_get_ctl_by_name(struct mixer *mixer, const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < mixer->num_ctls; i++)
+        if (strcmp(mixer->ctls[i].name, name) == 0)
+            return &mixer->ctls[i];
+    return NULL;
+}
+
+const char *mixer_ctl_get_name(struct mixer_ctl *ctl)
+{
+    return ctl->name;
+}
+
+enum mixer_ctl_type mixer_ctl_get_type(struct mixer_ctl *ctl)
+{
+    return ctl->type;
+}
+
+const char *mixer_ctl_get_type_string(struct mixer_ctl *ctl)
+{
+    static const char * const names[] = { "BOOL", "INT", "ENUM", "BYTE", "IEC958", "INT64" };
+
+    return ctl->type < MIXER_CTL_TYPE_UNKNOWN ? names[ctl->type] : "Unknown";
+}
+
+unsigned int mixer_ctl_get_num_values(struct mixer_ctl *ctl)
+{
+    return ctl->num_values;
+}
+
+unsigned int mixer_ctl_get_num_enums(struct mixer_ctl *ctl)
+{
+    return ctl->num_enums;
+}
+
+const char *mixer_ctl_get_enum_string(struct mixer_ctl *ctl, unsigned int enum_id)
+{
+    return enum_id < ctl->num_enums ? ctl->enums[enum_id] : NULL;
+}
+
+int mixer_ctl_get_range_min(struct mixer_ctl *ctl)
+{
+    return ctl->min;
+}
+
+int mixer_ctl_get_range_max(struct mixer_ctl *ctl)
+{
+    return ctl->type == MIXER_CTL_TYPE_ENUM ? (int)ctl->num_enums - 1 : ctl->max;
+}
+
+int mixer_ctl_get_value(struct mixer_ctl *ctl, unsigned int id)
+{
+    int value;
+
+    if (id >= ctl->num_values)
+        return -EINVAL;
+    pthread_mutex_lock(&s_sprdphone.lock);
+    value = ctl->value[id];
+    pthread_mutex_unlock(&s_sprdphone.lock);
+    return value;
+}
+
+/* the codec sits on I2C, each value written costs s_write_delay_us */
+int mixer_ctl_set_value(struct mixer_ctl *ctl, unsigned int id, int value)
+{
+    int64_t start = now_ns();
+
+    if (id >= ctl->num_values || value < ctl->min || value > mixer_ctl_get_range_max(ctl))
+        return -EINVAL;
+    if (s_write_delay_us)
+        sleep_until_ns(start + s_write_delay_us * 1000LL);
+    pthread_mutex_lock(&s_sprdphone.lock);
+    ctl->value[id] = value;
+    pthread_mutex_unlock(&s_sprdphone.lock);
+    stat_add32(&s_mixer_stats.writes, 1);
+    stat_add64(&s_mixer_stats.write_us, (now_ns() - start) / 1000);
+    return 0;
+}
+
+int mixer_ctl_set_enum_by_string(struct mixer_ctl *ctl, const char *string)
+{
+    unsigned int i;
+
+    if (!ctl)
+        return -EINVAL;
+    for (i = 0; i < ctl->num_enums; i++)
+        if (strcmp(ctl->enums[i], string) == 0)
+            return mixer_ctl_set_value(ctl, 0, i);
+    return -EINVAL;
+}
+
+void mock_mixer_set_write_delay(unsigned int us)
+{
+    s_write_delay_us = us;
+}
+
+void mock_pcm_get_stats(int out, struct mock_pcm_stats *stats)
+{
+    struct mock_pcm_stats *s = &s_pcm_stats[out ? 1 : 0];
+
+    stats->opens = __atomic_load_n(&s->opens, __ATOMIC_RELAXED);
+    stats->xruns = __atomic_load_n(&s->xruns, __ATOMIC_RELAXED);
+    stats->transfers = __atomic_load_n(&s->transfers, __ATOMIC_RELAXED);
+    stats->frames = __atomic_load_n(&s->frames, __ATOMIC_RELAXED);
+}
+
+void mock_mixer_get_stats(struct mock_mixer_stats *stats)
+{
+    stats->writes = __atomic_load_n(&s_mixer_stats.writes, __ATOMIC_RELAXED);
+    stats->write_us = __atomic_load_n(&s_mixer_stats.write_us, __ATOMIC_RELAXED);
+}
+
+void mock_alsa_reset_stats(void)
+{
+    memset(s_pcm_stats, 0, sizeof(s_pcm_stats));
+    memset(&s_mixer_stats, 0, sizeof(s_mixer_stats));
+}
+
+int mock_mixer_value(const char *name)
+{
+    struct mixer_ctl *ctl = mixer_get_ctl_by_name(&s_sprdphone, name);
+
+    return ctl ? mixer_ctl_get_value(ctl, 0) : -1;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The sound card the HAL runs against on the host. Its hw pointer moves with
+ * CLOCK_MONOTONIC in steps of MOCK_PCM_HW_STEP frames, the VBC DMA unit, and
+ * pcm_get_htimestamp() stamps the last step as the kernel does. A playback
+ * pcm that runs dry or a capture pcm that is not read in time counts an xrun
+ * and starts over. Mixer writes take a set time, as on the I2C codec.
+ */
+
+#ifndef HAL_TEST_MOCK_ALSA_H
+#define HAL_TEST_MOCK_ALSA_H
+
+#include <stdint.h>
+
+#define MOCK_CARD_SPRDPHONE     0
+#define MOCK_CARD_VAUDIO        1
+#define MOCK_PCM_HW_STEP        160
+/* what a capture pcm reads, on every channel */
+#define MOCK_TONE_HZ            1000
+#define MOCK_TONE_AMP           8000
+
+struct mock_pcm_stats {
+    uint32_t opens;
+    uint32_t xruns;
+    uint32_t transfers;         /* pcm_mmap_write() or pcm_read() calls */
+    uint64_t frames;
+};
+
+struct mock_mixer_stats {
+    uint32_t writes;            /* values written to a control */
+    uint64_t write_us;
+};
+
+/* time each value written to a control takes */
+void mock_mixer_set_write_delay(unsigned int us);
+
+/* the stats of the playback (out != 0) or capture pcms since the last reset */
+void mock_pcm_get_stats(int out, struct mock_pcm_stats *stats);
+void mock_mixer_get_stats(struct mock_mixer_stats *stats);
+void mock_alsa_reset_stats(void);
+
+/* the value a control holds, -1 when there is no such control */
+int mock_mixer_value(const char *name);
+
+#endif
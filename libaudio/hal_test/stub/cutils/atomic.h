@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* the barriers of the HAL on the compiler builtins */
+
+#ifndef HAL_TEST_STUB_CUTILS_ATOMIC_H
+#define HAL_TEST_STUB_CUTILS_ATOMIC_H
+
+#include <stdint.h>
+
+static inline int32_t android_atomic_acquire_load(volatile const int32_t *addr)
+{
+    return __atomic_load_n(addr, __ATOMIC_ACQUIRE);
+}
+
+static inline void android_atomic_release_store(int32_t value, volatile int32_t *addr)
+{
+    __atomic_store_n(addr, value, __ATOMIC_RELEASE);
+}
+
+#endif
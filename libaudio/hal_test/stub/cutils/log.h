@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* host stand-in for the bionic logging header. The HAL logs at error level
+ * in normal operation, so nothing is printed unless the test asks for it
+ * with hal_log_level. */
+
+#ifndef HAL_TEST_STUB_CUTILS_LOG_H
+#define HAL_TEST_STUB_CUTILS_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef LOG_TAG
+#define LOG_TAG NULL
+#endif
+
+#define ANDROID_LOG_VERBOSE 2
+#define ANDROID_LOG_DEBUG   3
+#define ANDROID_LOG_INFO    4
+#define ANDROID_LOG_WARN    5
+#define ANDROID_LOG_ERROR   6
+
+/* the lowest priority printed, above ANDROID_LOG_ERROR prints nothing */
+extern int hal_log_level;
+
+void hal_log(int prio, const char *tag, const char *fmt, ...)
+        __attribute__((format(printf, 3, 4)));
+
+#define ALOGV(...)  ((void)0)
+#define ALOGD(...)  hal_log(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define ALOGI(...)  hal_log(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define ALOGW(...)  hal_log(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#define ALOGE(...)  hal_log(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* the part of libcutils str_parms the HAL uses, hal_stub.c implements it */
+
+#ifndef HAL_TEST_STUB_CUTILS_STR_PARMS_H
+#define HAL_TEST_STUB_CUTILS_STR_PARMS_H
+
+struct str_parms;
+
+struct str_parms *str_parms_create_str(const char *_string);
+void str_parms_destroy(struct str_parms *str_parms);
+int str_parms_get_str(struct str_parms *str_parms, const char *key, char *out_val, int len);
+int str_parms_get_int(struct str_parms *str_parms, const char *key, int *out_val);
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* the effect interface the HAL calls on its pre processors */
+
+#ifndef HAL_TEST_STUB_HARDWARE_AUDIO_EFFECT_H
+#define HAL_TEST_STUB_HARDWARE_AUDIO_EFFECT_H
+
+#include <stdint.h>
+
+#include <hardware/audio.h>
+
+typedef struct effect_uuid_s {
+    uint32_t timeLow;
+    uint16_t timeMid;
+    uint16_t timeHiAndVersion;
+    uint16_t clockSeq;
+    uint8_t node[6];
+} effect_uuid_t;
+
+#define EFFECT_STRING_LEN_MAX 64
+
+typedef struct effect_descriptor_s {
+    effect_uuid_t type;
+    effect_uuid_t uuid;
+    uint32_t apiVersion;
+    uint32_t flags;
+    uint16_t cpuLoad;
+    uint16_t memoryUsage;
+    char name[EFFECT_STRING_LEN_MAX];
+    char implementor[EFFECT_STRING_LEN_MAX];
+} effect_descriptor_t;
+
+typedef struct audio_buffer_s {
+    size_t frameCount;
+    union {
+        void *raw;
+        int32_t *s32;
+        int16_t *s16;
+        uint8_t *u8;
+    };
+} audio_buffer_t;
+
+struct effect_interface_s {
+    int32_t (*process)(effect_handle_t self, audio_buffer_t *inBuffer,
+                       audio_buffer_t *outBuffer);
+    int32_t (*command)(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
+                       void *pCmdData, uint32_t *replySize, void *pReplyData);
+    int32_t (*get_descriptor)(effect_handle_t self, effect_descriptor_t *pDescriptor);
+    int32_t (*process_reverse)(effect_handle_t self, audio_buffer_t *inBuffer,
+                               audio_buffer_t *outBuffer);
+};
+
+enum effect_command_e {
+    EFFECT_CMD_INIT,
+    EFFECT_CMD_SET_CONFIG,
+    EFFECT_CMD_RESET,
+    EFFECT_CMD_ENABLE,
+    EFFECT_CMD_DISABLE,
+    EFFECT_CMD_SET_PARAM,
+    EFFECT_CMD_SET_PARAM_DEFERRED,
+    EFFECT_CMD_SET_PARAM_COMMIT,
+    EFFECT_CMD_GET_PARAM,
+};
+
+typedef struct effect_param_s {
+    int32_t status;
+    uint32_t psize;
+    uint32_t vsize;
+    char data[];
+} effect_param_t;
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* the audio types of the platform the HAL uses, with the FM devices of the
+ * Spreadtrum tree. The values only have to agree within the host build. */
+
+#ifndef HAL_TEST_STUB_SYSTEM_AUDIO_H
+#define HAL_TEST_STUB_SYSTEM_AUDIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef int audio_io_handle_t;
+
+typedef enum {
+    AUDIO_MODE_INVALID          = -2,
+    AUDIO_MODE_CURRENT          = -1,
+    AUDIO_MODE_NORMAL           = 0,
+    AUDIO_MODE_RINGTONE         = 1,
+    AUDIO_MODE_IN_CALL          = 2,
+    AUDIO_MODE_IN_COMMUNICATION = 3,
+} audio_mode_t;
+
+typedef enum {
+    AUDIO_FORMAT_DEFAULT        = 0,
+    AUDIO_FORMAT_PCM_16_BIT     = 0x1,
+    AUDIO_FORMAT_PCM_8_BIT      = 0x2,
+} audio_format_t;
+
+enum {
+    AUDIO_CHANNEL_OUT_FRONT_LEFT    = 0x1,
+    AUDIO_CHANNEL_OUT_FRONT_RIGHT   = 0x2,
+    AUDIO_CHANNEL_OUT_MONO          = AUDIO_CHANNEL_OUT_FRONT_LEFT,
+    AUDIO_CHANNEL_OUT_STEREO        = AUDIO_CHANNEL_OUT_FRONT_LEFT |
+                                      AUDIO_CHANNEL_OUT_FRONT_RIGHT,
+
+    AUDIO_CHANNEL_IN_LEFT           = 0x4,
+    AUDIO_CHANNEL_IN_RIGHT          = 0x8,
+    AUDIO_CHANNEL_IN_FRONT          = 0x10,
+    AUDIO_CHANNEL_IN_MONO           = AUDIO_CHANNEL_IN_FRONT,
+    AUDIO_CHANNEL_IN_STEREO         = AUDIO_CHANNEL_IN_LEFT | AUDIO_CHANNEL_IN_RIGHT,
+};
+
+typedef uint32_t audio_channel_mask_t;
+
+enum {
+    AUDIO_DEVICE_NONE                          = 0x0,
+    /* output devices */
+    AUDIO_DEVICE_OUT_EARPIECE                  = 0x1,
+    AUDIO_DEVICE_OUT_SPEAKER                   = 0x2,
+    AUDIO_DEVICE_OUT_WIRED_HEADSET             = 0x4,
+    AUDIO_DEVICE_OUT_WIRED_HEADPHONE           = 0x8,
+    AUDIO_DEVICE_OUT_BLUETOOTH_SCO             = 0x10,
+    AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET     = 0x20,
+    AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT      = 0x40,
+    AUDIO_DEVICE_OUT_BLUETOOTH_A2DP            = 0x80,
+    AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES = 0x100,
+    AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER    = 0x200,
+    AUDIO_DEVICE_OUT_AUX_DIGITAL               = 0x400,
+    AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET         = 0x800,
+    AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET         = 0x1000,
+    AUDIO_DEVICE_OUT_USB_ACCESSORY             = 0x2000,
+    AUDIO_DEVICE_OUT_USB_DEVICE                = 0x4000,
+    AUDIO_DEVICE_OUT_DEFAULT                   = 0x8000,
+    AUDIO_DEVICE_OUT_FM_HEADSET                = 0x1000000,
+    AUDIO_DEVICE_OUT_FM_SPEAKER                = 0x2000000,
+    AUDIO_DEVICE_OUT_ALL_FM = (AUDIO_DEVICE_OUT_FM_HEADSET | AUDIO_DEVICE_OUT_FM_SPEAKER),
+    AUDIO_DEVICE_OUT_ALL      = (AUDIO_DEVICE_OUT_EARPIECE |
+                                 AUDIO_DEVICE_OUT_SPEAKER |
+                                 AUDIO_DEVICE_OUT_WIRED_HEADSET |
+                                 AUDIO_DEVICE_OUT_WIRED_HEADPHONE |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_SCO |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_A2DP |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_HEADPHONES |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_A2DP_SPEAKER |
+                                 AUDIO_DEVICE_OUT_AUX_DIGITAL |
+                                 AUDIO_DEVICE_OUT_ANLG_DOCK_HEADSET |
+                                 AUDIO_DEVICE_OUT_DGTL_DOCK_HEADSET |
+                                 AUDIO_DEVICE_OUT_USB_ACCESSORY |
+                                 AUDIO_DEVICE_OUT_USB_DEVICE |
+                                 AUDIO_DEVICE_OUT_ALL_FM |
+                                 AUDIO_DEVICE_OUT_DEFAULT),
+    AUDIO_DEVICE_OUT_ALL_SCO  = (AUDIO_DEVICE_OUT_BLUETOOTH_SCO |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET |
+                                 AUDIO_DEVICE_OUT_BLUETOOTH_SCO_CARKIT),
+    /* input devices */
+    AUDIO_DEVICE_IN_COMMUNICATION              = 0x10000,
+    AUDIO_DEVICE_IN_AMBIENT                    = 0x20000,
+    AUDIO_DEVICE_IN_BUILTIN_MIC                = 0x40000,
+    AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET      = 0x80000,
+    AUDIO_DEVICE_IN_WIRED_HEADSET              = 0x100000,
+    AUDIO_DEVICE_IN_AUX_DIGITAL                = 0x200000,
+    AUDIO_DEVICE_IN_VOICE_CALL                 = 0x400000,
+    AUDIO_DEVICE_IN_BACK_MIC                   = 0x800000,
+    AUDIO_DEVICE_IN_DEFAULT                    = 0x80000000,
+    AUDIO_DEVICE_IN_ALL       = (AUDIO_DEVICE_IN_COMMUNICATION |
+                                 AUDIO_DEVICE_IN_AMBIENT |
+                                 AUDIO_DEVICE_IN_BUILTIN_MIC |
+                                 AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET |
+                                 AUDIO_DEVICE_IN_WIRED_HEADSET |
+                                 AUDIO_DEVICE_IN_AUX_DIGITAL |
+                                 AUDIO_DEVICE_IN_VOICE_CALL |
+                                 AUDIO_DEVICE_IN_BACK_MIC |
+                                 AUDIO_DEVICE_IN_DEFAULT),
+    AUDIO_DEVICE_IN_ALL_SCO   = AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET,
+};
+
+typedef uint32_t audio_devices_t;
+
+typedef enum {
+    AUDIO_OUTPUT_FLAG_NONE      = 0x0,
+    AUDIO_OUTPUT_FLAG_DIRECT    = 0x1,
+    AUDIO_OUTPUT_FLAG_PRIMARY   = 0x2,
+    AUDIO_OUTPUT_FLAG_FAST      = 0x4,
+    AUDIO_OUTPUT_FLAG_DEEP_BUFFER = 0x8,
+} audio_output_flags_t;
+
+static inline uint32_t popcount(uint32_t u)
+{
+    return __builtin_popcount(u);
+}
+
+#endif
@@ -1,6 +1,10 @@
 #include <sys/select.h>
 #include <fcntl.h>
 
+#ifndef MMI_AUDIO_CTRL_PATH
+#define MMI_AUDIO_CTRL_PATH "/dev/pipe/mmi.audio.ctrl"
+#endif
+
 pthread_t mmi_audio_loop;
 
 void *mmi_audio_loop_thread(void *args);
@@ -94,8 +98,8 @@ void *mmi_audio_loop_thread(void *args)
     char r_buf[128], *p;
     int mmi_audio_ctrl, max_fd;
 
-	ALOGE("peter: open /dev/pipe/mmi.audio.ctrl in\n");
-    mmi_audio_ctrl = open("/dev/pipe/mmi.audio.ctrl", O_RDWR);
+	ALOGE("peter: open " MMI_AUDIO_CTRL_PATH " in\n");
+    mmi_audio_ctrl = open(MMI_AUDIO_CTRL_PATH, O_RDWR);
     max_fd = mmi_audio_ctrl;
     memset(r_buf, 0, sizeof r_buf);
     
@@ -8,6 +8,7 @@
 #include <dlfcn.h>
 #include <sys/wait.h>
 #include <sys/mman.h>
+#include <poll.h>
 #include "aud_enha.h"
 
 //#ifdef __cplusplus
@@ -25,6 +26,18 @@
 
 #define VBC_CMD_TAG   "VBC"
 
+#ifndef VBC_PIPE_NAME
+#define VBC_PIPE_NAME           "/dev/vbpipe6"
+#endif
+/* wait before reopening vbpipe once the modem went away, doubled up to the
+ * max while it does not answer */
+#define VBC_RECONNECT_MIN_MS    20
+#define VBC_RECONNECT_MAX_MS    500
+/* a message started by the modem must be complete within this time */
+#define VBC_MSG_TIMEOUT_MS      1000
+/* command latency buckets: under 1 ms, 2 ms, 4 ms ... 256 ms, and longer */
+#define VBC_LAT_BUCKETS         10
+
 #define READ_PARAS(type, exp)    if (s_vbpipe_fd > 0 && paras_ptr != NULL) { \
         exp = read(s_vbpipe_fd, paras_ptr, sizeof(type)); \
         }
@@ -37,6 +50,7 @@ static int s_vbpipe_fd = -1;
 static int s_is_exit = 0;
 static int s_is_active = 0;
 static int android_sim_num = 0;
+static int s_vbc_wake_fd[2] = {-1, -1};
 
 
 /* vbc control parameters struct here.*/
@@ -125,6 +139,25 @@ enum VBC_CMD_E
     VBC_CMD_MAX
 };
 
+/* vbc control thread states */
+enum vbc_link_state {
+    VBC_LINK_CONNECT,   /* open vbpipe */
+    VBC_LINK_BACKOFF,   /* wait before opening it again */
+    VBC_LINK_READY,     /* wait for the next command */
+};
+
+/* written by the control thread only, read by adev_dump() */
+struct vbc_ctrl_stats {
+    uint32_t reconnects;
+    uint32_t max_reconnect_ms;
+    int64_t lost_us;    /* time the link went down, 0 while it is up */
+    uint32_t cmd_count[VBC_CMD_MAX];
+    uint32_t cmd_max_us[VBC_CMD_MAX];
+    uint32_t cmd_lat[VBC_CMD_MAX][VBC_LAT_BUCKETS];
+};
+
+static struct vbc_ctrl_stats s_vbc_stats;
+
 typedef struct
 {
     char        tag[4];   /* "VBC" */
@@ -159,11 +192,60 @@ void *vbc_ctrl_thread_routine(void *args);
 /*
  * local functions definition.
  */
+static int64_t vbc_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Reads a whole message, returns len, 0 when the modem closed vbpipe, or -1
+ * with errno set, ETIMEDOUT when the message is not complete in time.
+ */
+static int vbc_read_full(int fd_pipe, void *buf, size_t len)
+{
+    int64_t deadline_us = vbc_now_us() + VBC_MSG_TIMEOUT_MS * 1000LL;
+    struct pollfd pfd;
+    size_t got = 0;
+    int timeout_ms;
+    int ret;
+
+    pfd.fd = fd_pipe;
+    pfd.events = POLLIN;
+    while (got < len) {
+        timeout_ms = (int)((deadline_us - vbc_now_us() + 999) / 1000);
+        if (timeout_ms < 0)
+            timeout_ms = 0;
+        ret = poll(&pfd, 1, timeout_ms);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (ret == 0) {
+            ALOGE("vbpipe: got %zu of %zu bytes in %d ms", got, len, VBC_MSG_TIMEOUT_MS);
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        ret = read(fd_pipe, (char *)buf + got, len - got);
+        if (ret == 0)
+            return 0;
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        got += ret;
+    }
+    return (int)got;
+}
+
 static int  ReadParas_Head(int fd_pipe,  parameters_head_t *head_ptr)
 {
     int ret = 0;
     if (fd_pipe > 0 && head_ptr != NULL) {
-        ret = read(fd_pipe, head_ptr, sizeof(parameters_head_t));
+        ret = vbc_read_full(fd_pipe, head_ptr, sizeof(parameters_head_t));
     }
     return ret;
 }
@@ -181,7 +263,7 @@ static int  ReadParas_OpenHal(int fd_pipe, open_hal_t *hal_open_param)
 {
     int ret = 0;
     if (fd_pipe > 0 && hal_open_param != NULL) {
-        ret = read(fd_pipe, hal_open_param, sizeof(open_hal_t));
+        ret = vbc_read_full(fd_pipe, hal_open_param, sizeof(open_hal_t));
     }
     return ret;
 }
@@ -191,7 +273,7 @@ static int  ReadParas_DeviceCtrl(int fd_pipe, device_ctrl_t *paras_ptr)
 {
     int ret = 0;
     if (fd_pipe > 0 && paras_ptr != NULL) {
-        ret = read(fd_pipe, paras_ptr, sizeof(device_ctrl_t));
+        ret = vbc_read_full(fd_pipe, paras_ptr, sizeof(device_ctrl_t));
     }
     return ret;
 }
@@ -200,7 +282,7 @@ static int  ReadParas_ModeGain(int fd_pipe,  paras_mode_gain_t *paras_ptr)
 {
     int ret = 0;
     if (fd_pipe > 0 && paras_ptr != NULL) {
-        ret = read(fd_pipe, paras_ptr, sizeof(paras_mode_gain_t));
+        ret = vbc_read_full(fd_pipe, paras_ptr, sizeof(paras_mode_gain_t));
     }
     return ret;
 }
@@ -209,7 +291,7 @@ static int  ReadParas_SwitchCtrl(int fd_pipe,  switch_ctrl_t *paras_ptr)
 {
     int ret = 0;
     if (fd_pipe > 0 && paras_ptr != NULL) {
-        ret = read(fd_pipe, paras_ptr, sizeof(switch_ctrl_t));
+        ret = vbc_read_full(fd_pipe, paras_ptr, sizeof(switch_ctrl_t));
     }
     return ret;
 }
@@ -218,7 +300,7 @@ static int  ReadParas_Mute(int fd_pipe,  set_mute_t *paras_ptr)
 {
     int ret = 0;
     if (fd_pipe > 0 && paras_ptr != NULL) {
-        ret = read(fd_pipe, paras_ptr, sizeof(set_mute_t));
+        ret = vbc_read_full(fd_pipe, paras_ptr, sizeof(set_mute_t));
     }
     return ret;
 }
@@ -392,19 +474,18 @@ static int SetAudio_gain_by_devices_incall(struct tiny_audio_device *adev, pga_g
         ALOGE("%s pga_gain_nv NULL",__func__);
         return -1;
     }
-    struct mixer_ctl* spkvolume = mixer_get_ctl_by_name(adev->mixer, "Inter PA Playback Volume");
     if(pga_gain_nv->devices & AUDIO_DEVICE_OUT_EARPIECE){
         audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_l,"earpiece");
     }
     if((pga_gain_nv->devices & AUDIO_DEVICE_OUT_SPEAKER) && ((pga_gain_nv->devices & AUDIO_DEVICE_OUT_WIRED_HEADSET) || (pga_gain_nv->devices & AUDIO_DEVICE_OUT_WIRED_HEADPHONE))){
         audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_l,"headphone-spk-l");
         audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_r,"headphone-spk-r");
-        mixer_ctl_set_value(spkvolume, 0, pga_gain_nv->pa_setting);
+        tiny_ctl_set(adev, TINY_CTL_INTER_PA_VOLUME, pga_gain_nv->pa_setting);
     }else{
         if(pga_gain_nv->devices & AUDIO_DEVICE_OUT_SPEAKER){
             audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_l,"speaker-l");
             audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_r,"speaker-r");
-            mixer_ctl_set_value(spkvolume, 0, pga_gain_nv->pa_setting);
+            tiny_ctl_set(adev, TINY_CTL_INTER_PA_VOLUME, pga_gain_nv->pa_setting);
         }
         if((pga_gain_nv->devices & AUDIO_DEVICE_OUT_WIRED_HEADSET) || (pga_gain_nv->devices & AUDIO_DEVICE_OUT_WIRED_HEADPHONE)){
     	    audio_pga_apply(adev->pga,pga_gain_nv->dac_pga_gain_l,"headphone-l");
@@ -752,12 +833,20 @@ int vbc_ctrl_open(struct tiny_audio_device *adev)
     if (s_is_active) return (-1);
     int rc;
     MY_TRACE("%s IN.",__func__);
+    /* vbc_ctrl_close() writes to it to wake the thread up */
+    if (pipe(s_vbc_wake_fd) < 0) {
+        ALOGE("error, pipe failed, %s", strerror(errno));
+        return (-1);
+    }
     s_is_exit = 0;
     s_is_active = 1;
     rc = pthread_create(&s_vbc_ctrl_thread, NULL, vbc_ctrl_thread_routine, (void *)adev);
     if (rc) {
         ALOGE("error, pthread_create failed, rc=%d", rc);
         s_is_active = 0;
+        close(s_vbc_wake_fd[0]);
+        close(s_vbc_wake_fd[1]);
+        s_vbc_wake_fd[0] = s_vbc_wake_fd[1] = -1;
         return (-1);
     }
 
@@ -768,216 +857,325 @@ int vbc_ctrl_close()
 {
     if (!s_is_active) return (-1);
     MY_TRACE("%s IN.",__func__);
-   
+
     s_is_exit = 1;
     s_is_active = 0;
-    /* close vbpipe.*/
-    close(s_vbpipe_fd);
-    s_vbpipe_fd = -1;
-
-    /* terminate thread.*/
-    //pthread_cancel (s_vbc_ctrl_thread);    
+    /* the thread closes vbpipe on its way out */
+    write(s_vbc_wake_fd[1], "q", 1);
+    pthread_join(s_vbc_ctrl_thread, NULL);
+    close(s_vbc_wake_fd[0]);
+    close(s_vbc_wake_fd[1]);
+    s_vbc_wake_fd[0] = s_vbc_wake_fd[1] = -1;
     return (0);
 }
 
+void vbc_ctrl_dump(int fd)
+{
+    static const char *cmd_names[VBC_CMD_MAX] = {
+        [VBC_CMD_SET_MODE] = "set_mode",
+        [VBC_CMD_SET_GAIN] = "set_gain",
+        [VBC_CMD_SWITCH_CTRL] = "switch_ctrl",
+        [VBC_CMD_SET_MUTE] = "set_mute",
+        [VBC_CMD_DEVICE_CTRL] = "device_ctrl",
+        [VBC_CMD_HAL_OPEN] = "hal_open",
+        [VBC_CMD_HAL_CLOSE] = "hal_close",
+    };
+    int cmd, b;
+
+    dprintf(fd, "vbc control: vbpipe %s, %u reconnects, worst %u ms\n",
+            s_vbpipe_fd >= 0 ? "open" : "closed",
+            s_vbc_stats.reconnects, s_vbc_stats.max_reconnect_ms);
+    dprintf(fd, "  command       count   max_us  ms: <1 <2 <4 <8 <16 <32 <64 <128 <256 more\n");
+    for (cmd = 0; cmd < VBC_CMD_MAX; cmd++) {
+        if (s_vbc_stats.cmd_count[cmd] == 0)
+            continue;
+        dprintf(fd, "  %-12s %6u %8u     ", cmd_names[cmd] ? cmd_names[cmd] : "unknown",
+                s_vbc_stats.cmd_count[cmd], s_vbc_stats.cmd_max_us[cmd]);
+        for (b = 0; b < VBC_LAT_BUCKETS; b++)
+            dprintf(fd, " %u", s_vbc_stats.cmd_lat[cmd][b]);
+        dprintf(fd, "\n");
+    }
+}
+
+static void vbc_ctrl_account(unsigned int cmd, int64_t lat_us)
+{
+    int64_t ms = lat_us / 1000;
+    int b = 0;
+
+    if (cmd >= VBC_CMD_MAX)
+        cmd = VBC_CMD_NONE;
+    while (ms > 0 && b < VBC_LAT_BUCKETS - 1) {
+        ms >>= 1;
+        b++;
+    }
+    s_vbc_stats.cmd_count[cmd]++;
+    s_vbc_stats.cmd_lat[cmd][b]++;
+    if (lat_us > s_vbc_stats.cmd_max_us[cmd])
+        s_vbc_stats.cmd_max_us[cmd] = (uint32_t)lat_us;
+}
+
+/* the modem went away during a call: give the codec back to arm and take the
+ * call down, the modem sets it up again once it is back */
+static void vbc_ctrl_link_lost(struct tiny_audio_device *adev)
+{
+    if (s_vbc_stats.lost_us == 0)
+        s_vbc_stats.lost_us = vbc_now_us();
+    if(adev->call_start){                  //cp crash during call
+        mixer_ctl_set_value(adev->private_ctl.vbc_switch, 0, 1);  //switch to arm
+        pthread_mutex_lock(&adev->lock);
+        force_all_standby(adev);
+        pcm_close(adev->pcm_modem_ul);
+        pcm_close(adev->pcm_modem_dl);
+        adev->call_start = 0;
+        adev->call_connected = 0;
+        publish_out_state(adev);
+        pthread_mutex_unlock(&adev->lock);
+    }
+}
+
+/* waits for fd_pipe to be readable, or only for timeout_ms when fd_pipe is -1.
+ * Returns 0 when vbc_ctrl_close() woke the thread up.
+ */
+static int vbc_ctrl_wait(int fd_pipe, int timeout_ms)
+{
+    struct pollfd pfd[2];
+    int ret;
+
+    pfd[0].fd = s_vbc_wake_fd[0];
+    pfd[0].events = POLLIN;
+    pfd[1].fd = fd_pipe;
+    pfd[1].events = POLLIN;
+    do {
+        ret = poll(pfd, fd_pipe >= 0 ? 2 : 1, timeout_ms);
+    } while (ret < 0 && errno == EINTR);
+    if (s_is_exit || (pfd[0].revents & POLLIN))
+        return 0;
+    return 1;
+}
+
+/* returns a negative value when the command could not be read whole, vbpipe is
+ * then opened again to get in step with the modem */
+static int vbc_ctrl_process_cmd(struct tiny_audio_device *adev,
+                                parameters_head_t *read_common_head,
+                                parameters_head_t *write_common_head)
+{
+    int ret = 0;
+    int err = 0;
+
+    if (memcmp(&read_common_head->tag[0], VBC_CMD_TAG, 3)) {
+        ALOGE("Error, (0x%x)NOT match VBC_CMD_TAG, wrong packet.", *((int*)read_common_head->tag));
+        return 0;
+    }
+    switch (read_common_head->cmd_type)
+    {
+    case VBC_CMD_HAL_OPEN:
+    {
+        ALOGE(":VBC_CMD_HAL_OPEN IN.");
+        ALOGW("VBC_CMD_HAL_OPEN, try lock");
+        pthread_mutex_lock(&adev->lock);
+        ALOGW("VBC_CMD_HAL_OPEN, got lock");
+        force_all_standby(adev);    /*should standby because MODE_IN_CALL is later than call_start*/
+        adev->pcm_modem_dl= pcm_open(s_tinycard, PORT_MODEM, PCM_OUT | PCM_MMAP, &pcm_config_vx);
+        if (!pcm_is_ready(adev->pcm_modem_dl)) {
+            ALOGE("cannot open pcm_modem_dl : %s", pcm_get_error(adev->pcm_modem_dl));
+            pcm_close(adev->pcm_modem_dl);
+            s_is_exit = 1;
+        }
+        adev->pcm_modem_ul= pcm_open(s_tinycard, PORT_MODEM, PCM_IN, &pcm_config_vrec_vx);
+        if (!pcm_is_ready(adev->pcm_modem_ul)) {
+            ALOGE("cannot open pcm_modem_ul : %s", pcm_get_error(adev->pcm_modem_ul));
+            pcm_close(adev->pcm_modem_ul);
+            pcm_close(adev->pcm_modem_dl);
+            s_is_exit = 1;
+        }
+        ALOGW("START CALL,open pcm device...");
+        pthread_mutex_lock(&adev->device_lock);
+        adev->call_start = 1;
+        publish_out_state(adev);
+        adev->codec_mute = 0;
+        codec_mute_set(adev);
+        pthread_mutex_unlock(&adev->device_lock);
+        SetParas_OpenHal_Incall(s_vbpipe_fd);   //get sim card number
+        pthread_mutex_unlock(&adev->lock);
+        MY_TRACE("VBC_CMD_HAL_OPEN OUT.");
+    }
+    break;
+    case VBC_CMD_HAL_CLOSE:
+    {
+        ALOGE(":VBC_CMD_HAL_CLOSE IN.");
+        adev->call_prestop = 1;
+        publish_out_state(adev);
+        write_common_head->cmd_type = VBC_CMD_RSP_CLOSE;     //ask cp to read vaudio data, "call_prestop" will stop to write pcm data again.
+        WriteParas_Head(s_vbpipe_fd, write_common_head);
+        mixer_ctl_set_value(adev->private_ctl.vbc_switch, 0, 1);  //switch vbc to arm
+        if(adev->call_start){  //if mediaserver crashed, audio will reopen, "call_start" value is 0, should bypass all the settings.
+            ALOGW("VBC_CMD_HAL_CLOSE, try lock");
+            pthread_mutex_lock(&adev->lock);
+            ALOGW("VBC_CMD_HAL_CLOSE, got lock");
+            force_all_standby(adev);
+            pcm_close(adev->pcm_modem_ul);
+            pcm_close(adev->pcm_modem_dl);
+            adev->call_start = 0;
+            adev->call_connected = 0;
+            publish_out_state(adev);
+            ALOGW("END CALL,close pcm device & switch to arm...");
+            pthread_mutex_unlock(&adev->lock);
+        }else{
+            ALOGW("VBC_CMD_HAL_CLOSE, call thread restart, we should stop call!!!");
+        }
+        ReadParas_Head(s_vbpipe_fd,write_common_head);
+        Write_Rsp2cp(s_vbpipe_fd,VBC_CMD_HAL_CLOSE);
+        adev->call_prestop = 0;
+        publish_out_state(adev);
+        MY_TRACE("VBC_CMD_HAL_CLOSE OUT.");
+    }
+    break;
+    case VBC_CMD_SET_MODE:
+    {
+        ALOGE(":VBC_CMD_SET_MODE IN.");
+        ret = SetParas_Route_Incall(s_vbpipe_fd,adev);
+        if(ret < 0){
+            MY_TRACE("VBC_CMD_SET_MODE SetParas_Route_Incall error.");
+            err = ret;
+        }
+        MY_TRACE("VBC_CMD_SET_MODE OUT.");
+    }
+    break;
+    case VBC_CMD_SET_GAIN:
+    {
+        ALOGE(":VBC_CMD_SET_GAIN IN.");
+        ret = SetParas_Volume_Incall(s_vbpipe_fd,adev);
+        if(ret < 0){
+            MY_TRACE("VBC_CMD_SET_GAIN SetParas_Route_Incall error.");
+            err = ret;
+        }
+        MY_TRACE("VBC_CMD_SET_GAIN OUT.");
+    }
+    break;
+    case VBC_CMD_SWITCH_CTRL:
+    {
+        ALOGE(":VBC_CMD_SWITCH_CTRL IN.");
+        ret = SetParas_Switch_Incall(s_vbpipe_fd,adev);
+        if(ret < 0){
+            MY_TRACE("VBC_CMD_SWITCH_CTRL SetParas_Switch_Incall error.");
+            err = ret;
+        }
+        pthread_mutex_lock(&adev->lock);
+        adev->call_connected = 1;
+        publish_out_state(adev);
+        pthread_mutex_unlock(&adev->lock);
+        MY_TRACE("VBC_CMD_SWITCH_CTRL OUT.");
+    }
+    break;
+    case VBC_CMD_SET_MUTE:
+    {
+        MY_TRACE("VBC_CMD_SET_MUTE IN.");
+
+        MY_TRACE("VBC_CMD_SET_MUTE OUT.");
+    }
+    break;
+    case VBC_CMD_DEVICE_CTRL:
+    {
+        ALOGE(":VBC_CMD_DEVICE_CTRL IN.");
+        ret = SetParas_DeviceCtrl_Incall(s_vbpipe_fd,adev);
+        if(ret < 0){
+            MY_TRACE("VBC_CMD_DEVICE_CTRL SetParas_DeviceCtrl_Incall error.");
+            err = ret;
+        }
+        ALOGE("wangzuo:before set mic");
+        tiny_ctl_set(adev, TINY_CTL_MIC_FUNCTION, 1);
+        ALOGE("wangzuo:after set mic");
+        MY_TRACE("VBC_CMD_DEVICE_CTRL OUT.");
+    }
+    break;
+    default:
+        ALOGE("Error: %s wrong cmd_type(%d)",__func__,read_common_head->cmd_type);
+    break;
+    }
+    return err;
+}
+
 void *vbc_ctrl_thread_routine(void *arg)
 {
     int ret = 0;
     struct tiny_audio_device *adev;
     parameters_head_t read_common_head;
     parameters_head_t write_common_head;
+    enum vbc_link_state state = VBC_LINK_CONNECT;
+    int backoff_ms = VBC_RECONNECT_MIN_MS;
+    int64_t start_us;
     adev = (struct tiny_audio_device *)arg;
 
     memset(&read_common_head, 0, sizeof(parameters_head_t));
     memset(&write_common_head, 0, sizeof(parameters_head_t));
-    
+
     memcpy(&write_common_head.tag[0], VBC_CMD_TAG, 3);
     write_common_head.cmd_type = VBC_CMD_NONE;
     write_common_head.paras_size = 0;
     MY_TRACE("vbc_ctrl_thread_routine in.");
-    
-RESTART:
-    if (s_is_exit) goto EXIT;
-    /* open vbpipe to build connection.*/
-    if (s_vbpipe_fd == -1) {
-        s_vbpipe_fd = open("/dev/vbpipe6", O_RDWR);
-        if (s_vbpipe_fd < 0) {
-            ALOGE("Error: s_vbpipe_fd(%d) open failed, %s ", s_vbpipe_fd,strerror(errno));
-            if(adev->call_start){                  //cp crash during call
-                mixer_ctl_set_value(adev->private_ctl.vbc_switch, 0, 1);  //switch to arm
-                pthread_mutex_lock(&adev->lock);
-                force_all_standby(adev);
-                pcm_close(adev->pcm_modem_ul);
-                pcm_close(adev->pcm_modem_dl);
-                adev->call_start = 0;
-                adev->call_connected = 0;
-                pthread_mutex_unlock(&adev->lock);
-            }
-            sleep(1);
-            goto RESTART;
-        } else {
-            ALOGW("s_vbpipe_fd(%d) open successfully.", s_vbpipe_fd);
-        }
-    } else {
-        ALOGW("warning: s_vbpipe_fd(%d) NOT closed.", s_vbpipe_fd);
-    }
 
-    /* loop to read parameters from vbpipe.*/
-    while(!s_is_exit)
-    {
-    	ALOGW("looping now...");
-        /* read parameters common head of the packet.*/
-        ret = ReadParas_Head(s_vbpipe_fd, &read_common_head);
-        if (ret < 0) {
-            ALOGE("Error, %s read head failed(%s), need to read again ",__func__,strerror(errno));
-            continue;
-        }else if (ret == 0) {   //cp something wrong
-            ALOGE("Error, %s read head failed(%s), need to reopen vbpipe ",__func__,strerror(errno));
-            if(adev->call_start){                  //cp crash during call
-                mixer_ctl_set_value(adev->private_ctl.vbc_switch, 0, 1);  //switch to arm
-                pthread_mutex_lock(&adev->lock);
-                force_all_standby(adev);
-                pcm_close(adev->pcm_modem_ul);
-                pcm_close(adev->pcm_modem_dl);
-                adev->call_start = 0;
-                adev->call_connected = 0;
-                pthread_mutex_unlock(&adev->lock);
-            }
-	        sleep(1);
-            close(s_vbpipe_fd);
-            s_vbpipe_fd = -1;
-            goto RESTART;
-        }
-        ALOGW("%s call start, Get CMD(%d) from cp, paras_size:%d devices:0x%x mode:%d", adev->call_start ? "":"NOT",read_common_head.cmd_type,read_common_head.paras_size,adev->devices,adev->mode);
-        if (!memcmp(&read_common_head.tag[0], VBC_CMD_TAG, 3)) {
-            switch (read_common_head.cmd_type)
-            {
-            case VBC_CMD_HAL_OPEN:
-            {
-                ALOGE(":VBC_CMD_HAL_OPEN IN.");
-                ALOGW("VBC_CMD_HAL_OPEN, try lock");
-                pthread_mutex_lock(&adev->lock);
-                ALOGW("VBC_CMD_HAL_OPEN, got lock");
-                force_all_standby(adev);    /*should standby because MODE_IN_CALL is later than call_start*/
-                adev->pcm_modem_dl= pcm_open(s_tinycard, PORT_MODEM, PCM_OUT | PCM_MMAP, &pcm_config_vx);
-                if (!pcm_is_ready(adev->pcm_modem_dl)) {
-                    ALOGE("cannot open pcm_modem_dl : %s", pcm_get_error(adev->pcm_modem_dl));
-                    pcm_close(adev->pcm_modem_dl);
-                    s_is_exit = 1;
-                }
-                adev->pcm_modem_ul= pcm_open(s_tinycard, PORT_MODEM, PCM_IN, &pcm_config_vrec_vx);
-                if (!pcm_is_ready(adev->pcm_modem_ul)) {
-                    ALOGE("cannot open pcm_modem_ul : %s", pcm_get_error(adev->pcm_modem_ul));
-                    pcm_close(adev->pcm_modem_ul);
-                    pcm_close(adev->pcm_modem_dl);
-                    s_is_exit = 1;
-                }
-                ALOGW("START CALL,open pcm device...");
-                pthread_mutex_lock(&adev->device_lock);
-                adev->call_start = 1;
-                adev->codec_mute = 0;
-                codec_mute_set(adev);
-                pthread_mutex_unlock(&adev->device_lock);
-                SetParas_OpenHal_Incall(s_vbpipe_fd);   //get sim card number
-                pthread_mutex_unlock(&adev->lock);
-                MY_TRACE("VBC_CMD_HAL_OPEN OUT.");
+    while (!s_is_exit) {
+        switch (state) {
+        case VBC_LINK_CONNECT:
+            /* open vbpipe to build connection.*/
+            s_vbpipe_fd = open(VBC_PIPE_NAME, O_RDWR);
+            if (s_vbpipe_fd < 0) {
+                ALOGE("Error: s_vbpipe_fd(%d) open failed, %s ", s_vbpipe_fd,strerror(errno));
+                vbc_ctrl_link_lost(adev);
+                state = VBC_LINK_BACKOFF;
+            } else {
+                ALOGW("s_vbpipe_fd(%d) open successfully.", s_vbpipe_fd);
+                state = VBC_LINK_READY;
             }
             break;
-            case VBC_CMD_HAL_CLOSE:
-            {
-                ALOGE(":VBC_CMD_HAL_CLOSE IN.");
-                adev->call_prestop = 1;
-                write_common_head.cmd_type = VBC_CMD_RSP_CLOSE;     //ask cp to read vaudio data, "call_prestop" will stop to write pcm data again.
-                WriteParas_Head(s_vbpipe_fd, &write_common_head);
-                mixer_ctl_set_value(adev->private_ctl.vbc_switch, 0, 1);  //switch vbc to arm
-                if(adev->call_start){  //if mediaserver crashed, audio will reopen, "call_start" value is 0, should bypass all the settings.
-                    ALOGW("VBC_CMD_HAL_CLOSE, try lock");
-                    pthread_mutex_lock(&adev->lock);
-                    ALOGW("VBC_CMD_HAL_CLOSE, got lock");
-                    force_all_standby(adev);
-                    pcm_close(adev->pcm_modem_ul);
-                    pcm_close(adev->pcm_modem_dl);
-                    adev->call_start = 0;
-                    adev->call_connected = 0;
-                    ALOGW("END CALL,close pcm device & switch to arm...");
-                    pthread_mutex_unlock(&adev->lock);
-                }else{
-                    ALOGW("VBC_CMD_HAL_CLOSE, call thread restart, we should stop call!!!");
-                }
-                ReadParas_Head(s_vbpipe_fd,&write_common_head);
-                Write_Rsp2cp(s_vbpipe_fd,VBC_CMD_HAL_CLOSE);
-                adev->call_prestop = 0;
-                MY_TRACE("VBC_CMD_HAL_CLOSE OUT.");
-            }
-            break;
-            case VBC_CMD_SET_MODE:
-            {
-                ALOGE(":VBC_CMD_SET_MODE IN.");
-                ret = SetParas_Route_Incall(s_vbpipe_fd,adev);
-                if(ret < 0){
-                    MY_TRACE("VBC_CMD_SET_MODE SetParas_Route_Incall error.s_is_exit:%d ",s_is_exit);
-                    s_is_exit = 1;
-                }
-                MY_TRACE("VBC_CMD_SET_MODE OUT.");
-            }
+        case VBC_LINK_BACKOFF:
+            ALOGW("reopening vbpipe in %d ms", backoff_ms);
+            vbc_ctrl_wait(-1, backoff_ms);
+            backoff_ms *= 2;
+            if (backoff_ms > VBC_RECONNECT_MAX_MS)
+                backoff_ms = VBC_RECONNECT_MAX_MS;
+            state = VBC_LINK_CONNECT;
             break;
-            case VBC_CMD_SET_GAIN:
-            {
-                ALOGE(":VBC_CMD_SET_GAIN IN.");
-                ret = SetParas_Volume_Incall(s_vbpipe_fd,adev);
-                if(ret < 0){
-                    MY_TRACE("VBC_CMD_SET_GAIN SetParas_Route_Incall error.s_is_exit:%d ",s_is_exit);
-                    s_is_exit = 1;
-                }
-                MY_TRACE("VBC_CMD_SET_GAIN OUT.");
+        case VBC_LINK_READY:
+            if (!vbc_ctrl_wait(s_vbpipe_fd, -1))
+                break;
+            /* read parameters common head of the packet.*/
+            ret = ReadParas_Head(s_vbpipe_fd, &read_common_head);
+            if (ret <= 0) {   //cp something wrong
+                ALOGE("Error, %s read head failed(%d, %s), need to reopen vbpipe ",__func__,ret,strerror(errno));
+                vbc_ctrl_link_lost(adev);
+                close(s_vbpipe_fd);
+                s_vbpipe_fd = -1;
+                state = VBC_LINK_BACKOFF;
+                break;
             }
-            break;
-            case VBC_CMD_SWITCH_CTRL:
-            {
-                ALOGE(":VBC_CMD_SWITCH_CTRL IN.");
-                ret = SetParas_Switch_Incall(s_vbpipe_fd,adev);
-                if(ret < 0){
-                    MY_TRACE("VBC_CMD_SWITCH_CTRL SetParas_Switch_Incall error.s_is_exit:%d ",s_is_exit);
-                    s_is_exit = 1;
-                }
-                pthread_mutex_lock(&adev->lock);
-                adev->call_connected = 1;
-                pthread_mutex_unlock(&adev->lock);
-                MY_TRACE("VBC_CMD_SWITCH_CTRL OUT.");
-            }
-            break;
-            case VBC_CMD_SET_MUTE:
-            {
-                MY_TRACE("VBC_CMD_SET_MUTE IN.");
-
-                MY_TRACE("VBC_CMD_SET_MUTE OUT.");
+            start_us = vbc_now_us();
+            if (s_vbc_stats.lost_us) {
+                ret = (int)((start_us - s_vbc_stats.lost_us) / 1000);
+                ALOGW("vbpipe back after %d ms", ret);
+                s_vbc_stats.reconnects++;
+                if ((uint32_t)ret > s_vbc_stats.max_reconnect_ms)
+                    s_vbc_stats.max_reconnect_ms = ret;
+                s_vbc_stats.lost_us = 0;
             }
-            break;
-            case VBC_CMD_DEVICE_CTRL:
-            {
-                ALOGE(":VBC_CMD_DEVICE_CTRL IN.");
-                ret = SetParas_DeviceCtrl_Incall(s_vbpipe_fd,adev);
-                if(ret < 0){
-                    MY_TRACE("VBC_CMD_DEVICE_CTRL SetParas_DeviceCtrl_Incall error.s_is_exit:%d ",s_is_exit);
-                    s_is_exit = 1;
-                }
-                ALOGE("wangzuo:before set mic");
-                struct mixer_ctl* ctl = mixer_get_ctl_by_name(adev->mixer, "Mic Function");
-                mixer_ctl_set_value(ctl, 0, 1);
-                ALOGE("wangzuo:after set mic");
-                MY_TRACE("VBC_CMD_DEVICE_CTRL OUT.");
+            backoff_ms = VBC_RECONNECT_MIN_MS;
+            ALOGW("%s call start, Get CMD(%d) from cp, paras_size:%d devices:0x%x mode:%d", adev->call_start ? "":"NOT",read_common_head.cmd_type,read_common_head.paras_size,adev->devices,adev->mode);
+            ret = vbc_ctrl_process_cmd(adev, &read_common_head, &write_common_head);
+            vbc_ctrl_account(read_common_head.cmd_type, vbc_now_us() - start_us);
+            if (ret < 0) {
+                vbc_ctrl_link_lost(adev);
+                close(s_vbpipe_fd);
+                s_vbpipe_fd = -1;
+                /* reopen at once, the modem is there */
+                state = VBC_LINK_CONNECT;
             }
             break;
-            default:
-                ALOGE("Error: %s wrong cmd_type(%d)",__func__,read_common_head.cmd_type);
-            break;
-            }
-        } else {
-            ALOGE("Error, (0x%x)NOT match VBC_CMD_TAG, wrong packet.", *((int*)read_common_head.tag));
         }
     }
-EXIT:
+    if (s_vbpipe_fd >= 0) {
+        close(s_vbpipe_fd);
+        s_vbpipe_fd = -1;
+    }
     ALOGW("vbc_ctrl_thread exit!!!");
     return 0;
 }
-
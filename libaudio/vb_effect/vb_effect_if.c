@@ -45,6 +45,7 @@
 #define VBC_EFFECT_PROFILE_CNT          (4)
 
 #define STORED_VBC_EFFECT_PARAS_PATH    "/productinfo/vbc_eq"
+#define STORED_VBC_EFFECT_PARAS_TMP     "/productinfo/vbc_eq.tmp"
 
 /* ALSA cards for sprd */
 #define CARD_SPRDPHONE "sprdphone"
@@ -144,12 +145,36 @@ extern int get_snd_card_number(const char *card_name);
 static AUDIO_TOTAL_T *get_aud_paras();
 static int do_parse(AUDIO_TOTAL_T *aud_ptr, unsigned int size);
 
+/* the firmware file only changes with the audio nv parameters, rewriting the
+   same content at each boot would just expose it to a power loss midway */
+static int vbc_eq_file_matches(const void *fw_buf, size_t fw_size)
+{
+    FILE *fp;
+    char *old_buf;
+    size_t len;
+    int same = 0;
+
+    fp = fopen(STORED_VBC_EFFECT_PARAS_PATH, "rb");
+    if (NULL == fp)
+        return 0;
+    old_buf = (char *)malloc(fw_size + 1);
+    if (old_buf != NULL) {
+        /* one more byte to notice a longer file */
+        len = fread(old_buf, 1, fw_size + 1, fp);
+        same = (len == fw_size) && (memcmp(old_buf, fw_buf, fw_size) == 0);
+        free(old_buf);
+    }
+    fclose(fp);
+    return same;
+}
+
 static int do_parse(AUDIO_TOTAL_T *audio_params_ptr, unsigned int params_size)
 {
     AUDIO_TOTAL_T *temp_params_ptr = NULL;
     AUDIO_TOTAL_T *cur_params_ptr = NULL;
     struct vbc_fw_header  *fw_header;
     struct vbc_eq_profile  *effect_profile;
+    size_t fw_size;
     uint32_t i = 0;
 
     if (NULL == audio_params_ptr) {
@@ -161,53 +186,68 @@ static int do_parse(AUDIO_TOTAL_T *audio_params_ptr, unsigned int params_size)
         return -1;
     }
 
-    fw_header = (struct vbc_fw_header *) malloc(sizeof(struct vbc_fw_header));
-    effect_profile = (struct vbc_eq_profile *)malloc(sizeof(struct vbc_eq_profile));
-    if ((fw_header != NULL) && (effect_profile != NULL)) {
-        memset(fw_header, 0, sizeof(struct vbc_fw_header));
-        memset(effect_profile, 0, sizeof(struct vbc_eq_profile));
-    } else {
+    //the whole file is built in memory: the header and the profiles following it.
+    fw_size = sizeof(struct vbc_fw_header) + VBC_EFFECT_PROFILE_CNT * sizeof(struct vbc_eq_profile);
+    fw_header = (struct vbc_fw_header *)calloc(1, fw_size);
+    if (NULL == fw_header) {
         ALOGE("Error: malloc failed for internal struct.");
         return -1;
     }
     ALOGI("do_parse...start");
-    //audio para nv file--> fd_src
-    //vb effect paras file-->fd_dest
-    fd_dest_paras = fopen(STORED_VBC_EFFECT_PARAS_PATH, "wb");
-    if (NULL  == fd_dest_paras) {
-        free(fw_header);
-        free(effect_profile);
-        ALOGE("file %s open failed:%s", STORED_VBC_EFFECT_PARAS_PATH, strerror(errno));
-        return -1;
-    }
-    //init temp buffer for paras calculated.
 
     memcpy(fw_header->magic, VBC_EQ_FIRMWARE_MAGIC_ID, VBC_EQ_FIRMWARE_MAGIC_LEN);
     fw_header->profile_version = VBC_EQ_PROFILE_VERSION;
     fw_header->num_profile = VBC_EFFECT_PROFILE_CNT; //TODO
 
-    ALOGI("fd_dest_paras(0x%x), header_len(%d), profile_len(%d)", (unsigned int)fd_dest_paras,
+    ALOGI("header_len(%d), profile_len(%d)",
          sizeof(struct vbc_fw_header), sizeof(struct vbc_eq_profile));
-    //write dest file header
-    fwrite(fw_header, sizeof(struct vbc_fw_header), 1, fd_dest_paras);
+    effect_profile = (struct vbc_eq_profile *)(fw_header + 1);
     temp_params_ptr = audio_params_ptr;
-    for (i=0; i<fw_header->num_profile; i++) {
+    for (i=0; i<fw_header->num_profile; i++, effect_profile++) {
         cur_params_ptr = temp_params_ptr + i;
-        //reset the paras buffer and copy default register value.
-        memset(effect_profile, 0, sizeof(struct vbc_eq_profile));
+        //copy default register value.
         memcpy(effect_profile->effect_paras, &vbc_reg_default[0], sizeof(vbc_reg_default));
         //set paras to buffer.
         AUDENHA_SetPara(cur_params_ptr, effect_profile->effect_paras);
-        //write buffer to stored file.
         memcpy(effect_profile->magic, VBC_EQ_FIRMWARE_MAGIC_ID, VBC_EQ_FIRMWARE_MAGIC_LEN);
         memcpy(effect_profile->name, cur_params_ptr->audio_nv_arm_mode_info.ucModeName, VBC_EQ_PROFILE_NAME_MAX);
         //strcpy(effect_profile->name, cur_params_ptr->audio_nv_arm_mode_info.ucModeName);
         ALOGI("effect_profile->name is %s", effect_profile->name);
-        fwrite(effect_profile, sizeof(struct vbc_eq_profile), 1, fd_dest_paras);
+    }
+
+    if (vbc_eq_file_matches(fw_header, fw_size)) {
+        ALOGI("%s is up to date", STORED_VBC_EFFECT_PARAS_PATH);
+        free(fw_header);
+        ALOGI("do_parse...end");
+        return 0;
+    }
+
+    //audio para nv file--> fd_src
+    //vb effect paras file-->fd_dest
+    //the new file is written aside and renamed over the old one, a power loss
+    //midway leaves the old file in place instead of a truncated one.
+    fd_dest_paras = fopen(STORED_VBC_EFFECT_PARAS_TMP, "wb");
+    if (NULL  == fd_dest_paras) {
+        free(fw_header);
+        ALOGE("file %s open failed:%s", STORED_VBC_EFFECT_PARAS_TMP, strerror(errno));
+        return -1;
+    }
+    //write buffer to stored file.
+    if ((fwrite(fw_header, fw_size, 1, fd_dest_paras) != 1)
+        || fflush(fd_dest_paras) || fsync(fileno(fd_dest_paras))) {
+        ALOGE("file %s write failed:%s", STORED_VBC_EFFECT_PARAS_TMP, strerror(errno));
+        fclose(fd_dest_paras);
+        unlink(STORED_VBC_EFFECT_PARAS_TMP);
+        free(fw_header);
+        return -1;
     }
     fclose(fd_dest_paras);
     free(fw_header);
-    free(effect_profile);
+    if (rename(STORED_VBC_EFFECT_PARAS_TMP, STORED_VBC_EFFECT_PARAS_PATH)) {
+        ALOGE("file %s rename failed:%s", STORED_VBC_EFFECT_PARAS_PATH, strerror(errno));
+        unlink(STORED_VBC_EFFECT_PARAS_TMP);
+        return -1;
+    }
     ALOGI("do_parse...end");
     return 0;
 }
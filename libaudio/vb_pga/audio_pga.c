@@ -21,7 +21,10 @@
 #include <errno.h>
 #include <expat.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <cutils/log.h>
 
@@ -56,7 +59,8 @@ struct pga_profile {
 	struct pga_item *item;
 };
 
-struct audio_pga {
+/* the profiles and attributes as read from the xml */
+struct pga_config {
 	struct mixer *mixer;
 	int num_pga_profiles;
 	int pga_profile_size;
@@ -64,8 +68,40 @@ struct audio_pga {
 	struct pga_attribute attribute;
 };
 
+/* A profile item with its attribute folded in, ready to be written */
+struct pga_table_item {
+	struct mixer_ctl *ctl;
+	int bit;
+	unsigned int mask;
+	int max;
+	int inverse;
+};
+
+struct pga_table_profile {
+	const char *name;
+	uint32_t hash;
+	int length;
+	struct pga_table_item *item;
+};
+
+/* Built once from a pga_config and never changed, so audio_pga_apply() only
+ * needs to hold on to it. The profiles are found through an open addressed
+ * hash of their names, hash_index holds the profile index plus one.
+ */
+struct pga_table {
+	int num_profiles;
+	unsigned int hash_mask;
+	uint16_t *hash_index;
+	struct pga_table_profile *profile;
+};
+
+struct audio_pga {
+	struct mixer *mixer;
+	struct pga_table *table;
+};
+
 struct config_parse_state {
-	struct audio_pga *pga;
+	struct pga_config *pga;
 	struct pga_profile *profile;
 	struct pga_attribute_item *attribute_item;
 };
@@ -109,7 +145,7 @@ const char *mixer_ctl_get_name_d(struct mixer_ctl *ctl)
 	return mixer_ctl_get_name(ctl);
 }
 
-static struct pga_profile *profile_get_by_name(struct audio_pga *pga,
+static struct pga_profile *profile_get_by_name(struct pga_config *pga,
 		const char *name)
 {
 	int i;
@@ -121,7 +157,7 @@ static struct pga_profile *profile_get_by_name(struct audio_pga *pga,
 	return NULL;
 }
 
-static struct pga_profile *profile_create(struct audio_pga *pga, const char *name)
+static struct pga_profile *profile_create(struct pga_config *pga, const char *name)
 {
 	struct pga_profile *new_profile = NULL;
 
@@ -217,7 +253,7 @@ static struct pga_attribute_item *attribute_get_by_ctl(struct pga_attribute *att
 	return NULL;
 }
 
-static struct pga_attribute_item *attribute_create(struct audio_pga *pga,
+static struct pga_attribute_item *attribute_create(struct pga_config *pga,
 		struct mixer_ctl *ctl)
 {
 	struct pga_attribute_item *new_item = NULL;
@@ -257,7 +293,7 @@ static void audio_pga_start_tag(void *data, const XML_Char *tag_name,
 		const XML_Char **attr)
 {
 	struct config_parse_state *state = data;
-	struct audio_pga *pga = state->pga;
+	struct pga_config *pga = state->pga;
 	unsigned int i;
 	int value;
 	struct mixer_ctl *ctl;
@@ -358,44 +394,26 @@ static void audio_pga_mixer_set(struct mixer_ctl *ctl, int new_value)
 		mixer_ctl_set_value(ctl, i, new_value);
 }
 
-static void audio_pga_set(struct mixer_ctl *ctl, int value,
-		struct pga_attribute_item *attribute_item)
+static void audio_pga_set(const struct pga_table_item *item, int value)
 {
-	unsigned int mask;
-
-	mask = (1 << fls(attribute_item->max)) - 1;
-	value &= mask;
-	if (attribute_item->inverse) {
-		value = attribute_item->max - value;
+	value &= item->mask;
+	if (item->inverse) {
+		value = item->max - value;
 	}
-	ALOGI("'%s' set to %d", mixer_ctl_get_name_d(ctl), value);
-	audio_pga_mixer_set(ctl, value);
+	ALOGI("'%s' set to %d", mixer_ctl_get_name_d(item->ctl), value);
+	audio_pga_mixer_set(item->ctl, value);
 }
 
-/* Initialises and frees the audio PGA */
-struct audio_pga *audio_pga_init(struct mixer *mixer)
+static int pga_config_load(struct pga_config *pga, struct mixer *mixer)
 {
 	struct config_parse_state state;
 	XML_Parser parser;
 	FILE *file;
 	int bytes_read;
 	void *buf;
-	int i;
-	struct audio_pga *pga;
-
-	pga = calloc(1, sizeof(struct audio_pga));
-	if (!pga)
-		goto err_calloc;
 
+	memset(pga, 0, sizeof(*pga));
 	pga->mixer = mixer;
-	if (!pga->mixer) {
-		ALOGE("Unable to open the mixer, aborting.");
-		goto err_mixer_open;
-	}
-
-	pga->profile = NULL;
-	pga->num_pga_profiles = 0;
-	pga->pga_profile_size = 0;
 
 	file = fopen(PGA_XML_PATH, "r");
 	if (!file) {
@@ -435,13 +453,165 @@ struct audio_pga *audio_pga_init(struct mixer *mixer)
 
 	XML_ParserFree(parser);
 	fclose(file);
-	return pga;
+	return 0;
 
 err_parse:
 	XML_ParserFree(parser);
 err_parser_create:
 	fclose(file);
 err_fopen:
+	return -1;
+}
+
+static void pga_config_free(struct pga_config *pga)
+{
+	int i;
+
+	for (i = 0; i < pga->num_pga_profiles; i++) {
+		if (pga->profile[i].name)
+			free(pga->profile[i].name);
+		if (pga->profile[i].item)
+			free(pga->profile[i].item);
+	}
+	free(pga->profile);
+	free(pga->attribute.item);
+}
+
+/* FNV-1a */
+static uint32_t pga_name_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static struct pga_table_profile *pga_table_lookup(const struct pga_table *table,
+		const char *name)
+{
+	uint32_t hash = pga_name_hash(name);
+	unsigned int slot = hash & table->hash_mask;
+	struct pga_table_profile *profile;
+
+	while (table->hash_index[slot]) {
+		profile = &table->profile[table->hash_index[slot] - 1];
+		if (profile->hash == hash && strcmp(profile->name, name) == 0)
+			return profile;
+		slot = (slot + 1) & table->hash_mask;
+	}
+
+	return NULL;
+}
+
+/* Lays the table out in a single allocation: the header, the hash index, the
+ * profiles, their items and then the names.
+ */
+static struct pga_table *pga_table_build(struct pga_config *pga)
+{
+	struct pga_table *table;
+	struct pga_table_item *item;
+	struct pga_attribute_item *attribute_item;
+	char *name;
+	unsigned int hash_size = 8;
+	size_t num_items = 0, names_size = 0, size;
+	unsigned int slot;
+	int i, j;
+
+	for (i = 0; i < pga->num_pga_profiles; i++) {
+		num_items += pga->profile[i].length;
+		names_size += strlen(pga->profile[i].name) + 1;
+	}
+	/* keep the load factor at or below one half */
+	while (hash_size < 2 * (unsigned int)pga->num_pga_profiles)
+		hash_size *= 2;
+
+	size = sizeof(*table) + hash_size * sizeof(uint16_t);
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	table = calloc(1, size + pga->num_pga_profiles * sizeof(struct pga_table_profile)
+			+ num_items * sizeof(struct pga_table_item) + names_size);
+	if (!table)
+		return NULL;
+
+	table->hash_mask = hash_size - 1;
+	table->hash_index = (uint16_t *)(table + 1);
+	table->profile = (struct pga_table_profile *)((char *)table + size);
+	item = (struct pga_table_item *)(table->profile + pga->num_pga_profiles);
+	name = (char *)(item + num_items);
+
+	for (i = 0; i < pga->num_pga_profiles; i++) {
+		struct pga_table_profile *profile = &table->profile[i];
+
+		strcpy(name, pga->profile[i].name);
+		profile->name = name;
+		profile->hash = pga_name_hash(name);
+		profile->item = item;
+		name += strlen(name) + 1;
+
+		for (j = 0; j < pga->profile[i].length; j++) {
+			struct mixer_ctl *ctl = pga->profile[i].item[j].ctl;
+
+			attribute_item = ctl ? attribute_get_by_ctl(&pga->attribute, ctl) : NULL;
+			if (!attribute_item) {
+				ALOGE("'%s' item %d has no mixer attribute, dropped",
+						profile->name, j);
+				continue;
+			}
+			item->ctl = ctl;
+			item->bit = pga->profile[i].item[j].bit;
+			item->mask = (1 << fls(attribute_item->max)) - 1;
+			item->max = attribute_item->max;
+			item->inverse = attribute_item->inverse;
+			item++;
+			profile->length++;
+		}
+
+		slot = profile->hash & table->hash_mask;
+		while (table->hash_index[slot])
+			slot = (slot + 1) & table->hash_mask;
+		table->hash_index[slot] = i + 1;
+	}
+	table->num_profiles = pga->num_pga_profiles;
+
+	return table;
+}
+
+static struct pga_table *pga_table_load(struct mixer *mixer)
+{
+	struct pga_config config;
+	struct pga_table *table = NULL;
+
+	if (pga_config_load(&config, mixer) == 0)
+		table = pga_table_build(&config);
+	pga_config_free(&config);
+
+	return table;
+}
+
+/* Initialises and frees the audio PGA */
+struct audio_pga *audio_pga_init(struct mixer *mixer)
+{
+	struct audio_pga *pga;
+
+	pga = calloc(1, sizeof(struct audio_pga));
+	if (!pga)
+		goto err_calloc;
+
+	pga->mixer = mixer;
+	if (!pga->mixer) {
+		ALOGE("Unable to open the mixer, aborting.");
+		goto err_mixer_open;
+	}
+
+	pga->table = pga_table_load(mixer);
+	if (!pga->table)
+		goto err_load;
+
+	return pga;
+
+err_load:
 err_mixer_open:
 	free(pga);
 	pga = NULL;
@@ -451,28 +621,19 @@ err_calloc:
 
 void audio_pga_free(struct audio_pga *pga)
 {
-	int i;
-
 	if (!pga) {
 		ALOGE("PGA is NULL");
 		return;
 	}
 
-	for (i = 0; i < pga->num_pga_profiles; i++) {
-		if (pga->profile[i].name)
-			free(pga->profile[i].name);
-		if (pga->profile[i].item)
-			free(pga->profile[i].item);
-	}
-	free(pga->profile);
-	free(pga->attribute.item);
+	free(pga->table);
 	free(pga);
 }
 
 /* Applies an audio pga by name */
 int audio_pga_apply(struct audio_pga *pga, int val, const char *name)
 {
-	struct pga_profile *profile = NULL;
+	struct pga_table_profile *profile = NULL;
 	int i;
 
 	if (!pga) {
@@ -482,15 +643,14 @@ int audio_pga_apply(struct audio_pga *pga, int val, const char *name)
 
 	ALOGD("'%s' apply", name);
 
-	profile = profile_get_by_name(pga, name);
+	profile = pga_table_lookup(pga->table, name);
 	if (!profile) {
 		ALOGE("Profile name '%s' is not exists", name);
 		return -1;
 	}
 
 	for (i = 0; i < profile->length; i++) {
-		audio_pga_set(profile->item[i].ctl, (val >> profile->item[i].bit),
-				attribute_get_by_ctl(&pga->attribute, profile->item[i].ctl));
+		audio_pga_set(&profile->item[i], val >> profile->item[i].bit);
 	}
 
 	return 0;
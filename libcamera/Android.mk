@@ -13,6 +13,7 @@ LOCAL_C_INCLUDES := \
 	$(LOCAL_PATH)/vsp/sc8810/src \
 	$(LOCAL_PATH)/jpeg_fw_8810/inc \
 	$(LOCAL_PATH)/jpeg_fw_8810/src \
+	$(LOCAL_PATH)/jpeg_fw_common/inc \
 	external/skia/include/images \
 	external/skia/include/core\
         external/jhead \
@@ -26,26 +27,26 @@ LOCAL_SRC_FILES:= \
 	sc8810/SprdOEMCamera.cpp \
         sc8810/SprdCameraHardwareInterface.cpp \
 	vsp/sc8810/src/vsp_drv_sc8810.c \
-	jpeg_fw_8810/src/jpegcodec_bufmgr.c \
-	jpeg_fw_8810/src/jpegcodec_global.c \
-	jpeg_fw_8810/src/jpegcodec_table.c \
+	jpeg_fw_common/src/jpegcodec_bufmgr.c \
+	jpeg_fw_common/src/jpegcodec_global.c \
+	jpeg_fw_common/src/jpegcodec_table.c \
 	jpeg_fw_8810/src/jpegenc_bitstream.c \
-	jpeg_fw_8810/src/jpegenc_frame.c \
+	jpeg_fw_common/src/jpegenc_frame.c \
 	jpeg_fw_8810/src/jpegenc_header.c \
 	jpeg_fw_8810/src/jpegenc_init.c \
 	jpeg_fw_8810/src/jpegenc_interface.c \
-	jpeg_fw_8810/src/jpegenc_malloc.c \
+	jpeg_fw_common/src/jpegenc_malloc.c \
 	jpeg_fw_8810/src/jpegenc_api.c \
-        jpeg_fw_8810/src/jpegdec_bitstream.c \
+        jpeg_fw_common/src/jpegdec_bitstream.c \
 	jpeg_fw_8810/src/jpegdec_frame.c \
 	jpeg_fw_8810/src/jpegdec_init.c \
 	jpeg_fw_8810/src/jpegdec_interface.c \
-	jpeg_fw_8810/src/jpegdec_malloc.c \
-	jpeg_fw_8810/src/jpegdec_dequant.c	\
+	jpeg_fw_common/src/jpegdec_malloc.c \
+	jpeg_fw_common/src/jpegdec_dequant.c	\
 	jpeg_fw_8810/src/jpegdec_out.c \
-	jpeg_fw_8810/src/jpegdec_parse.c \
-	jpeg_fw_8810/src/jpegdec_pvld.c \
-	jpeg_fw_8810/src/jpegdec_vld.c \
+	jpeg_fw_common/src/jpegdec_parse.c \
+	jpeg_fw_common/src/jpegdec_pvld.c \
+	jpeg_fw_common/src/jpegdec_vld.c \
 	jpeg_fw_8810/src/jpegdec_api.c \
 	jpeg_fw_8810/src/exif_writer.c \
 	jpeg_fw_8810/src/jpeg_stream.c
@@ -60,6 +61,7 @@ LOCAL_C_INCLUDES := \
 	$(LOCAL_PATH)/vsp/sc8825/src \
 	$(LOCAL_PATH)/jpeg_fw_8825/inc \
 	$(LOCAL_PATH)/jpeg_fw_8825/src \
+	$(LOCAL_PATH)/jpeg_fw_common/inc \
 	$(LOCAL_PATH)/sc8825/inc \
 	$(LOCAL_PATH)/sc8825/isp/inc \
 	external/skia/include/images \
@@ -76,6 +78,7 @@ LOCAL_SRC_FILES:= \
 	sc8825/src/cmr_oem.c \
 	sc8825/src/cmr_set.c \
 	sc8825/src/cmr_mem.c \
+	sc8825/src/cmr_trace.c \
 	sc8825/src/cmr_msg.c \
 	sc8825/src/cmr_cvt.c \
 	sc8825/src/cmr_v4l2.c \
@@ -97,26 +100,27 @@ LOCAL_SRC_FILES:= \
 	sensor/sensor_ov5640_mipi_raw.c \
 	sensor/sensor_hi351_mipi.c \
 	vsp/sc8825/src/vsp_drv_sc8825.c \
-	jpeg_fw_8825/src/jpegcodec_bufmgr.c \
-	jpeg_fw_8825/src/jpegcodec_global.c \
-	jpeg_fw_8825/src/jpegcodec_table.c \
+	jpeg_fw_common/src/jpegcodec_bufmgr.c \
+	jpeg_fw_common/src/jpegcodec_global.c \
+	jpeg_fw_common/src/jpegcodec_table.c \
 	jpeg_fw_8825/src/jpegenc_bitstream.c \
-	jpeg_fw_8825/src/jpegenc_frame.c \
+	jpeg_fw_common/src/jpegenc_frame.c \
 	jpeg_fw_8825/src/jpegenc_header.c \
 	jpeg_fw_8825/src/jpegenc_init.c \
 	jpeg_fw_8825/src/jpegenc_interface.c \
-	jpeg_fw_8825/src/jpegenc_malloc.c \
+	jpeg_fw_common/src/jpegenc_malloc.c \
 	jpeg_fw_8825/src/jpegenc_api.c \
-        jpeg_fw_8825/src/jpegdec_bitstream.c \
+	jpeg_fw_8825/src/jpegenc_progressive.c \
+        jpeg_fw_common/src/jpegdec_bitstream.c \
 	jpeg_fw_8825/src/jpegdec_frame.c \
 	jpeg_fw_8825/src/jpegdec_init.c \
 	jpeg_fw_8825/src/jpegdec_interface.c \
-	jpeg_fw_8825/src/jpegdec_malloc.c \
-	jpeg_fw_8825/src/jpegdec_dequant.c	\
+	jpeg_fw_common/src/jpegdec_malloc.c \
+	jpeg_fw_common/src/jpegdec_dequant.c	\
 	jpeg_fw_8825/src/jpegdec_out.c \
-	jpeg_fw_8825/src/jpegdec_parse.c \
-	jpeg_fw_8825/src/jpegdec_pvld.c \
-	jpeg_fw_8825/src/jpegdec_vld.c \
+	jpeg_fw_common/src/jpegdec_parse.c \
+	jpeg_fw_common/src/jpegdec_pvld.c \
+	jpeg_fw_common/src/jpegdec_vld.c \
 	jpeg_fw_8825/src/jpegdec_api.c  \
 	jpeg_fw_8825/src/exif_writer.c  \
 	jpeg_fw_8825/src/jpeg_stream.c \
@@ -132,6 +136,7 @@ LOCAL_C_INCLUDES := \
 	$(LOCAL_PATH)/vsp/sc8825/src \
 	$(LOCAL_PATH)/jpeg_fw_8825/inc \
 	$(LOCAL_PATH)/jpeg_fw_8825/src \
+	$(LOCAL_PATH)/jpeg_fw_common/inc \
 	$(LOCAL_PATH)/sc8825/inc \
 	$(LOCAL_PATH)/sc8825/isp/inc \
 	external/skia/include/images \
@@ -148,6 +153,7 @@ LOCAL_SRC_FILES:= \
 	sc8825/src/cmr_oem.c \
 	sc8825/src/cmr_set.c \
 	sc8825/src/cmr_mem.c \
+	sc8825/src/cmr_trace.c \
 	sc8825/src/cmr_msg.c \
 	sc8825/src/cmr_cvt.c \
 	sc8825/src/cmr_v4l2.c \
@@ -169,26 +175,27 @@ LOCAL_SRC_FILES:= \
 	sensor/sensor_ov5640_mipi_raw.c \
 	sensor/sensor_hi351_mipi.c \
 	vsp/sc8825/src/vsp_drv_sc8825.c \
-	jpeg_fw_8825/src/jpegcodec_bufmgr.c \
-	jpeg_fw_8825/src/jpegcodec_global.c \
-	jpeg_fw_8825/src/jpegcodec_table.c \
+	jpeg_fw_common/src/jpegcodec_bufmgr.c \
+	jpeg_fw_common/src/jpegcodec_global.c \
+	jpeg_fw_common/src/jpegcodec_table.c \
 	jpeg_fw_8825/src/jpegenc_bitstream.c \
-	jpeg_fw_8825/src/jpegenc_frame.c \
+	jpeg_fw_common/src/jpegenc_frame.c \
 	jpeg_fw_8825/src/jpegenc_header.c \
 	jpeg_fw_8825/src/jpegenc_init.c \
 	jpeg_fw_8825/src/jpegenc_interface.c \
-	jpeg_fw_8825/src/jpegenc_malloc.c \
+	jpeg_fw_common/src/jpegenc_malloc.c \
 	jpeg_fw_8825/src/jpegenc_api.c \
-        jpeg_fw_8825/src/jpegdec_bitstream.c \
+	jpeg_fw_8825/src/jpegenc_progressive.c \
+        jpeg_fw_common/src/jpegdec_bitstream.c \
 	jpeg_fw_8825/src/jpegdec_frame.c \
 	jpeg_fw_8825/src/jpegdec_init.c \
 	jpeg_fw_8825/src/jpegdec_interface.c \
-	jpeg_fw_8825/src/jpegdec_malloc.c \
-	jpeg_fw_8825/src/jpegdec_dequant.c	\
+	jpeg_fw_common/src/jpegdec_malloc.c \
+	jpeg_fw_common/src/jpegdec_dequant.c	\
 	jpeg_fw_8825/src/jpegdec_out.c \
-	jpeg_fw_8825/src/jpegdec_parse.c \
-	jpeg_fw_8825/src/jpegdec_pvld.c \
-	jpeg_fw_8825/src/jpegdec_vld.c \
+	jpeg_fw_common/src/jpegdec_parse.c \
+	jpeg_fw_common/src/jpegdec_pvld.c \
+	jpeg_fw_common/src/jpegdec_vld.c \
 	jpeg_fw_8825/src/jpegdec_api.c  \
 	jpeg_fw_8825/src/exif_writer.c  \
 	jpeg_fw_8825/src/jpeg_stream.c \
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The capture memory plan against the modes of every sc8825 sensor driver.
+ *
+ * The HAL sizes the capture frames with camera_capture_get_buffer_size() when
+ * the picture size is set, and rotation, thumbnail size and JPEG quality may
+ * be changed after that. For every mode and picture size the size query is
+ * made with each of those settings, and the smallest size reported has to hold
+ * the layout camera_arrange_capture_buf_plan() makes at the shot for each of
+ * them and each zoom trim, with every frame inside the major frame.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmr_mem.h"
+#include "host_log.h"
+#include "sensor_drv_u.h"
+
+#define CAP_PHY_BASE        0x10000000
+#define CAP_ZOOM_STEPS      4
+
+extern SENSOR_INFO_T g_ov5640_raw_info;
+extern SENSOR_INFO_T g_ov5640_yuv_info;
+extern SENSOR_INFO_T g_OV2640_yuv_info;
+extern SENSOR_INFO_T g_OV2655_yuv_info;
+extern SENSOR_INFO_T g_OV7675_yuv_info;
+extern SENSOR_INFO_T g_GC0309_yuv_info;
+extern SENSOR_INFO_T g_s5k5ccgx_yuv_info;
+extern SENSOR_INFO_T g_s5k5ccgx_yuv_info_mipi;
+extern SENSOR_INFO_T g_ov5640_mipi_yuv_info;
+extern SENSOR_INFO_T g_ov5640_mipi_raw_info;
+extern SENSOR_INFO_T g_hi351_mipi_yuv_info;
+
+/* the drivers libcamera builds for sc8825, sensor_cfg.c picks from them */
+static SENSOR_INFO_T *const sensors[] = {
+    &g_ov5640_raw_info,
+    &g_ov5640_yuv_info,
+    &g_OV2640_yuv_info,
+    &g_OV2655_yuv_info,
+    &g_OV7675_yuv_info,
+    &g_GC0309_yuv_info,
+    &g_s5k5ccgx_yuv_info,
+    &g_s5k5ccgx_yuv_info_mipi,
+    &g_ov5640_mipi_yuv_info,
+    &g_ov5640_mipi_raw_info,
+    &g_hi351_mipi_yuv_info,
+};
+
+/* the picture sizes the HAL offers */
+static const struct img_size pictures[] = {
+    {320, 240}, {640, 480}, {1280, 960}, {1600, 1200}, {2048, 1536}, {2592, 1944},
+};
+
+/* {0, 0} is a shot without thumbnail */
+static const struct img_size thumbs[] = {
+    {0, 0}, {160, 120}, {176, 144}, {320, 240}, {640, 480},
+};
+
+static const uint32_t qualities[] = {0, 30, 60, 61, 70, 80, 81, 95, 100};
+
+/* the same mapping as camera_capture_get_buffer_size() */
+static uint32_t mode_fmt(const SENSOR_INFO_T *sn, const SENSOR_REG_TAB_INFO_T *res)
+{
+    SENSOR_IMAGE_FORMAT fmt = sn->image_format;
+
+    if (SENSOR_IMAGE_FORMAT_MAX == fmt)
+        fmt = res->image_format;
+    if (SENSOR_IMAGE_FORMAT_RAW == fmt)
+        return IMG_DATA_TYPE_RAW;
+    if (SENSOR_IMAGE_FORMAT_JPEG == fmt)
+        return IMG_DATA_TYPE_JPEG;
+    return IMG_DATA_TYPE_YUV420;
+}
+
+static void set_shot(struct cmr_cap_plan_param *param, uint32_t i)
+{
+    uint32_t n_thum = sizeof(thumbs) / sizeof(thumbs[0]);
+    uint32_t n_qual = sizeof(qualities) / sizeof(qualities[0]);
+
+    param->jpeg_quality = qualities[i % n_qual];
+    param->thum_size = thumbs[(i / n_qual) % n_thum];
+    param->need_rot = (i / (n_qual * n_thum)) & 1;
+}
+
+static int frm_fits(const char *name, uint32_t addr, uint32_t size, uint32_t total)
+{
+    if (0 == addr && 0 == size)
+        return 1;
+    if (addr < CAP_PHY_BASE || addr + size > CAP_PHY_BASE + total) {
+        fprintf(stderr, "  %s 0x%x size 0x%x is outside 0x%x size 0x%x\n",
+                name, addr, size, CAP_PHY_BASE, total);
+        return 0;
+    }
+    return 1;
+}
+
+static int yuv_fits(const char *name, const struct img_frm *frm, uint32_t total)
+{
+    uint32_t y = frm->size.width * frm->size.height;
+
+    if (0 == frm->addr_phy.addr_y)
+        return 1;
+    if (0 == frm->addr_phy.addr_u)
+        return frm_fits(name, frm->addr_phy.addr_y, y * 3 / 2, total);
+    return frm_fits(name, frm->addr_phy.addr_y, y, total) &&
+        frm_fits(name, frm->addr_phy.addr_u, y / 2, total);
+}
+
+static int shot_fits(const struct cmr_cap_plan_param *param, const struct cmr_cap_mem *mem,
+        uint32_t total)
+{
+    uint32_t thum = param->thum_size.width * param->thum_size.height * 3 / 2;
+
+    if (mem->thum_yuv.buf_size < thum) {
+        fprintf(stderr, "  thum_yuv 0x%x is smaller than the thumbnail 0x%x\n",
+                mem->thum_yuv.buf_size, thum);
+        return 0;
+    }
+    if (param->need_rot && 0 == mem->cap_yuv_rot.buf_size) {
+        fprintf(stderr, "  no rotation buffer\n");
+        return 0;
+    }
+    return yuv_fits("target_yuv", &mem->target_yuv, total) &&
+        yuv_fits("cap_yuv", &mem->cap_yuv, total) &&
+        yuv_fits("cap_yuv_rot", &mem->cap_yuv_rot, total) &&
+        frm_fits("cap_raw", mem->cap_raw.addr_phy.addr_y,
+                mem->cap_raw.addr_phy.addr_y ? mem->cap_raw.buf_size : 0, total) &&
+        frm_fits("target_jpeg", mem->target_jpeg.addr_phy.addr_y - JPEG_EXIF_SIZE,
+                mem->target_jpeg.buf_size + JPEG_EXIF_SIZE, total) &&
+        frm_fits("thum_yuv", mem->thum_yuv.addr_phy.addr_y, mem->thum_yuv.buf_size, total) &&
+        frm_fits("thum_jpeg", mem->thum_jpeg.addr_phy.addr_y, mem->thum_jpeg.buf_size, total) &&
+        frm_fits("jpeg_tmp", mem->jpeg_tmp.addr_phy.addr_y, mem->jpeg_tmp.buf_size, total) &&
+        frm_fits("scale_tmp", mem->scale_tmp.addr_phy.addr_y, mem->scale_tmp.buf_size, total);
+}
+
+static void print_param(const char *sn_name, uint32_t mode, const struct cmr_cap_plan_param *p)
+{
+    fprintf(stderr, "%s mode %d fmt %d: image %dx%d sensor %dx%d trim %d,%d %dx%d cap %dx%d "
+            "thum %dx%d rot %d quality %d\n",
+            sn_name, mode, p->orig_fmt,
+            p->image_size.width, p->image_size.height,
+            p->sn_size.width, p->sn_size.height,
+            p->sn_trim.start_x, p->sn_trim.start_y, p->sn_trim.width, p->sn_trim.height,
+            p->cap_size.width, p->cap_size.height,
+            p->thum_size.width, p->thum_size.height,
+            p->need_rot, p->jpeg_quality);
+}
+
+/*
+ * One sensor mode at one picture size, returns the number of failed shots.
+ * The query and the shot set up the parameters as camera_capture_get_buffer_size()
+ * and the capture path of SprdOEMCamera.c do.
+ */
+static int test_mode(const SENSOR_INFO_T *sn, uint32_t mode, const struct img_size *picture,
+        uint32_t *cases)
+{
+    const SENSOR_REG_TAB_INFO_T *res = &sn->resolution_tab_info_ptr[mode];
+    uint32_t n_shot = 2 * (sizeof(thumbs) / sizeof(thumbs[0])) *
+        (sizeof(qualities) / sizeof(qualities[0]));
+    struct cmr_cap_plan_param param;
+    struct cmr_cap_2_frm frm;
+    struct cmr_cap_mem mem[CMR_IMG_CNT_MAX];
+    uint32_t size_major, size_minor, size = 0, i, z;
+    int failed = 0;
+
+    memset(&param, 0, sizeof(param));
+    param.camera_id = 0;
+    param.orig_fmt = mode_fmt(sn, res);
+    param.image_size.width = MAX(picture->width, res->width);
+    param.image_size.height = MAX(picture->height, res->height);
+    param.sn_size = param.image_size;
+    param.cap_size = param.image_size;
+    param.thum_from_cap = 1;
+    param.image_cnt = 1;
+
+    for (i = 0; i < n_shot; i++) {
+        set_shot(&param, i);
+        host_log_reset();
+        if (camera_capture_plan_buf_size(&param, &size_major, &size_minor)) {
+            print_param(sn->name, mode, &param);
+            fprintf(stderr, "  size query failed\n%s", host_log_buf);
+            return 1;
+        }
+        if (0 == size || size_major + size_minor < size)
+            size = size_major + size_minor;
+    }
+
+    param.sn_size.width = res->width;
+    param.sn_size.height = res->height;
+    for (z = 0; z < CAP_ZOOM_STEPS; z++) {
+        /* from no zoom to the largest, 1 / CMR_ZOOM_FACTOR of the sensor */
+        uint32_t cut_w = (res->width - res->width / CMR_ZOOM_FACTOR) * z / (CAP_ZOOM_STEPS - 1);
+        uint32_t cut_h = (res->height - res->height / CMR_ZOOM_FACTOR) * z / (CAP_ZOOM_STEPS - 1);
+
+        param.sn_trim.start_x = (cut_w >> 1) & ~1;
+        param.sn_trim.start_y = (cut_h >> 1) & ~1;
+        param.sn_trim.width = res->width - 2 * param.sn_trim.start_x;
+        param.sn_trim.height = res->height - 2 * param.sn_trim.start_y;
+        param.cap_size.width = param.sn_trim.width;
+        param.cap_size.height = param.sn_trim.height;
+
+        for (i = 0; i < n_shot; i++) {
+            set_shot(&param, i);
+            memset(&frm, 0, sizeof(frm));
+            frm.major_frm.buf_size = size;
+            frm.major_frm.addr_phy.addr_y = CAP_PHY_BASE;
+            frm.major_frm.addr_vir.addr_y = CAP_PHY_BASE;
+            host_log_reset();
+            (*cases)++;
+            if (camera_arrange_capture_buf_plan(&frm, &param, mem)) {
+                print_param(sn->name, mode, &param);
+                fprintf(stderr, "  no plan in the queried 0x%x\n%s", size, host_log_buf);
+                failed++;
+            } else if (!shot_fits(&param, &mem[0], size)) {
+                print_param(sn->name, mode, &param);
+                failed++;
+            }
+        }
+    }
+
+    return failed;
+}
+
+int main(void)
+{
+    uint32_t n_sensor = sizeof(sensors) / sizeof(sensors[0]);
+    uint32_t n_picture = sizeof(pictures) / sizeof(pictures[0]);
+    uint32_t s, mode, p, modes = 0, cases = 0;
+    int failed = 0;
+
+    for (s = 0; s < n_sensor; s++) {
+        const SENSOR_INFO_T *sn = sensors[s];
+
+        for (mode = SENSOR_MODE_PREVIEW_ONE; mode < SENSOR_MODE_MAX; mode++) {
+            const SENSOR_REG_TAB_INFO_T *res = &sn->resolution_tab_info_ptr[mode];
+
+            /* camera_get_sensor_capture_mode() only picks modes with a size */
+            if (0 == res->width || 0 == res->height)
+                continue;
+            modes++;
+            for (p = 0; p < n_picture; p++) {
+                failed += test_mode(sn, mode, &pictures[p], &cases);
+            }
+        }
+    }
+
+    printf("cap_plan: %d sensors, %d modes, %d shots, %d failed\n",
+           n_sensor, modes, cases, failed);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The APP1 template of exif_writer.c against a fresh Jpeg_WriteAPP1().
+ *
+ * A session of shots goes through IMGJPEG_WriteExif() the way
+ * _jpeg_enc_wexif() calls it, with the tags dc_cfg.c sets up and the
+ * per-shot fields camera_get_exif() fills in. Each output has to be the SOI
+ * marker, the APP1 Jpeg_WriteAPP1() writes for the same info and the main
+ * JPEG, byte for byte. The session changes the tag set, the thumbnail and
+ * the string lengths now and then, so the template is rebuilt as well as
+ * patched. Then both writers are timed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sci_types.h"
+#include "jpeg_exif_header.h"
+#include "exif_writer.h"
+#include "dc_cfg.h"
+#include "host_log.h"
+
+#define EXIF_SHOTS          32
+#define EXIF_BENCH_SHOTS    2000
+#define EXIF_THUMB_MAX      (32 * 1024)
+/* _jpeg_enc_wexif() gives the writer the thumbnail size and 21 KB */
+#define EXIF_TEMP_SIZE      (EXIF_THUMB_MAX + 21 * 1024)
+#define EXIF_SRC_SIZE       4096
+#define EXIF_TMPL_MSG       "template size"
+
+static EXIF_SPEC_PIC_TAKING_COND_T pic_taking;
+
+static uint8 thumb[EXIF_THUMB_MAX];
+static uint8 temp[EXIF_TEMP_SIZE];
+static uint8 ref[EXIF_TEMP_SIZE];
+/* the APP1 goes in front of the main JPEG, which sits at the end */
+static uint8 target[EXIF_TEMP_SIZE + EXIF_SRC_SIZE];
+static uint8 src[EXIF_SRC_SIZE];
+
+/* dc_cfg.c takes the picture taking conditions from the sensor driver */
+EXIF_SPEC_PIC_TAKING_COND_T *Sensor_GetSensorExifInfo(void)
+{
+    return &pic_taking;
+}
+
+static void fill(uint8 *buf, uint32 size, uint32 seed)
+{
+    uint32 i;
+
+    for (i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = (uint8)(seed >> 16);
+    }
+}
+
+/* a JPEG stream is all the writer looks at: SOI, data, EOI */
+static void make_jpeg(uint8 *buf, uint32 size, uint32 seed)
+{
+    fill(buf, size, seed);
+    buf[0] = 0xFF;
+    buf[1] = 0xD8;
+    buf[size - 2] = 0xFF;
+    buf[size - 1] = 0xD9;
+}
+
+static uint32 thumb_size(uint32 shot)
+{
+    /* every eighth shot has none, which drops IFD1 */
+    if (7 == shot % 8)
+        return 0;
+    return 6000 + shot * 397;
+}
+
+/* what camera_get_exif() changes from shot to shot */
+static JINF_EXIF_INFO_T *shot_exif(uint32 shot)
+{
+    static const uint16 orientations[] = {1, 6, 3, 8};
+    static const char ascii[] = {0x41, 0x53, 0x43, 0x49, 0x49, 0, 0, 0};
+    JINF_EXIF_INFO_T *info = DC_GetExifParameter();
+    EXIF_GPS_INFO_T *gps = info->gps_ptr;
+    const char *method = shot < 24 ? "GPS" : "NETWORK";
+    char datetime[20];
+
+    sprintf(datetime, "2026:10:19 12:%02u:%02u", shot / 60 % 60, shot % 60);
+
+    info->spec_ptr->basic.PixelXDimension = 2048 + 16 * (shot % 3);
+    info->spec_ptr->basic.PixelYDimension = 1536;
+    info->primary.basic.ImageWidth = info->spec_ptr->basic.PixelXDimension;
+    info->primary.basic.ImageLength = info->spec_ptr->basic.PixelYDimension;
+    info->primary.data_struct_ptr->valid.Orientation = 1;
+    info->primary.data_struct_ptr->Orientation = orientations[shot % 4];
+
+    strcpy((char *)info->primary.img_desc_ptr->DateTime, datetime);
+    /* the model string grows half way through */
+    if (shot >= EXIF_SHOTS / 2)
+        strcpy((char *)info->primary.img_desc_ptr->Model, "SP8825ea-host");
+    sprintf((char *)info->spec_ptr->other_ptr->ImageUniqueID, "IMAGE %s", datetime);
+    strcpy((char *)info->spec_ptr->date_time_ptr->DateTimeOriginal, datetime);
+    strcpy((char *)info->spec_ptr->date_time_ptr->DateTimeDigitized, datetime);
+
+    pic_taking.valid.ExposureTime = 1;
+    pic_taking.ExposureTime.numerator = 1;
+    pic_taking.ExposureTime.denominator = 30 + shot;
+    pic_taking.valid.FNumber = 1;
+    pic_taking.FNumber.numerator = 28;
+    pic_taking.FNumber.denominator = 10;
+    pic_taking.valid.Flash = 1;
+    pic_taking.Flash = shot & 1;
+    pic_taking.valid.WhiteBalance = 1;
+    pic_taking.WhiteBalance = (shot >> 1) & 1;
+    pic_taking.valid.FocalLength = 1;
+    pic_taking.FocalLength.numerator = 3500 + shot;
+    pic_taking.FocalLength.denominator = 1000;
+
+    /* a location from shot 12 on */
+    memset(&gps->valid, 0, sizeof(EXIF_GPS_VALID_T));
+    if (shot >= 12) {
+        gps->valid.GPSLatitudeRef = 1;
+        gps->GPSLatitudeRef[0] = shot & 1 ? 'N' : 'S';
+        gps->valid.GPSLatitude = 1;
+        gps->GPSLatitude[0].numerator = 31;
+        gps->GPSLatitude[0].denominator = 1;
+        gps->GPSLatitude[1].numerator = shot;
+        gps->GPSLatitude[1].denominator = 1;
+        gps->GPSLatitude[2].numerator = 1000 * shot + 7;
+        gps->GPSLatitude[2].denominator = 1000;
+        gps->valid.GPSLongitudeRef = 1;
+        gps->GPSLongitudeRef[0] = 'E';
+        gps->valid.GPSLongitude = 1;
+        gps->GPSLongitude[0].numerator = 121;
+        gps->GPSLongitude[0].denominator = 1;
+        gps->GPSLongitude[1].numerator = 4;
+        gps->GPSLongitude[1].denominator = 1;
+        gps->GPSLongitude[2].numerator = 2000 + shot;
+        gps->GPSLongitude[2].denominator = 1000;
+        gps->valid.GPSAltitudeRef = 1;
+        gps->valid.GPSAltitude = 1;
+        gps->GPSAltitude.numerator = 4 + shot;
+        gps->GPSAltitude.denominator = 1;
+        gps->valid.GPSProcessingMethod = 1;
+        gps->GPSProcessingMethod.count = strlen(method) + sizeof(ascii) + 1;
+        memcpy(gps->GPSProcessingMethod.ptr, ascii, sizeof(ascii));
+        strcpy(gps->GPSProcessingMethod.ptr + sizeof(ascii), method);
+        gps->valid.GPSTimeStamp = 1;
+        gps->GPSTimeStamp[0].numerator = 12;
+        gps->GPSTimeStamp[0].denominator = 1;
+        gps->GPSTimeStamp[1].numerator = shot / 60 % 60;
+        gps->GPSTimeStamp[1].denominator = 1;
+        gps->GPSTimeStamp[2].numerator = shot % 60;
+        gps->GPSTimeStamp[2].denominator = 1;
+        gps->valid.GPSDateStamp = 1;
+        strcpy((char *)gps->GPSDateStamp, "2026:10:19");
+    }
+
+    return info;
+}
+
+/* as _jpeg_enc_wexif() does it, the temp buffer holds whatever malloc left */
+static JINF_RET_E write_exif(JINF_EXIF_INFO_T *info, uint32 thumb_len,
+                             JINF_WEXIF_OUT_PARAM_T *out)
+{
+    JINF_WEXIF_IN_PARAM_T in;
+
+    memset(&in, 0, sizeof(in));
+    in.exif_info_ptr = info;
+    in.src_jpeg_buf_ptr = target + sizeof(target) - EXIF_SRC_SIZE;
+    in.src_jpeg_size = EXIF_SRC_SIZE;
+    in.thumbnail_buf_ptr = thumb_len ? thumb : PNULL;
+    in.thumbnail_buf_size = thumb_len;
+    in.temp_buf_ptr = temp;
+    in.temp_buf_size = thumb_len + 21 * 1024;
+    in.wrtie_file_func = PNULL;
+    in.target_buf_ptr = target;
+    in.target_buf_size = sizeof(target);
+    memcpy(in.src_jpeg_buf_ptr, src, EXIF_SRC_SIZE);
+
+    return IMGJPEG_WriteExif(&in, out);
+}
+
+static int test_shot(uint32 shot, uint32 *patched)
+{
+    JINF_EXIF_INFO_T *info = shot_exif(shot);
+    JINF_WEXIF_OUT_PARAM_T out;
+    uint32 thumb_len = thumb_size(shot);
+    uint32 app1_size = 0;
+    const uint8 *p;
+
+    make_jpeg(thumb, thumb_len ? thumb_len : 2, shot);
+    memset(ref, 0, sizeof(ref));
+    if (JPEG_SUCCESS != Jpeg_WriteAPP1(ref, thumb_len + 21 * 1024, info,
+                                       thumb_len ? thumb : PNULL, thumb_len, &app1_size)) {
+        fprintf(stderr, "shot %u: Jpeg_WriteAPP1 failed\n%s", shot, host_log_buf);
+        return 1;
+    }
+
+    host_log_reset();
+    fill(temp, sizeof(temp), ~shot);
+    memset(&out, 0, sizeof(out));
+    if (JINF_SUCCESS != write_exif(info, thumb_len, &out)) {
+        fprintf(stderr, "shot %u: IMGJPEG_WriteExif failed\n%s", shot, host_log_buf);
+        return 1;
+    }
+    if (!strstr(host_log_buf, EXIF_TMPL_MSG))
+        (*patched)++;
+
+    p = out.output_buf_ptr;
+    if (out.output_size != 2 + app1_size + EXIF_SRC_SIZE - 2
+        || p != target + sizeof(target) - EXIF_SRC_SIZE - app1_size
+        || p[0] != 0xFF || p[1] != 0xD8
+        || memcmp(p + 2, ref, app1_size)
+        || memcmp(p + 2 + app1_size, src + 2, EXIF_SRC_SIZE - 2)) {
+        uint32 i = 0;
+
+        while (i < app1_size && p[2 + i] == ref[i])
+            i++;
+        fprintf(stderr, "shot %u: output size %u, APP1 %u, first difference at APP1 byte %u\n%s",
+                shot, out.output_size, app1_size, i, host_log_buf);
+        return 1;
+    }
+    return 0;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* a session of shots with a thumbnail, as the camera takes them */
+static void bench(void)
+{
+    JINF_WEXIF_OUT_PARAM_T out;
+    uint32 thumb_len = thumb_size(1), app1_size, shot;
+    double start, writer, tmpl;
+
+    make_jpeg(thumb, thumb_len, 1);
+    IMGJPEG_ResetExifTemplate();
+
+    start = now_us();
+    for (shot = 0; shot < EXIF_BENCH_SHOTS; shot++)
+        Jpeg_WriteAPP1(ref, thumb_len + 21 * 1024, shot_exif(shot % 4), thumb, thumb_len,
+                       &app1_size);
+    writer = (now_us() - start) / EXIF_BENCH_SHOTS;
+
+    start = now_us();
+    for (shot = 0; shot < EXIF_BENCH_SHOTS; shot++)
+        write_exif(shot_exif(shot % 4), thumb_len, &out);
+    tmpl = (now_us() - start) / EXIF_BENCH_SHOTS;
+
+    printf("exif: APP1 of %u bytes with its thumbnail, Jpeg_WriteAPP1 %.2f us/shot,"
+           " IMGJPEG_WriteExif with the template %.2f us/shot\n",
+           app1_size, writer, tmpl);
+}
+
+int main(void)
+{
+    uint32 shot, patched = 0;
+    int failed = 0;
+
+    make_jpeg(src, EXIF_SRC_SIZE, 0x5eed);
+    for (shot = 0; shot < EXIF_SHOTS; shot++)
+        failed += test_shot(shot, &patched);
+    IMGJPEG_ResetExifTemplate();
+
+    printf("exif: %d shots, %u patched from the template, %d failed\n",
+           EXIF_SHOTS, patched, failed);
+    if (0 == patched) {
+        fprintf(stderr, "exif: the template was never used\n");
+        failed++;
+    }
+    if (!failed)
+        bench();
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <cutils/log.h>
+
+#include "host_log.h"
+
+char host_log_buf[HOST_LOG_SIZE];
+static size_t host_log_len;
+
+void host_test_log(const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    if (host_log_len >= HOST_LOG_SIZE - 1)
+        return;
+    va_start(ap, fmt);
+    n = vsnprintf(host_log_buf + host_log_len, HOST_LOG_SIZE - host_log_len - 1, fmt, ap);
+    va_end(ap);
+    if (n < 0)
+        return;
+    host_log_len += (size_t)n;
+    if (host_log_len > HOST_LOG_SIZE - 2)
+        host_log_len = HOST_LOG_SIZE - 2;
+    host_log_buf[host_log_len++] = '\n';
+    host_log_buf[host_log_len] = '\0';
+}
+
+void host_log_reset(void)
+{
+    host_log_len = 0;
+    host_log_buf[0] = '\0';
+}
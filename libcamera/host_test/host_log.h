@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* the messages host_test_log() kept for the current case */
+
+#ifndef HOST_TEST_HOST_LOG_H
+#define HOST_TEST_HOST_LOG_H
+
+#define HOST_LOG_SIZE       4096
+
+extern char host_log_buf[HOST_LOG_SIZE];
+
+void host_log_reset(void);
+
+#endif
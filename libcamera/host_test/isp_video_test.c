@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The ISP tuning video channel against tuning tools on the loopback.
+ *
+ * A preview thread hands isp_video.c a VGA frame every 33 ms with
+ * send_img_data(), as the preview callback of SprdCameraHardwareInterface
+ * does, while three tools ask the server for pictures: one reads as fast as
+ * it can, one through a small receive buffer at some 800 kB/s, and one asks
+ * once and never reads. The preview has to keep its cadence whatever the
+ * tools do. Every picture has to come whole and from a single frame, the
+ * fast tool has to get most frames and the throttled one the latest frame
+ * each time it asks, not the ones it missed.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "isp_param_tune_com.h"
+#include "isp_video.h"
+
+#define ISP_PORT            16666
+/* SEND_IMAGE_SIZE of isp_video.c, the data of one picture packet */
+#define ISP_PACKET_DATA     64512
+#define ISP_MSG_TYPE        0xfe
+#define ISP_GET_PICTURE     5
+#define ISP_FLAG            0x7e
+
+#define PREVIEW_WIDTH       640
+#define PREVIEW_HEIGHT      480
+#define PREVIEW_LEN         (PREVIEW_WIDTH * PREVIEW_HEIGHT * 3 / 2)
+#define PREVIEW_FORMAT      2
+#define PREVIEW_PERIOD_NS   33333333LL
+#define PREVIEW_FRAMES      90
+#define PREVIEW_SIZE_ID     3
+/* a frame starting more than a period after its slot is late, a loaded host
+ * makes a few of them, a preview stuck behind a tool all of them */
+#define PREVIEW_MAX_LATE    (PREVIEW_FRAMES / 10)
+/* of the preview time, send_img_data() only copies the frame */
+#define PREVIEW_MAX_CALL_PCT    5
+
+#define THROTTLE_RCVBUF     8192
+#define THROTTLE_CHUNK      8192
+#define THROTTLE_PAUSE_NS   10000000LL
+#define STALL_RCVBUF        4096
+#define CONNECT_MS          2000
+
+struct isp_msg_head {
+    uint32_t seq_num;
+    uint16_t len;
+    uint8_t type;
+    uint8_t subtype;
+} __attribute__((packed));
+
+struct isp_image_head {
+    uint32_t headlen;
+    uint32_t img_format;
+    uint32_t img_size;
+    uint32_t totalpacket;
+    uint32_t packetsn;
+};
+
+#define ISP_PICTURE_HEAD    (1 + sizeof(struct isp_msg_head) + sizeof(struct isp_image_head))
+
+struct tool {
+    const char *name;
+    int rcvbuf;             /* 0: the default of the host */
+    size_t chunk;           /* most bytes taken at once, 0: no limit */
+    int64_t pause_ns;       /* after each recv */
+    int stall;              /* asks for one picture and never reads */
+    int fd;
+    unsigned int pictures;
+    unsigned int skipped;   /* frames published between two of its pictures */
+    unsigned int bad;
+    uint32_t last_id;
+    int64_t wait_ns[PREVIEW_FRAMES];
+    uint8_t *buf;
+};
+
+static struct tool tools[] = {
+    { "fast", 0, 0, 0, 0 },
+    { "throttled", THROTTLE_RCVBUF, THROTTLE_CHUNK, THROTTLE_PAUSE_NS, 0 },
+    { "stalled", STALL_RCVBUF, 0, 0, 1 },
+};
+
+#define TOOLS   (sizeof(tools) / sizeof(tools[0]))
+
+static pthread_mutex_t ready_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ready_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int tools_ready;
+
+/* isp_video.c only asks the parser for the size id of a picture */
+uint32_t ispParserGetSizeID(uint32_t width, uint32_t height)
+{
+    return PREVIEW_SIZE_ID;
+}
+
+int32_t ispParser(uint32_t cmd, void *in_param_ptr, void *rtn_param_ptr)
+{
+    return -1;
+}
+
+uint32_t *ispParserAlloc(uint32_t size)
+{
+    return NULL;
+}
+
+int32_t ispParserFree(void *addr)
+{
+    return 0;
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t t)
+{
+    struct timespec ts;
+
+    ts.tv_sec = t / 1000000000LL;
+    ts.tv_nsec = t % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+static double ms(int64_t ns)
+{
+    return ns / 1e6;
+}
+
+static int cmp_ns(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* sorts the samples */
+static int64_t pct_ns(int64_t *ns, unsigned int n, unsigned int pct)
+{
+    if (!n)
+        return 0;
+    qsort(ns, n, sizeof(*ns), cmp_ns);
+    return ns[(n - 1) * pct / 100];
+}
+
+static int tool_connect(struct tool *t)
+{
+    struct sockaddr_in addr;
+    int64_t end = now_ns() + CONNECT_MS * 1000000LL;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(ISP_PORT);
+    /* the server thread may not listen yet */
+    do {
+        t->fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (t->fd < 0)
+            return -1;
+        if (t->rcvbuf)
+            setsockopt(t->fd, SOL_SOCKET, SO_RCVBUF, &t->rcvbuf, sizeof(t->rcvbuf));
+        if (!connect(t->fd, (struct sockaddr *)&addr, sizeof(addr)))
+            return 0;
+        close(t->fd);
+        t->fd = -1;
+        usleep(10000);
+    } while (now_ns() < end);
+
+    return -1;
+}
+
+static int tool_ask(struct tool *t)
+{
+    uint8_t req[sizeof(struct isp_msg_head) + 3];
+    struct isp_msg_head head;
+
+    memset(&head, 0, sizeof(head));
+    head.len = sizeof(head) + 1;
+    head.type = ISP_MSG_TYPE;
+    head.subtype = ISP_GET_PICTURE;
+    req[0] = ISP_FLAG;
+    memcpy(req + 1, &head, sizeof(head));
+    req[1 + sizeof(head)] = 0;  /* the image type, the server sends what it has */
+    req[2 + sizeof(head)] = ISP_FLAG;
+
+    return send(t->fd, req, sizeof(req), MSG_NOSIGNAL) == sizeof(req) ? 0 : -1;
+}
+
+static int tool_read(struct tool *t, uint8_t *buf, size_t len)
+{
+    size_t got = 0, n;
+    ssize_t res;
+
+    while (got < len) {
+        n = len - got;
+        if (t->chunk && n > t->chunk)
+            n = t->chunk;
+        res = recv(t->fd, buf + got, n, 0);
+        if (res <= 0)
+            return -1;
+        got += res;
+        if (t->pause_ns)
+            usleep(t->pause_ns / 1000);
+    }
+
+    return 0;
+}
+
+/* one picture, packet by packet, returns -1 when the socket is shut down */
+static int tool_read_picture(struct tool *t)
+{
+    struct isp_msg_head head;
+    struct isp_image_head image;
+    uint32_t packets = (PREVIEW_LEN + ISP_PACKET_DATA - 1) / ISP_PACKET_DATA;
+    uint32_t sn, len, id = 0, i;
+    uint8_t *p = t->buf;
+    int bad = 0;
+
+    for (sn = 1; sn <= packets; sn++) {
+        if (tool_read(t, p, 1 + sizeof(head)))
+            return -1;
+        memcpy(&head, p + 1, sizeof(head));
+        if (p[0] != ISP_FLAG || head.type != ISP_MSG_TYPE || head.subtype != ISP_GET_PICTURE ||
+            head.len + 2 < ISP_PICTURE_HEAD + 1 ||
+            head.len + 2 > ISP_PICTURE_HEAD + ISP_PACKET_DATA + 1) {
+            fprintf(stderr, "isp_video: %s: no picture packet, type 0x%x subtype %u len %u\n",
+                    t->name, head.type, head.subtype, head.len);
+            return -1;
+        }
+        if (tool_read(t, p + 1 + sizeof(head), head.len + 2 - 1 - sizeof(head)))
+            return -1;
+
+        memcpy(&image, p + 1 + sizeof(head), sizeof(image));
+        len = head.len + 2 - ISP_PICTURE_HEAD - 1;
+        if (image.packetsn != sn || image.totalpacket != packets ||
+            image.img_format != PREVIEW_FORMAT || image.img_size != PREVIEW_SIZE_ID ||
+            p[ISP_PICTURE_HEAD + len] != ISP_FLAG ||
+            len != (sn < packets ? ISP_PACKET_DATA : PREVIEW_LEN - (packets - 1) * ISP_PACKET_DATA))
+            bad = 1;
+        /* the preview fills each frame with its number */
+        if (sn == 1)
+            id = p[ISP_PICTURE_HEAD];
+        for (i = 0; i < len; i++)
+            if (p[ISP_PICTURE_HEAD + i] != id)
+                bad = 1;
+    }
+
+    if (bad || id <= t->last_id) {
+        fprintf(stderr, "isp_video: %s: picture %u is not frame %u whole, after frame %u\n",
+                t->name, t->pictures, id, t->last_id);
+        t->bad++;
+    } else if (t->pictures) {
+        t->skipped += id - t->last_id - 1;
+    }
+    t->last_id = id;
+
+    return 0;
+}
+
+static void *tool_thread(void *arg)
+{
+    struct tool *t = arg;
+    int64_t start;
+    int ok;
+
+    ok = !tool_connect(t);
+    pthread_mutex_lock(&ready_mutex);
+    tools_ready++;
+    pthread_cond_signal(&ready_cond);
+    pthread_mutex_unlock(&ready_mutex);
+    if (!ok) {
+        fprintf(stderr, "isp_video: %s: can not connect: %s\n", t->name, strerror(errno));
+        return NULL;
+    }
+
+    if (t->stall) {
+        tool_ask(t);
+        return NULL;
+    }
+    while (t->pictures < PREVIEW_FRAMES) {
+        start = now_ns();
+        if (tool_ask(t) || tool_read_picture(t))
+            break;
+        t->wait_ns[t->pictures++] = now_ns() - start;
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    int64_t call_ns[PREVIEW_FRAMES];
+    int64_t start, slot, t0, call_total = 0, preview_ns;
+    pthread_t threads[TOOLS];
+    unsigned int i, n, late = 0;
+    char *frame;
+    int failed = 0;
+
+    frame = malloc(PREVIEW_LEN);
+    for (i = 0; i < TOOLS; i++) {
+        tools[i].fd = -1;
+        tools[i].buf = malloc(ISP_PICTURE_HEAD + ISP_PACKET_DATA + 1);
+        if (!frame || !tools[i].buf) {
+            fprintf(stderr, "isp_video: out of memory\n");
+            return 1;
+        }
+    }
+
+    startispserver();
+    for (i = 0; i < TOOLS; i++)
+        pthread_create(&threads[i], NULL, tool_thread, &tools[i]);
+    pthread_mutex_lock(&ready_mutex);
+    while (tools_ready < TOOLS)
+        pthread_cond_wait(&ready_cond, &ready_mutex);
+    pthread_mutex_unlock(&ready_mutex);
+    /* let the server take the connections and the first requests */
+    usleep(50000);
+
+    start = now_ns();
+    for (n = 0; n < PREVIEW_FRAMES; n++) {
+        slot = start + n * PREVIEW_PERIOD_NS;
+        sleep_until_ns(slot);
+        memset(frame, n + 1, PREVIEW_LEN);
+        t0 = now_ns();
+        if (t0 - slot > PREVIEW_PERIOD_NS)
+            late++;
+        send_img_data(PREVIEW_FORMAT, PREVIEW_WIDTH, PREVIEW_HEIGHT, frame, PREVIEW_LEN);
+        call_ns[n] = now_ns() - t0;
+        call_total += call_ns[n];
+    }
+    preview_ns = now_ns() - start;
+
+    /* a tool waiting for a frame that will not come gets the end of the stream */
+    for (i = 0; i < TOOLS; i++) {
+        if (tools[i].fd >= 0)
+            shutdown(tools[i].fd, SHUT_RDWR);
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("isp_video: %u frames of %d bytes in %.0f ms, %u late, send_img_data p50 %.3f ms"
+           " p99 %.3f ms max %.3f ms, %.1f%% of the preview\n", PREVIEW_FRAMES, PREVIEW_LEN,
+           ms(preview_ns), late, ms(pct_ns(call_ns, PREVIEW_FRAMES, 50)),
+           ms(pct_ns(call_ns, PREVIEW_FRAMES, 99)), ms(pct_ns(call_ns, PREVIEW_FRAMES, 100)),
+           100.0 * call_total / preview_ns);
+    for (i = 0; i < TOOLS; i++) {
+        struct tool *t = &tools[i];
+
+        failed |= t->fd < 0;
+        close(t->fd);
+        if (t->stall)
+            continue;
+        printf("  %s: %u pictures, %u frames skipped, request to picture p50 %.1f ms"
+               " max %.1f ms\n", t->name, t->pictures, t->skipped,
+               ms(pct_ns(t->wait_ns, t->pictures, 50)), ms(pct_ns(t->wait_ns, t->pictures, 100)));
+        failed |= t->bad;
+    }
+
+    if (late > PREVIEW_MAX_LATE) {
+        fprintf(stderr, "isp_video: %u of %u frames late\n", late, PREVIEW_FRAMES);
+        failed = 1;
+    }
+    if (call_total * 100 > preview_ns * PREVIEW_MAX_CALL_PCT) {
+        fprintf(stderr, "isp_video: send_img_data took %.0f ms of %.0f ms\n",
+                ms(call_total), ms(preview_ns));
+        failed = 1;
+    }
+    /* the fast tool is served between two frames, the throttled one takes a
+     * few hundred ms a picture and has to get the latest frame each time */
+    if (tools[0].pictures < PREVIEW_FRAMES / 2) {
+        fprintf(stderr, "isp_video: the fast tool got %u of %u frames\n", tools[0].pictures,
+                PREVIEW_FRAMES);
+        failed = 1;
+    }
+    if (tools[1].pictures < 2 || !tools[1].skipped) {
+        fprintf(stderr, "isp_video: the throttled tool got %u pictures, %u frames skipped\n",
+                tools[1].pictures, tools[1].skipped);
+        failed = 1;
+    }
+
+    for (i = 0; i < TOOLS; i++)
+        free(tools[i].buf);
+    free(frame);
+    return failed;
+}
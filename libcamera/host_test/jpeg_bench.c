@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sizes and times the software progressive encoder of jpeg_fw_8825 against
+ * the baseline streams the VSP writes. The VSP can not run here, so the
+ * baseline is encoded by libjpeg with what the hardware uses: the quant
+ * tables of the same quality and the standard huffman tables. libjpeg also
+ * has to decode every progressive stream without a warning, close to the
+ * source.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "jpegenc_api.h"
+#include "jpegcodec_table.h"
+#include "jpeg_test.h"
+
+#define BENCH_POOL_SIZE     (256 << 20)
+#define BENCH_RUNS          3
+#define BENCH_MIN_PSNR      30.0
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* the planes libjpeg takes, cb and cr out of the VUVU of the capture */
+static void split_vu(const struct jpeg_case *c, const uint8_t *vu, uint8_t *cb, uint8_t *cr)
+{
+    uint32_t i, n = (c->width / 2) * (c->height / 2);
+
+    for (i = 0; i < n; i++) {
+        cr[i] = vu[2 * i];
+        cb[i] = vu[2 * i + 1];
+    }
+}
+
+static int bench_case(const struct jpeg_case *c, uint64_t *base_total, uint64_t *prog_total)
+{
+    JPEGENC_PARAMS_T params;
+    uint8_t *y, *vu, *cb, *cr;
+    unsigned char *base_buf = NULL;
+    unsigned long base_len = 0;
+    double start, prog_ms = 1e30, base_ms = 1e30, t, psnr;
+    int run;
+
+    jpeg_pool_reset();
+    y = jpeg_pool_alloc(c->width * c->height);
+    vu = jpeg_pool_alloc(c->width * c->height / 2);
+    cb = jpeg_pool_alloc(c->width * c->height / 4);
+    cr = jpeg_pool_alloc(c->width * c->height / 4);
+    memset(&params, 0, sizeof(params));
+    params.stream_buf_len = c->width * c->height * 2 + 4096;
+    params.stream_virt_buf[0] = jpeg_pool_alloc(params.stream_buf_len);
+    if (!y || !vu || !cb || !cr || !params.stream_virt_buf[0]) {
+        fprintf(stderr, "%s: out of memory\n", c->name);
+        return 1;
+    }
+    jpeg_picture(c, y, vu);
+    split_vu(c, vu, cb, cr);
+
+    params.format = JPEGENC_YUV_420;
+    params.width = c->width;
+    params.height = c->height;
+    params.quality = (JPEGENC_QUALITY_E)c->quality;
+    params.yuv_virt_buf = y;
+    params.yuv_u_virt_buf = vu;
+
+    /* the best of a few runs, the first one also pays for the page faults */
+    for (run = 0; run < BENCH_RUNS; run++) {
+        start = now_ms();
+        if (JPEGENC_Progressive_Encode(&params)) {
+            fprintf(stderr, "%s: progressive encode failed\n", c->name);
+            return 1;
+        }
+        t = now_ms() - start;
+        prog_ms = t < prog_ms ? t : prog_ms;
+
+        free(base_buf);
+        base_buf = NULL;
+        start = now_ms();
+        if (jpeg_libjpeg_encode(c, y, cb, cr, jpeg_fw_lum_quant_tbl_default[c->quality],
+                jpeg_fw_chr_quant_tbl_default[c->quality], &base_buf, &base_len)) {
+            fprintf(stderr, "%s: libjpeg baseline encode failed\n", c->name);
+            free(base_buf);
+            return 1;
+        }
+        t = now_ms() - start;
+        base_ms = t < base_ms ? t : base_ms;
+    }
+    free(base_buf);
+
+    if (jpeg_libjpeg_check(c, params.stream_virt_buf[0], params.stream_size, y, cb, cr, &psnr)) {
+        fprintf(stderr, "%s: libjpeg can not decode the progressive stream\n", c->name);
+        return 1;
+    }
+
+    printf("  %-9s %4ux%-4u q%u  baseline %8lu  progressive %8u  %+5.1f%%"
+           "  encode %8.2f ms (libjpeg baseline %7.2f ms)  libjpeg psnr %.1f\n",
+           c->name, c->width, c->height, c->quality, base_len, params.stream_size,
+           100.0 * ((double)params.stream_size - base_len) / base_len, prog_ms, base_ms, psnr);
+    *base_total += base_len;
+    *prog_total += params.stream_size;
+
+    if (psnr < BENCH_MIN_PSNR) {
+        fprintf(stderr, "%s: libjpeg decodes it to %.1f dB, under %.0f dB\n", c->name, psnr,
+                BENCH_MIN_PSNR);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    uint64_t base_total = 0, prog_total = 0;
+    unsigned int i, num = 0;
+    int failed = 0;
+
+    if (jpeg_pool_init(BENCH_POOL_SIZE))
+        return 1;
+    for (i = 0; i < jpeg_case_num; i++) {
+        /* the scaled cases only differ in the decode */
+        if (jpeg_cases[i].scale)
+            continue;
+        failed += bench_case(&jpeg_cases[i], &base_total, &prog_total);
+        num++;
+    }
+
+    printf("jpeg_bench: %u streams, progressive %+.1f%% against baseline, %s\n", num,
+           base_total ? 100.0 * ((double)prog_total - base_total) / base_total : 0.0,
+           failed ? "FAILED" : "ok");
+
+    return failed ? 1 : 0;
+}
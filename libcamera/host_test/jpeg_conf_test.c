@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Decodes the streams jpeg_corpus wrote with the decoder of one SoC tree,
+ * jpeg_fw_common built against that tree's headers. The baseline decode
+ * needs the VSP, the progressive one is done by the CPU, so the corpus is
+ * progressive. Every tree has to give the output in golden/jpeg_conf.txt,
+ * and the pictures have to come back close to what was encoded.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jpeg_fw_soc.h"
+#include "jpegcodec_def.h"
+#include "jpeg_fw_def.h"
+#include "jpeg_test.h"
+
+#define CONF_POOL_SIZE      (256 << 20)
+#define CONF_DEC_BUF_SIZE   (64 << 20)
+#define CONF_MIN_PSNR       30.0
+
+#ifndef JPEG_CONF_SOC
+#define JPEG_CONF_SOC       "soc"
+#endif
+
+static const char *golden_dir = "golden";
+static const char *corpus_dir = "out/corpus";
+static int update_golden;
+
+static uint8_t *read_stream(const struct jpeg_case *c, uint32_t *len)
+{
+    char path[256];
+    uint8_t *buf = NULL;
+    FILE *fp;
+    long n;
+
+    snprintf(path, sizeof(path), "%s/%s.jpg", corpus_dir, c->name);
+    fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "  no %s, jpeg_corpus writes it\n", path);
+        return NULL;
+    }
+    if (0 == fseek(fp, 0, SEEK_END) && (n = ftell(fp)) > 0 && 0 == fseek(fp, 0, SEEK_SET)) {
+        /* the bitstream reader may look a little past the end */
+        buf = jpeg_pool_alloc(n + 256);
+        if (buf && fread(buf, 1, n, fp) == (size_t)n)
+            *len = (uint32_t)n;
+        else
+            buf = NULL;
+    }
+    fclose(fp);
+    return buf;
+}
+
+/* the source down to the decoded size, by averaging scale x scale blocks */
+static uint32_t src_sample(const uint8_t *p, uint32_t stride, uint32_t step,
+        uint32_t x, uint32_t y, uint32_t s)
+{
+    uint32_t i, j, sum = 0;
+
+    for (j = 0; j < (1u << s); j++) {
+        for (i = 0; i < (1u << s); i++)
+            sum += p[((y << s) + j) * stride + ((x << s) + i) * step];
+    }
+    return (sum + (1u << (2 * s)) / 2) >> (2 * s);
+}
+
+static double psnr(double se, uint32_t n)
+{
+    if (0 == se)
+        return 99.0;
+    return 10 * log10(255.0 * 255.0 * n / se);
+}
+
+static int decode_case(const struct jpeg_case *c, FILE *out)
+{
+    JPEG_DEC_INPUT_PARA_T in;
+    JPEG_DEC_OUTPUT_PARA_T res;
+    uint32_t s = c->scale;
+    uint32_t w = c->width >> s, h = c->height >> s;
+    uint32_t out_w = ((c->width + 15) & ~15) >> s, out_h = ((c->height + 15) & ~15) >> s;
+    uint32_t len = 0, stride, x, y, hash_y, hash_uv;
+    uint8_t *stream, *src_y, *src_vu, *dst_y, *dst_uv;
+    double se_y = 0, se_cb = 0, se_cr = 0, p_y, p_cb, p_cr;
+    JPEG_RET_E ret;
+
+    jpeg_pool_reset();
+    stream = read_stream(c, &len);
+    src_y = jpeg_pool_alloc(c->width * c->height);
+    src_vu = jpeg_pool_alloc(c->width * c->height / 2);
+    dst_y = jpeg_pool_alloc(out_w * out_h);
+    dst_uv = jpeg_pool_alloc(out_w * out_h / 2);
+    memset(&in, 0, sizeof(in));
+    in.dec_buf.buf_size = CONF_DEC_BUF_SIZE;
+    in.dec_buf.buf_ptr = jpeg_pool_alloc(CONF_DEC_BUF_SIZE);
+    if (!stream || !src_y || !src_vu || !dst_y || !dst_uv || !in.dec_buf.buf_ptr) {
+        fprintf(stderr, "%s %s: no stream or out of memory\n", JPEG_CONF_SOC, c->name);
+        return 1;
+    }
+    jpeg_picture(c, src_y, src_vu);
+
+    in.data_type = 1;
+    in.scaling_down_factor = s;
+    in.bitstream_ptr = stream;
+    in.bitstream_len = len;
+    in.pingpong_buf_0_ptr = stream;
+    in.pingpong_buf_len = len + 256;
+    in.yuv_0_addr.y_data_ptr = dst_y;
+    in.yuv_0_addr.u_data_ptr = dst_uv;
+    in.yuv_1_addr = in.yuv_0_addr;
+    in.stream_buf0_valid = TRUE;
+    in.dbk_bfr0_valid = TRUE;
+    in.is_first_slice = TRUE;
+
+    ret = JPEG_FWParseHead(&in);
+    if (JPEG_SUCCESS == ret && !in.progressive_mode)
+        ret = JPEG_FAILED;
+    if (JPEG_SUCCESS == ret) {
+        /* as jpegdec_api.c does, the entropy coded data follows the header */
+        in.pingpong_buf_0_ptr = stream + in.header_len;
+        in.bitstream_len = len - in.header_len;
+        ret = JPEG_HWDecInit(&in);
+    }
+    if (JPEG_SUCCESS == ret)
+        ret = JPEG_HWDecStart((c->height + 15) & ~15, &res);
+    if (JPEG_SUCCESS != ret) {
+        fprintf(stderr, "%s %s: decode failed %d\n", JPEG_CONF_SOC, c->name, ret);
+        return 1;
+    }
+
+    /* the decoder writes UVUV, the source is VUVU */
+    stride = res.output_width;
+    hash_y = hash_uv = JPEG_HASH_INIT;
+    for (y = 0; y < h; y++) {
+        hash_y = jpeg_hash(hash_y, dst_y + y * stride, w);
+        for (x = 0; x < w; x++) {
+            double d = dst_y[y * stride + x] - (double)src_sample(src_y, c->width, 1, x, y, s);
+
+            se_y += d * d;
+        }
+    }
+    for (y = 0; y < h / 2; y++) {
+        hash_uv = jpeg_hash(hash_uv, dst_uv + y * stride, w & ~1);
+        for (x = 0; x < w / 2; x++) {
+            double cb = dst_uv[y * stride + 2 * x] -
+                (double)src_sample(src_vu + 1, c->width, 2, x, y, s);
+            double cr = dst_uv[y * stride + 2 * x + 1] -
+                (double)src_sample(src_vu, c->width, 2, x, y, s);
+
+            se_cb += cb * cb;
+            se_cr += cr * cr;
+        }
+    }
+    p_y = psnr(se_y, w * h);
+    p_cb = psnr(se_cb, (w / 2) * (h / 2));
+    p_cr = psnr(se_cr, (w / 2) * (h / 2));
+
+    fprintf(out, "%s %ux%u scale %u out %ux%u y %08x uv %08x psnr %.1f %.1f %.1f\n",
+            c->name, c->width, c->height, s, res.output_width, res.output_height,
+            hash_y, hash_uv, p_y, p_cb, p_cr);
+    if (p_y < CONF_MIN_PSNR || p_cb < CONF_MIN_PSNR || p_cr < CONF_MIN_PSNR) {
+        fprintf(stderr, "%s %s: psnr %.1f %.1f %.1f is under %.0f dB\n", JPEG_CONF_SOC,
+                c->name, p_y, p_cb, p_cr, CONF_MIN_PSNR);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-u] [-g golden_dir] [-c corpus_dir]\n"
+            "  -u  rewrite golden/jpeg_conf.txt instead of comparing\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int i;
+    int failed = 0;
+    FILE *out;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ug:c:")) != -1) {
+        switch (opt) {
+        case 'u':
+            update_golden = 1;
+            break;
+        case 'g':
+            golden_dir = optarg;
+            break;
+        case 'c':
+            corpus_dir = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (jpeg_pool_init(CONF_POOL_SIZE))
+        return 1;
+    jpeg_vsp_init();
+    out = jpeg_golden_begin();
+    for (i = 0; i < jpeg_case_num; i++)
+        failed += decode_case(&jpeg_cases[i], out);
+    /* a failed run only compares, it never rewrites the golden file */
+    failed += jpeg_golden_end(out, golden_dir, "jpeg_conf", update_golden && !failed);
+
+    printf("jpeg_conf %s: %u streams, %s\n", JPEG_CONF_SOC, jpeg_case_num,
+           failed ? "FAILED" : "ok");
+
+    return failed ? 1 : 0;
+}
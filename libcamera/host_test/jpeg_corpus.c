@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Encodes the conformance corpus with the software progressive encoder of
+ * jpeg_fw_8825, the only encoder that runs without the VSP, and writes the
+ * streams for jpeg_conf_test. The stream checksums are compared with
+ * golden/jpeg_corpus.txt.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jpegenc_api.h"
+#include "jpeg_test.h"
+
+#define CORPUS_POOL_SIZE    (256 << 20)
+
+static const char *golden_dir = "golden";
+static const char *corpus_dir = "out/corpus";
+static int update_golden;
+
+static int write_stream(const struct jpeg_case *c, const void *buf, uint32_t len)
+{
+    char path[256];
+    FILE *fp;
+    int ret = 0;
+
+    snprintf(path, sizeof(path), "%s/%s.jpg", corpus_dir, c->name);
+    fp = fopen(path, "wb");
+    if (!fp || fwrite(buf, 1, len, fp) != len) {
+        fprintf(stderr, "  can not write %s\n", path);
+        ret = 1;
+    }
+    if (fp)
+        fclose(fp);
+    return ret;
+}
+
+static int encode_case(const struct jpeg_case *c, FILE *out)
+{
+    JPEGENC_PARAMS_T params;
+    uint8_t *y, *vu;
+    int ret;
+
+    jpeg_pool_reset();
+    y = jpeg_pool_alloc(c->width * c->height);
+    vu = jpeg_pool_alloc(c->width * c->height / 2);
+    memset(&params, 0, sizeof(params));
+    params.stream_buf_len = c->width * c->height * 2 + 4096;
+    params.stream_virt_buf[0] = jpeg_pool_alloc(params.stream_buf_len);
+    if (!y || !vu || !params.stream_virt_buf[0]) {
+        fprintf(stderr, "%s: out of memory\n", c->name);
+        return 1;
+    }
+    jpeg_picture(c, y, vu);
+
+    params.format = JPEGENC_YUV_420;
+    params.width = c->width;
+    params.height = c->height;
+    params.quality = (JPEGENC_QUALITY_E)c->quality;
+    params.yuv_virt_buf = y;
+    params.yuv_u_virt_buf = vu;
+    ret = JPEGENC_Progressive_Encode(&params);
+    if (ret) {
+        fprintf(stderr, "%s: encode failed %d\n", c->name, ret);
+        return 1;
+    }
+
+    fprintf(out, "%s %ux%u quality %u bytes %u hash %08x\n", c->name, c->width, c->height,
+            c->quality, params.stream_size,
+            jpeg_hash(JPEG_HASH_INIT, params.stream_virt_buf[0], params.stream_size));
+    return write_stream(c, params.stream_virt_buf[0], params.stream_size);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-u] [-g golden_dir] [-o corpus_dir]\n"
+            "  -u  rewrite golden/jpeg_corpus.txt instead of comparing\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int i;
+    int failed = 0;
+    FILE *out;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ug:o:")) != -1) {
+        switch (opt) {
+        case 'u':
+            update_golden = 1;
+            break;
+        case 'g':
+            golden_dir = optarg;
+            break;
+        case 'o':
+            corpus_dir = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (jpeg_pool_init(CORPUS_POOL_SIZE))
+        return 1;
+    out = jpeg_golden_begin();
+    for (i = 0; i < jpeg_case_num; i++)
+        failed += encode_case(&jpeg_cases[i], out);
+    /* a failed run only compares, it never rewrites the golden file */
+    failed += jpeg_golden_end(out, golden_dir, "jpeg_corpus", update_golden && !failed);
+
+    printf("jpeg_corpus: %u streams, %s\n", jpeg_case_num, failed ? "FAILED" : "ok");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The host libjpeg side of jpeg_bench. jpeglib.h and the firmware headers
+ * both define jpeg_component_info, so it can not share a file with them.
+ */
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <jpeglib.h>
+
+#include "jpeg_test.h"
+
+struct libjpeg_err {
+    struct jpeg_error_mgr pub;
+    jmp_buf jmp;
+};
+
+static void libjpeg_error_exit(j_common_ptr cinfo)
+{
+    struct libjpeg_err *err = (struct libjpeg_err *)cinfo->err;
+
+    (*cinfo->err->output_message)(cinfo);
+    longjmp(err->jmp, 1);
+}
+
+/* a corrupt data warning is a failure of the encoder here, not noise */
+static void libjpeg_emit_message(j_common_ptr cinfo, int level)
+{
+    if (level < 0)
+        libjpeg_error_exit(cinfo);
+}
+
+/*
+ * The raw data interface of libjpeg reads and writes whole blocks of whole
+ * iMCU rows, so the planes are held at 16 x 16 MCU size. The edges are
+ * repeated into the padding, as Prog_TransformFrame does.
+ */
+static uint8_t *pad_plane(const uint8_t *src, uint32_t w, uint32_t h, uint32_t pw, uint32_t ph)
+{
+    uint8_t *p = jpeg_pool_alloc(pw * ph);
+    uint32_t x, y;
+
+    if (!p)
+        return NULL;
+    for (y = 0; y < ph; y++) {
+        const uint8_t *row = src + (y < h ? y : h - 1) * w;
+
+        for (x = 0; x < pw; x++)
+            p[y * pw + x] = row[x < w ? x : w - 1];
+    }
+    return p;
+}
+
+static void set_rows(JSAMPARRAY planes[3], uint8_t *p[3], uint32_t pw, uint32_t row)
+{
+    uint32_t i;
+
+    for (i = 0; i < 16; i++)
+        planes[0][i] = p[0] + (row + i) * pw;
+    for (i = 0; i < 8; i++) {
+        planes[1][i] = p[1] + (row / 2 + i) * (pw / 2);
+        planes[2][i] = p[2] + (row / 2 + i) * (pw / 2);
+    }
+}
+
+int jpeg_libjpeg_encode(const struct jpeg_case *c, uint8_t *y, uint8_t *cb, uint8_t *cr,
+        const uint8_t *lum_quant, const uint8_t *chr_quant, unsigned char **buf,
+        unsigned long *len)
+{
+    struct jpeg_compress_struct cinfo;
+    struct libjpeg_err err;
+    JSAMPROW y_rows[16], cb_rows[8], cr_rows[8];
+    JSAMPARRAY planes[3] = { y_rows, cb_rows, cr_rows };
+    uint32_t pw = (c->width + 15) & ~15u, ph = (c->height + 15) & ~15u;
+    unsigned int quant[64];
+    uint8_t *p[3];
+    uint32_t i, row;
+
+    p[0] = pad_plane(y, c->width, c->height, pw, ph);
+    p[1] = pad_plane(cb, c->width / 2, c->height / 2, pw / 2, ph / 2);
+    p[2] = pad_plane(cr, c->width / 2, c->height / 2, pw / 2, ph / 2);
+    if (!p[0] || !p[1] || !p[2])
+        return 1;
+
+    cinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = libjpeg_error_exit;
+    if (setjmp(err.jmp)) {
+        jpeg_destroy_compress(&cinfo);
+        return 1;
+    }
+    jpeg_create_compress(&cinfo);
+    jpeg_mem_dest(&cinfo, buf, len);
+    cinfo.image_width = c->width;
+    cinfo.image_height = c->height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_YCbCr;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_colorspace(&cinfo, JCS_YCbCr);
+    cinfo.raw_data_in = TRUE;
+    cinfo.dct_method = JDCT_ISLOW;
+    cinfo.optimize_coding = FALSE;
+    cinfo.comp_info[0].h_samp_factor = 2;
+    cinfo.comp_info[0].v_samp_factor = 2;
+    for (i = 1; i < 3; i++) {
+        cinfo.comp_info[i].h_samp_factor = 1;
+        cinfo.comp_info[i].v_samp_factor = 1;
+    }
+    for (i = 0; i < 64; i++)
+        quant[i] = lum_quant[i];
+    jpeg_add_quant_table(&cinfo, 0, quant, 100, TRUE);
+    for (i = 0; i < 64; i++)
+        quant[i] = chr_quant[i];
+    jpeg_add_quant_table(&cinfo, 1, quant, 100, TRUE);
+
+    jpeg_start_compress(&cinfo, TRUE);
+    for (row = 0; row < ph; row += 16) {
+        set_rows(planes, p, pw, row);
+        jpeg_write_raw_data(&cinfo, planes, 16);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return 0;
+}
+
+static double plane_psnr(const uint8_t *a, uint32_t a_stride, const uint8_t *b, uint32_t w,
+        uint32_t h)
+{
+    double se = 0, d;
+    uint32_t x, y;
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++) {
+            d = (double)a[y * a_stride + x] - b[y * w + x];
+            se += d * d;
+        }
+    }
+    if (0 == se)
+        return 99.0;
+    return 10 * log10(255.0 * 255.0 * w * h / se);
+}
+
+int jpeg_libjpeg_check(const struct jpeg_case *c, const uint8_t *stream, uint32_t len,
+        uint8_t *y, uint8_t *cb, uint8_t *cr, double *psnr)
+{
+    struct jpeg_decompress_struct dinfo;
+    struct libjpeg_err err;
+    JSAMPROW y_rows[16], cb_rows[8], cr_rows[8];
+    JSAMPARRAY planes[3] = { y_rows, cb_rows, cr_rows };
+    uint32_t pw = (c->width + 15) & ~15u, ph = (c->height + 15) & ~15u;
+    uint32_t cw = c->width / 2, ch = c->height / 2, row;
+    uint8_t *p[3];
+    double cb_psnr, cr_psnr;
+
+    p[0] = jpeg_pool_alloc(pw * ph);
+    p[1] = jpeg_pool_alloc(pw * ph / 4);
+    p[2] = jpeg_pool_alloc(pw * ph / 4);
+    if (!p[0] || !p[1] || !p[2])
+        return 1;
+
+    dinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = libjpeg_error_exit;
+    err.pub.emit_message = libjpeg_emit_message;
+    if (setjmp(err.jmp)) {
+        jpeg_destroy_decompress(&dinfo);
+        return 1;
+    }
+    jpeg_create_decompress(&dinfo);
+    jpeg_mem_src(&dinfo, (unsigned char *)stream, len);
+    jpeg_read_header(&dinfo, TRUE);
+    if (!jpeg_has_multiple_scans(&dinfo) || 3 != dinfo.num_components ||
+            2 != dinfo.comp_info[0].h_samp_factor || 2 != dinfo.comp_info[0].v_samp_factor) {
+        fprintf(stderr, "%s: not a 420 progressive stream\n", c->name);
+        jpeg_destroy_decompress(&dinfo);
+        return 1;
+    }
+    dinfo.raw_data_out = TRUE;
+    dinfo.dct_method = JDCT_ISLOW;
+    jpeg_start_decompress(&dinfo);
+    for (row = 0; row < ph; row += 16) {
+        set_rows(planes, p, pw, row);
+        jpeg_read_raw_data(&dinfo, planes, 16);
+    }
+    jpeg_finish_decompress(&dinfo);
+    jpeg_destroy_decompress(&dinfo);
+
+    *psnr = plane_psnr(p[0], pw, y, c->width, c->height);
+    cb_psnr = plane_psnr(p[1], pw / 2, cb, cw, ch);
+    cr_psnr = plane_psnr(p[2], pw / 2, cr, cw, ch);
+    if (cb_psnr < *psnr)
+        *psnr = cb_psnr;
+    if (cr_psnr < *psnr)
+        *psnr = cr_psnr;
+    return 0;
+}
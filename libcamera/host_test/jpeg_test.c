@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "jpeg_test.h"
+
+/*
+ * Quality is the JPEGENC_QUALITY_E level, 0 (low) to 4 (high). wide has 256
+ * luma MCUs in a row of a single component scan, one more than a uint8 counts.
+ */
+const struct jpeg_case jpeg_cases[] = {
+    { "tiny",       16,   16,   2, 0 },
+    { "qvga_low",   320,  240,  0, 0 },
+    { "vga",        640,  480,  2, 0 },
+    { "vga_half",   640,  480,  2, 1 },
+    { "odd_size",   1000, 750,  3, 0 },
+    { "wide",       2048, 64,   4, 0 },
+    { "5m",         2592, 1944, 3, 0 },
+};
+const unsigned int jpeg_case_num = sizeof(jpeg_cases) / sizeof(jpeg_cases[0]);
+
+static uint8_t *pool;
+static size_t pool_size;
+static size_t pool_used;
+
+/* sin(pi * x / 32768) for a 16 bit phase, scaled by 16384, as in dsp_test */
+static int32_t pic_sin(uint32_t phase)
+{
+    int32_t x = (int16_t)phase;
+
+    return (x * (32768 - abs(x))) >> 14;
+}
+
+static uint8_t pic_clip(int32_t v)
+{
+    return v < 0 ? 0 : (v > 255 ? 255 : (uint8_t)v);
+}
+
+/*
+ * Smooth waves, hard edged blocks and some noise, all in integers so the
+ * pictures and so the checksums are the same on every host.
+ */
+static uint8_t pic_sample(uint32_t x, uint32_t y, uint32_t plane)
+{
+    uint32_t noise = (x * 1103515245u + y * 12345u + plane * 2654435761u) * 2246822519u;
+    int32_t v = 128;
+
+    v += (pic_sin(x * (700 + 300 * plane)) * pic_sin(y * 450 + plane * 8192)) >> 22;
+    if (((x / 40) + (y / 24)) % 5 == plane)
+        v += (x / 40) & 1 ? 48 : -48;
+    v += (int32_t)(noise >> 28) - 8;
+
+    return pic_clip(v);
+}
+
+void jpeg_picture(const struct jpeg_case *c, uint8_t *y, uint8_t *vu)
+{
+    uint32_t i, j;
+
+    for (j = 0; j < c->height; j++) {
+        for (i = 0; i < c->width; i++)
+            y[j * c->width + i] = pic_sample(i, j, 0);
+    }
+    for (j = 0; j < c->height / 2; j++) {
+        for (i = 0; i < c->width / 2; i++) {
+            vu[j * c->width + 2 * i] = pic_sample(i, j, 2);
+            vu[j * c->width + 2 * i + 1] = pic_sample(i, j, 1);
+        }
+    }
+}
+
+int jpeg_pool_init(size_t size)
+{
+    pool = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (MAP_FAILED == pool) {
+        perror("jpeg pool");
+        pool = NULL;
+        return -1;
+    }
+    pool_size = size;
+    pool_used = 0;
+    return 0;
+}
+
+void *jpeg_pool_alloc(size_t size)
+{
+    void *p;
+
+    size = (size + 63) & ~(size_t)63;
+    if (pool_used + size > pool_size)
+        return NULL;
+    p = pool + pool_used;
+    pool_used += size;
+    memset(p, 0, size);
+    return p;
+}
+
+void jpeg_pool_reset(void)
+{
+    pool_used = 0;
+}
+
+uint32_t jpeg_hash(uint32_t h, const uint8_t *p, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 16777619;
+    }
+    return h;
+}
+
+static char *golden_buf;
+static size_t golden_len;
+
+FILE *jpeg_golden_begin(void)
+{
+    return open_memstream(&golden_buf, &golden_len);
+}
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *fp = fopen(path, "rb");
+    char *buf = NULL;
+    long n;
+
+    if (!fp)
+        return NULL;
+    if (0 == fseek(fp, 0, SEEK_END) && (n = ftell(fp)) >= 0 &&
+            0 == fseek(fp, 0, SEEK_SET) && (buf = malloc(n + 1)) != NULL) {
+        *len = fread(buf, 1, n, fp);
+        buf[*len] = '\0';
+    }
+    fclose(fp);
+    return buf;
+}
+
+static void report_diff(const char *path, const char *want, const char *got)
+{
+    unsigned int line = 1;
+    const char *w = want, *g = got;
+
+    while (*w && *w == *g) {
+        if ('\n' == *w) {
+            line++;
+            want = w + 1;
+            got = g + 1;
+        }
+        w++;
+        g++;
+    }
+    fprintf(stderr, "  %s differs at line %u\n  want: %.*s\n  got:  %.*s\n", path, line,
+            (int)strcspn(want, "\n"), want, (int)strcspn(got, "\n"), got);
+}
+
+int jpeg_golden_end(FILE *fp, const char *dir, const char *name, int update)
+{
+    char path[256];
+    char *want;
+    size_t len;
+    int ret = 0;
+
+    fclose(fp);
+    snprintf(path, sizeof(path), "%s/%s.txt", dir, name);
+    if (update) {
+        fp = fopen(path, "w");
+        if (!fp || fwrite(golden_buf, 1, golden_len, fp) != golden_len) {
+            fprintf(stderr, "  can not write %s\n", path);
+            ret = 1;
+        }
+        if (fp)
+            fclose(fp);
+    } else if (!(want = read_file(path, &len))) {
+        fprintf(stderr, "  no %s, make golden writes it\n", path);
+        ret = 1;
+    } else {
+        if (len != golden_len || memcmp(want, golden_buf, len)) {
+            report_diff(path, want, golden_buf);
+            ret = 1;
+        }
+        free(want);
+    }
+    free(golden_buf);
+    golden_buf = NULL;
+    return ret;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The JPEG conformance corpus: the pictures, the memory the firmware works in
+ * and the golden files both jpeg_corpus and jpeg_conf_test compare with.
+ */
+
+#ifndef HOST_TEST_JPEG_TEST_H
+#define HOST_TEST_JPEG_TEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct jpeg_case {
+    const char *name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t quality;       /* JPEGENC_QUALITY_E */
+    uint32_t scale;         /* scaling_down_factor of the decode */
+};
+
+extern const struct jpeg_case jpeg_cases[];
+extern const unsigned int jpeg_case_num;
+
+/* YVU420 semiplanar, VUVU as the capture hands it to the encoder */
+void jpeg_picture(const struct jpeg_case *c, uint8_t *y, uint8_t *vu);
+
+/*
+ * The firmware keeps its addresses in uint32, so all of its memory comes from
+ * one pool below 4 GB. jpeg_pool_reset() frees everything taken since start.
+ */
+int jpeg_pool_init(size_t size);
+void *jpeg_pool_alloc(size_t size);
+void jpeg_pool_reset(void);
+
+/* in jpeg_vsp_stub.c, built against each SoC tree: backs the VSP registers */
+void jpeg_vsp_init(void);
+
+/*
+ * In jpeg_libjpeg.c, the host libjpeg for jpeg_bench. The planes are cb and
+ * cr of c->width / 2, the quant tables in natural order. jpeg_libjpeg_encode
+ * writes a baseline stream with the standard huffman tables, as the VSP does,
+ * to a malloc'd *buf. jpeg_libjpeg_check fails on any libjpeg warning and
+ * gives the lowest PSNR of the three planes. 0 on success.
+ */
+int jpeg_libjpeg_encode(const struct jpeg_case *c, uint8_t *y, uint8_t *cb, uint8_t *cr,
+        const uint8_t *lum_quant, const uint8_t *chr_quant, unsigned char **buf,
+        unsigned long *len);
+int jpeg_libjpeg_check(const struct jpeg_case *c, const uint8_t *stream, uint32_t len,
+        uint8_t *y, uint8_t *cb, uint8_t *cr, double *psnr);
+
+uint32_t jpeg_hash(uint32_t h, const uint8_t *p, size_t n);
+
+#define JPEG_HASH_INIT      2166136261u
+
+/*
+ * The output of a test goes to the returned stream, jpeg_golden_end() checks
+ * it against golden/<name>.txt, or rewrites the file with update set. 0 if
+ * it matches.
+ */
+FILE *jpeg_golden_begin(void);
+int jpeg_golden_end(FILE *fp, const char *dir, const char *name, int update);
+
+#endif
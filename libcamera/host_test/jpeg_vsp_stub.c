@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Stands in for the VSP driver of each SoC tree. The progressive decode is
+ * done by the CPU, it only writes a few registers on the way, which land in
+ * plain memory here.
+ */
+
+#include <stdint.h>
+
+#include "jpeg_fw_soc.h"
+#include "jpeg_test.h"
+
+#define VSP_REG_WORDS       0x10000
+
+uint32 g_vsp_Vaddr_base;
+static uint32_t vsp_regs[VSP_REG_WORDS];
+
+void jpeg_vsp_init(void)
+{
+    g_vsp_Vaddr_base = (uint32)(uintptr_t)vsp_regs;
+}
+
+PUBLIC void VSP_Reset(void)
+{
+}
+
+PUBLIC void configure_huff_tab(uint32 *pHuff_tab, int32 n)
+{
+}
+
+PUBLIC void flush_unalign_bytes(int32 nbytes)
+{
+}
+
+PUBLIC void open_vsp_iram(void)
+{
+}
+
+PUBLIC void close_vsp_iram(void)
+{
+}
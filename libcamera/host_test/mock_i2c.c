@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "mock_i2c.h"
+
+/* the requests of sensor_drv_u.c, as the kernel driver defines them */
+#define SENSOR_IOC_MAGIC            'R'
+#define SENSOR_IO_PD                _IOW(SENSOR_IOC_MAGIC, 0,  BOOLEAN)
+#define SENSOR_IO_SET_AVDD          _IOW(SENSOR_IOC_MAGIC, 1,  uint32_t)
+#define SENSOR_IO_SET_DVDD          _IOW(SENSOR_IOC_MAGIC, 2,  uint32_t)
+#define SENSOR_IO_SET_IOVDD         _IOW(SENSOR_IOC_MAGIC, 3,  uint32_t)
+#define SENSOR_IO_SET_MCLK          _IOW(SENSOR_IOC_MAGIC, 4,  uint32_t)
+#define SENSOR_IO_RST               _IOW(SENSOR_IOC_MAGIC, 5,  uint32_t)
+#define SENSOR_IO_I2C_INIT          _IOW(SENSOR_IOC_MAGIC, 6,  uint32_t)
+#define SENSOR_IO_I2C_DEINIT        _IOW(SENSOR_IOC_MAGIC, 7,  uint32_t)
+#define SENSOR_IO_SET_ID            _IOW(SENSOR_IOC_MAGIC, 8,  uint32_t)
+#define SENSOR_IO_RST_LEVEL         _IOW(SENSOR_IOC_MAGIC, 9,  uint32_t)
+#define SENSOR_IO_I2C_ADDR          _IOW(SENSOR_IOC_MAGIC, 10, uint16_t)
+#define SENSOR_IO_I2C_READ          _IOWR(SENSOR_IOC_MAGIC, 11, SENSOR_REG_BITS_T)
+#define SENSOR_IO_I2C_WRITE         _IOW(SENSOR_IOC_MAGIC, 12, SENSOR_REG_BITS_T)
+#define SENSOR_IO_SET_FLASH         _IOW(SENSOR_IOC_MAGIC, 13, uint32_t)
+#define SENSOR_IO_I2C_WRITE_REGS    _IOW(SENSOR_IOC_MAGIC, 14, SENSOR_REG_TAB_T)
+#define SENSOR_IO_SET_CAMMOT        _IOW(SENSOR_IOC_MAGIC, 15, uint32_t)
+#define SENSOR_IO_SET_I2CCLOCK      _IOW(SENSOR_IOC_MAGIC, 16, uint32_t)
+
+#define MOCK_I2C_DEV                "/dev/sprd_sensor"
+#define MOCK_I2C_CHIPS              4
+#define MOCK_I2C_REGS               0x10000
+#define MOCK_I2C_CLOCK              100000
+/* start, the address byte and its ack, and stop */
+#define MOCK_I2C_MSG_BITS           11
+#define MOCK_I2C_BYTE_BITS          9
+
+struct mock_chip {
+    uint32_t sensor_id;
+    uint16_t addr;
+    SENSOR_INFO_T *info;
+    const SENSOR_REG_T *defaults;
+    uint32_t default_count;
+    uint16_t *regs;
+};
+
+static pthread_mutex_t mock_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct mock_chip chips[MOCK_I2C_CHIPS];
+static int dev_fd = -1;
+static uint32_t cur_id;
+static uint16_t cur_addr;
+static uint32_t clock_hz = MOCK_I2C_CLOCK;
+static struct mock_i2c_stats stats;
+static SENSOR_REG_T *log_buf;
+static uint32_t log_max, log_len;
+static int logging;
+
+int __real_open(const char *path, int flags, ...);
+int __real_close(int fd);
+int __real_ioctl(int fd, unsigned long request, ...);
+ssize_t __real_write(int fd, const void *buf, size_t len);
+
+static void chip_reset(struct mock_chip *chip)
+{
+    uint32_t i;
+
+    memset(chip->regs, 0, MOCK_I2C_REGS * sizeof(uint16_t));
+    for (i = 0; i < chip->default_count; i++)
+        chip->regs[chip->defaults[i].reg_addr] = chip->defaults[i].reg_value;
+}
+
+static struct mock_chip *chip_find(uint32_t sensor_id, uint16_t addr)
+{
+    int i;
+
+    for (i = 0; i < MOCK_I2C_CHIPS; i++)
+        if (chips[i].info && chips[i].sensor_id == sensor_id && chips[i].addr == addr)
+            return &chips[i];
+    return NULL;
+}
+
+static struct mock_chip *chip_of(SENSOR_INFO_T *info)
+{
+    int i;
+
+    for (i = 0; i < MOCK_I2C_CHIPS; i++)
+        if (chips[i].info == info)
+            return &chips[i];
+    return NULL;
+}
+
+int mock_i2c_plug(uint32_t sensor_id, SENSOR_INFO_T *info, const SENSOR_REG_T *regs,
+                  uint32_t count)
+{
+    int i;
+
+    pthread_mutex_lock(&mock_lock);
+    for (i = 0; i < MOCK_I2C_CHIPS && chips[i].info; i++)
+        ;
+    if (i == MOCK_I2C_CHIPS) {
+        pthread_mutex_unlock(&mock_lock);
+        return -1;
+    }
+    chips[i].regs = malloc(MOCK_I2C_REGS * sizeof(uint16_t));
+    if (!chips[i].regs) {
+        pthread_mutex_unlock(&mock_lock);
+        return -1;
+    }
+    chips[i].sensor_id = sensor_id;
+    chips[i].addr = info->salve_i2c_addr_w & 0xff;
+    chips[i].info = info;
+    chips[i].defaults = regs;
+    chips[i].default_count = count;
+    chip_reset(&chips[i]);
+    pthread_mutex_unlock(&mock_lock);
+    return 0;
+}
+
+void mock_i2c_unplug_all(void)
+{
+    int i;
+
+    pthread_mutex_lock(&mock_lock);
+    for (i = 0; i < MOCK_I2C_CHIPS; i++) {
+        free(chips[i].regs);
+        memset(&chips[i], 0, sizeof(chips[i]));
+    }
+    pthread_mutex_unlock(&mock_lock);
+}
+
+void mock_i2c_reset_chip(SENSOR_INFO_T *info)
+{
+    struct mock_chip *chip;
+
+    pthread_mutex_lock(&mock_lock);
+    chip = chip_of(info);
+    if (chip)
+        chip_reset(chip);
+    pthread_mutex_unlock(&mock_lock);
+}
+
+uint16_t mock_i2c_reg(SENSOR_INFO_T *info, uint16_t addr)
+{
+    struct mock_chip *chip;
+    uint16_t value = 0;
+
+    pthread_mutex_lock(&mock_lock);
+    chip = chip_of(info);
+    if (chip)
+        value = chip->regs[addr];
+    pthread_mutex_unlock(&mock_lock);
+    return value;
+}
+
+void mock_i2c_get_stats(struct mock_i2c_stats *s)
+{
+    pthread_mutex_lock(&mock_lock);
+    *s = stats;
+    pthread_mutex_unlock(&mock_lock);
+}
+
+void mock_i2c_reset_stats(void)
+{
+    pthread_mutex_lock(&mock_lock);
+    memset(&stats, 0, sizeof(stats));
+    pthread_mutex_unlock(&mock_lock);
+}
+
+uint64_t mock_i2c_time_us(void)
+{
+    uint64_t us;
+
+    pthread_mutex_lock(&mock_lock);
+    us = stats.bus_ns / 1000 + stats.sleep_us;
+    pthread_mutex_unlock(&mock_lock);
+    return us;
+}
+
+void mock_i2c_log_start(SENSOR_REG_T *log, uint32_t max)
+{
+    pthread_mutex_lock(&mock_lock);
+    log_buf = log;
+    log_max = max;
+    log_len = 0;
+    logging = 1;
+    pthread_mutex_unlock(&mock_lock);
+}
+
+uint32_t mock_i2c_log_stop(void)
+{
+    uint32_t len;
+
+    pthread_mutex_lock(&mock_lock);
+    logging = 0;
+    len = log_len;
+    pthread_mutex_unlock(&mock_lock);
+    return len;
+}
+
+static void log_add(uint16_t addr, uint16_t value)
+{
+    if (!logging)
+        return;
+    if (log_len < log_max) {
+        log_buf[log_len].reg_addr = addr;
+        log_buf[log_len].reg_value = value;
+    }
+    log_len++;
+}
+
+static void bus_msg(uint32_t bytes)
+{
+    stats.msgs++;
+    stats.bus_ns += (uint64_t)(MOCK_I2C_MSG_BITS + bytes * MOCK_I2C_BYTE_BITS) *
+                    1000000000ULL / clock_hz;
+}
+
+static void sleep_ms(uint32_t ms)
+{
+    stats.sleep_us += ms * 1000ULL;
+    log_add(SENSOR_WRITE_DELAY, ms);
+}
+
+static int reg_write(struct mock_chip *chip, uint16_t addr, uint16_t value, uint32_t reg_bits)
+{
+    uint32_t addr_bytes = (reg_bits & SENSOR_I2C_REG_16BIT) ? 2 : 1;
+    uint32_t val_bytes = (reg_bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1;
+
+    bus_msg(addr_bytes + val_bytes);
+    if (!chip) {
+        stats.nacks++;
+        return -1;
+    }
+    if (val_bytes == 1)
+        value &= 0xff;
+    chip->regs[addr] = value;
+    stats.regs++;
+    log_add(addr, value);
+    return 0;
+}
+
+static int reg_read(struct mock_chip *chip, SENSOR_REG_BITS_T *reg)
+{
+    uint32_t addr_bytes = (reg->reg_bits & SENSOR_I2C_REG_16BIT) ? 2 : 1;
+    uint32_t val_bytes = (reg->reg_bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1;
+
+    /* the address is written, then the value read after a repeated start */
+    bus_msg(addr_bytes);
+    bus_msg(val_bytes);
+    if (!chip) {
+        stats.nacks++;
+        return -1;
+    }
+    reg->reg_value = chip->regs[reg->reg_addr];
+    if (val_bytes == 1)
+        reg->reg_value &= 0xff;
+    stats.reads++;
+    return 0;
+}
+
+static int regs_write(SENSOR_REG_TAB_T *tab)
+{
+    struct mock_chip *chip = chip_find(cur_id, cur_addr);
+    SENSOR_REG_T *reg = tab->sensor_reg_tab_ptr;
+    uint32_t i;
+    int ret = 0;
+
+    /* the driver writes a table register by register and sleeps on a delay */
+    for (i = 0; i < tab->reg_count; i++) {
+        if (SENSOR_WRITE_DELAY == reg[i].reg_addr)
+            sleep_ms(reg[i].reg_value);
+        else if (reg_write(chip, reg[i].reg_addr, reg[i].reg_value, tab->reg_bits))
+            ret = -1;
+    }
+    return ret;
+}
+
+static int ioctl_locked(unsigned int request, void *arg)
+{
+    switch (request) {
+    case SENSOR_IO_I2C_INIT:
+    case SENSOR_IO_SET_ID:
+        cur_id = *(uint32_t *)arg;
+        return 0;
+    case SENSOR_IO_I2C_ADDR:
+        cur_addr = *(uint16_t *)arg;
+        return 0;
+    case SENSOR_IO_SET_I2CCLOCK:
+        clock_hz = *(uint32_t *)arg ? *(uint32_t *)arg : MOCK_I2C_CLOCK;
+        return 0;
+    case SENSOR_IO_RST: {
+        int i;
+
+        for (i = 0; i < MOCK_I2C_CHIPS; i++)
+            if (chips[i].info && chips[i].sensor_id == cur_id)
+                chip_reset(&chips[i]);
+        return 0;
+    }
+    case SENSOR_IO_I2C_READ:
+        return reg_read(chip_find(cur_id, cur_addr), arg);
+    case SENSOR_IO_I2C_WRITE: {
+        SENSOR_REG_BITS_T *reg = arg;
+
+        return reg_write(chip_find(cur_id, cur_addr), reg->reg_addr, reg->reg_value,
+                         reg->reg_bits);
+    }
+    case SENSOR_IO_I2C_WRITE_REGS:
+        return regs_write(arg);
+    case SENSOR_IO_PD:
+    case SENSOR_IO_SET_AVDD:
+    case SENSOR_IO_SET_DVDD:
+    case SENSOR_IO_SET_IOVDD:
+    case SENSOR_IO_SET_MCLK:
+    case SENSOR_IO_I2C_DEINIT:
+    case SENSOR_IO_RST_LEVEL:
+    case SENSOR_IO_SET_FLASH:
+    case SENSOR_IO_SET_CAMMOT:
+        return 0;
+    }
+    return -1;
+}
+
+/* a burst: the first address, then the values of consecutive registers */
+static int burst_write(const uint8_t *buf, size_t len)
+{
+    struct mock_chip *chip = chip_find(cur_id, cur_addr);
+    uint32_t addr_bytes, val_bytes, bits;
+    uint16_t addr, value;
+    size_t pos;
+
+    bus_msg(len);
+    if (!chip) {
+        stats.nacks++;
+        return -1;
+    }
+    bits = chip->info->reg_addr_value_bits;
+    addr_bytes = (bits & SENSOR_I2C_REG_16BIT) ? 2 : 1;
+    val_bytes = (bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1;
+    if (len < addr_bytes + val_bytes || (len - addr_bytes) % val_bytes)
+        return -1;
+
+    addr = addr_bytes == 2 ? (buf[0] << 8) | buf[1] : buf[0];
+    for (pos = addr_bytes; pos < len; pos += val_bytes) {
+        value = val_bytes == 2 ? (buf[pos] << 8) | buf[pos + 1] : buf[pos];
+        chip->regs[addr] = value;
+        stats.regs++;
+        log_add(addr, value);
+        /* the chip moves to the next register by the bytes it took */
+        addr += val_bytes;
+    }
+    return 0;
+}
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    va_list ap;
+    int mode = 0;
+
+    if (flags & O_CREAT) {
+        va_start(ap, flags);
+        mode = va_arg(ap, int);
+        va_end(ap);
+    }
+    if (strcmp(path, MOCK_I2C_DEV))
+        return __real_open(path, flags, mode);
+
+    pthread_mutex_lock(&mock_lock);
+    if (dev_fd < 0)
+        dev_fd = __real_open("/dev/null", O_RDWR);
+    pthread_mutex_unlock(&mock_lock);
+    return dev_fd;
+}
+
+int __wrap_close(int fd)
+{
+    pthread_mutex_lock(&mock_lock);
+    if (fd >= 0 && fd == dev_fd)
+        dev_fd = -1;
+    pthread_mutex_unlock(&mock_lock);
+    return __real_close(fd);
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    va_list ap;
+    void *arg;
+    int ret;
+
+    va_start(ap, request);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+    if (fd < 0 || fd != dev_fd)
+        return __real_ioctl(fd, request, arg);
+
+    pthread_mutex_lock(&mock_lock);
+    stats.ioctls++;
+    /* xioctl() passes the request as an int, _IOWR ones come sign extended */
+    ret = ioctl_locked((unsigned int)request, arg);
+    pthread_mutex_unlock(&mock_lock);
+    return ret;
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t len)
+{
+    int ret;
+
+    if (fd < 0 || fd != dev_fd)
+        return __real_write(fd, buf, len);
+
+    pthread_mutex_lock(&mock_lock);
+    stats.ioctls++;
+    ret = burst_write(buf, len);
+    pthread_mutex_unlock(&mock_lock);
+    /* the driver returns 0 for a message sent whole */
+    return ret;
+}
+
+int __wrap_usleep(useconds_t us)
+{
+    pthread_mutex_lock(&mock_lock);
+    stats.sleep_us += us;
+    if (us >= 1000)
+        log_add(SENSOR_WRITE_DELAY, us / 1000);
+    pthread_mutex_unlock(&mock_lock);
+    /* let a thread polling with usleep() see the others move */
+    sched_yield();
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The /dev/sprd_sensor sensor_drv_u.c runs against on the host. open(),
+ * ioctl(), write() and close() of the device are taken over at link time,
+ * and so is usleep(), which only moves the clock of the bus on: the power
+ * sequences and table delays cost no real time and are counted as they
+ * would run. Each chip plugged in answers on the bus of its sensor id at the
+ * address of its driver and keeps a flat file of 16 bit registers, which a
+ * reset brings back to its power on values. Every i2c message is charged its
+ * bits at the clock the driver set.
+ */
+
+#ifndef HOST_TEST_MOCK_I2C_H
+#define HOST_TEST_MOCK_I2C_H
+
+#include <stdint.h>
+
+#include "sensor_drv_u.h"
+
+struct mock_i2c_stats {
+    uint32_t ioctls;            /* ioctl() and write() calls on the device */
+    uint32_t msgs;              /* i2c messages */
+    uint32_t regs;              /* registers written */
+    uint32_t reads;             /* registers read */
+    uint32_t nacks;             /* messages no chip answered */
+    uint64_t bus_ns;            /* the messages at the clock of the bus */
+    uint64_t sleep_us;          /* usleep() and the delays in the tables */
+};
+
+/* puts a chip for the driver on the bus of sensor_id, the registers not
+ * listed in regs come up as 0 */
+int mock_i2c_plug(uint32_t sensor_id, SENSOR_INFO_T *info, const SENSOR_REG_T *regs,
+                  uint32_t count);
+void mock_i2c_unplug_all(void);
+
+/* brings the registers of the chip back to their power on values */
+void mock_i2c_reset_chip(SENSOR_INFO_T *info);
+uint16_t mock_i2c_reg(SENSOR_INFO_T *info, uint16_t addr);
+
+void mock_i2c_get_stats(struct mock_i2c_stats *stats);
+void mock_i2c_reset_stats(void);
+
+/* the time the bus took and slept since the last reset of the stats, in us */
+uint64_t mock_i2c_time_us(void);
+
+/* records every register written to any chip, in order, and the delays as
+ * SENSOR_WRITE_DELAY entries, until mock_i2c_log_stop() which returns the
+ * count. Entries past max are counted but not kept. */
+void mock_i2c_log_start(SENSOR_REG_T *log, uint32_t max);
+uint32_t mock_i2c_log_stop(void);
+
+#endif
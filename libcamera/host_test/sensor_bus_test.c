@@ -0,0 +1,752 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * sensor_drv_u.c against the mock i2c bus of mock_i2c.c, with the sc8825
+ * sensor list of sensor_cfg.c.
+ *
+ * sensor_drv_u.c keeps what it identified for the life of the process, as
+ * mediaserver does, so each sensor is brought up in a process of its own.
+ *
+ *   burst  every mode table of ov5640_mipi, s5k5ccgx_mipi and hi351_mipi is
+ *          uploaded from the power on state once register by register and
+ *          once compiled into bursts. The chip has to see the same writes and
+ *          delays in the same order and end up with the same registers, the
+ *          calls, i2c messages and bus time of each upload are reported. Only
+ *          ov5640_mipi sets SENSOR_I2C_BURST_WRITE, the others are forced to
+ *          show what the flag would save them. hi351 pages its registers
+ *          through 0x03, which the flat register file of the mock does not
+ *          see, the write log has to match for it as well.
+ *   delta  the preview and capture modes are switched back and forth the way
+ *          the HAL does, once with the shadow of the driver and once with it
+ *          off. The registers have to end up the same after every switch, the
+ *          registers and ms saved by the shadow are reported. The driver keeps
+ *          the shadow off for s5k5ccgx_mipi, whose tables write its memory
+ *          through the 0x0F12 data port, and for hi351_mipi, whose registers
+ *          are paged, a flat shadow would skip writes the chip needs. For them
+ *          the switches are modelled with a shadow that follows the pointer or
+ *          the page and sends it again before a write that needs it. Nothing
+ *          in their tables is known to be volatile, so this is the most such
+ *          a shadow could save.
+ *   probe  the camera is started to its first preview frame with hi351_mipi,
+ *          the last sensor of the main list, and ov7675 as the sub one, once
+ *          with no probe cache and once with the cache that boot saved, then
+ *          with the main sensor changed for ov5640_mipi behind the cache and
+ *          once more after that. /data/misc/sensors/ is a temporary directory.
+ *          The time the bus took and slept, the messages and the reads up to
+ *          the first frame are reported for each boot.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "host_log.h"
+#include "mock_i2c.h"
+#include "sensor_drv_u.h"
+
+#define BUS_LOG_MAX         16384
+#define BUS_REGS            0x10000
+#define BUS_STEPS_MAX       16
+/* the flat registers, then 16 banks of memory behind a data port */
+#define BUS_MODEL_KEYS      (17 << 16)
+/* start, the address byte and its ack, and stop */
+#define BUS_MSG_BITS        11
+#define BUS_BYTE_BITS       9
+
+/* the s5k5ccgx memory pointer registers and data port, and the hi351 page */
+#define S5K_PTR_HI          0x0028
+#define S5K_PTR_LO          0x002A
+#define S5K_DATA            0x0F12
+#define HI351_PAGE          0x03
+
+#define BUS_DATA_DIR        "/data/misc/sensors/"
+
+enum bus_regs {
+    BUS_FLAT,
+    BUS_PORT,
+    BUS_PAGED,
+};
+
+extern SENSOR_INFO_T g_ov5640_mipi_yuv_info;
+extern SENSOR_INFO_T g_s5k5ccgx_yuv_info_mipi;
+extern SENSOR_INFO_T g_hi351_mipi_yuv_info;
+extern SENSOR_INFO_T g_OV7675_yuv_info;
+
+struct bus_sensor {
+    SENSOR_INFO_T *info;
+    /* the power on values the identify of the driver reads */
+    const SENSOR_REG_T *id_regs;
+    uint32_t id_count;
+    enum bus_regs regs;
+};
+
+struct bus_upload {
+    struct mock_i2c_stats stats;
+    uint32_t log_len;
+    SENSOR_REG_T *log;
+    uint16_t *regs;
+};
+
+/* one mode switch as the mock saw it */
+struct bus_step {
+    uint32_t regs;
+    uint32_t nacks;
+    uint64_t us;
+    uint32_t sum;
+};
+
+/* what the children of the delta case hand back, in memory shared with them */
+struct bus_pass {
+    struct bus_step step[BUS_STEPS_MAX];
+};
+
+/* the registers as a shadow which knows the chip would see them */
+struct bus_model {
+    enum bus_regs regs;
+    uint16_t *value;
+    uint8_t *valid;
+    uint32_t ptr, chip_ptr;
+    uint16_t page, chip_page;
+};
+
+struct bus_cost {
+    uint32_t regs;
+    uint32_t bits;
+    uint32_t delay_ms;
+};
+
+/* one start of the camera up to its first frame */
+struct bus_boot {
+    int ret;
+    uint32_t msgs;
+    uint32_t reads;
+    uint32_t nacks;
+    uint64_t us;
+    char name[16];
+};
+
+struct bus_case {
+    const char *name;
+    int (*run)(void);
+};
+
+static const SENSOR_REG_T ov5640_id[] = { { 0x300A, 0x56 }, { 0x300B, 0x40 } };
+static const SENSOR_REG_T s5k5ccgx_id[] = { { 0x0F12, 0x05CC } };
+static const SENSOR_REG_T hi351_id[] = { { 0x04, 0xA4 } };
+static const SENSOR_REG_T ov7675_id[] = { { 0x0A, 0x76 }, { 0x0B, 0x73 } };
+
+/* the main sensors of sensor_cfg.c, in its order */
+static const struct bus_sensor bus_sensors[] = {
+    { &g_ov5640_mipi_yuv_info, ov5640_id, 2, BUS_FLAT },
+    { &g_s5k5ccgx_yuv_info_mipi, s5k5ccgx_id, 1, BUS_PORT },
+    { &g_hi351_mipi_yuv_info, hi351_id, 1, BUS_PAGED },
+};
+
+static const struct bus_sensor bus_sub = { &g_OV7675_yuv_info, ov7675_id, 2, BUS_FLAT };
+
+static char bus_data_dir[] = "/tmp/sensor_bus.XXXXXX";
+
+FILE *__real_fopen(const char *path, const char *mode);
+int __real_rename(const char *oldpath, const char *newpath);
+int __real_unlink(const char *path);
+
+/* the probe cache goes to bus_data_dir instead of /data/misc/sensors */
+static const char *bus_data_path(const char *path, char *buf, size_t len)
+{
+    if (strncmp(path, BUS_DATA_DIR, strlen(BUS_DATA_DIR)))
+        return path;
+    snprintf(buf, len, "%s/%s", bus_data_dir, path + strlen(BUS_DATA_DIR));
+    return buf;
+}
+
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+    char buf[256];
+
+    return __real_fopen(bus_data_path(path, buf, sizeof(buf)), mode);
+}
+
+int __wrap_rename(const char *oldpath, const char *newpath)
+{
+    char oldbuf[256], newbuf[256];
+
+    return __real_rename(bus_data_path(oldpath, oldbuf, sizeof(oldbuf)),
+                         bus_data_path(newpath, newbuf, sizeof(newbuf)));
+}
+
+int __wrap_unlink(const char *path)
+{
+    char buf[256];
+
+    return __real_unlink(bus_data_path(path, buf, sizeof(buf)));
+}
+
+static double bus_ms(const struct mock_i2c_stats *stats)
+{
+    return stats->bus_ns / 1e6;
+}
+
+/* plugs the sensor in as the only main one and opens it */
+static int bus_open(const struct bus_sensor *sensor)
+{
+    uint32_t num = 0;
+
+    mock_i2c_unplug_all();
+    if (mock_i2c_plug(SENSOR_MAIN, sensor->info, sensor->id_regs, sensor->id_count)) {
+        fprintf(stderr, "sensor_bus: can not plug %s\n", sensor->info->name);
+        return -1;
+    }
+    host_log_reset();
+    if (Sensor_Init(SENSOR_MAIN, &num) != SENSOR_SUCCESS) {
+        fprintf(stderr, "sensor_bus: %s: Sensor_Init failed\n", sensor->info->name);
+        return -1;
+    }
+    /* the init table is written by the sensor thread, stream on waits for it */
+    Sensor_StreamOn();
+    Sensor_StreamOff();
+    return 0;
+}
+
+static void bus_close(void)
+{
+    Sensor_Close();
+    mock_i2c_unplug_all();
+}
+
+static void bus_upload(const struct bus_sensor *sensor, SENSOR_REG_TAB_INFO_T *tab,
+                       struct bus_upload *up)
+{
+    uint32_t i;
+
+    mock_i2c_reset_chip(sensor->info);
+    mock_i2c_reset_stats();
+    mock_i2c_log_start(up->log, BUS_LOG_MAX);
+    Sensor_SendRegTabToSensor(tab);
+    up->log_len = mock_i2c_log_stop();
+    mock_i2c_get_stats(&up->stats);
+    for (i = 0; i < BUS_REGS; i++)
+        up->regs[i] = mock_i2c_reg(sensor->info, i);
+}
+
+static int bus_upload_alloc(struct bus_upload *up)
+{
+    up->log = malloc(BUS_LOG_MAX * sizeof(SENSOR_REG_T));
+    up->regs = malloc(BUS_REGS * sizeof(uint16_t));
+    return up->log && up->regs ? 0 : -1;
+}
+
+static void bus_upload_free(struct bus_upload *up)
+{
+    free(up->log);
+    free(up->regs);
+}
+
+/* runs fn in a child, a fresh boot of the camera stack, returns its failures */
+static int bus_fork(int (*fn)(const struct bus_sensor *), const struct bus_sensor *sensor)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("sensor_bus: fork");
+        return 1;
+    }
+    if (pid == 0)
+        exit(fn(sensor));
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+        fprintf(stderr, "sensor_bus: %s: the child died\n", sensor->info->name);
+        return 1;
+    }
+    return WEXITSTATUS(status);
+}
+
+static int bus_burst_sensor(const struct bus_sensor *sensor)
+{
+    struct bus_upload plain_up, burst_up;
+    struct bus_upload *plain = &plain_up, *burst = &burst_up;
+    SENSOR_INFO_T *info = sensor->info;
+    SENSOR_REG_RANGE_T_PTR volatile_ptr = info->volatile_reg_ptr;
+    uint32_t bits = info->reg_addr_value_bits;
+    int failed = 0, mode, i;
+
+    if (bus_upload_alloc(plain) || bus_upload_alloc(burst)) {
+        fprintf(stderr, "sensor_bus: out of memory\n");
+        return 1;
+    }
+    if (bus_open(sensor))
+        return 1;
+
+    /* every upload starts from the power on state, the shadow would skip it */
+    info->volatile_reg_ptr = NULL;
+    for (mode = 0; mode < SENSOR_MODE_MAX; mode++) {
+        SENSOR_REG_TAB_INFO_T *tab = &info->resolution_tab_info_ptr[mode];
+
+        if (!tab->sensor_reg_tab_ptr || !tab->reg_count)
+            continue;
+        for (i = 0; i < mode; i++)
+            if (info->resolution_tab_info_ptr[i].sensor_reg_tab_ptr == tab->sensor_reg_tab_ptr)
+                break;
+        if (i < mode)
+            continue;
+
+        info->reg_addr_value_bits = bits & ~SENSOR_I2C_BURST_WRITE;
+        bus_upload(sensor, tab, plain);
+        info->reg_addr_value_bits = bits | SENSOR_I2C_BURST_WRITE;
+        bus_upload(sensor, tab, burst);
+        info->reg_addr_value_bits = bits;
+
+        printf("%-14s mode %d: %5u regs, plain %5u calls %5u msgs %7.2f ms, "
+               "burst %5u calls %5u msgs %7.2f ms\n", info->name, mode, tab->reg_count,
+               plain->stats.ioctls, plain->stats.msgs, bus_ms(&plain->stats),
+               burst->stats.ioctls, burst->stats.msgs, bus_ms(&burst->stats));
+
+        if (plain->log_len != burst->log_len
+            || memcmp(plain->log, burst->log,
+                      (plain->log_len < BUS_LOG_MAX ? plain->log_len : BUS_LOG_MAX) *
+                      sizeof(SENSOR_REG_T))) {
+            fprintf(stderr, "sensor_bus: %s mode %d: the bursts write %u entries, "
+                    "not the %u of the table\n", info->name, mode, burst->log_len,
+                    plain->log_len);
+            failed++;
+        }
+        if (memcmp(plain->regs, burst->regs, BUS_REGS * sizeof(uint16_t))) {
+            fprintf(stderr, "sensor_bus: %s mode %d: the registers differ after the bursts\n",
+                    info->name, mode);
+            failed++;
+        }
+        if (burst->stats.nacks || plain->stats.nacks) {
+            fprintf(stderr, "sensor_bus: %s mode %d: %u messages not answered\n",
+                    info->name, mode, burst->stats.nacks + plain->stats.nacks);
+            failed++;
+        }
+        if (burst->stats.msgs > plain->stats.msgs
+            || burst->stats.bus_ns > plain->stats.bus_ns) {
+            fprintf(stderr, "sensor_bus: %s mode %d: the bursts take longer\n",
+                    info->name, mode);
+            failed++;
+        }
+    }
+    info->volatile_reg_ptr = volatile_ptr;
+
+    bus_close();
+    bus_upload_free(plain);
+    bus_upload_free(burst);
+    return failed;
+}
+
+static int bus_burst(void)
+{
+    unsigned int i;
+    int failed = 0;
+
+    for (i = 0; i < sizeof(bus_sensors) / sizeof(bus_sensors[0]); i++)
+        failed += bus_fork(bus_burst_sensor, &bus_sensors[i]);
+    return failed;
+}
+
+static struct bus_pass *bus_passes;
+static int bus_pass_shadow;
+static uint32_t bus_seq[BUS_STEPS_MAX];
+static uint32_t bus_seq_len;
+
+/* preview, then each capture mode and back to preview, as the HAL switches */
+static void bus_delta_seq(SENSOR_INFO_T *info)
+{
+    SENSOR_REG_TAB_INFO_T *tab = info->resolution_tab_info_ptr;
+    uint32_t preview = 0, mode, i;
+
+    bus_seq_len = 0;
+    for (mode = SENSOR_MODE_PREVIEW_ONE; mode < SENSOR_MODE_MAX; mode++) {
+        if (!tab[mode].sensor_reg_tab_ptr || !tab[mode].reg_count)
+            continue;
+        for (i = SENSOR_MODE_PREVIEW_ONE; i < mode; i++)
+            if (tab[i].sensor_reg_tab_ptr == tab[mode].sensor_reg_tab_ptr)
+                break;
+        if (i < mode)
+            continue;
+        if (!preview) {
+            preview = mode;
+            bus_seq[bus_seq_len++] = mode;
+        } else if (bus_seq_len + 2 <= BUS_STEPS_MAX) {
+            bus_seq[bus_seq_len++] = mode;
+            bus_seq[bus_seq_len++] = preview;
+        }
+    }
+}
+
+static uint32_t bus_reg_sum(SENSOR_INFO_T *info)
+{
+    uint32_t sum = 2166136261u, i;
+
+    for (i = 0; i < BUS_REGS; i++)
+        sum = (sum ^ mock_i2c_reg(info, i)) * 16777619u;
+    return sum;
+}
+
+/* the switches of bus_seq through the driver, with its shadow or without */
+static int bus_delta_driver(const struct bus_sensor *sensor)
+{
+    SENSOR_INFO_T *info = sensor->info;
+    struct bus_pass *pass = &bus_passes[bus_pass_shadow];
+    struct mock_i2c_stats stats;
+    uint32_t i;
+
+    if (!bus_pass_shadow)
+        info->volatile_reg_ptr = NULL;
+    if (bus_open(sensor))
+        return 1;
+    for (i = 0; i < bus_seq_len; i++) {
+        mock_i2c_reset_stats();
+        Sensor_SendRegTabToSensor(&info->resolution_tab_info_ptr[bus_seq[i]]);
+        mock_i2c_get_stats(&stats);
+        pass->step[i].regs = stats.regs;
+        pass->step[i].nacks = stats.nacks;
+        pass->step[i].us = mock_i2c_time_us();
+        pass->step[i].sum = bus_reg_sum(info);
+    }
+    bus_close();
+    return 0;
+}
+
+static void bus_model_send(const SENSOR_INFO_T *info, struct bus_cost *cost)
+{
+    uint32_t bits = info->reg_addr_value_bits;
+
+    cost->regs++;
+    cost->bits += BUS_MSG_BITS + BUS_BYTE_BITS *
+                  (((bits & SENSOR_I2C_REG_16BIT) ? 2 : 1) + ((bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1));
+}
+
+/*
+ * Uploads the table to the model, in full or only what the chip does not hold
+ * yet. The pointer and page writes of the table are only taken note of in the
+ * delta, the chip is sent them before the first write that needs them. A
+ * delay is kept if anything was sent since the last one, as the driver does.
+ */
+static void bus_model_upload(struct bus_model *m, const SENSOR_INFO_T *info,
+                             const SENSOR_REG_TAB_INFO_T *tab, int delta, struct bus_cost *cost)
+{
+    const SENSOR_REG_T *reg = tab->sensor_reg_tab_ptr;
+    uint32_t i, key, sent = 0;
+    int port;
+
+    memset(cost, 0, sizeof(*cost));
+    for (i = 0; i < tab->reg_count; i++) {
+        uint16_t addr = reg[i].reg_addr, value = reg[i].reg_value;
+
+        if (SENSOR_WRITE_DELAY == addr) {
+            if (!delta || sent)
+                cost->delay_ms += value;
+            sent = 0;
+            continue;
+        }
+
+        port = 0;
+        key = addr;
+        if (BUS_PORT == m->regs && (S5K_PTR_HI == addr || S5K_PTR_LO == addr)) {
+            if (S5K_PTR_HI == addr)
+                m->ptr = (value << 16) | (m->ptr & 0xffff);
+            else
+                m->ptr = (m->ptr & 0xffff0000) | value;
+            if (!delta) {
+                bus_model_send(info, cost);
+                m->chip_ptr = m->ptr;
+            }
+            continue;
+        } else if (BUS_PORT == m->regs && S5K_DATA == addr) {
+            port = 1;
+            key = ((1 + (m->ptr >> 28)) << 16) | (m->ptr & 0xffff);
+        } else if (BUS_PAGED == m->regs && HI351_PAGE == addr) {
+            m->page = value;
+            if (!delta) {
+                bus_model_send(info, cost);
+                m->chip_page = value;
+            }
+            continue;
+        } else if (BUS_PAGED == m->regs) {
+            key = (m->page << 8) | (addr & 0xff);
+        }
+
+        if (!delta || !m->valid[key] || m->value[key] != value) {
+            if (port && m->chip_ptr != m->ptr) {
+                if ((m->chip_ptr >> 16) != (m->ptr >> 16))
+                    bus_model_send(info, cost);
+                bus_model_send(info, cost);
+            } else if (BUS_PAGED == m->regs && m->chip_page != m->page) {
+                bus_model_send(info, cost);
+            }
+            bus_model_send(info, cost);
+            m->chip_page = m->page;
+            if (port)
+                m->chip_ptr = m->ptr + 2;
+            sent = 1;
+        }
+        m->value[key] = value;
+        m->valid[key] = 1;
+        if (port)
+            m->ptr += 2;
+    }
+}
+
+static double bus_cost_ms(const SENSOR_INFO_T *info, const struct bus_cost *cost)
+{
+    uint32_t clock = (info->reg_addr_value_bits & SENSOR_I2C_CLOCK_MASK) == SENSOR_I2C_FREQ_400 ?
+                     400000 : 100000;
+
+    return cost->bits * 1000.0 / clock + cost->delay_ms;
+}
+
+/* the full and the delta upload of every switch, on two models side by side */
+static int bus_delta_model(const struct bus_sensor *sensor)
+{
+    SENSOR_INFO_T *info = sensor->info;
+    struct bus_model full = { sensor->regs }, delta = { sensor->regs };
+    struct bus_cost full_cost, delta_cost;
+    uint32_t i, prev = SENSOR_MODE_COMMON_INIT;
+
+    full.value = calloc(BUS_MODEL_KEYS, sizeof(uint16_t));
+    full.valid = calloc(BUS_MODEL_KEYS, 1);
+    delta.value = calloc(BUS_MODEL_KEYS, sizeof(uint16_t));
+    delta.valid = calloc(BUS_MODEL_KEYS, 1);
+    if (!full.value || !full.valid || !delta.value || !delta.valid) {
+        fprintf(stderr, "sensor_bus: out of memory\n");
+        return 1;
+    }
+
+    bus_model_upload(&full, info, &info->resolution_tab_info_ptr[SENSOR_MODE_COMMON_INIT], 0,
+                     &full_cost);
+    bus_model_upload(&delta, info, &info->resolution_tab_info_ptr[SENSOR_MODE_COMMON_INIT], 0,
+                     &delta_cost);
+    for (i = 0; i < bus_seq_len; i++) {
+        bus_model_upload(&full, info, &info->resolution_tab_info_ptr[bus_seq[i]], 0, &full_cost);
+        bus_model_upload(&delta, info, &info->resolution_tab_info_ptr[bus_seq[i]], 1,
+                         &delta_cost);
+        printf("%-14s mode %u -> %u: full %5u regs %7.2f ms, delta %5u regs %7.2f ms, "
+               "saved %5d regs %7.2f ms (modelled)\n", info->name, prev, bus_seq[i],
+               full_cost.regs, bus_cost_ms(info, &full_cost), delta_cost.regs,
+               bus_cost_ms(info, &delta_cost), (int)(full_cost.regs - delta_cost.regs),
+               bus_cost_ms(info, &full_cost) - bus_cost_ms(info, &delta_cost));
+        prev = bus_seq[i];
+    }
+
+    free(full.value);
+    free(full.valid);
+    free(delta.value);
+    free(delta.valid);
+    return 0;
+}
+
+static int bus_delta_sensor(const struct bus_sensor *sensor)
+{
+    SENSOR_INFO_T *info = sensor->info;
+    struct bus_step *full, *delta;
+    uint32_t i, prev = SENSOR_MODE_COMMON_INIT;
+    int failed = 0;
+
+    bus_delta_seq(info);
+    if (!info->volatile_reg_ptr)
+        return bus_delta_model(sensor);
+
+    memset(bus_passes, 0, 2 * sizeof(struct bus_pass));
+    for (bus_pass_shadow = 0; bus_pass_shadow < 2; bus_pass_shadow++)
+        failed += bus_fork(bus_delta_driver, sensor);
+    if (failed)
+        return failed;
+
+    for (i = 0; i < bus_seq_len; i++) {
+        full = &bus_passes[0].step[i];
+        delta = &bus_passes[1].step[i];
+        printf("%-14s mode %u -> %u: full %5u regs %7.2f ms, delta %5u regs %7.2f ms, "
+               "saved %5d regs %7.2f ms\n", info->name, prev, bus_seq[i],
+               full->regs, full->us / 1000.0, delta->regs, delta->us / 1000.0,
+               (int)(full->regs - delta->regs), ((int64_t)full->us - (int64_t)delta->us) / 1000.0);
+        if (full->sum != delta->sum) {
+            fprintf(stderr, "sensor_bus: %s mode %u -> %u: the registers differ with the "
+                    "shadow\n", info->name, prev, bus_seq[i]);
+            failed++;
+        }
+        if (full->nacks || delta->nacks) {
+            fprintf(stderr, "sensor_bus: %s mode %u -> %u: %u messages not answered\n",
+                    info->name, prev, bus_seq[i], full->nacks + delta->nacks);
+            failed++;
+        }
+        if (delta->regs > full->regs) {
+            fprintf(stderr, "sensor_bus: %s mode %u -> %u: the shadow writes more\n",
+                    info->name, prev, bus_seq[i]);
+            failed++;
+        }
+        prev = bus_seq[i];
+    }
+    return failed;
+}
+
+static int bus_delta(void)
+{
+    unsigned int i;
+    int failed = 0;
+
+    bus_passes = mmap(NULL, 2 * sizeof(struct bus_pass), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == bus_passes) {
+        perror("sensor_bus: mmap");
+        return 1;
+    }
+    for (i = 0; i < sizeof(bus_sensors) / sizeof(bus_sensors[0]); i++)
+        failed += bus_delta_sensor(&bus_sensors[i]);
+    munmap(bus_passes, 2 * sizeof(struct bus_pass));
+    return failed;
+}
+
+static struct bus_boot *bus_boots;
+static int bus_boot_num;
+
+/* starts the camera with the sensor as main up to the first preview frame */
+static int bus_probe_boot(const struct bus_sensor *sensor)
+{
+    struct bus_boot *boot = &bus_boots[bus_boot_num];
+    struct mock_i2c_stats stats;
+    uint32_t num = 0;
+
+    mock_i2c_unplug_all();
+    if (mock_i2c_plug(SENSOR_MAIN, sensor->info, sensor->id_regs, sensor->id_count)
+        || mock_i2c_plug(SENSOR_SUB, bus_sub.info, bus_sub.id_regs, bus_sub.id_count)) {
+        fprintf(stderr, "sensor_bus: can not plug %s\n", sensor->info->name);
+        return 1;
+    }
+    mock_i2c_reset_stats();
+    boot->ret = Sensor_Init(SENSOR_MAIN, &num);
+    if (SENSOR_SUCCESS == boot->ret) {
+        Sensor_SetMode(SENSOR_MODE_PREVIEW_ONE);
+        /* stream on is queued behind the init and preview tables */
+        Sensor_StreamOn();
+        strncpy(boot->name, Sensor_GetInfo()->name, sizeof(boot->name) - 1);
+    }
+    mock_i2c_get_stats(&stats);
+    boot->us = mock_i2c_time_us();
+    boot->msgs = stats.msgs;
+    boot->reads = stats.reads;
+    boot->nacks = stats.nacks;
+    bus_close();
+    return 0;
+}
+
+static int bus_probe_step(const char *what, const struct bus_sensor *sensor)
+{
+    struct bus_boot *boot = &bus_boots[bus_boot_num];
+
+    if (bus_fork(bus_probe_boot, sensor))
+        return 1;
+    printf("%-8s %-8s first frame after %7.2f ms, %5u msgs, %3u reads, %2u not answered\n",
+           what, sensor->info->name, boot->us / 1000.0, boot->msgs, boot->reads, boot->nacks);
+    bus_boot_num++;
+    if (SENSOR_SUCCESS != boot->ret || strcmp(boot->name, sensor->info->name)) {
+        fprintf(stderr, "sensor_bus: %s: %s did not open (%d, %s)\n", what,
+                sensor->info->name, boot->ret, boot->name);
+        return 1;
+    }
+    return 0;
+}
+
+static int bus_probe(void)
+{
+    const struct bus_sensor *hi351 = &bus_sensors[2], *ov5640 = &bus_sensors[0];
+    struct bus_boot *cold, *warm, *swapped, *again;
+    char path[256];
+    int failed = 0;
+
+    bus_boots = mmap(NULL, 4 * sizeof(struct bus_boot), PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == bus_boots) {
+        perror("sensor_bus: mmap");
+        return 1;
+    }
+    memset(bus_boots, 0, 4 * sizeof(struct bus_boot));
+    if (!mkdtemp(bus_data_dir)) {
+        perror("sensor_bus: mkdtemp");
+        return 1;
+    }
+
+    bus_boot_num = 0;
+    failed += bus_probe_step("cold", hi351);
+    failed += bus_probe_step("warm", hi351);
+    failed += bus_probe_step("swapped", ov5640);
+    failed += bus_probe_step("warm", ov5640);
+    if (failed)
+        goto out;
+
+    cold = &bus_boots[0];
+    warm = &bus_boots[1];
+    swapped = &bus_boots[2];
+    again = &bus_boots[3];
+    printf("probe cache: first frame %.2f ms sooner, %u reads fewer\n",
+           ((int64_t)cold->us - (int64_t)warm->us) / 1000.0, cold->reads - warm->reads);
+    /* the sensors before hi351 in the list do not answer a full probe */
+    if (!cold->nacks || warm->nacks || warm->us >= cold->us || warm->reads >= cold->reads) {
+        fprintf(stderr, "sensor_bus: the warm boot did not take the probe cache\n");
+        failed++;
+    }
+    if (!swapped->nacks) {
+        fprintf(stderr, "sensor_bus: the swapped sensor was not probed again\n");
+        failed++;
+    }
+    if (again->nacks || again->us >= cold->us) {
+        fprintf(stderr, "sensor_bus: the cache was not saved for the new sensor\n");
+        failed++;
+    }
+
+out:
+    snprintf(path, sizeof(path), "%s/sensor_probe.cache", bus_data_dir);
+    unlink(path);
+    rmdir(bus_data_dir);
+    munmap(bus_boots, 4 * sizeof(struct bus_boot));
+    return failed;
+}
+
+static const struct bus_case bus_cases[] = {
+    { "burst", bus_burst },
+    { "delta", bus_delta },
+    { "probe", bus_probe },
+};
+
+int main(int argc, char **argv)
+{
+    unsigned int i;
+    int failed = 0, j;
+
+    for (i = 0; i < sizeof(bus_cases) / sizeof(bus_cases[0]); i++) {
+        if (argc > 1) {
+            for (j = 1; j < argc; j++)
+                if (strcmp(argv[j], bus_cases[i].name) == 0)
+                    break;
+            if (j == argc)
+                continue;
+        }
+        host_log_reset();
+        if (bus_cases[i].run()) {
+            printf("sensor_bus %s: FAILED\n", bus_cases[i].name);
+            failed++;
+        } else {
+            printf("sensor_bus %s: ok\n", bus_cases[i].name);
+        }
+    }
+    return failed;
+}
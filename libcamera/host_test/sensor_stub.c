@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The sensor drivers are linked only for their SENSOR_INFO_T tables. These
+ * stand in for the sensor_drv_u.c calls their ioctl functions make, none of
+ * which is reached by the tests.
+ */
+
+#include "sensor_drv_u.h"
+
+int Sensor_WriteData(uint8_t *regPtr, uint32_t length)
+{
+    return -1;
+}
+
+int Sensor_SetMode(uint32_t mode)
+{
+    return -1;
+}
+
+int Sensor_StreamOff(void)
+{
+    return -1;
+}
+
+int32_t Sensor_WriteReg(uint16_t subaddr, uint16_t data)
+{
+    return -1;
+}
+
+uint16_t Sensor_ReadReg(uint16_t subaddr)
+{
+    return 0;
+}
+
+int Sensor_SetMCLK(uint32_t mclk)
+{
+    return -1;
+}
+
+int Sensor_SetVoltage(SENSOR_AVDD_VAL_E dvdd_val,
+               SENSOR_AVDD_VAL_E avdd_val, SENSOR_AVDD_VAL_E iodd_val)
+{
+    return -1;
+}
+
+BOOLEAN Sensor_PowerDown(BOOLEAN power_down)
+{
+    return SENSOR_FALSE;
+}
+
+void Sensor_Reset(uint32_t level)
+{
+}
+
+uint32_t Sensor_SetSensorExifInfo(SENSOR_EXIF_CTRL_E cmd, uint32_t param)
+{
+    return 0;
+}
+
+int Sensor_SetMonitorVoltage(SENSOR_AVDD_VAL_E vdd_val)
+{
+    return -1;
+}
+
+int32_t Sensor_WriteReg_8bits(uint16_t reg_addr, uint8_t value)
+{
+    return -1;
+}
+
+int32_t Sensor_ReadReg_8bits(uint8_t reg_addr, uint8_t *reg_val)
+{
+    return -1;
+}
+
+ERR_SENSOR_E Sensor_SendRegTabToSensor(SENSOR_REG_TAB_INFO_T *sensor_reg_tab_info_ptr)
+{
+    return SENSOR_OP_STATUS_ERR;
+}
+
+uint32_t Sensor_SetFlash(uint32_t is_open)
+{
+    return 0;
+}
+
+int _Sensor_Device_WriteRegTab(SENSOR_REG_TAB_PTR reg_tab)
+{
+    return -1;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * host stand-in for the bionic logging header. The camera code logs its
+ * verbose messages as errors, so everything goes to host_test_log() which
+ * keeps the messages of the current case and prints them when it fails.
+ */
+
+#ifndef HOST_TEST_STUB_CUTILS_LOG_H
+#define HOST_TEST_STUB_CUTILS_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+void host_test_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#define ALOGV(...)  ((void)0)
+#define ALOGD(...)  ((void)0)
+#define ALOGI(...)  host_test_log(__VA_ARGS__)
+#define ALOGW(...)  host_test_log(__VA_ARGS__)
+#define ALOGE(...)  host_test_log(__VA_ARGS__)
+
+/* the names before Jelly Bean, jpeg_fw_tiger still uses them */
+#define LOGV(...)   ALOGV(__VA_ARGS__)
+#define LOGD(...)   ALOGD(__VA_ARGS__)
+#define LOGI(...)   ALOGI(__VA_ARGS__)
+#define LOGW(...)   ALOGW(__VA_ARGS__)
+#define LOGE(...)   ALOGE(__VA_ARGS__)
+
+#endif
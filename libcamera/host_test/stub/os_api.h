@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The RTOS header jpeg_fw_8800g includes, the decoder only sleeps from it
+ * while it waits for the VSP.
+ */
+
+#ifndef HOST_TEST_STUB_OS_API_H
+#define HOST_TEST_STUB_OS_API_H
+
+#include <unistd.h>
+
+#define SCI_Sleep(ms)       usleep((ms) * 1000)
+
+#endif
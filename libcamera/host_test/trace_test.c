@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The per stage tracing of cmr_trace.c fed by a synthetic event generator.
+ *
+ * Four threads end jpeg_enc events of known durations, 1 to 1000 us, each
+ * once, so the percentiles cmr_trace_summary() logs are known. A fifth thread
+ * laps its ring three times with exif events, the dump has to keep the newest
+ * ring full of them. One thread marks the isp stage of 16 frames 1 ms apart
+ * and another completes them all at once, every frame has to get its own
+ * start. The dump is read back event by event. The cost of an event is timed
+ * with the tracing on and off, and turned off nothing may be recorded.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cutils/properties.h>
+
+#include "cmr_trace.h"
+#include "host_log.h"
+
+#define GEN_THREADS         4
+#define GEN_EVENTS          1000
+/* 7919 is prime, so the durations of the generator are a permutation */
+#define GEN_DUR_US(n)       ((n) * 7919 % GEN_EVENTS + 1)
+#define LAP_EVENTS          (3 * CMR_TRACE_RING_SIZE + 5)
+#define MARK_FRAMES         CMR_TRACE_MARK_NUM
+#define MARK_GAP_US         1000
+/* how late a loaded host may end an event */
+#define SLACK_US            2000
+#define COST_EVENTS         1000000
+#define TRACE_THREADS       (GEN_THREADS + 3)
+
+struct trace_evt {
+    char name[16];
+    unsigned long long ts;
+    unsigned int dur, tid, id;
+    int pid;
+};
+
+static const char *trace_prop = "1";
+static pthread_mutex_t mark_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mark_cond = PTHREAD_COND_INITIALIZER;
+static int marks_done;
+/*
+ * a ring is handed to the next thread when its owner exits, the threads stay
+ * until all are done so each keeps its own, as the threads of the HAL do
+ */
+static pthread_barrier_t exit_barrier;
+
+int property_get(const char *key, char *value, const char *default_value)
+{
+    if (strcmp(key, CMR_TRACE_PROPERTY))
+        snprintf(value, PROPERTY_VALUE_MAX, "%s", default_value ? default_value : "");
+    else
+        snprintf(value, PROPERTY_VALUE_MAX, "%s", trace_prop);
+    return strlen(value);
+}
+
+static void *gen_thread(void *arg)
+{
+    uint32_t n;
+    uint64_t now;
+
+    for (n = (uint32_t)(uintptr_t)arg; n < GEN_EVENTS; n += GEN_THREADS) {
+        now = cmr_trace_begin();
+        cmr_trace_end(CMR_TRACE_JPEG_ENC, n, now - GEN_DUR_US(n) * 1000ULL);
+    }
+    pthread_barrier_wait(&exit_barrier);
+    return NULL;
+}
+
+static void *lap_thread(void *arg)
+{
+    uint32_t n;
+
+    for (n = 0; n < LAP_EVENTS; n++)
+        cmr_trace_end(CMR_TRACE_EXIF, n, cmr_trace_begin());
+    pthread_barrier_wait(&exit_barrier);
+    return NULL;
+}
+
+static void *mark_thread(void *arg)
+{
+    uint32_t id;
+
+    for (id = 0; id < MARK_FRAMES; id++) {
+        cmr_trace_mark(CMR_TRACE_ISP, id);
+        usleep(MARK_GAP_US);
+    }
+    /* the message queue between the stages of the HAL */
+    pthread_mutex_lock(&mark_mutex);
+    marks_done = 1;
+    pthread_cond_signal(&mark_cond);
+    pthread_mutex_unlock(&mark_mutex);
+    pthread_barrier_wait(&exit_barrier);
+    return NULL;
+}
+
+static void *done_thread(void *arg)
+{
+    uint32_t id;
+
+    pthread_mutex_lock(&mark_mutex);
+    while (!marks_done)
+        pthread_cond_wait(&mark_cond, &mark_mutex);
+    pthread_mutex_unlock(&mark_mutex);
+    for (id = 0; id < MARK_FRAMES; id++)
+        cmr_trace_done(CMR_TRACE_ISP, id);
+    /* never marked, the done has nothing to end */
+    cmr_trace_done(CMR_TRACE_ROTATE, 0);
+    pthread_barrier_wait(&exit_barrier);
+    return NULL;
+}
+
+/* reads the events of a dump back, returns their count or -1 */
+static int read_dump(const char *path, struct trace_evt *evt, int max)
+{
+    char line[256];
+    FILE *fp;
+    int n = 0, ok = 0;
+
+    fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+    if (!fgets(line, sizeof(line), fp) || strcmp(line, "{\"traceEvents\":[\n")) {
+        fclose(fp);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp)) {
+        if (strcmp(line, "]}\n") == 0) {
+            ok = 1;
+            break;
+        }
+        if (!strcmp(line, "\n"))
+            continue;
+        if (n == max || sscanf(line, "{\"name\":\"%15[^\"]\",\"cat\":\"camera\",\"ph\":\"X\","
+                               "\"ts\":%llu,\"dur\":%u,\"pid\":%d,\"tid\":%u,\"args\":{\"id\":%u}}",
+                               evt[n].name, &evt[n].ts, &evt[n].dur, &evt[n].pid, &evt[n].tid,
+                               &evt[n].id) != 6)
+            break;
+        n++;
+    }
+    fclose(fp);
+    return ok ? n : -1;
+}
+
+static int check_events(const struct trace_evt *evt, int num)
+{
+    unsigned int gen_seen[GEN_EVENTS] = { 0 };
+    unsigned int isp_dur[MARK_FRAMES] = { 0 };
+    unsigned int gen = 0, lap = 0, isp = 0, lap_min = ~0u, lap_max = 0, id;
+    int failed = 0, i;
+
+    for (i = 0; i < num; i++) {
+        if (evt[i].pid != getpid()) {
+            fprintf(stderr, "trace: event %d has pid %d\n", i, evt[i].pid);
+            failed++;
+        }
+        if (!strcmp(evt[i].name, "jpeg_enc")) {
+            gen++;
+            if (evt[i].id >= GEN_EVENTS || gen_seen[evt[i].id]++
+                || evt[i].dur < GEN_DUR_US(evt[i].id)
+                || evt[i].dur > GEN_DUR_US(evt[i].id) + SLACK_US) {
+                fprintf(stderr, "trace: jpeg_enc %u took %u us, not %u\n", evt[i].id,
+                        evt[i].dur, GEN_DUR_US(evt[i].id));
+                failed++;
+            }
+        } else if (!strcmp(evt[i].name, "exif")) {
+            lap++;
+            lap_min = evt[i].id < lap_min ? evt[i].id : lap_min;
+            lap_max = evt[i].id > lap_max ? evt[i].id : lap_max;
+        } else if (!strcmp(evt[i].name, "isp")) {
+            isp++;
+            if (evt[i].id < MARK_FRAMES)
+                isp_dur[evt[i].id] = evt[i].dur;
+        } else {
+            fprintf(stderr, "trace: unexpected %s event\n", evt[i].name);
+            failed++;
+        }
+    }
+
+    printf("trace: %u jpeg_enc, %u exif, %u isp events in the dump\n", gen, lap, isp);
+    if (gen != GEN_EVENTS) {
+        fprintf(stderr, "trace: %u of the %u jpeg_enc events dumped\n", gen, GEN_EVENTS);
+        failed++;
+    }
+    if (lap != CMR_TRACE_RING_SIZE || lap_min != LAP_EVENTS - CMR_TRACE_RING_SIZE
+        || lap_max != LAP_EVENTS - 1) {
+        fprintf(stderr, "trace: the lapped ring kept %u events, ids %u to %u\n", lap, lap_min,
+                lap_max);
+        failed++;
+    }
+    if (isp != MARK_FRAMES) {
+        fprintf(stderr, "trace: %u of the %u isp frames completed\n", isp, MARK_FRAMES);
+        failed++;
+    }
+    /* the frames were marked 1 ms apart and completed together, in order */
+    for (id = 1; id < MARK_FRAMES; id++) {
+        if (isp_dur[id] >= isp_dur[id - 1] || isp_dur[id - 1] - isp_dur[id] < MARK_GAP_US / 2) {
+            fprintf(stderr, "trace: isp frame %u took %u us after frame %u took %u us\n", id,
+                    isp_dur[id], id - 1, isp_dur[id - 1]);
+            failed++;
+            break;
+        }
+    }
+    return failed;
+}
+
+/* the percentiles cmr_trace_summary() logged for the generator */
+static int check_summary(void)
+{
+    unsigned int cnt, p50, p99, max;
+    const char *line;
+
+    line = strstr(host_log_buf, "jpeg_enc: cnt ");
+    if (!line || sscanf(line, "jpeg_enc: cnt %u, p50 %u us, p99 %u us, max %u us",
+                        &cnt, &p50, &p99, &max) != 4) {
+        fprintf(stderr, "trace: no jpeg_enc summary\n%s", host_log_buf);
+        return 1;
+    }
+    printf("trace: summary jpeg_enc cnt %u, p50 %u us, p99 %u us, max %u us\n",
+           cnt, p50, p99, max);
+    if (cnt != GEN_EVENTS || p50 < GEN_EVENTS / 2 + 1 || p50 > GEN_EVENTS / 2 + 1 + SLACK_US
+        || p99 < GEN_EVENTS * 99 / 100 + 1 || p99 > GEN_EVENTS * 99 / 100 + 1 + SLACK_US
+        || max < GEN_EVENTS || max > GEN_EVENTS + SLACK_US) {
+        fprintf(stderr, "trace: the summary does not match the generator\n");
+        return 1;
+    }
+    return 0;
+}
+
+static double event_cost_ns(void)
+{
+    struct timespec t0, t1;
+    uint32_t n;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (n = 0; n < COST_EVENTS; n++)
+        cmr_trace_end(CMR_TRACE_CALLBACK, n, cmr_trace_begin());
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / COST_EVENTS;
+}
+
+int main(void)
+{
+    pthread_t threads[TRACE_THREADS];
+    char path[] = "/tmp/cmr_trace.XXXXXX";
+    struct trace_evt *evt;
+    double on_ns, off_ns;
+    int failed = 0, fd, num;
+    unsigned int i;
+
+    evt = malloc(CMR_TRACE_THREAD_MAX * CMR_TRACE_RING_SIZE * sizeof(*evt));
+    fd = mkstemp(path);
+    if (!evt || fd < 0) {
+        fprintf(stderr, "trace: out of memory\n");
+        return 1;
+    }
+    close(fd);
+
+    cmr_trace_init();
+    pthread_barrier_init(&exit_barrier, NULL, TRACE_THREADS);
+    for (i = 0; i < GEN_THREADS; i++)
+        pthread_create(&threads[i], NULL, gen_thread, (void *)(uintptr_t)i);
+    pthread_create(&threads[i++], NULL, lap_thread, NULL);
+    pthread_create(&threads[i++], NULL, done_thread, NULL);
+    pthread_create(&threads[i++], NULL, mark_thread, NULL);
+    for (i = 0; i < TRACE_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&exit_barrier);
+
+    host_log_reset();
+    cmr_trace_summary();
+    failed += check_summary();
+    if (cmr_trace_dump(path)) {
+        fprintf(stderr, "trace: can not dump to %s\n", path);
+        failed++;
+    } else {
+        num = read_dump(path, evt, CMR_TRACE_THREAD_MAX * CMR_TRACE_RING_SIZE);
+        if (num < 0) {
+            fprintf(stderr, "trace: %s is not a trace the dump writes\n", path);
+            failed++;
+        } else {
+            failed += check_events(evt, num);
+        }
+    }
+
+    /* a new session starts empty */
+    cmr_trace_init();
+    on_ns = event_cost_ns();
+    trace_prop = "0";
+    cmr_trace_init();
+    off_ns = event_cost_ns();
+    cmr_trace_mark(CMR_TRACE_ISP, 0);
+    cmr_trace_done(CMR_TRACE_ISP, 0);
+    printf("trace: an event costs %.1f ns traced, %.1f ns off\n", on_ns, off_ns);
+
+    num = cmr_trace_dump(path) ? -1 : read_dump(path, evt, CMR_TRACE_THREAD_MAX * CMR_TRACE_RING_SIZE);
+    if (num != CMR_TRACE_RING_SIZE) {
+        fprintf(stderr, "trace: the second session dumped %d events, not the %u of its ring\n",
+                num, CMR_TRACE_RING_SIZE);
+        failed++;
+    }
+    for (i = 0; num > 0 && i < (unsigned int)num; i++) {
+        if (strcmp(evt[i].name, "callback") || evt[i].id < COST_EVENTS - CMR_TRACE_RING_SIZE) {
+            fprintf(stderr, "trace: %s %u recorded after the tracing was turned off\n",
+                    evt[i].name, evt[i].id);
+            failed++;
+            break;
+        }
+    }
+
+    unlink(path);
+    free(evt);
+    printf("trace: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
@@ -26,7 +26,10 @@
 #include <sys/socket.h>
 #include <stdint.h>
 #include <sys/types.h>
-#include <semaphore.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <pthread.h>
 #define LOG_TAG "isp-video"
 #include <cutils/log.h>
@@ -94,14 +97,48 @@ struct camera_func{
 #define DBG ALOGD
 #endif
 
-static unsigned char diag_cmd_buf[CMD_BUF_SIZE];
-static unsigned char eng_rsp_diag[DATA_BUF_SIZE];
+#define CLIENT_MAX 4
+#define IMAGE_HEAD_SIZE (1 + sizeof(MSG_HEAD_T) + sizeof(ISP_IMAGE_HEADER_T))
+
+/*
+  A copy of one preview frame, shared by every client sending it. The
+  preview thread only copies the frame and replaces the latest one, the
+  sockets are served by the server thread, so a slow client never stalls
+  the preview. A client which is still sending an old frame gets the latest
+  one on its next request, the frames in between are dropped.
+*/
+struct isp_video_frame {
+	volatile int32_t refcnt;
+	uint32_t id;
+	uint32_t format;
+	uint32_t size_id;
+	uint32_t len;
+	uint8_t data[0];
+};
+
+struct isp_video_client {
+	int fd;
+	uint32_t seq_num;
+	uint32_t want_frame;	// 1: a picture is requested
+	uint32_t req_frame_id;	// only a frame published after the request is sent
+	struct isp_video_frame *frame;
+	uint32_t packet_num;
+	uint32_t packetsn;
+	uint32_t packet_sent;
+	uint32_t rsp_len;	// a command response waiting to be sent
+	uint32_t rsp_sent;
+	uint8_t image_head[IMAGE_HEAD_SIZE];
+	unsigned char cmd_buf[CMD_BUF_SIZE];
+	unsigned char rsp_buf[DATA_BUF_SIZE];
+};
+
 static int preview_flag = 0; // 1: start preview
-static int getpic_flag = 0; // 1: call get pic
-static sem_t thread_sem_lock;
-static int wire_connected = 0;
-static int sockfd = 0;
-int sequence_num = 0;
+static volatile int frame_wanted = 0; // 1: a client waits for a picture
+static pthread_mutex_t frame_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct isp_video_frame *latest_frame = NULL;
+static uint32_t frame_id = 0;
+static int wake_fd[2] = {-1, -1};
+static struct isp_video_client *clients[CLIENT_MAX];
 struct camera_func s_camera_fun={0x00};
 struct camera_func* s_camera_fun_ptr=&s_camera_fun;
 
@@ -154,54 +191,155 @@ uint32_t ispvideo_SetIspParamToSt(unsigned char* dig_ptr, struct isp_parser_buf_
 	return buf_len;
 }
 
-static int handle_img_data(uint32_t format, uint32_t width,uint32_t height,char *imgptr, int imagelen)
+static void frame_put(struct isp_video_frame *frame)
+{
+	if ((NULL != frame) && (0 == __sync_sub_and_fetch(&frame->refcnt, 1)))
+		free(frame);
+}
+
+/* returns the latest frame if it is newer than after_id, with a reference taken */
+static struct isp_video_frame *frame_get_latest(uint32_t after_id)
+{
+	struct isp_video_frame *frame = NULL;
+
+	pthread_mutex_lock(&frame_mutex);
+	if ((NULL != latest_frame) && (latest_frame->id > after_id)) {
+		frame = latest_frame;
+		__sync_add_and_fetch(&frame->refcnt, 1);
+	}
+	pthread_mutex_unlock(&frame_mutex);
+
+	return frame;
+}
+
+static int client_respond(struct isp_video_client *client, uint32_t len)
+{
+	client->rsp_len = len;
+	client->rsp_sent = 0;
+
+	return len;
+}
+
+static void client_want_frame(struct isp_video_client *client)
+{
+	pthread_mutex_lock(&frame_mutex);
+	client->want_frame = 1;
+	client->req_frame_id = frame_id;
+	frame_wanted = 1;
+	pthread_mutex_unlock(&frame_mutex);
+}
+
+static int client_is_busy(struct isp_video_client *client)
+{
+	return client->want_frame || (NULL != client->frame) || client->rsp_len;
+}
+
+static void client_start_frame(struct isp_video_client *client, struct isp_video_frame *frame)
+{
+	DBG("%s: fd %d, frame %d, imagelen[%d]\n", __FUNCTION__, client->fd, frame->id, frame->len);
+	client->want_frame = 0;
+	client->frame = frame;
+	client->packet_num = (frame->len + SEND_IMAGE_SIZE - 1) / SEND_IMAGE_SIZE;
+	client->packetsn = 0;
+	client->packet_sent = 0;
+}
+
+static void client_fill_image_head(struct isp_video_client *client, uint32_t len)
 {
-	int i,  res, number;
-	int len = 0, rlen = 0, rsp_len = 0, extra_len = 0;
-	MSG_HEAD_T *msg_ret;
+	MSG_HEAD_T *msg_ret = (MSG_HEAD_T *)(client->image_head+1);
 	ISP_IMAGE_HEADER_T isp_msg;
-	uint32_t size_id=0x00;
 
-	size_id=ispParserGetSizeID(width,height);
+	// the head of the picture request is still in rsp_buf
+	memcpy(client->image_head, client->rsp_buf, sizeof(MSG_HEAD_T)+1);
 
-	number = (imagelen + SEND_IMAGE_SIZE - 1) /SEND_IMAGE_SIZE;
-	msg_ret = (MSG_HEAD_T *)(eng_rsp_diag+1);
-	DBG("%s: imagelen[%d] number[%d]\n",__FUNCTION__, imagelen, number);
+	isp_msg.headlen = 12;
+	isp_msg.img_format = client->frame->format;
+	isp_msg.img_size = client->frame->size_id;
+	isp_msg.totalpacket = client->packet_num;
+	isp_msg.packetsn = client->packetsn+1;
+	memcpy(client->image_head+sizeof(MSG_HEAD_T)+1, (char *)&isp_msg, sizeof(ISP_IMAGE_HEADER_T));
 
-	for (i=0; i<number; i++)
-	{
-		if (i < number-1)
+	msg_ret->len = IMAGE_HEAD_SIZE+len-1;
+	msg_ret->seq_num = client->seq_num++;
+}
+
+/*
+  Sends the packets of the current frame straight from the shared frame, the
+  head, the image data and the tail going out in one sendmsg. Returns -1 on a
+  socket error, 0 when the frame is done or the socket is full.
+*/
+static int client_send_frame(struct isp_video_client *client)
+{
+	static uint8_t image_tail = 0x7e;
+	struct iovec iov[3];
+	struct msghdr msg;
+	uint32_t len, skip, i;
+	ssize_t res;
+
+	while (NULL != client->frame) {
+		if (client->packetsn < client->packet_num-1)
 			len = SEND_IMAGE_SIZE;
 		else
-			len = imagelen-SEND_IMAGE_SIZE*i;
-		rsp_len = sizeof(MSG_HEAD_T)+1;
-
-		// combine data
-		isp_msg.headlen = 12;
-		isp_msg.img_format = format;
-		isp_msg.img_size = size_id;
-		isp_msg.totalpacket = number;
-		isp_msg.packetsn = i+1;
-		DBG("%s: request rsp_len[%d] index[%d] len[%d]\n",__FUNCTION__, rsp_len, i, len);
-		memcpy(eng_rsp_diag+rsp_len, (char *)&isp_msg, sizeof(ISP_IMAGE_HEADER_T));
-		rsp_len += sizeof(ISP_IMAGE_HEADER_T);
-
-		DBG("%s: request rsp_len[%d]\n",__FUNCTION__, rsp_len);
-		memcpy(eng_rsp_diag+rsp_len, (char *)imgptr+i*SEND_IMAGE_SIZE, len);
-		rsp_len += len;
-
-		eng_rsp_diag[rsp_len] = 0x7e;
-		msg_ret->len = rsp_len-1;
-		msg_ret->seq_num = sequence_num++;
-		DBG("%s: request rsp_len[%d]\n",__FUNCTION__, rsp_len);
-		res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
-		DBG("%s: send success. res: %d, rsp_len: %d.\n",__FUNCTION__, res, rsp_len + 1);
+			len = client->frame->len-SEND_IMAGE_SIZE*client->packetsn;
+
+		if (0 == client->packet_sent)
+			client_fill_image_head(client, len);
+
+		iov[0].iov_base = client->image_head;
+		iov[0].iov_len = IMAGE_HEAD_SIZE;
+		iov[1].iov_base = client->frame->data+client->packetsn*SEND_IMAGE_SIZE;
+		iov[1].iov_len = len;
+		iov[2].iov_base = &image_tail;
+		iov[2].iov_len = 1;
+
+		// skip what a partial send already took
+		skip = client->packet_sent;
+		for (i = 0; skip >= iov[i].iov_len; i++)
+			skip -= iov[i].iov_len;
+		iov[i].iov_base = (uint8_t *)iov[i].iov_base+skip;
+		iov[i].iov_len -= skip;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov[i];
+		msg.msg_iovlen = 3-i;
+		res = sendmsg(client->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (res < 0)
+			return ((EAGAIN == errno) || (EWOULDBLOCK == errno)) ? 0 : -1;
+
+		client->packet_sent += res;
+		if (client->packet_sent == IMAGE_HEAD_SIZE+len+1) {
+			client->packet_sent = 0;
+			client->packetsn++;
+			if (client->packetsn == client->packet_num) {
+				frame_put(client->frame);
+				client->frame = NULL;
+			}
+		}
 	}
+
 	return 0;
 }
 
-static int handle_isp_data(unsigned char *buf, unsigned int len)
+static int client_send_rsp(struct isp_video_client *client)
 {
+	ssize_t res;
+
+	while (client->rsp_sent < client->rsp_len) {
+		res = send(client->fd, client->rsp_buf+client->rsp_sent,
+			client->rsp_len-client->rsp_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (res < 0)
+			return ((EAGAIN == errno) || (EWOULDBLOCK == errno)) ? 0 : -1;
+		client->rsp_sent += res;
+	}
+	client->rsp_len = 0;
+	client->rsp_sent = 0;
+
+	return 0;
+}
+
+static int handle_isp_data(struct isp_video_client *client, unsigned char *buf, unsigned int len)
+{
+	unsigned char *eng_rsp_diag = client->rsp_buf;
 	int rlen = 0, rsp_len = 0, extra_len = 0;
 	int ret = 1, res = 0;
 	int image_type = 0;
@@ -218,12 +356,12 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 		return -1;
 
 	rsp_len = sizeof(MSG_HEAD_T)+1;
-	memset(eng_rsp_diag,0,sizeof(eng_rsp_diag));
+	memset(eng_rsp_diag,0,DATA_BUF_SIZE);
 	memcpy(eng_rsp_diag,buf,rsp_len);
 	msg_ret = (MSG_HEAD_T *)(eng_rsp_diag+1);
 
 	if(CMD_GET_PREVIEW_PICTURE != msg->subtype) {
-		msg_ret->seq_num = sequence_num++;
+		msg_ret->seq_num = client->seq_num++;
 	}
 
 	switch ( msg->subtype ) {
@@ -235,7 +373,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 
 		case CMD_STOP_PREVIEW:
@@ -246,7 +384,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 
 		case CMD_READ_ISP_PARAM:
@@ -332,7 +470,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
 			DBG("ISP_TOOL:isp ret:0x%x ,len:0x%x \n",ret,msg_ret->len);
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 		}
 		case CMD_WRITE_ISP_PARAM:
@@ -368,16 +506,14 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 		}
 		case CMD_GET_PREVIEW_PICTURE:
 		{
 			DBG("ISP_TOOL:CMD_GET_PREVIEW_PICTURE \n");
 			image_type = *(buf+rsp_len);
-			getpic_flag = 1;
-			sem_wait(&thread_sem_lock);
-			getpic_flag = 0;
+			client_want_frame(client);
 			break;
 		}
 		case CMD_UPLOAD_MAIN_INFO:
@@ -432,7 +568,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len += rlen;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break ;
 		}
 		case CMD_TAKE_PICTURE:
@@ -481,9 +617,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			}
 #endif
 			image_type = *(buf+rsp_len);
-			getpic_flag = 1;
-			sem_wait(&thread_sem_lock);
-			getpic_flag = 0;
+			client_want_frame(client);
 			break;
 		}
 		case CMD_ISP_LEVEL:
@@ -509,7 +643,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 		}
 
@@ -546,7 +680,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 		}
 		case CMD_WRITE_SENSOR_REG:
@@ -572,7 +706,7 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 			rsp_len++;
 			eng_rsp_diag[rsp_len] = 0x7e;
 			msg_ret->len = rsp_len-1;
-			res = send(sockfd, eng_rsp_diag, rsp_len+1, 0);
+			res = client_respond(client, rsp_len+1);
 			break;
 		}
 		default:
@@ -592,82 +726,156 @@ static int handle_isp_data(unsigned char *buf, unsigned int len)
 */
 void send_img_data(uint32_t format, uint32_t width, uint32_t height, char *imgptr, int imagelen)
 {
-	int ret;
+	struct isp_video_frame *frame, *old_frame;
+	char wake = 0;
 
-	if (( (preview_flag == 1) && (getpic_flag == 1)) ||
-		( (preview_flag == 0) && (getpic_flag == 1)))
-	{
-		DBG("%s: preview_flag: %d, getpic_flag: %d, imagelen: %d.\n", __FUNCTION__, preview_flag, getpic_flag, imagelen);
-		getpic_flag = 0;
-		ret = handle_img_data(format, width, height, imgptr, imagelen);
-		sem_post(&thread_sem_lock);
-		if (ret != 0) {
-			DBG("%s: Fail to handle_img_data(). ret = %d.", __FUNCTION__, ret);
-		}
-	}
-	else {
-		DBG("%s: no data. preview_flag: %d, getpic_flag: %d.\n", __FUNCTION__, preview_flag, getpic_flag);
+	// nobody waits, nothing to copy
+	if ((0 == frame_wanted) || (imagelen <= 0))
+		return;
+
+	DBG("%s: preview_flag: %d, imagelen: %d.\n", __FUNCTION__, preview_flag, imagelen);
+	frame = (struct isp_video_frame *)malloc(sizeof(struct isp_video_frame)+imagelen);
+	if (NULL == frame) {
+		DBG("%s: no memory, imagelen: %d.\n", __FUNCTION__, imagelen);
+		return;
 	}
+	frame->refcnt = 1;
+	frame->format = format;
+	frame->size_id = ispParserGetSizeID(width, height);
+	frame->len = imagelen;
+	memcpy(frame->data, imgptr, imagelen);
+
+	pthread_mutex_lock(&frame_mutex);
+	old_frame = latest_frame;
+	frame->id = ++frame_id;
+	latest_frame = frame;
+	frame_wanted = 0;
+	pthread_mutex_unlock(&frame_mutex);
+
+	frame_put(old_frame);
+	write(wake_fd[1], &wake, 1);
 }
 
-static void * isp_diag_handler(void *args)
+static void client_close(int index)
 {
-	int from = *((int *)args);
-	static char *code = "diag channel exit";
-	fd_set rfds;
-	struct timeval tv;
-
-	FD_ZERO(&rfds);
-	FD_SET(from, &rfds);
-
-	sockfd = from;
-	/* Read client request, send sequence number back */
-	while (wire_connected) {
-		int i, cnt, res;
-		/* Wait up to  two seconds. */
-		tv.tv_sec = 2;
-		tv.tv_usec = 0;
-		FD_SET(from, &rfds);
-		res = select(from + 1, &rfds, NULL, NULL, &tv);
-		if (res <= 0) { //timeout or other error
-			DBG("No data within five seconds. res:%d\n", res);
-			continue;
-		}
-		//cnt = read(diag->from, diag_cmd_buf, DATA_BUF_SIZE);
-		cnt = recv(from, diag_cmd_buf, CMD_BUF_SIZE,
-				MSG_DONTWAIT);
-		//DBG("read from socket %d\n", cnt);
-		if (cnt <= 0) {
-			DBG("read socket error %s\n", strerror(errno));
-			break;
-		}
-		DBG("%s: request buffer[%d]\n",__FUNCTION__, cnt);
-		for(i=0; i<cnt; i++)
-			DBG("%x,",diag_cmd_buf[i]);
-		DBG("\n");
-
-		handle_isp_data(diag_cmd_buf, cnt);
-	}
-	return code;
+	struct isp_video_client *client = clients[index];
+
+	DBG("%s: fd %d\n", __FUNCTION__, client->fd);
+	if (close(client->fd) == -1)           /* Close connection */
+		DBG("close socket cfd error\n");
+	frame_put(client->frame);
+	free(client);
+	clients[index] = NULL;
 }
 
-static void * ispserver_thread(void *args)
+static void client_accept(int lfd)
 {
 	struct sockaddr claddr;
-	int lfd, cfd, optval;
-	int log_fd;
-	struct sockaddr_in sock_addr;
 	socklen_t addrlen;
+	struct isp_video_client *client;
+	int cfd, i;
 #ifdef CLIENT_DEBUG
 #define ADDRSTRLEN (128)
 	char addrStr[ADDRSTRLEN];
 	char host[50];
 	char service[30];
 #endif
-	pthread_t tdiag;
-	pthread_attr_t attr;
 
-	DBG("isp-video server version 1.0\n");
+	/* Accept a client connection, obtaining client's address */
+	addrlen = sizeof(struct sockaddr);
+	cfd = accept(lfd, &claddr, &addrlen);
+	if (cfd == -1) {
+		DBG("accept error %s\n", strerror(errno));
+		return;
+	}
+
+	for (i = 0; i < CLIENT_MAX; i++) {
+		if (NULL == clients[i])
+			break;
+	}
+	client = (i < CLIENT_MAX) ? (struct isp_video_client *)calloc(1, sizeof(struct isp_video_client)) : NULL;
+	if (NULL == client) {
+		DBG("no room for a new client\n");
+		close(cfd);
+		return;
+	}
+	fcntl(cfd, F_SETFL, fcntl(cfd, F_GETFL) | O_NONBLOCK);
+	client->fd = cfd;
+	clients[i] = client;
+
+#ifdef CLIENT_DEBUG
+	if (getnameinfo(&claddr, addrlen, host, 50, service,
+		 30, NI_NUMERICHOST) == 0)
+		snprintf(addrStr, ADDRSTRLEN, "(%s, %s)", host, service);
+	else
+		snprintf(addrStr, ADDRSTRLEN, "(?UNKNOWN?)");
+	DBG("Connection from %s, client %d\n", addrStr, i);
+#endif
+}
+
+static int client_recv(struct isp_video_client *client)
+{
+	int i, cnt;
+
+	cnt = recv(client->fd, client->cmd_buf, CMD_BUF_SIZE, MSG_DONTWAIT);
+	if (cnt <= 0) {
+		if ((cnt < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+			return 0;
+		DBG("read socket error %s\n", strerror(errno));
+		return -1;
+	}
+	DBG("%s: request buffer[%d]\n",__FUNCTION__, cnt);
+	for(i=0; i<cnt; i++)
+		DBG("%x,",client->cmd_buf[i]);
+	DBG("\n");
+
+	handle_isp_data(client, client->cmd_buf, cnt);
+
+	return 0;
+}
+
+/* hands the new frame to the waiting clients and sends what the sockets take */
+static void client_dispatch(void)
+{
+	struct isp_video_client *client;
+	struct isp_video_frame *frame;
+	int i, wanted = 0;
+
+	for (i = 0; i < CLIENT_MAX; i++) {
+		client = clients[i];
+		if (NULL == client)
+			continue;
+
+		if (client->want_frame) {
+			frame = frame_get_latest(client->req_frame_id);
+			if (NULL != frame)
+				client_start_frame(client, frame);
+		}
+
+		if (client_send_rsp(client) || client_send_frame(client)) {
+			client_close(i);
+			continue;
+		}
+		wanted |= client->want_frame;
+	}
+
+	pthread_mutex_lock(&frame_mutex);
+	for (i = 0; (i < CLIENT_MAX) && !wanted; i++)
+		wanted = (NULL != clients[i]) && clients[i]->want_frame;
+	frame_wanted = wanted;
+	pthread_mutex_unlock(&frame_mutex);
+}
+
+static void * ispserver_thread(void *args)
+{
+	int lfd, optval;
+	struct sockaddr_in sock_addr;
+	struct pollfd fds[CLIENT_MAX+2];
+	int fd_client[CLIENT_MAX+2];
+	char wake[16];
+	int i, nfds, res;
+
+	DBG("isp-video server version 1.1\n");
 
 	memset(&sock_addr, 0, sizeof (struct sockaddr_in));
 	sock_addr.sin_family = AF_INET;        /* Allows IPv4*/
@@ -696,51 +904,73 @@ static void * ispserver_thread(void *args)
 		 return NULL;
 	}
 
-	sem_init(&thread_sem_lock, 0, 0);
-	pthread_attr_init(&attr);
-	for (;;) {                  /* Handle clients iteratively */
-		void * res;
-		int ret;
-
-		DBG("log server waiting client dail in...\n");
-		/* Accept a client connection, obtaining client's address */
-		addrlen = sizeof(struct sockaddr);
-		cfd = accept(lfd, &claddr, &addrlen);
-		if (cfd == -1) {
-			DBG("accept error %s\n", strerror(errno));
-			break;
+	/* the preview thread wakes the server up when a frame is published */
+	if (pipe(wake_fd) == -1) {
+		DBG("pipe error %s\n", strerror(errno));
+		 return NULL;
+	}
+	fcntl(wake_fd[0], F_SETFL, fcntl(wake_fd[0], F_GETFL) | O_NONBLOCK);
+	fcntl(wake_fd[1], F_SETFL, fcntl(wake_fd[1], F_GETFL) | O_NONBLOCK);
+
+	/* Ignore the SIGPIPE signal, so that we find out about broken
+	 * connection errors via a failure from write().
+	 */
+	if (signal(SIGPIPE, SIG_IGN) == SIG_ERR)
+		DBG("signal error\n");
+
+	for (;;) {
+		fds[0].fd = lfd;
+		fds[0].events = POLLIN;
+		fds[1].fd = wake_fd[0];
+		fds[1].events = POLLIN;
+		nfds = 2;
+		for (i = 0; i < CLIENT_MAX; i++) {
+			if (NULL == clients[i])
+				continue;
+			// a client is served one command at a time
+			fds[nfds].fd = clients[i]->fd;
+			if (!client_is_busy(clients[i]))
+				fds[nfds].events = POLLIN;
+			else if (clients[i]->want_frame)
+				fds[nfds].events = 0;
+			else
+				fds[nfds].events = POLLOUT;
+			fd_client[nfds] = i;
+			nfds++;
 		}
-		DBG("log server connected with client\n");
-		wire_connected = 1;
-		sequence_num = 0;
-		/* Ignore the SIGPIPE signal, so that we find out about broken
-		 * connection errors via a failure from write().
-		 */
-		if (signal(SIGPIPE, SIG_IGN) == SIG_ERR)
-			DBG("signal error\n");
-#ifdef CLIENT_DEBUG
-		addrlen = sizeof(struct sockaddr);
-		if (getnameinfo(&claddr, addrlen, host, 50, service,
-			 30, NI_NUMERICHOST) == 0)
-			snprintf(addrStr, ADDRSTRLEN, "(%s, %s)", host, service);
-		else
-			snprintf(addrStr, ADDRSTRLEN, "(?UNKNOWN?)");
-		DBG("Connection from %s\n", addrStr);
-#endif
 
-		//create a thread for recv cmd
-		ret = pthread_create(&tdiag, &attr, isp_diag_handler, &cfd);
-		if (ret != 0) {
-			DBG("diag thread create success\n");
+		res = poll(fds, nfds, -1);
+		if (res < 0) {
+			if (EINTR == errno)
+				continue;
+			DBG("poll error %s\n", strerror(errno));
 			break;
 		}
 
-		pthread_join(tdiag, &res);
-		DBG("diag thread exit success %s\n", (char *)res);
-		if (close(cfd) == -1)           /* Close connection */
-			DBG("close socket cfd error\n");
+		if (fds[1].revents & POLLIN) {
+			while (read(wake_fd[0], wake, sizeof(wake)) > 0)
+				;
+		}
+
+		for (i = 2; i < nfds; i++) {
+			if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+				client_close(fd_client[i]);
+			} else if (fds[i].revents & POLLIN) {
+				if (client_recv(clients[fd_client[i]]))
+					client_close(fd_client[i]);
+			}
+		}
+
+		if (fds[0].revents & POLLIN)
+			client_accept(lfd);
+
+		client_dispatch();
+	}
+
+	for (i = 0; i < CLIENT_MAX; i++) {
+		if (NULL != clients[i])
+			client_close(i);
 	}
-	pthread_attr_destroy(&attr);
 	if (close(lfd) == -1)           /* Close connection */
 		DBG("close socket lfd error\n");
 
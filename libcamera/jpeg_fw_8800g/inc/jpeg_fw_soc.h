@@ -0,0 +1,27 @@
+/******************************************************************************
+ ** File Name:      jpeg_fw_soc.h                                             *
+ ** Author:                                                                   *
+ ** DATE:           10/19/2026                                                *
+ ** Description:    the SoC binding of the jpeg core for sc8800g.             *
+ ** Note:           The sources of jpeg_fw_common include this header only,   *
+ **                 it wraps sc8800g_video_header.h of this tree.             *
+******************************************************************************/
+/******************************************************************************
+ **                        Edit History                                       *
+ ** ------------------------------------------------------------------------- *
+ ** DATE           NAME             DESCRIPTION                               *
+ ** 10/19/2026                      Create.                                   *
+******************************************************************************/
+#ifndef _JPEG_FW_SOC_H_
+#define _JPEG_FW_SOC_H_
+
+#include "sc8800g_video_header.h"
+#include "os_api.h"
+
+/*the register polling helper of the older vsp driver*/
+#ifndef VSP_READ_REG_POLL
+#define VSP_READ_REG_POLL	READ_REG_POLL
+#endif
+
+#endif  //_JPEG_FW_SOC_H_
+// End 
@@ -19,7 +19,10 @@
 #include "jpeg_jfif.h"
 #include "jpeg_common.h"
 
+//the build may set it, the host tests turn it on
+#ifndef PROGRESSIVE_SUPPORT
 #define PROGRESSIVE_SUPPORT 1
+#endif
 
 /*down sample*/
 #define DOWN_SAMPLE_DIS	0
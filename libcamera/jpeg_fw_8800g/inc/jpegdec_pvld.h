@@ -18,7 +18,7 @@
 **                        Dependencies                                        *
 **---------------------------------------------------------------------------*/
 #include "jpegcodec_def.h"
-#include "JpegDec_bitstream.h"
+#include "jpegdec_bitstream.h"
 /**---------------------------------------------------------------------------*
 **                        Compiler Flag                                       *
 **---------------------------------------------------------------------------*/
@@ -112,6 +112,13 @@ JPEG_RET_E Jpeg_WriteAPP1(uint8 *target_buf,
 JINF_RET_E IMGJPEG_WriteExif(JINF_WEXIF_IN_PARAM_T *in_param_ptr,
 										 JINF_WEXIF_OUT_PARAM_T *out_param_ptr);
 
+/*
+*@	Name :
+*@	Description:	release the APP1 template kept by IMGJPEG_WriteExif, call it
+*@					when the session is over
+*/
+void IMGJPEG_ResetExifTemplate(void);
+
 /*
 *@	Name :
 *@	Description:	format the date/time string
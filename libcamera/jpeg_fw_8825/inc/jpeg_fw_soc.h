@@ -0,0 +1,21 @@
+/******************************************************************************
+ ** File Name:      jpeg_fw_soc.h                                             *
+ ** Author:                                                                   *
+ ** DATE:           10/19/2026                                                *
+ ** Description:    the SoC binding of the jpeg core for sc8825.              *
+ ** Note:           The sources of jpeg_fw_common include this header only,   *
+ **                 it wraps sc8825_video_header.h of this tree.              *
+******************************************************************************/
+/******************************************************************************
+ **                        Edit History                                       *
+ ** ------------------------------------------------------------------------- *
+ ** DATE           NAME             DESCRIPTION                               *
+ ** 10/19/2026                      Create.                                   *
+******************************************************************************/
+#ifndef _JPEG_FW_SOC_H_
+#define _JPEG_FW_SOC_H_
+
+#include "sc8825_video_header.h"
+
+#endif  //_JPEG_FW_SOC_H_
+// End 
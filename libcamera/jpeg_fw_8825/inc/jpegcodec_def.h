@@ -21,7 +21,10 @@
 
 
 
+//the build may set it, the host tests turn it on
+#ifndef PROGRESSIVE_SUPPORT
 #define PROGRESSIVE_SUPPORT 0
+#endif
 
 /*down sample*/
 #define DOWN_SAMPLE_DIS	0
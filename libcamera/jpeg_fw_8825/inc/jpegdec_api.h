@@ -107,9 +107,25 @@ typedef struct jpegdec_params
 
 	uint32_t   fw_decode_buf_size;
 	void * 	fw_decode_buf;
+
+	uint32_t	scale_down;	/*0 ~ 2, the output is (width >> scale_down) x (height >> scale_down)*/
 	 
 }JPEGDEC_PARAMS_T;
 
+#define JPEGDEC_SCALE_DOWN_MAX	3	/*1/8*/
+
+typedef struct
+{
+	uint32_t	stream_offset;	/*word aligned, from the start of the given stream*/
+	uint32_t	stream_size;
+	uint32_t	width;			/*of the picked stream*/
+	uint32_t	height;
+	uint32_t	scale_down;		/*for JPEGDEC_PARAMS_T*/
+	uint32_t	out_width;
+	uint32_t	out_height;
+	uint32_t	is_thumbnail;	/*1: the EXIF thumbnail is picked*/
+}JPEGDEC_SCALE_PLAN_T;
+
 typedef struct
 {
 	uint32_t slice_height;
@@ -132,6 +148,12 @@ int JPEGDEC_decode_one_pic(JPEGDEC_PARAMS_T *jpegdec_params, jpegdec_callback ca
 uint32_t get_address_align(uint32_t  ,uint32_t );
 int JPEGDEC_Slice_Start(JPEGDEC_PARAMS_T *jpegdec_params,  JPEGDEC_SLICE_OUT_T *out_ptr);
 int JPEGDEC_Slice_Next(JPEGDEC_SLICE_NEXT_T *update_params,  JPEGDEC_SLICE_OUT_T *out_ptr);
+/*
+  Picks the cheapest way to get at least 1/(1 << scale_down) of the picture: the
+  EXIF thumbnail when it is large enough, else the main picture scaled by the
+  hardware, which stops at 1/4. The output may be larger than asked for.
+*/
+int JPEGDEC_Scale_Plan(void *stream_virt_buf, uint32_t stream_size, uint32_t scale_down, JPEGDEC_SCALE_PLAN_T *plan_ptr);
 
 //////////////////////////////////////////////////////////////////////////
 //#endif //JPEG_ENC
@@ -1,40 +0,0 @@
-/******************************************************************************
- ** File Name:      JpegDec_parse.h                                            *
- ** Author:         Xiaowei Luo                                               *
- ** DATE:           12/14/2006                                                *
- ** Copyright:      2006 Spreatrum, Incoporated. All Rights Reserved.         *
- ** Description:    This file defines the operation interfaces of macroblock  *
- **                 operation of mp4 deccoder.                                *
- *****************************************************************************/
-/******************************************************************************
- **                   Edit    History                                         *
- **---------------------------------------------------------------------------* 
- ** DATE          NAME            DESCRIPTION                                 * 
- ** 12/14/2006    Xiaowei Luo     Create.                                     *
- *****************************************************************************/
-#ifndef _JPEGDEC_PARSE_H_
-#define _JPEGDEC_PARSE_H_
-/*----------------------------------------------------------------------------*
-**                        Dependencies                                        *
-**---------------------------------------------------------------------------*/
-#include "jpegcodec_def.h"
-/**---------------------------------------------------------------------------*
-**                        Compiler Flag                                       *
-**---------------------------------------------------------------------------*/
-#ifdef   __cplusplus
-    extern   "C" 
-    {
-#endif
-
-PUBLIC JPEG_RET_E ParseHead(JPEG_DEC_INPUT_PARA_T  *jpeg_dec_input);
-PUBLIC JPEG_RET_E ParseHead_Res(JPEG_DEC_INPUT_PARA_T  *jpeg_dec_input);
-
-/**---------------------------------------------------------------------------*
-**                         Compiler Flag                                      *
-**---------------------------------------------------------------------------*/
-#ifdef   __cplusplus
-    }
-#endif
-/**---------------------------------------------------------------------------*/
-// End 
-#endif //_JPEGDEC_PARSE_H_
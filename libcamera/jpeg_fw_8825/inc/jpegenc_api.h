@@ -134,6 +134,9 @@ int JPEGENC_Slice_Start(JPEGENC_PARAMS_T *jpegenc_params, JPEGENC_SLICE_OUT_T *o
 
 uint32_t JPEGENC_Slice_Next(JPEGENC_SLICE_NEXT_T *update_parm_ptr, JPEGENC_SLICE_OUT_T *out_ptr);
 
+/*software progressive encoder of one whole frame, uses the virtual addresses only, 0: success*/
+int JPEGENC_Progressive_Encode(JPEGENC_PARAMS_T *jpegenc_params);
+
 //////////////////////////////////////////////////////////////////////////
 
 /**---------------------------------------------------------------------------*
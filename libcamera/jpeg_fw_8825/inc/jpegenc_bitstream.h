@@ -42,6 +42,8 @@ PUBLIC void JPEGFW_PutC(uint8 ch);
 PUBLIC void JPEGFW_PutW(uint16 w);
 PUBLIC void JPEGFW_PutW_II(uint16 w);
 PUBLIC void JPEGFW_PutBits32_II(uint32 val, uint32 nbits);
+PUBLIC void JPEGFW_FlushBits(void);
+PUBLIC void JPEGFW_ResetBits(void);
 
 /**---------------------------------------------------------------------------*
 **                         Compiler Flag                                      *
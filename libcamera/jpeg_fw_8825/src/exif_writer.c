@@ -28,6 +28,66 @@
 #define JPEG_PRINT_LOW(format,...) ALOGE(DEBUG_STR format, DEBUG_ARGS, ##__VA_ARGS__)
 #define JPEG_ALIGN_4(_input) ((((_input) + 3) >> 2) << 2)
 
+/*
+  The APP1 of the last shot is kept as a template. The IFD entries whose value
+  is read from the caller's EXIF structures are recorded while the template is
+  serialised, and rewritten in place for the next shots. The other entries,
+  such as the IFD pointers and the version tags, only depend on the layout.
+  The layout is decided by the structure pointers, the valid flags, the counts
+  of the custom tags and the presence of the thumbnail, they are the key of
+  the template.
+*/
+#define EXIF_TMPL_SLOT_MAX          128
+#define EXIF_TMPL_RANGE_NUM         13
+#define EXIF_TMPL_VALID_NUM         12
+#define EXIF_TMPL_CUSTOM_NUM        11
+
+typedef enum
+{
+    EXIF_TMPL_RATIONAL = 0,
+    EXIF_TMPL_LONG,
+    EXIF_TMPL_SHORT,
+    EXIF_TMPL_BYTE,
+    EXIF_TMPL_WRITER_MAX
+}EXIF_TMPL_WRITER_E;
+
+typedef struct
+{
+    const uint8     *base;
+    uint32          size;
+}EXIF_TMPL_RANGE_T;
+
+typedef struct
+{
+    EXIF_TMPL_RANGE_T   range[EXIF_TMPL_RANGE_NUM];     //caller structures the values are read from
+    uint32              valid[EXIF_TMPL_VALID_NUM];
+    uint32              custom_count[EXIF_TMPL_CUSTOM_NUM];
+    uint32              is_ifd1_exist;
+}EXIF_TMPL_KEY_T;
+
+typedef struct
+{
+    uint32          writer;
+    uint32          ifd_offset;
+    uint32          value_offset;
+    BOOLEAN         is_fixed_count;         //ASCII count not taken from the string
+    IFD_INFO_T      ifd_info;
+}EXIF_TMPL_SLOT_T;
+
+typedef struct
+{
+    EXIF_TMPL_KEY_T     key;
+    uint8               *buf_ptr;
+    uint32              size;                   //without the thumbnail
+    uint32              thumbnail_len_pos;      //value position of the thumbnail length
+    uint32              slot_num;
+    BOOLEAN             is_overflow;
+    EXIF_TMPL_SLOT_T    slot[EXIF_TMPL_SLOT_MAX];
+}EXIF_TEMPLATE_T;
+
+LOCAL EXIF_TEMPLATE_T s_exif_tmpl;
+LOCAL EXIF_TEMPLATE_T *s_exif_rec_ptr = PNULL;     //not NULL while the template is serialised
+
 /*
 *@	Name :
 *@	Description:	Get string size in which the terminating null character is not included
@@ -54,6 +114,79 @@ LOCAL uint32 _GetAsciiStringSize(const uint8 *string_ptr)
     return string_size;
 }
 
+/*
+*@	Name :
+*@	Description:	check whether the value is read from the caller's EXIF structures
+*@  Parameters:
+*@                  key_ptr:        pointer of the template key
+*@                  value_ptr:      value pointer of the IFD
+*@	Note:           return TRUE if the value is owned by the caller
+*/
+LOCAL BOOLEAN Jpeg_IsCallerValue(const EXIF_TMPL_KEY_T *key_ptr, const void *value_ptr)
+{
+    const uint8 *ptr    = (const uint8 *)value_ptr;
+    uint32      i       = 0;
+
+    for (i=0; i<EXIF_TMPL_RANGE_NUM; i++)
+    {
+        if (PNULL != key_ptr->range[i].base
+            && ptr >= key_ptr->range[i].base
+            && ptr < key_ptr->range[i].base + key_ptr->range[i].size)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+*@	Name :
+*@	Description:	record an IFD into the template being serialised
+*@  Parameters:
+*@                  writer:         EXIF_TMPL_WRITER_E, the function writing the IFD
+*@                  ifd_ptr:        pointer of IFD structure
+*@                  ifd_offset:     the IFD offset
+*@                  value_offset:   the value offset
+*/
+LOCAL void Jpeg_RecordIFD(uint32 writer, IFD_INFO_T *ifd_ptr,
+                            uint32 ifd_offset, uint32 value_offset)
+{
+    EXIF_TEMPLATE_T     *tmpl_ptr   = s_exif_rec_ptr;
+    EXIF_TMPL_SLOT_T    *slot_ptr   = PNULL;
+
+    if (PNULL == tmpl_ptr)
+    {
+        return;
+    }
+
+    if (IFD_JPEGINTERCHANGEFORMATLENGTH == ifd_ptr->tag)
+    {
+        //skip the tag, type and count
+        tmpl_ptr->thumbnail_len_pos = ifd_offset + 8;
+        return;
+    }
+
+    if (!Jpeg_IsCallerValue(&tmpl_ptr->key, ifd_ptr->value_ptr))
+    {
+        return;
+    }
+
+    if (tmpl_ptr->slot_num >= EXIF_TMPL_SLOT_MAX)
+    {
+        tmpl_ptr->is_overflow = TRUE;
+        return;
+    }
+
+    slot_ptr = &tmpl_ptr->slot[tmpl_ptr->slot_num++];
+    slot_ptr->writer = writer;
+    slot_ptr->ifd_offset = ifd_offset;
+    slot_ptr->value_offset = value_offset;
+    slot_ptr->is_fixed_count = IFD_ASCII == ifd_ptr->type
+        && _GetAsciiStringSize(ifd_ptr->value_ptr) + 1 != ifd_ptr->count;
+    slot_ptr->ifd_info = *ifd_ptr;
+}
+
 /*
 *@	Name :
 *@	Description:	write a IFD
@@ -133,6 +266,8 @@ LOCAL BOOLEAN Jpeg_WriteRationalIFD(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
         return FALSE;
     }
 
+    Jpeg_RecordIFD(EXIF_TMPL_RATIONAL, ifd_ptr, ifd_offset, value_offset);
+
     ptr = (EXIF_RATIONAL_T *)ifd_ptr->value_ptr;
 
     //write IFD header
@@ -195,6 +330,8 @@ LOCAL BOOLEAN Jpeg_WriteLongIFD(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
         return FALSE;
     }
 
+    Jpeg_RecordIFD(EXIF_TMPL_LONG, ifd_ptr, ifd_offset, value_offset);
+
     ptr = (EXIF_LONG_T *)ifd_ptr->value_ptr;
     if (ifd_ptr->count <= 1)
     {
@@ -263,6 +400,8 @@ BOOLEAN Jpeg_WriteShortIFD(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
         return FALSE;
     }
 
+    Jpeg_RecordIFD(EXIF_TMPL_SHORT, ifd_ptr, ifd_offset, value_offset);
+
     ptr = (EXIF_SHORT_T *)ifd_ptr->value_ptr;
 
     if (ifd_ptr->count <= 2)
@@ -337,6 +476,8 @@ BOOLEAN Jpeg_WriteByteIFD(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
         return FALSE;
     }
 
+    Jpeg_RecordIFD(EXIF_TMPL_BYTE, ifd_ptr, ifd_offset, value_offset);
+
     ptr = (EXIF_BYTE_T *)ifd_ptr->value_ptr;
 
     if (ifd_ptr->count <= 4)
@@ -2849,6 +2990,314 @@ PUBLIC JPEG_RET_E Jpeg_WriteAPP1(uint8 *target_buf,
     return JPEG_SUCCESS;
 }
 
+LOCAL BOOLEAN (* const s_write_ifd_func[EXIF_TMPL_WRITER_MAX])(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
+                                                        IFD_INFO_T *ifd_ptr,
+                                                        uint32 *ifd_offset_ptr,
+                                                        uint32 *value_offset_ptr) =
+{
+    Jpeg_WriteRationalIFD,
+    Jpeg_WriteLongIFD,
+    Jpeg_WriteShortIFD,
+    Jpeg_WriteByteIFD
+};
+
+/*****************************************************************************
+**	Name :
+**	Description:	fill the key deciding the layout of the APP1
+**  Parameters:
+**                  key_ptr:          pointer of the template key, output structure
+**                  exif_info_ptr:    pointer of exif structure
+**                  is_ifd1_exist:    whether the thumbnail is written
+*****************************************************************************/
+LOCAL void Jpeg_GetTemplateKey(EXIF_TMPL_KEY_T *key_ptr,
+                                JINF_EXIF_INFO_T *exif_info_ptr,
+                                BOOLEAN is_ifd1_exist)
+{
+    EXIF_PRIMARY_INFO_T             *primary_ptr    = &exif_info_ptr->primary;
+    EXIF_SPECIFIC_INFO_T            *spec_ptr       = exif_info_ptr->spec_ptr;
+    EXIF_SPEC_PIC_TAKING_COND_T     *pic_ptr        = PNULL;
+    EXIF_SPEC_USER_T                *user_ptr       = PNULL;
+    EXIF_TMPL_RANGE_T               *range_ptr      = key_ptr->range;
+    uint32                          *valid_ptr      = key_ptr->valid;
+    uint32                          *count_ptr      = key_ptr->custom_count;
+
+#define EXIF_TMPL_ADD_RANGE(_ptr)   \
+    do  \
+    {   \
+        range_ptr->base = (const uint8 *)(_ptr);    \
+        range_ptr->size = sizeof(*(_ptr));  \
+        range_ptr++;    \
+    } while(0)
+
+#define EXIF_TMPL_ADD_VALID(_ptr)   \
+    do  \
+    {   \
+        if (PNULL != (_ptr))    \
+        {   \
+            memcpy(valid_ptr, &(_ptr)->valid, sizeof((_ptr)->valid));   \
+        }   \
+        valid_ptr += (sizeof((_ptr)->valid) + 3) >> 2;  \
+    } while(0)
+
+    memset(key_ptr, 0, sizeof(EXIF_TMPL_KEY_T));
+
+    if (PNULL != spec_ptr)
+    {
+        pic_ptr = spec_ptr->pic_taking_cond_ptr;
+        user_ptr = spec_ptr->user_ptr;
+    }
+
+    EXIF_TMPL_ADD_RANGE(exif_info_ptr);
+    EXIF_TMPL_ADD_RANGE(primary_ptr->data_struct_ptr);
+    EXIF_TMPL_ADD_RANGE(primary_ptr->data_char_ptr);
+    EXIF_TMPL_ADD_RANGE(primary_ptr->img_desc_ptr);
+    EXIF_TMPL_ADD_RANGE(spec_ptr);
+    EXIF_TMPL_ADD_RANGE(PNULL != spec_ptr ? spec_ptr->img_config_ptr : PNULL);
+    EXIF_TMPL_ADD_RANGE(user_ptr);
+    EXIF_TMPL_ADD_RANGE(PNULL != spec_ptr ? spec_ptr->related_file_ptr : PNULL);
+    EXIF_TMPL_ADD_RANGE(PNULL != spec_ptr ? spec_ptr->date_time_ptr : PNULL);
+    EXIF_TMPL_ADD_RANGE(pic_ptr);
+    EXIF_TMPL_ADD_RANGE(PNULL != spec_ptr ? spec_ptr->other_ptr : PNULL);
+    EXIF_TMPL_ADD_RANGE(exif_info_ptr->gps_ptr);
+    EXIF_TMPL_ADD_RANGE(exif_info_ptr->inter_ptr);
+
+    EXIF_TMPL_ADD_VALID(primary_ptr->data_struct_ptr);
+    EXIF_TMPL_ADD_VALID(primary_ptr->data_char_ptr);
+    EXIF_TMPL_ADD_VALID(primary_ptr->img_desc_ptr);
+    EXIF_TMPL_ADD_VALID(PNULL != spec_ptr ? spec_ptr->img_config_ptr : PNULL);
+    EXIF_TMPL_ADD_VALID(user_ptr);
+    EXIF_TMPL_ADD_VALID(PNULL != spec_ptr ? spec_ptr->related_file_ptr : PNULL);
+    EXIF_TMPL_ADD_VALID(PNULL != spec_ptr ? spec_ptr->date_time_ptr : PNULL);
+    EXIF_TMPL_ADD_VALID(pic_ptr);
+    EXIF_TMPL_ADD_VALID(PNULL != spec_ptr ? spec_ptr->other_ptr : PNULL);
+    EXIF_TMPL_ADD_VALID(exif_info_ptr->gps_ptr);
+    EXIF_TMPL_ADD_VALID(exif_info_ptr->inter_ptr);
+
+#undef EXIF_TMPL_ADD_RANGE
+#undef EXIF_TMPL_ADD_VALID
+
+    if (PNULL != pic_ptr)
+    {
+        *count_ptr++ = pic_ptr->ISOSpeedRatings.count;
+        *count_ptr++ = pic_ptr->OECF.count;
+        *count_ptr++ = pic_ptr->SubjectArea.count;
+        *count_ptr++ = pic_ptr->SpatialFrequencyResponse.count;
+        *count_ptr++ = pic_ptr->CFAPattern.count;
+        *count_ptr++ = pic_ptr->DeviceSettingDescription.count;
+    }
+    else
+    {
+        count_ptr += 6;
+    }
+
+    if (PNULL != user_ptr)
+    {
+        *count_ptr++ = user_ptr->MakerNote.count;
+        *count_ptr++ = user_ptr->UserComment.count;
+    }
+    else
+    {
+        count_ptr += 2;
+    }
+
+    if (PNULL != exif_info_ptr->gps_ptr)
+    {
+        *count_ptr++ = exif_info_ptr->gps_ptr->GPSProcessingMethod.count;
+        *count_ptr++ = exif_info_ptr->gps_ptr->GPSAreaInformation.count;
+    }
+    else
+    {
+        count_ptr += 2;
+    }
+
+    if (PNULL != exif_info_ptr->inter_ptr)
+    {
+        *count_ptr = exif_info_ptr->inter_ptr->InteroperabilityIndex.count;
+    }
+
+    key_ptr->is_ifd1_exist = is_ifd1_exist;
+}
+
+/*****************************************************************************
+**	Name :
+**	Description:	write the APP1 from the template, only the values are rewritten
+**  Parameters:
+**                  tmpl_ptr:         pointer of the template
+**                  target_buf:       pointer of target buffer
+**                  target_buf_size:  size of target buffer
+**                  thumbnail_buf_ptr:thumbnail buffer pointer
+**                  thumbnail_size:   thumbnail size
+**                  app1_size_ptr:    pointer of APP1 size. output structure
+**	Note:           return FALSE if the template does not fit the values
+*****************************************************************************/
+LOCAL BOOLEAN Jpeg_PatchAPP1(EXIF_TEMPLATE_T *tmpl_ptr,
+                                uint8 *target_buf,
+                                uint32 target_buf_size,
+                                uint8 *thumbnail_buf_ptr,
+                                uint32 thumbnail_size,
+                                uint32 *app1_size_ptr)
+{
+    JPEG_WRITE_STREAM_CONTEXT_T context;
+    EXIF_TMPL_SLOT_T    *slot_ptr       = PNULL;
+    IFD_INFO_T          ifd_info;
+    uint32              ifd_offset      = 0;
+    uint32              value_offset    = 0;
+    uint32              end_offset      = 0;
+    uint16              app1_length     = 0;
+    uint32              i               = 0;
+
+    if (tmpl_ptr->size + thumbnail_size > target_buf_size)
+    {
+        return FALSE;
+    }
+
+    //the length of the strings decides the layout too, unless the tag has a
+    //fixed count, such as the 33 bytes of ImageUniqueID
+    for (i=0; i<tmpl_ptr->slot_num; i++)
+    {
+        slot_ptr = &tmpl_ptr->slot[i];
+
+        if (IFD_ASCII == slot_ptr->ifd_info.type && !slot_ptr->is_fixed_count
+            && _GetAsciiStringSize(slot_ptr->ifd_info.value_ptr) + 1 != slot_ptr->ifd_info.count)
+        {
+            return FALSE;
+        }
+    }
+
+    memcpy(target_buf, tmpl_ptr->buf_ptr, tmpl_ptr->size);
+
+    memset(&context, 0, sizeof(JPEG_WRITE_STREAM_CONTEXT_T));
+    context.write_buf = target_buf;
+    context.write_buf_size = target_buf_size;
+    context.write_ptr = context.write_buf;
+
+    for (i=0; i<tmpl_ptr->slot_num; i++)
+    {
+        slot_ptr = &tmpl_ptr->slot[i];
+        ifd_info = slot_ptr->ifd_info;
+        ifd_offset = slot_ptr->ifd_offset;
+        value_offset = slot_ptr->value_offset;
+
+        if (!s_write_ifd_func[slot_ptr->writer](&context, &ifd_info, &ifd_offset, &value_offset))
+        {
+            return FALSE;
+        }
+    }
+
+    end_offset = tmpl_ptr->size;
+
+    if (tmpl_ptr->key.is_ifd1_exist)
+    {
+        Jpeg_SetWritePos(&context, tmpl_ptr->thumbnail_len_pos);
+        JPEG_WRITE_DATA(Jpeg_WriteL, &context, thumbnail_size, return FALSE);
+
+        memcpy(target_buf + end_offset, thumbnail_buf_ptr, thumbnail_size);
+        end_offset += thumbnail_size;
+    }
+
+    app1_length = (uint16)end_offset - 2;   //without app1 marker
+    *app1_size_ptr = app1_length + 2;
+
+    if (JPEG_SUCCESS != Jpeg_WriteAPP1Header(&context, 0, &end_offset, app1_length))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*****************************************************************************
+**	Name :
+**	Description:	write the APP1, the template of the last shot is patched if
+**                  the layout is the same, otherwise the template is rebuilt
+**  Parameters:
+**                  target_buf:       pointer of target buffer
+**                  target_buf_size:  size of target buffer
+**                  exif_info_ptr:    pointer of exif structure
+**                  thumbnail_buf_ptr:thumbnail buffer pointer
+**                  thumbnail_size:   thumbnail size
+**                  app1_size_ptr:    pointer of APP1 size. output structure
+**	Note:           return JPEG_SUCESS if successful
+*****************************************************************************/
+LOCAL JPEG_RET_E Jpeg_WriteAPP1ByTemplate(uint8 *target_buf,
+                                            uint32 target_buf_size,
+                                            JINF_EXIF_INFO_T *exif_info_ptr,
+                                            uint8 *thumbnail_buf_ptr,
+                                            uint32 thumbnail_size,
+                                            uint32 *app1_size_ptr)
+{
+    EXIF_TEMPLATE_T     *tmpl_ptr       = &s_exif_tmpl;
+    EXIF_TMPL_KEY_T     key;
+    BOOLEAN             is_ifd1_exist   = FALSE;
+    JPEG_RET_E          ret             = JPEG_SUCCESS;
+
+    if (PNULL == exif_info_ptr || PNULL == target_buf)
+    {
+        return Jpeg_WriteAPP1(target_buf, target_buf_size, exif_info_ptr,
+                                thumbnail_buf_ptr, thumbnail_size, app1_size_ptr);
+    }
+
+    if (PNULL != thumbnail_buf_ptr && thumbnail_size > 0)
+    {
+        is_ifd1_exist = TRUE;
+    }
+
+    Jpeg_GetTemplateKey(&key, exif_info_ptr, is_ifd1_exist);
+
+    if (PNULL != tmpl_ptr->buf_ptr
+        && 0 == memcmp(&key, &tmpl_ptr->key, sizeof(EXIF_TMPL_KEY_T))
+        && Jpeg_PatchAPP1(tmpl_ptr, target_buf, target_buf_size,
+                            thumbnail_buf_ptr, thumbnail_size, app1_size_ptr))
+    {
+        return JPEG_SUCCESS;
+    }
+
+    IMGJPEG_ResetExifTemplate();
+    tmpl_ptr->key = key;
+
+    //the alignment gaps are not written, keep them same as the template
+    memset(target_buf, 0, target_buf_size);
+
+    s_exif_rec_ptr = tmpl_ptr;
+    ret = Jpeg_WriteAPP1(target_buf, target_buf_size, exif_info_ptr,
+                            thumbnail_buf_ptr, thumbnail_size, app1_size_ptr);
+    s_exif_rec_ptr = PNULL;
+
+    if (JPEG_SUCCESS != ret || tmpl_ptr->is_overflow
+        || (is_ifd1_exist && (*app1_size_ptr <= thumbnail_size || 0 == tmpl_ptr->thumbnail_len_pos)))
+    {
+        IMGJPEG_ResetExifTemplate();
+        return ret;
+    }
+
+    tmpl_ptr->size = *app1_size_ptr - (is_ifd1_exist ? thumbnail_size : 0);
+    tmpl_ptr->buf_ptr = (uint8 *)malloc(tmpl_ptr->size);
+    if (PNULL == tmpl_ptr->buf_ptr)
+    {
+        IMGJPEG_ResetExifTemplate();
+        return ret;
+    }
+
+    memcpy(tmpl_ptr->buf_ptr, target_buf, tmpl_ptr->size);
+    JPEG_PRINT_LOW("[Jpeg_WriteAPP1ByTemplate] template size %d, %d values", tmpl_ptr->size, tmpl_ptr->slot_num);
+
+    return ret;
+}
+
+/*****************************************************************************
+**	Name :
+**	Description:	release the APP1 template, the next APP1 is serialised again
+*****************************************************************************/
+PUBLIC void IMGJPEG_ResetExifTemplate(void)
+{
+    if (PNULL != s_exif_tmpl.buf_ptr)
+    {
+        free(s_exif_tmpl.buf_ptr);
+    }
+
+    memset(&s_exif_tmpl, 0, sizeof(EXIF_TEMPLATE_T));
+}
+
 /*****************************************************************************
 **	Name :
 **	Description:	and the EXIF info and write the output jpeg to the memory
@@ -2867,18 +3316,17 @@ LOCAL JPEG_RET_E JPEG_AddExifToMemory(JINF_WEXIF_IN_PARAM_T *in_param_ptr,
     uint8   *target_buf_ptr = NULL;
     uint32  free_buf_size   = 0;
     JPEG_RET_E  ret         = JPEG_SUCCESS;
-	uint32_t i = 0;
 
     app1_buf_ptr = in_param_ptr->temp_buf_ptr;
     app1_buf_size = in_param_ptr->temp_buf_size;
 
     //write APP1 to temp buffer
-    ret = Jpeg_WriteAPP1(app1_buf_ptr,
-                         app1_buf_size,
-                         in_param_ptr->exif_info_ptr,
-                         in_param_ptr->thumbnail_buf_ptr,
-                         in_param_ptr->thumbnail_buf_size,
-                         &app1_size);
+    ret = Jpeg_WriteAPP1ByTemplate(app1_buf_ptr,
+                                   app1_buf_size,
+                                   in_param_ptr->exif_info_ptr,
+                                   in_param_ptr->thumbnail_buf_ptr,
+                                   in_param_ptr->thumbnail_buf_size,
+                                   &app1_size);
 
 	JPEG_PRINT_LOW("Jpeg_WriteAPP1 end.ret = %d.",ret);
 	
@@ -2909,11 +3357,7 @@ LOCAL JPEG_RET_E JPEG_AddExifToMemory(JINF_WEXIF_IN_PARAM_T *in_param_ptr,
     *target_buf_ptr++ = M_SOI;
     JPEG_PRINT_LOW("target buf:0x%x,app1_buf_ptr 0x%x ,app1_size %d.",
 		target_buf_ptr,app1_buf_ptr,app1_size);
-   // memcpy(target_buf_ptr, app1_buf_ptr, app1_size);
-   for(i=0;i<app1_size;i++) {
-		*target_buf_ptr++ = *app1_buf_ptr++;
-/*		JPEG_PRINT_LOW("i=%d.",i);*/
-   }
+    memcpy(target_buf_ptr, app1_buf_ptr, app1_size);
 
 	JPEG_PRINT_LOW("end.");
 
@@ -2945,7 +3389,7 @@ LOCAL JPEG_RET_E JPEG_AddExifToFile(JINF_WEXIF_IN_PARAM_T *in_param_ptr)
     app1_buf_size = in_param_ptr->temp_buf_size;
 
     //write APP1 to temp buffer
-    ret = Jpeg_WriteAPP1(   app1_buf_ptr,
+    ret = Jpeg_WriteAPP1ByTemplate(app1_buf_ptr,
                             app1_buf_size,
                             in_param_ptr->exif_info_ptr,
                             in_param_ptr->thumbnail_buf_ptr,
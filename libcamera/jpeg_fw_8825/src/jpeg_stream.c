@@ -623,6 +623,14 @@ PUBLIC BOOLEAN Jpeg_WriteL(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr, uint32 l)
     uint8   *write_buf = context_ptr->write_buf;
     uint32  write_size = context_ptr->write_buf_size;
 
+    if (PNULL != context_ptr->write_file_func && NULL != write_ptr
+        && (((uint32)write_ptr + 4) > ((uint32)write_buf + write_size)))
+    {
+        //the temp buffer will be flushed in the middle
+        return (Jpeg_WriteW(context_ptr, (uint16)(l >> 16))
+                && Jpeg_WriteW(context_ptr, (uint16)l));
+    }
+
     if (NULL == write_ptr || (((uint32)write_ptr + 4) > ((uint32)write_buf + write_size)))
     {
         return FALSE;
@@ -654,32 +662,38 @@ PUBLIC BOOLEAN Jpeg_WriteBlock(JPEG_WRITE_STREAM_CONTEXT_T *context_ptr,
     uint8   *write_ptr = context_ptr->write_ptr;
     uint8   *write_buf = context_ptr->write_buf;
     uint32  write_size = context_ptr->write_buf_size;
-    uint32 i;
+    uint32  free_size  = 0;
+    uint32  copy_size  = 0;
 
-#if 1
-	if (NULL == write_ptr || NULL == block_buf_ptr )
-	{
-		return FALSE;
-	}
-	else
-	{
-		for(i=0; i<block_size; i++)
-		{
-			Jpeg_WriteC(context_ptr, *block_buf_ptr++);
-		}
-	}
-#else
-    if (NULL == write_ptr || NULL == block_buf_ptr 
-        || (((uint32)write_ptr + block_size) > ((uint32)write_buf + write_size)))
+    if (NULL == write_ptr || NULL == block_buf_ptr || 0 == write_size)
     {
         return FALSE;
     }
-    else
+
+    //copy as much as the temp buffer holds, flush it to file when it is full
+    while (block_size > 0)
     {
-        SCI_MEMCPY(write_ptr, block_buf_ptr, block_size);
-        context_ptr->write_ptr += block_size;
+        write_ptr = context_ptr->write_ptr;
+        free_size = ((uint32)write_ptr < ((uint32)write_buf + write_size))
+                        ? ((uint32)write_buf + write_size - (uint32)write_ptr) : 0;
+
+        if (0 == free_size)
+        {
+            if (PNULL == context_ptr->write_file_func
+                || !Jpeg_WriteStreamToFile(context_ptr))
+            {
+                return FALSE;
+            }
+
+            continue;
+        }
+
+        copy_size = (block_size < free_size) ? block_size : free_size;
+        SCI_MEMCPY(write_ptr, block_buf_ptr, copy_size);
+        context_ptr->write_ptr += copy_size;
+        block_buf_ptr += copy_size;
+        block_size -= copy_size;
     }
-#endif
 
     return TRUE;
 }
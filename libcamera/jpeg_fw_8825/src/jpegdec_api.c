@@ -40,6 +40,20 @@
 
 #define SLICE_HEIGHT 1024 //the height for slice mode
 
+#define JPEGDEC_RD16(p, be)	((be) ? (((uint32_t)(p)[0] << 8) | (p)[1]) : (((uint32_t)(p)[1] << 8) | (p)[0]))
+#define JPEGDEC_RD32(p, be)	((be) ? ((JPEGDEC_RD16(p, be) << 16) | JPEGDEC_RD16((p) + 2, be)) : \
+								((JPEGDEC_RD16((p) + 2, be) << 16) | JPEGDEC_RD16(p, be)))
+
+typedef struct
+{
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	mcu_info;		/*JPEG_FW_YUV420...*/
+	uint32_t	is_progressive;
+	uint32_t	thumb_offset;	/*from the SOI, 0: no EXIF thumbnail*/
+	uint32_t	thumb_size;
+}JPEGDEC_STREAM_INFO_T;
+
 static uint32_t g_stream_buf_id = 1;  //record the bsm buf id for switch buf. the init buf is 0.
 //uint32_t g_stream_buf_size = 0;
 
@@ -90,7 +104,7 @@ LOCAL void JPEGDEC_init_fw_param(JPEGDEC_PARAMS_T *jpegdec_params,
 	SCI_TRACE_LOW("[JPEGDEC_init_fw_param] get_address_align = %d  " ,YUV_Size_Align);
 	
 	dec_fw_info_ptr->data_type = 1;		//output yuv data
-	dec_fw_info_ptr->scaling_down_factor = JPEG_SCALING_DOWN_ZERO;
+	dec_fw_info_ptr->scaling_down_factor = jpegdec_params->scale_down;
 
 	dec_fw_info_ptr->pingpong_buf_0_ptr = (uint8_t *)jpegdec_params->stream_phy_buf[0];
 	dec_fw_info_ptr->pingpong_buf_1_ptr = NULL;//(uint8_t *)jpegdec_params->stream_phy_buf[1];
@@ -316,30 +330,15 @@ void JPEGDEC_Handle_BSM_INT(jpegdec_callback callback)
 	SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM callback after.\n");	*/	
 }
 
-void poll_ahb_idle(uint32_t time)
+//the slice output is only complete once the AHB master is idle, 1 if it never got there
+uint32_t poll_ahb_idle(uint32_t time)
 {
-	uint32_t vsp_time_out_cnt = 0;
-	
-	while (1)
+	if (IS_TIME_OUT == VSP_WaitReg(VSP_AHBM_REG_BASE+AHBM_STS_OFFSET, 0x1, 0, time)) //busy
 	{
-		uint32 ahb_idle = 0;
-		ahb_idle = ((*(volatile uint32*)(VSP_AHBM_REG_BASE+AHBM_STS_OFFSET-VSP_DCAM_BASE+g_vsp_Vaddr_base) & 0x1));
-
-		if (ahb_idle) //busy
-		{
-			usleep(1000);
-			SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X, AHB IS BUSY.\n");
-		}else
-		{
-			break;
-		}
-		vsp_time_out_cnt++;
-
-		if (vsp_time_out_cnt > time)
-		{
-			SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X, fail 2.\n");
-		}
+		SCI_TRACE_LOW("poll_ahb_idle X, fail, AHB busy.\n");
+		return 1;
 	}
+	return 0;
 }
 
 //poll MEA done and BSM done
@@ -347,7 +346,6 @@ void poll_ahb_idle(uint32_t time)
 uint32_t JPEGDEC_Poll_DBK_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback callback, uint32_t slice_num)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 	uint32_t buf_id = 1;
 	JPEG_CODEC_T *jpeg_fw_codec = Get_JPEGDecCodec();
 
@@ -355,7 +353,11 @@ uint32_t JPEGDEC_Poll_DBK_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback
 			
 	while (1)
 	{		
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");		
+		if (IS_TIME_OUT == VSP_WaitInt(0x3200, time, &value))
+		{
+			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM X, fail 1,value 0x%x.\n",value);
+			return 1;
+		}
 		if(value & 0x200) //for MBC/DBK done
 		{		
 			slice_num--;
@@ -365,7 +367,10 @@ uint32_t JPEGDEC_Poll_DBK_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback
 				SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM: sencod start , buf_id %d,value 0x%x.", buf_id,value);
 				if(NULL != callback)
 				{
-					poll_ahb_idle(time);
+					if (poll_ahb_idle(time))
+					{
+						return 1;
+					}
 					callback(0,0,0);
 				}
 
@@ -376,7 +381,10 @@ uint32_t JPEGDEC_Poll_DBK_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback
 				buf_id = !buf_id;
 			}else
 			{
-				poll_ahb_idle(time);
+				if (poll_ahb_idle(time))
+				{
+					return 1;
+				}
 				if(NULL != callback)
 				{
 					callback(1,0,0);
@@ -389,22 +397,12 @@ uint32_t JPEGDEC_Poll_DBK_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback
 			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM:vsp error 0x%x.",value);
 			return 1;
 		}
-		
-		if (vsp_time_out_cnt > time)
-		{
-			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM X, fail 1,value 0x%x.\n",value);
-			return 1;
-		}
-		vsp_time_out_cnt++;
-
-		usleep(1000);
 	}
 }
 
 uint32_t JPEGDEC_Poll_DBK_BSM_FOR_SLICE(uint32_t time, uint32_t *buf_id_ptr,  uint32_t *slice_num_ptr)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 	uint32_t buf_id = *buf_id_ptr;
 	JPEG_CODEC_T *jpeg_fw_codec = Get_JPEGDecCodec();
 	uint32_t slice_num = *slice_num_ptr;
@@ -414,7 +412,11 @@ uint32_t JPEGDEC_Poll_DBK_BSM_FOR_SLICE(uint32_t time, uint32_t *buf_id_ptr,  ui
 
 	while (1)
 	{
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");
+		if (IS_TIME_OUT == VSP_WaitInt(0x3200, time, &value))
+		{
+			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM_FOR_SLICE X, fail 1,value 0x%x.\n",value);
+			return 1;
+		}
 		if(value & 0x200) //for MBC/DBK done
 		{
 			slice_num--;
@@ -422,14 +424,20 @@ uint32_t JPEGDEC_Poll_DBK_BSM_FOR_SLICE(uint32_t time, uint32_t *buf_id_ptr,  ui
 			if (slice_num)
 			{
 				SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM_FOR_SLICE: sencod start , buf_id %d,value 0x%x.", buf_id,value);
-				poll_ahb_idle(time);
+				if (poll_ahb_idle(time))
+				{
+					return 1;
+				}
 				*buf_id_ptr = buf_id;
 				*slice_num_ptr = slice_num;
 				ret = 0;
 				return 0;
 			}else
 			{
-				poll_ahb_idle(time);
+				if (poll_ahb_idle(time))
+				{
+					return 1;
+				}
 				*slice_num_ptr = slice_num;
 				return 0;
 			}
@@ -439,15 +447,6 @@ uint32_t JPEGDEC_Poll_DBK_BSM_FOR_SLICE(uint32_t time, uint32_t *buf_id_ptr,  ui
 			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM_FOR_SLICE:vsp error 0x%x.",value);
 			return 1;
 		}
-
-		if (vsp_time_out_cnt > time)
-		{
-			SCI_TRACE_LOW("JPEGDEC_Poll_DBK_BSM_FOR_SLICE X, fail 1,value 0x%x.\n",value);
-			return 1;
-		}
-		vsp_time_out_cnt++;
-
-		usleep(1000);
 	}
 	return ret;
 }
@@ -456,60 +455,44 @@ uint32_t JPEGDEC_Poll_DBK_BSM_FOR_SLICE(uint32_t time, uint32_t *buf_id_ptr,  ui
 uint32_t JPEGDEC_Poll_MEA_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback callback)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 
 	SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM E.\n");
-			
-	while (1)
+
+	//BSM done is not cleared by its handler, only MEA done ends the wait
+	if (IS_TIME_OUT == VSP_WaitInt(0x4000, time, &value))
 	{
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");		
-		if(value & 0x80){ //for BSM done			
-			JPEGDEC_Handle_BSM_INT(callback);
-		}
-		if(value & 0x4000){ //for MEA done
-			 JPEG_HWUpdateMEABufInfo();
-			JPEG_HWSet_MEA_Buf_ReadOnly(1);
-			JPGEDEC_Clear_INT(0x4000);
-			SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X.\n");
-			return 1;
-		}
-		if (vsp_time_out_cnt > time)
-		{
-			SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X, fail..\n");
-			return 1;
-		}
-		vsp_time_out_cnt++;
-		usleep(1000);
-	}	
+		SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X, fail..\n");
+		return 1;
+	}
+	if(value & 0x80){ //for BSM done			
+		JPEGDEC_Handle_BSM_INT(callback);
+	}
+	JPEG_HWUpdateMEABufInfo();
+	JPEG_HWSet_MEA_Buf_ReadOnly(1);
+	JPGEDEC_Clear_INT(0x4000);
+	SCI_TRACE_LOW("JPEGDEC_Poll_MEA_BSM X.\n");
+	return 1;
 }
 
 //poll VLC done and BSM done
 uint32_t JPEGDEC_Poll_VLC_BSM(uint32_t time, uint32_t buf_len,  jpegdec_callback callback)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 	
 	SCI_TRACE_LOW("JPEGDEC_Poll_VLC_BSM E.\n");	
-	while (1)
-	{
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");		
-		if(value & 0x100){ //for VLC done			
-			JPGEDEC_Clear_INT(0x100);
-			SCI_TRACE_LOW("JPEGDEC_Poll_VLC_BSM X.\n");		
-			return 1;
-		}
-		if(value & 0x80){ //for BSM done		
-			JPEGDEC_Handle_BSM_INT(callback);		
-		}
 
-		if (vsp_time_out_cnt > time)
-		{			
-			SCI_TRACE_LOW("JPEGDEC_Poll_VLC_BSM X, fail.\n");	
-			return 1;
-		}
-		vsp_time_out_cnt++;
-		usleep(1000);
-	}	
+	//BSM done is not cleared by its handler, only VLC done ends the wait
+	if (IS_TIME_OUT == VSP_WaitInt(0x100, time, &value))
+	{			
+		SCI_TRACE_LOW("JPEGDEC_Poll_VLC_BSM X, fail.\n");	
+		return 1;
+	}
+	if(value & 0x80){ //for BSM done		
+		JPEGDEC_Handle_BSM_INT(callback);		
+	}
+	JPGEDEC_Clear_INT(0x100);
+	SCI_TRACE_LOW("JPEGDEC_Poll_VLC_BSM X.\n");		
+	return 1;
 }
 
 
@@ -710,6 +693,295 @@ int JPEGDEC_Slice_Next(JPEGDEC_SLICE_NEXT_T *update_params,  JPEGDEC_SLICE_OUT_T
 	return ret;
 }
 
+/*
+  The EXIF thumbnail is located through the JPEGInterchangeFormat tags of IFD1,
+  it must lie inside the APP1 segment.
+*/
+LOCAL void JPEGDEC_Scan_Exif(uint8_t *stream, uint8_t *data, uint32_t len, JPEGDEC_STREAM_INFO_T *info_ptr)
+{
+	uint8_t *tiff = data + 6;
+	uint8_t *entry;
+	uint32_t tiff_len, be, ifd, num, i, tag;
+	uint32_t offset = 0, size = 0;
+
+	if((len < 6 + 8) || (0 != memcmp(data, "Exif\0\0", 6)))
+	{
+		return;
+	}
+	tiff_len = len - 6;
+
+	if(('M' == tiff[0]) && ('M' == tiff[1]))
+	{
+		be = 1;
+	}
+	else if(('I' == tiff[0]) && ('I' == tiff[1]))
+	{
+		be = 0;
+	}
+	else
+	{
+		return;
+	}
+	if(42 != JPEGDEC_RD16(tiff + 2, be))
+	{
+		return;
+	}
+
+	/*skip IFD0 to get the offset of IFD1*/
+	ifd = JPEGDEC_RD32(tiff + 4, be);
+	if((ifd > tiff_len) || (tiff_len - ifd < 2))
+	{
+		return;
+	}
+	num = JPEGDEC_RD16(tiff + ifd, be);
+	if(tiff_len - ifd - 2 < num * 12 + 4)
+	{
+		return;
+	}
+	ifd = JPEGDEC_RD32(tiff + ifd + 2 + num * 12, be);
+	if((0 == ifd) || (ifd > tiff_len) || (tiff_len - ifd < 2))
+	{
+		return;
+	}
+	num = JPEGDEC_RD16(tiff + ifd, be);
+	if(tiff_len - ifd - 2 < num * 12)
+	{
+		return;
+	}
+
+	for(i = 0, entry = tiff + ifd + 2; i < num; i++, entry += 12)
+	{
+		tag = JPEGDEC_RD16(entry, be);
+		if(0x0201 == tag)
+		{
+			offset = JPEGDEC_RD32(entry + 8, be);
+		}
+		else if(0x0202 == tag)
+		{
+			size = JPEGDEC_RD32(entry + 8, be);
+		}
+	}
+
+	if((0 != offset) && (0 != size) && (offset < tiff_len) && (size <= tiff_len - offset))
+	{
+		info_ptr->thumb_offset = (uint32_t)(tiff - stream) + offset;
+		info_ptr->thumb_size = size;
+	}
+}
+
+LOCAL int JPEGDEC_Scan_SOF(uint8_t *data, uint32_t len, uint32_t is_progressive, JPEGDEC_STREAM_INFO_T *info_ptr)
+{
+	uint32_t num, i;
+
+	if(len < 6)
+	{
+		return -1;
+	}
+	num = data[5];
+	if((0 == num) || (len < 6 + num * 3))
+	{
+		return -1;
+	}
+
+	info_ptr->height = JPEGDEC_RD16(data + 1, 1);
+	info_ptr->width = JPEGDEC_RD16(data + 3, 1);
+	info_ptr->is_progressive = is_progressive;
+
+	if(1 == num)
+	{
+		info_ptr->mcu_info = JPEG_FW_YUV400;
+		return 0;
+	}
+
+	/*the same formats as GetSOF, the chroma must not be subsampled in the MCU*/
+	for(i = 1; i < num; i++)
+	{
+		if(0x11 != data[6 + i * 3 + 1])
+		{
+			return -1;
+		}
+	}
+	switch(data[6 + 1])
+	{
+		case 0x11:
+			info_ptr->mcu_info = JPEG_FW_YUV444;
+			break;
+		case 0x21:
+			info_ptr->mcu_info = JPEG_FW_YUV422;
+			break;
+		case 0x41:
+			info_ptr->mcu_info = JPEG_FW_YUV411;
+			break;
+		case 0x14:
+			info_ptr->mcu_info = JPEG_FW_YUV411_R;
+			break;
+		case 0x22:
+			info_ptr->mcu_info = JPEG_FW_YUV420;
+			break;
+		case 0x12:
+			info_ptr->mcu_info = JPEG_FW_YUV422_R;
+			break;
+		default:
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+  Walks the markers up to SOF without touching the decoder state, the APP1
+  segment always comes before SOF.
+*/
+LOCAL int JPEGDEC_Scan_Stream(uint8_t *stream, uint32_t size, JPEGDEC_STREAM_INFO_T *info_ptr)
+{
+	uint32_t pos = 2;
+	uint32_t len;
+	uint8_t marker;
+
+	SCI_MEMSET(info_ptr, 0, sizeof(JPEGDEC_STREAM_INFO_T));
+
+	if((size < 4) || (0xFF != stream[0]) || (M_SOI != stream[1]))
+	{
+		return -1;
+	}
+
+	while(pos + 4 <= size)
+	{
+		if(0xFF != stream[pos])
+		{
+			return -1;
+		}
+		marker = stream[pos + 1];
+		if(0xFF == marker)
+		{
+			pos++;	/*fill byte*/
+			continue;
+		}
+
+		len = JPEGDEC_RD16(stream + pos + 2, 1);
+		if((len < 2) || (len > size - pos - 2))
+		{
+			return -1;
+		}
+
+		switch(marker)
+		{
+			case M_SOF0:
+			case M_SOF1:
+				return JPEGDEC_Scan_SOF(stream + pos + 4, len - 2, 0, info_ptr);
+			case M_SOF2:
+				return JPEGDEC_Scan_SOF(stream + pos + 4, len - 2, 1, info_ptr);
+			case M_APP1:
+				JPEGDEC_Scan_Exif(stream, stream + pos + 4, len - 2, info_ptr);
+				break;
+			case M_SOS:
+			case M_EOI:
+				return -1;
+			default:
+				break;
+		}
+		pos += 2 + len;
+	}
+
+	return -1;
+}
+
+/*the largest factor the MBC takes, JPEG_HWDecStart rejects 1/4 for some formats*/
+LOCAL uint32_t JPEGDEC_Max_Scale(JPEGDEC_STREAM_INFO_T *info_ptr)
+{
+	if(((JPEG_FW_YUV444 == info_ptr->mcu_info) && (!info_ptr->is_progressive)) ||
+		(JPEG_FW_YUV400 == info_ptr->mcu_info) ||
+		(JPEG_FW_YUV422_R == info_ptr->mcu_info) ||
+		(JPEG_FW_YUV411_R == info_ptr->mcu_info))
+	{
+		return JPEG_SCALING_DOWN_HALF;
+	}
+
+	return JPEG_SCALING_DOWN_QUATER;
+}
+
+/*the thumbnail must not be letterboxed, allow 1/64 for the rounding of its size*/
+LOCAL BOOLEAN JPEGDEC_Is_Same_Aspect(JPEGDEC_STREAM_INFO_T *main_ptr, JPEGDEC_STREAM_INFO_T *thumb_ptr)
+{
+	uint32_t a = thumb_ptr->width * main_ptr->height;
+	uint32_t b = thumb_ptr->height * main_ptr->width;
+	uint32_t diff = (a > b) ? (a - b) : (b - a);
+
+	return (diff <= (a >> 6)) ? TRUE : FALSE;
+}
+
+int JPEGDEC_Scale_Plan(void *stream_virt_buf, uint32_t stream_size, uint32_t scale_down, JPEGDEC_SCALE_PLAN_T *plan_ptr)
+{
+	uint8_t *stream = (uint8_t*)stream_virt_buf;
+	JPEGDEC_STREAM_INFO_T main_info;
+	JPEGDEC_STREAM_INFO_T thumb_info;
+	uint32_t want_width, want_height;
+	uint32_t scale, align;
+
+	if((NULL == stream) || (NULL == plan_ptr) || (scale_down > JPEGDEC_SCALE_DOWN_MAX))
+	{
+		return -1;
+	}
+	SCI_MEMSET(plan_ptr, 0, sizeof(JPEGDEC_SCALE_PLAN_T));
+
+	if(0 != JPEGDEC_Scan_Stream(stream, stream_size, &main_info))
+	{
+		SCI_TRACE_LOW("JPEGDEC_Scale_Plan, no SOF.");
+		return -1;
+	}
+	want_width = main_info.width >> scale_down;
+	want_height = main_info.height >> scale_down;
+
+	/*the thumbnail is baseline in practice, and the software progressive path is not built*/
+	if((JPEG_SCALING_DOWN_ZERO != scale_down) && (0 != main_info.thumb_size) &&
+		(0 == JPEGDEC_Scan_Stream(stream + main_info.thumb_offset, main_info.thumb_size, &thumb_info)) &&
+		(!thumb_info.is_progressive) &&
+		JPEGDEC_Is_Same_Aspect(&main_info, &thumb_info))
+	{
+		scale = JPEGDEC_Max_Scale(&thumb_info);
+		while((scale > 0) &&
+			(((thumb_info.width >> scale) < want_width) || ((thumb_info.height >> scale) < want_height)))
+		{
+			scale--;
+		}
+
+		if(((thumb_info.width >> scale) >= want_width) && ((thumb_info.height >> scale) >= want_height))
+		{
+			/*the stream buffer address is given to the VSP in words, the parser skips the leading bytes*/
+			align = main_info.thumb_offset & 3;
+			plan_ptr->stream_offset = main_info.thumb_offset - align;
+			plan_ptr->stream_size = main_info.thumb_size + align;
+			plan_ptr->width = thumb_info.width;
+			plan_ptr->height = thumb_info.height;
+			plan_ptr->scale_down = scale;
+			plan_ptr->out_width = thumb_info.width >> scale;
+			plan_ptr->out_height = thumb_info.height >> scale;
+			plan_ptr->is_thumbnail = 1;
+			SCI_TRACE_LOW("JPEGDEC_Scale_Plan, thumbnail %dx%d at %d, 1/%d.",
+				thumb_info.width, thumb_info.height, main_info.thumb_offset, 1 << scale);
+			return 0;
+		}
+	}
+
+	scale = JPEGDEC_Max_Scale(&main_info);
+	if(scale > scale_down)
+	{
+		scale = scale_down;
+	}
+	plan_ptr->stream_offset = 0;
+	plan_ptr->stream_size = stream_size;
+	plan_ptr->width = main_info.width;
+	plan_ptr->height = main_info.height;
+	plan_ptr->scale_down = scale;
+	plan_ptr->out_width = main_info.width >> scale;
+	plan_ptr->out_height = main_info.height >> scale;
+	plan_ptr->is_thumbnail = 0;
+	SCI_TRACE_LOW("JPEGDEC_Scale_Plan, %dx%d, 1/%d for 1/%d.",
+		main_info.width, main_info.height, 1 << scale, 1 << scale_down);
+
+	return 0;
+}
+
 //////////////////////////////////////////////////////////////////////////
 //#endif //JPEG_DEC
 /**---------------------------------------------------------------------------*
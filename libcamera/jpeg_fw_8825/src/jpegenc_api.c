@@ -598,14 +598,17 @@ void JPEGENC_Handle_BSM_INT_Ext(void)
 uint32_t JPEGENC_Poll_MEA_BSM(uint32_t time, uint32_t buf_len,  uint32_t slice_num,jpegenc_callback callback,jpegenc_callback updata_yuv_callback)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 	uint32_t buf_id = 1; 
 
 	SCI_TRACE_LOW("JPEGENC_Poll_MEA_BSM E,slice_num=%d.\n",slice_num);
 			
 	while (1)
 	{
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");		
+		if (IS_TIME_OUT == VSP_WaitInt(0x4080, time, &value))
+		{
+			SCI_TRACE_LOW("JPEGENC_Poll_MEA_BSM X, fail..\n");
+			return 1;
+		}
 		if(value & 0x80){ //for BSM done			
 			JPEGENC_Handle_BSM_INT(callback);
 		}
@@ -630,13 +633,6 @@ uint32_t JPEGENC_Poll_MEA_BSM(uint32_t time, uint32_t buf_len,  uint32_t slice_n
 				return 1;
 			 }
 		}
-		if (vsp_time_out_cnt > time)
-		{
-			SCI_TRACE_LOW("JPEGENC_Poll_MEA_BSM X, fail..\n");
-			return 1;
-		}
-		vsp_time_out_cnt++;
-		usleep(1000);
 	}	
 }
 
@@ -926,12 +922,15 @@ while(1)
 uint32_t JPEGENC_Poll_VLC_BSM(uint32_t time, uint32_t buf_len,  jpegenc_callback callback)
 {
 	uint32_t value;
-	uint32_t vsp_time_out_cnt = 0;
 	
 	SCI_TRACE_LOW("JPEGENC_Poll_VLC_BSM E.\n");	
 	while (1)
 	{
-		value = VSP_READ_REG(VSP_DCAM_REG_BASE + DCAM_INT_RAW_OFF, "read the interrupt register.");		
+		if (IS_TIME_OUT == VSP_WaitInt(0x180, time, &value))
+		{			
+			SCI_TRACE_LOW("JPEGENC_Poll_VLC_BSM X, fail.\n");	
+			return 1;
+		}
 		if(value & 0x100){ //for VLC done			
 			JPGEENC_Clear_INT(0x100);
 			SCI_TRACE_LOW("JPEGENC_Poll_VLC_BSM X.\n");		
@@ -940,14 +939,6 @@ uint32_t JPEGENC_Poll_VLC_BSM(uint32_t time, uint32_t buf_len,  jpegenc_callback
 		if(value & 0x80){ //for BSM done		
 			JPEGENC_Handle_BSM_INT(callback);		
 		}
-
-		if (vsp_time_out_cnt > time)
-		{			
-			SCI_TRACE_LOW("JPEGENC_Poll_VLC_BSM X, fail.\n");	
-			return 1;
-		}
-		vsp_time_out_cnt++;
-		usleep(1000);
 	}	
 }
 
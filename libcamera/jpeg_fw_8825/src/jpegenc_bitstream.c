@@ -28,8 +28,16 @@
 //////////////////////////////////////////////////////////////////////////
 
 //used in JPEG encode.
-#if _CMODEL_
-LOCAL void JPEGFW_PutBits(uint32 val, uint32 nbits)
+/*
+  The header bits are gathered in a 64-bit accumulator and handed to the BSM
+  32 bits at a time, every BSM write costs a ready polling and two register
+  writes. The BSM must see the pending bits before the VLC or the tail writes
+  it, so JPEGFW_FlushBits is called when a header or a marker is done.
+*/
+LOCAL uint64_t s_bit_acc = 0;
+LOCAL uint32 s_bit_num = 0;		//valid bits in s_bit_acc, less than 32 between calls
+
+LOCAL void JPEGFW_WriteBSM(uint32 val, uint32 nbits)
 {
 #if _CMODEL_
 	write_nbits(val, nbits, 0);
@@ -40,15 +48,51 @@ LOCAL void JPEGFW_PutBits(uint32 val, uint32 nbits)
 	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_CFG2_OFF, (nbits << 24) , "BSM_CFG2: configure write n bits");
 	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_WDATA_OFF, val, "BSM_WDATA: write val(n bits) to bitstream, auto-stuffing");
 }
-#else
+
 __inline void JPEGFW_PutBits(uint32 val, uint32 nbits)
 {
-	//VSP_READ_REG_POLL(VSP_BSM_REG_BASE+BSM_DEBUG_OFF, V_BIT_3, 0, TIME_OUT_CLK, "BSM_READY: polling bsm rfifo ready");
-    VSP_READ_REG_POLL(VSP_BSM_REG_BASE+BSM_READY_OFF, 1, 1, TIME_OUT_CLK, "BSM_READY: polling bsm rfifo ready");
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_CFG2_OFF, (nbits << 24) , "BSM_CFG2: configure write n bits");
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_WDATA_OFF, val, "BSM_WDATA: write val(n bits) to bitstream, auto-stuffing");
+	if (nbits < 32)
+	{
+		val &= ((uint32)1 << nbits) - 1;
+	}
+
+	s_bit_acc = (s_bit_acc << nbits) | val;
+	s_bit_num += nbits;
+
+	if (s_bit_num >= 32)
+	{
+		s_bit_num -= 32;
+		JPEGFW_WriteBSM((uint32)(s_bit_acc >> s_bit_num), 32);
+	}
 }
-#endif //_CMODEL_
+
+/*****************************************************************************
+**	Name : 			JPEGFW_FlushBits
+**	Description:	write the bits left in the accumulator to the BSM
+**	Note:
+*****************************************************************************/
+PUBLIC void JPEGFW_FlushBits(void)
+{
+	if (s_bit_num > 0)
+	{
+		JPEGFW_WriteBSM((uint32)s_bit_acc & (((uint32)1 << s_bit_num) - 1), s_bit_num);
+	}
+
+	s_bit_acc = 0;
+	s_bit_num = 0;
+}
+
+/*****************************************************************************
+**	Name : 			JPEGFW_ResetBits
+**	Description:	drop the bits left by an aborted header
+**	Note:
+*****************************************************************************/
+PUBLIC void JPEGFW_ResetBits(void)
+{
+	s_bit_acc = 0;
+	s_bit_num = 0;
+}
+
 /*****************************************************************************
 **	Name : 			JPEG_PutC
 **	Description:	Output CHAR
@@ -57,14 +101,7 @@ __inline void JPEGFW_PutBits(uint32 val, uint32 nbits)
 *****************************************************************************/
 PUBLIC void JPEGFW_PutC(uint8 ch)
 {
-#if _CMODEL_
-	write_nbits(ch, 8, 0);
-#endif //_CMODEL_
-
-	VSP_READ_REG_POLL(VSP_BSM_REG_BASE+BSM_READY_OFF, 1, 1, TIME_OUT_CLK, "BSM_READY: polling bsm rfifo ready");
-
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_CFG2_OFF, (8<<24), "BSM_CFG2: configure 8 bit for writing");
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_WDATA_OFF, ch, "BSM_WDATA: configure the value to be written to bitstream");
+	JPEGFW_PutBits(ch, 8);
 }
 
 /*****************************************************************************
@@ -75,14 +112,7 @@ PUBLIC void JPEGFW_PutC(uint8 ch)
 *****************************************************************************/
 PUBLIC void JPEGFW_PutW(uint16 w)
 {
-#if _CMODEL_
-	write_nbits(w, 16, 0);
-#endif //_CMODEL_
-
-	VSP_READ_REG_POLL(VSP_BSM_REG_BASE+BSM_READY_OFF, 1, 1, TIME_OUT_CLK, "BSM_READY: polling bsm rfifo ready");
-
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_CFG2_OFF, (16<<24), "BSM_CFG2: configure 16 bit for writing");
-	VSP_WRITE_REG(VSP_BSM_REG_BASE+BSM_WDATA_OFF, w, "BSM_WDATA: configure the value to be written to bitstream");
+	JPEGFW_PutBits(w, 16);
 }
 PUBLIC void JPEGFW_PutW_II(uint16 w)
 {
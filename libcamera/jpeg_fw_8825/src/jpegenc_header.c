@@ -53,6 +53,7 @@ PUBLIC void OutPutRstMarker(void)
 	}
 	JPEGFW_PutC(0xFF);
 	JPEGFW_PutC(jpeg_fw_codec->RST_Count++);
+	JPEGFW_FlushBits();
 }
 
 PUBLIC JPEG_RET_E PutAPP0(void)
@@ -98,6 +99,8 @@ PUBLIC JPEG_RET_E JPEG_HWWriteHeadForThumbnail(void)
 		return JPEG_FAILED;
 	}
 
+	JPEGFW_ResetBits();
+
 	/*put SOI*/
 	PutMarker(M_SOI);
 
@@ -134,6 +137,8 @@ PUBLIC JPEG_RET_E JPEG_HWWriteHeadForThumbnail(void)
 	{
 		return JPEG_FAILED;
 	}
+
+	JPEGFW_FlushBits();
 	
 	return JPEG_SUCCESS;
 }
@@ -145,6 +150,7 @@ PUBLIC JPEG_RET_E JPEG_HWWriteTailForThumbnail(void){
 	
 	/*put SOI*/
 	PutMarker(M_EOI);
+	JPEGFW_FlushBits();
 	return JPEG_SUCCESS;
 }
 
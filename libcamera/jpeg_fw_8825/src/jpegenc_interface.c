@@ -158,6 +158,8 @@ PUBLIC JPEG_RET_E JPEG_HWWriteHead(APP1_T *app1_t)
 		return JPEG_FAILED;
 	}
 
+	JPEGFW_ResetBits();
+
 	/*put SOI*/
 	PutMarker(M_SOI);
 
@@ -195,6 +197,8 @@ PUBLIC JPEG_RET_E JPEG_HWWriteHead(APP1_T *app1_t)
 	{
 		return JPEG_FAILED;
 	}
+
+	JPEGFW_FlushBits();
 	
 	return JPEG_SUCCESS;
 }
@@ -0,0 +1,1046 @@
+/******************************************************************************
+ ** File Name:      jpegenc_progressive.c                                     *
+ ** Author:                                                                   *
+ ** DATE:           10/19/2026                                                *
+ ** Description:    progressive encoder with optimal huffman tables           *
+ ** Note:           Built on jpegenc_header.c, CPU only, the VSP can not      *
+ **                 produce progressive streams                               *
+******************************************************************************/
+/******************************************************************************
+ **                        Edit History                                       *
+ ** ------------------------------------------------------------------------- *
+ ** DATE           NAME             DESCRIPTION                               *
+ ** 10/19/2026                      Create.                                   *
+******************************************************************************/
+/*----------------------------------------------------------------------------*
+**                        Dependencies                                        *
+**---------------------------------------------------------------------------*/
+#include "sc8825_video_header.h"
+#include "jpegenc_api.h"
+/**---------------------------------------------------------------------------*
+**                        Compiler Flag                                       *
+**---------------------------------------------------------------------------*/
+#ifdef   __cplusplus
+    extern   "C"
+    {
+#endif
+
+#if defined(JPEG_ENC)
+//////////////////////////////////////////////////////////////////////////
+/*
+  The VLC of the VSP only produces baseline streams, so the progressive mode
+  is done by the CPU on one whole frame: the frame is transformed and quantized
+  once into a coefficient buffer, then every scan of the script is coded twice,
+  the first pass only counts the symbols to build the optimal huffman tables of
+  this scan, the second one writes the tables and the entropy coded data.
+  The scan coding follows ISO 10918-1 Annex G, the same way as the libjpeg.
+*/
+#define PROG_COMP_NUM			3
+#define PROG_TBL_NUM			2
+#define PROG_MAX_EOBRUN			0x7FFF
+#define PROG_MAX_CORR_BITS		1000	/*max correction bits buffered in one EOB run*/
+#define PROG_MAX_CLEN			32		/*code length limit before the 16 bits adjustment*/
+
+#define PROG_CONST_BITS			13
+#define PROG_PASS1_BITS			2
+#define PROG_DESCALE(x, n)		(((x) + (1 << ((n)-1))) >> (n))
+
+typedef struct
+{
+	uint8 comps_in_scan;
+	uint8 comp_id[PROG_COMP_NUM];
+	uint8 Ss;
+	uint8 Se;
+	uint8 Ah;
+	uint8 Al;
+}PROG_SCAN_T;
+
+/*the scan script of jpeg_simple_progression for YCbCr*/
+LOCAL const PROG_SCAN_T s_prog_scan[] =
+{
+	{3, {0, 1, 2}, 0, 0, 0, 1},
+	{1, {0}, 1, 5, 0, 2},
+	{1, {2}, 1, 63, 0, 1},
+	{1, {1}, 1, 63, 0, 1},
+	{1, {0}, 6, 63, 0, 2},
+	{1, {0}, 1, 63, 2, 1},
+	{3, {0, 1, 2}, 0, 0, 1, 0},
+	{1, {2}, 1, 63, 1, 0},
+	{1, {1}, 1, 63, 1, 0},
+	{1, {0}, 1, 63, 1, 0},
+};
+
+typedef struct
+{
+	uint8 h_samp;
+	uint8 v_samp;
+	uint8 tbl_id;		/*quant table, and huffman table in the interleaved DC scans*/
+	uint32 width;		/*samples*/
+	uint32 height;
+	uint32 blocks_w;	/*blocks of the MCU aligned plane*/
+	uint32 blocks_h;
+	uint32 scan_w;		/*blocks coded by the non-interleaved scans*/
+	uint32 scan_h;
+	int16 *coef;		/*64 quantized coefficients per block, zigzag order*/
+	int32 last_dc;
+}PROG_COMP_T;
+
+typedef struct
+{
+	uint8 *buf;
+	uint32 buf_len;
+	uint32 pos;
+	BOOLEAN overflow;
+
+	uint32 put_buf;
+	int32 put_bits;
+
+	BOOLEAN gather;
+	uint32 count[PROG_TBL_NUM][257];
+	uint16 ehufco[PROG_TBL_NUM][256];
+	uint8 ehufsi[PROG_TBL_NUM][256];
+
+	uint32 eobrun;
+	uint32 be;			/*correction bits buffered in bit_buf for the EOB run*/
+	uint8 bit_buf[PROG_MAX_CORR_BITS];
+
+	uint32 mcus_x;
+	uint32 mcus_y;
+	PROG_COMP_T comp[PROG_COMP_NUM];
+	const uint8 *quant_tbl[PROG_TBL_NUM];
+}PROG_ENC_T;
+
+LOCAL void Prog_EmitByte(PROG_ENC_T *enc, uint8 c)
+{
+	if (enc->pos < enc->buf_len)
+	{
+		enc->buf[enc->pos++] = c;
+	}else
+	{
+		enc->overflow = TRUE;
+	}
+}
+
+LOCAL void Prog_EmitMarker(PROG_ENC_T *enc, uint8 marker)
+{
+	Prog_EmitByte(enc, 0xFF);
+	Prog_EmitByte(enc, marker);
+}
+
+LOCAL void Prog_EmitW(PROG_ENC_T *enc, uint16 w)
+{
+	Prog_EmitByte(enc, (uint8)(w >> 8));
+	Prog_EmitByte(enc, (uint8)(w & 0xFF));
+}
+
+//the entropy coded bytes, 0xFF is stuffed with 0x00
+LOCAL void Prog_EmitBits(PROG_ENC_T *enc, uint32 code, int32 size)
+{
+	uint32 put_buf;
+	int32 put_bits = enc->put_bits;
+	uint8 c;
+
+	if (enc->gather)
+	{
+		return;
+	}
+
+	put_buf = code & (((uint32)1 << size) - 1);
+	put_bits += size;
+	put_buf <<= 24 - put_bits;
+	put_buf |= enc->put_buf;
+
+	while (put_bits >= 8)
+	{
+		c = (uint8)((put_buf >> 16) & 0xFF);
+		Prog_EmitByte(enc, c);
+		if (c == 0xFF)
+		{
+			Prog_EmitByte(enc, 0);
+		}
+		put_buf <<= 8;
+		put_bits -= 8;
+	}
+
+	enc->put_buf = put_buf;
+	enc->put_bits = put_bits;
+}
+
+LOCAL void Prog_FlushBits(PROG_ENC_T *enc)
+{
+	Prog_EmitBits(enc, 0x7F, 7);	/*fill the partial byte with ones*/
+	enc->put_buf = 0;
+	enc->put_bits = 0;
+}
+
+LOCAL void Prog_EmitSymbol(PROG_ENC_T *enc, uint32 tbl, uint32 symbol)
+{
+	if (enc->gather)
+	{
+		enc->count[tbl][symbol]++;
+	}else
+	{
+		Prog_EmitBits(enc, enc->ehufco[tbl][symbol], enc->ehufsi[tbl][symbol]);
+	}
+}
+
+LOCAL void Prog_EmitBufferedBits(PROG_ENC_T *enc, uint8 *bits, uint32 num)
+{
+	if (enc->gather)
+	{
+		return;
+	}
+
+	while (num > 0)
+	{
+		Prog_EmitBits(enc, *bits++, 1);
+		num--;
+	}
+}
+
+LOCAL uint32 Prog_BitLen(uint32 value)
+{
+	uint32 nbits = 0;
+
+	while (value)
+	{
+		nbits++;
+		value >>= 1;
+	}
+
+	return nbits;
+}
+
+LOCAL void Prog_EmitEobrun(PROG_ENC_T *enc, uint32 tbl)
+{
+	uint32 nbits;
+
+	if (enc->eobrun > 0)
+	{
+		nbits = Prog_BitLen(enc->eobrun) - 1;
+		Prog_EmitSymbol(enc, tbl, nbits << 4);
+		if (nbits)
+		{
+			Prog_EmitBits(enc, enc->eobrun, nbits);
+		}
+		enc->eobrun = 0;
+
+		Prog_EmitBufferedBits(enc, enc->bit_buf, enc->be);
+		enc->be = 0;
+	}
+}
+
+/*****************************************************************************
+ **	Name :			Prog_FDCT
+ ** Description:	the islow integer DCT, the output is scaled up by 8.
+ **	Note:
+ *****************************************************************************/
+LOCAL void Prog_FDCT(int32 *data)
+{
+	int32 tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+	int32 tmp10, tmp11, tmp12, tmp13;
+	int32 z1, z2, z3, z4, z5;
+	int32 *ptr;
+	int32 i;
+
+	for (i = 0, ptr = data; i < 8; i++, ptr += 8)
+	{
+		tmp0 = ptr[0] + ptr[7];
+		tmp7 = ptr[0] - ptr[7];
+		tmp1 = ptr[1] + ptr[6];
+		tmp6 = ptr[1] - ptr[6];
+		tmp2 = ptr[2] + ptr[5];
+		tmp5 = ptr[2] - ptr[5];
+		tmp3 = ptr[3] + ptr[4];
+		tmp4 = ptr[3] - ptr[4];
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		ptr[0] = (tmp10 + tmp11) << PROG_PASS1_BITS;
+		ptr[4] = (tmp10 - tmp11) << PROG_PASS1_BITS;
+
+		z1 = (tmp12 + tmp13) * 4433;
+		ptr[2] = PROG_DESCALE(z1 + tmp13 * 6270, PROG_CONST_BITS - PROG_PASS1_BITS);
+		ptr[6] = PROG_DESCALE(z1 - tmp12 * 15137, PROG_CONST_BITS - PROG_PASS1_BITS);
+
+		z1 = tmp4 + tmp7;
+		z2 = tmp5 + tmp6;
+		z3 = tmp4 + tmp6;
+		z4 = tmp5 + tmp7;
+		z5 = (z3 + z4) * 9633;
+
+		tmp4 *= 2446;
+		tmp5 *= 16819;
+		tmp6 *= 25172;
+		tmp7 *= 12299;
+		z1 *= -7373;
+		z2 *= -20995;
+		z3 *= -16069;
+		z4 *= -3196;
+		z3 += z5;
+		z4 += z5;
+
+		ptr[7] = PROG_DESCALE(tmp4 + z1 + z3, PROG_CONST_BITS - PROG_PASS1_BITS);
+		ptr[5] = PROG_DESCALE(tmp5 + z2 + z4, PROG_CONST_BITS - PROG_PASS1_BITS);
+		ptr[3] = PROG_DESCALE(tmp6 + z2 + z3, PROG_CONST_BITS - PROG_PASS1_BITS);
+		ptr[1] = PROG_DESCALE(tmp7 + z1 + z4, PROG_CONST_BITS - PROG_PASS1_BITS);
+	}
+
+	for (i = 0, ptr = data; i < 8; i++, ptr++)
+	{
+		tmp0 = ptr[0] + ptr[56];
+		tmp7 = ptr[0] - ptr[56];
+		tmp1 = ptr[8] + ptr[48];
+		tmp6 = ptr[8] - ptr[48];
+		tmp2 = ptr[16] + ptr[40];
+		tmp5 = ptr[16] - ptr[40];
+		tmp3 = ptr[24] + ptr[32];
+		tmp4 = ptr[24] - ptr[32];
+
+		tmp10 = tmp0 + tmp3;
+		tmp13 = tmp0 - tmp3;
+		tmp11 = tmp1 + tmp2;
+		tmp12 = tmp1 - tmp2;
+
+		ptr[0] = PROG_DESCALE(tmp10 + tmp11, PROG_PASS1_BITS);
+		ptr[32] = PROG_DESCALE(tmp10 - tmp11, PROG_PASS1_BITS);
+
+		z1 = (tmp12 + tmp13) * 4433;
+		ptr[16] = PROG_DESCALE(z1 + tmp13 * 6270, PROG_CONST_BITS + PROG_PASS1_BITS);
+		ptr[48] = PROG_DESCALE(z1 - tmp12 * 15137, PROG_CONST_BITS + PROG_PASS1_BITS);
+
+		z1 = tmp4 + tmp7;
+		z2 = tmp5 + tmp6;
+		z3 = tmp4 + tmp6;
+		z4 = tmp5 + tmp7;
+		z5 = (z3 + z4) * 9633;
+
+		tmp4 *= 2446;
+		tmp5 *= 16819;
+		tmp6 *= 25172;
+		tmp7 *= 12299;
+		z1 *= -7373;
+		z2 *= -20995;
+		z3 *= -16069;
+		z4 *= -3196;
+		z3 += z5;
+		z4 += z5;
+
+		ptr[56] = PROG_DESCALE(tmp4 + z1 + z3, PROG_CONST_BITS + PROG_PASS1_BITS);
+		ptr[40] = PROG_DESCALE(tmp5 + z2 + z4, PROG_CONST_BITS + PROG_PASS1_BITS);
+		ptr[24] = PROG_DESCALE(tmp6 + z2 + z3, PROG_CONST_BITS + PROG_PASS1_BITS);
+		ptr[8] = PROG_DESCALE(tmp7 + z1 + z4, PROG_CONST_BITS + PROG_PASS1_BITS);
+	}
+}
+
+/*****************************************************************************
+ **	Name :			Prog_TransformFrame
+ ** Description:	transform and quantize all the blocks of the frame, the
+ **					edges are padded by the last sample up to the MCU border.
+ **	Note:			uv is interleaved vuvu, v at the even bytes, as the
+ **					hardware encoder is configured in JPEG_HWEncInit.
+ *****************************************************************************/
+LOCAL void Prog_TransformFrame(PROG_ENC_T *enc, JPEGENC_PARAMS_T *jpegenc_params)
+{
+	const uint8 *zigzag = jpeg_fw_zigzag_order;
+	const uint8 *plane, *row;
+	const uint8 *quant;
+	PROG_COMP_T *comp;
+	int32 block[64];
+	int32 temp, qval;
+	uint32 ci, bx, by, x, y, sx, sy, k;
+	uint32 step, offset, stride;
+	int16 *coef;
+
+	for (ci = 0; ci < PROG_COMP_NUM; ci++)
+	{
+		comp = &enc->comp[ci];
+		quant = enc->quant_tbl[comp->tbl_id];
+		coef = comp->coef;
+
+		if (0 == ci)
+		{
+			plane = (const uint8 *)jpegenc_params->yuv_virt_buf;
+			step = 1;
+			offset = 0;
+		}else
+		{
+			plane = (const uint8 *)jpegenc_params->yuv_u_virt_buf;
+			step = 2;
+			offset = (1 == ci) ? 1 : 0;	/*Cb at the odd bytes, Cr at the even ones*/
+		}
+		stride = jpegenc_params->width;
+
+		for (by = 0; by < comp->blocks_h; by++)
+		{
+			for (bx = 0; bx < comp->blocks_w; bx++)
+			{
+				for (y = 0; y < 8; y++)
+				{
+					sy = by * 8 + y;
+					sy = (sy < comp->height) ? sy : (comp->height - 1);
+					row = plane + sy * stride + offset;
+
+					for (x = 0; x < 8; x++)
+					{
+						sx = bx * 8 + x;
+						sx = (sx < comp->width) ? sx : (comp->width - 1);
+						block[y * 8 + x] = (int32)row[sx * step] - 128;
+					}
+				}
+
+				Prog_FDCT(block);
+
+				for (k = 0; k < 64; k++)
+				{
+					qval = (int32)quant[zigzag[k]] << 3;
+					temp = block[zigzag[k]];
+					if (temp < 0)
+					{
+						temp = -((-temp + (qval >> 1)) / qval);
+					}else
+					{
+						temp = (temp + (qval >> 1)) / qval;
+					}
+					coef[k] = (int16)temp;
+				}
+				coef += 64;
+			}
+		}
+	}
+}
+
+/*****************************************************************************
+ **	Name :			Prog_GenOptimalTable
+ ** Description:	the huffman table of the counted symbols limited to 16
+ **					bits, see ISO 10918-1 Annex K.2.
+ **	Note:			the count is destroyed. FALSE when a code is longer than
+ **					PROG_MAX_CLEN, like libjpeg's JERR_HUFF_CLEN_OVERFLOW.
+ *****************************************************************************/
+LOCAL BOOLEAN Prog_GenOptimalTable(uint32 *freq, uint8 *bits, uint8 *huffval)
+{
+	uint8 bits_tmp[PROG_MAX_CLEN + 1];
+	int32 codesize[257];
+	int32 others[257];
+	int32 c1, c2, i, j, p;
+	uint32 v;
+
+	memset(bits_tmp, 0, sizeof(bits_tmp));
+	memset(codesize, 0, sizeof(codesize));
+	for (i = 0; i < 257; i++)
+	{
+		others[i] = -1;
+	}
+	freq[256] = 1;	/*reserves one code point, no code is all ones*/
+
+	while (TRUE)
+	{
+		c1 = -1;
+		v = 0xFFFFFFFF;
+		for (i = 0; i <= 256; i++)
+		{
+			if (freq[i] && freq[i] <= v)
+			{
+				v = freq[i];
+				c1 = i;
+			}
+		}
+
+		c2 = -1;
+		v = 0xFFFFFFFF;
+		for (i = 0; i <= 256; i++)
+		{
+			if (freq[i] && freq[i] <= v && i != c1)
+			{
+				v = freq[i];
+				c2 = i;
+			}
+		}
+
+		if (c2 < 0)
+		{
+			break;
+		}
+
+		freq[c1] += freq[c2];
+		freq[c2] = 0;
+
+		codesize[c1]++;
+		while (others[c1] >= 0)
+		{
+			c1 = others[c1];
+			codesize[c1]++;
+		}
+		others[c1] = c2;
+
+		codesize[c2]++;
+		while (others[c2] >= 0)
+		{
+			c2 = others[c2];
+			codesize[c2]++;
+		}
+	}
+
+	for (i = 0; i <= 256; i++)
+	{
+		if (codesize[i])
+		{
+			if (codesize[i] > PROG_MAX_CLEN)
+			{
+				SCI_TRACE_LOW("Prog_GenOptimalTable, code length %d overflow.", codesize[i]);
+				return FALSE;
+			}
+			bits_tmp[codesize[i]]++;
+		}
+	}
+
+	for (i = PROG_MAX_CLEN; i > 16; i--)
+	{
+		while (bits_tmp[i] > 0)
+		{
+			j = i - 2;
+			while (bits_tmp[j] == 0)
+			{
+				j--;
+			}
+			bits_tmp[i] -= 2;
+			bits_tmp[i-1]++;
+			bits_tmp[j+1] += 2;
+			bits_tmp[j]--;
+		}
+	}
+
+	while (bits_tmp[i] == 0)
+	{
+		i--;
+	}
+	bits_tmp[i]--;	/*removes the reserved code point*/
+
+	memcpy(bits, bits_tmp, 17);
+
+	p = 0;
+	for (i = 1; i <= PROG_MAX_CLEN; i++)
+	{
+		for (j = 0; j <= 255; j++)
+		{
+			if (codesize[j] == i)
+			{
+				huffval[p++] = (uint8)j;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+//build the code table from bits and huffval, and write it in the DHT
+LOCAL void Prog_DeriveTable(PROG_ENC_T *enc, uint32 tbl, uint8 *bits, uint8 *huffval)
+{
+	uint32 code = 0;
+	uint32 i, l, p = 0;
+
+	memset(enc->ehufsi[tbl], 0, 256);
+
+	for (l = 1; l <= 16; l++)
+	{
+		for (i = 0; i < bits[l]; i++)
+		{
+			enc->ehufco[tbl][huffval[p]] = (uint16)code;
+			enc->ehufsi[tbl][huffval[p]] = (uint8)l;
+			code++;
+			p++;
+		}
+		code <<= 1;
+	}
+}
+
+//the tables of one scan are counted in count[], DC class or AC class
+LOCAL BOOLEAN Prog_PutHuffTbl(PROG_ENC_T *enc, uint32 tbl_num, BOOLEAN is_dc)
+{
+	uint8 bits[PROG_TBL_NUM][17];
+	uint8 huffval[PROG_TBL_NUM][256];
+	uint32 tbl, i, len = 2;
+	uint32 num[PROG_TBL_NUM];
+
+	for (tbl = 0; tbl < tbl_num; tbl++)
+	{
+		if (!Prog_GenOptimalTable(enc->count[tbl], bits[tbl], huffval[tbl]))
+		{
+			return FALSE;
+		}
+		Prog_DeriveTable(enc, tbl, bits[tbl], huffval[tbl]);
+
+		num[tbl] = 0;
+		for (i = 1; i <= 16; i++)
+		{
+			num[tbl] += bits[tbl][i];
+		}
+		len += 1 + 16 + num[tbl];
+	}
+
+	Prog_EmitMarker(enc, M_DHT);
+	Prog_EmitW(enc, (uint16)len);
+	for (tbl = 0; tbl < tbl_num; tbl++)
+	{
+		Prog_EmitByte(enc, (uint8)(is_dc ? tbl : (0x10 | tbl)));
+		for (i = 1; i <= 16; i++)
+		{
+			Prog_EmitByte(enc, bits[tbl][i]);
+		}
+		for (i = 0; i < num[tbl]; i++)
+		{
+			Prog_EmitByte(enc, huffval[tbl][i]);
+		}
+	}
+
+	return TRUE;
+}
+
+LOCAL void Prog_EncodeDCFirst(PROG_ENC_T *enc, PROG_COMP_T *comp, uint32 tbl, int16 *coef, uint32 Al)
+{
+	int32 temp, temp2;
+	uint32 nbits;
+
+	temp2 = (int32)coef[0] >> Al;
+	temp = temp2 - comp->last_dc;
+	comp->last_dc = temp2;
+
+	temp2 = temp;
+	if (temp < 0)
+	{
+		temp = -temp;
+		temp2--;
+	}
+
+	nbits = Prog_BitLen((uint32)temp);
+	Prog_EmitSymbol(enc, tbl, nbits);
+	if (nbits)
+	{
+		Prog_EmitBits(enc, (uint32)temp2, nbits);
+	}
+}
+
+LOCAL void Prog_EncodeDCRefine(PROG_ENC_T *enc, int16 *coef, uint32 Al)
+{
+	Prog_EmitBits(enc, (uint32)((int32)coef[0] >> Al), 1);
+}
+
+LOCAL void Prog_EncodeACFirst(PROG_ENC_T *enc, int16 *coef, uint32 Ss, uint32 Se, uint32 Al)
+{
+	int32 temp, temp2;
+	uint32 nbits, r = 0, k;
+
+	for (k = Ss; k <= Se; k++)
+	{
+		temp = coef[k];
+		if (temp == 0)
+		{
+			r++;
+			continue;
+		}
+
+		if (temp < 0)
+		{
+			temp = -temp;
+			temp >>= Al;
+			temp2 = ~temp;
+		}else
+		{
+			temp >>= Al;
+			temp2 = temp;
+		}
+		if (temp == 0)
+		{
+			r++;
+			continue;
+		}
+
+		Prog_EmitEobrun(enc, 0);
+
+		while (r > 15)
+		{
+			Prog_EmitSymbol(enc, 0, 0xF0);
+			r -= 16;
+		}
+
+		nbits = Prog_BitLen((uint32)temp);
+		Prog_EmitSymbol(enc, 0, (r << 4) + nbits);
+		Prog_EmitBits(enc, (uint32)temp2, nbits);
+		r = 0;
+	}
+
+	if (r > 0)
+	{
+		enc->eobrun++;
+		if (enc->eobrun == PROG_MAX_EOBRUN)
+		{
+			Prog_EmitEobrun(enc, 0);
+		}
+	}
+}
+
+LOCAL void Prog_EncodeACRefine(PROG_ENC_T *enc, int16 *coef, uint32 Ss, uint32 Se, uint32 Al)
+{
+	int32 absvalues[64];
+	int32 temp;
+	uint32 r = 0, br = 0, eob = 0, k;
+	uint8 *br_buf;
+
+	for (k = Ss; k <= Se; k++)
+	{
+		temp = coef[k];
+		if (temp < 0)
+		{
+			temp = -temp;
+		}
+		temp >>= Al;
+		absvalues[k] = temp;
+		if (temp == 1)
+		{
+			eob = k;	/*the last newly nonzero coefficient*/
+		}
+	}
+
+	br_buf = enc->bit_buf + enc->be;
+
+	for (k = Ss; k <= Se; k++)
+	{
+		temp = absvalues[k];
+		if (temp == 0)
+		{
+			r++;
+			continue;
+		}
+
+		while (r > 15 && k <= eob)
+		{
+			Prog_EmitEobrun(enc, 0);
+			Prog_EmitSymbol(enc, 0, 0xF0);
+			r -= 16;
+			Prog_EmitBufferedBits(enc, br_buf, br);
+			br_buf = enc->bit_buf;
+			br = 0;
+		}
+
+		if (temp > 1)
+		{
+			//already nonzero, only the correction bit
+			br_buf[br++] = (uint8)(temp & 1);
+			continue;
+		}
+
+		Prog_EmitEobrun(enc, 0);
+		Prog_EmitSymbol(enc, 0, (r << 4) + 1);
+		Prog_EmitBits(enc, (coef[k] < 0) ? 0 : 1, 1);
+		Prog_EmitBufferedBits(enc, br_buf, br);
+		br_buf = enc->bit_buf;
+		br = 0;
+		r = 0;
+	}
+
+	if (r > 0 || br > 0)
+	{
+		enc->eobrun++;
+		enc->be += br;
+		if (enc->eobrun == PROG_MAX_EOBRUN || enc->be > (PROG_MAX_CORR_BITS - 64 + 1))
+		{
+			Prog_EmitEobrun(enc, 0);
+		}
+	}
+}
+
+/*****************************************************************************
+ **	Name :			Prog_EncodeScan
+ ** Description:	one pass over the blocks of the scan, counts the symbols
+ **					or writes the entropy coded data.
+ **	Note:
+ *****************************************************************************/
+LOCAL void Prog_EncodeScan(PROG_ENC_T *enc, const PROG_SCAN_T *scan)
+{
+	PROG_COMP_T *comp;
+	int16 *coef;
+	uint32 mx, my, ci, h, v, bx, by;
+
+	enc->eobrun = 0;
+	enc->be = 0;
+	enc->put_buf = 0;
+	enc->put_bits = 0;
+	for (ci = 0; ci < PROG_COMP_NUM; ci++)
+	{
+		enc->comp[ci].last_dc = 0;
+	}
+
+	if (scan->comps_in_scan > 1)
+	{
+		//interleaved, only the DC scans
+		for (my = 0; my < enc->mcus_y; my++)
+		{
+			for (mx = 0; mx < enc->mcus_x; mx++)
+			{
+				for (ci = 0; ci < scan->comps_in_scan; ci++)
+				{
+					comp = &enc->comp[scan->comp_id[ci]];
+					for (v = 0; v < comp->v_samp; v++)
+					{
+						by = my * comp->v_samp + v;
+						for (h = 0; h < comp->h_samp; h++)
+						{
+							bx = mx * comp->h_samp + h;
+							coef = comp->coef + (by * comp->blocks_w + bx) * 64;
+							if (0 == scan->Ah)
+							{
+								Prog_EncodeDCFirst(enc, comp, comp->tbl_id, coef, scan->Al);
+							}else
+							{
+								Prog_EncodeDCRefine(enc, coef, scan->Al);
+							}
+						}
+					}
+				}
+			}
+		}
+	}else
+	{
+		comp = &enc->comp[scan->comp_id[0]];
+		for (by = 0; by < comp->scan_h; by++)
+		{
+			for (bx = 0; bx < comp->scan_w; bx++)
+			{
+				coef = comp->coef + (by * comp->blocks_w + bx) * 64;
+				if (0 == scan->Ss)
+				{
+					if (0 == scan->Ah)
+					{
+						Prog_EncodeDCFirst(enc, comp, 0, coef, scan->Al);
+					}else
+					{
+						Prog_EncodeDCRefine(enc, coef, scan->Al);
+					}
+				}else if (0 == scan->Ah)
+				{
+					Prog_EncodeACFirst(enc, coef, scan->Ss, scan->Se, scan->Al);
+				}else
+				{
+					Prog_EncodeACRefine(enc, coef, scan->Ss, scan->Se, scan->Al);
+				}
+			}
+		}
+	}
+
+	Prog_EmitEobrun(enc, 0);
+	Prog_FlushBits(enc);
+}
+
+LOCAL void Prog_PutSOS(PROG_ENC_T *enc, const PROG_SCAN_T *scan)
+{
+	uint32 ci, id;
+
+	Prog_EmitMarker(enc, M_SOS);
+	Prog_EmitW(enc, (uint16)(2 + 1 + scan->comps_in_scan * 2 + 3));
+	Prog_EmitByte(enc, scan->comps_in_scan);
+	for (ci = 0; ci < scan->comps_in_scan; ci++)
+	{
+		id = scan->comp_id[ci];
+		Prog_EmitByte(enc, (uint8)(id + 1));
+		if (scan->comps_in_scan > 1)
+		{
+			Prog_EmitByte(enc, (uint8)((enc->comp[id].tbl_id << 4) | enc->comp[id].tbl_id));
+		}else
+		{
+			Prog_EmitByte(enc, 0);
+		}
+	}
+	Prog_EmitByte(enc, scan->Ss);
+	Prog_EmitByte(enc, scan->Se);
+	Prog_EmitByte(enc, (uint8)((scan->Ah << 4) | scan->Al));
+}
+
+LOCAL void Prog_PutHead(PROG_ENC_T *enc, JPEGENC_PARAMS_T *jpegenc_params)
+{
+	const uint8 *zigzag = jpeg_fw_zigzag_order;
+	PROG_COMP_T *comp;
+	uint32 i, k;
+
+	Prog_EmitMarker(enc, M_SOI);
+
+	//the same APP0 as PutAPP0
+	Prog_EmitMarker(enc, M_APP0);
+	Prog_EmitW(enc, (2+4+1+2+1+2+2+1+1));
+	Prog_EmitByte(enc, 'J');
+	Prog_EmitByte(enc, 'F');
+	Prog_EmitByte(enc, 'I');
+	Prog_EmitByte(enc, 'F');
+	Prog_EmitByte(enc, 0);
+	Prog_EmitByte(enc, 1);
+	Prog_EmitByte(enc, 1);
+	Prog_EmitByte(enc, 0);
+	Prog_EmitW(enc, 1);
+	Prog_EmitW(enc, 1);
+	Prog_EmitByte(enc, 0);
+	Prog_EmitByte(enc, 0);
+
+	for (i = 0; i < PROG_TBL_NUM; i++)
+	{
+		Prog_EmitMarker(enc, M_DQT);
+		Prog_EmitW(enc, 64 + 1 + 2);
+		Prog_EmitByte(enc, (uint8)i);
+		for (k = 0; k < 64; k++)
+		{
+			Prog_EmitByte(enc, enc->quant_tbl[i][zigzag[k]]);
+		}
+	}
+
+	Prog_EmitMarker(enc, M_SOF2);
+	Prog_EmitW(enc, 8 + PROG_COMP_NUM * 3);
+	Prog_EmitByte(enc, 8);
+	Prog_EmitW(enc, (uint16)jpegenc_params->height);
+	Prog_EmitW(enc, (uint16)jpegenc_params->width);
+	Prog_EmitByte(enc, PROG_COMP_NUM);
+	for (i = 0; i < PROG_COMP_NUM; i++)
+	{
+		comp = &enc->comp[i];
+		Prog_EmitByte(enc, (uint8)(i + 1));
+		Prog_EmitByte(enc, (uint8)((comp->h_samp << 4) | comp->v_samp));
+		Prog_EmitByte(enc, comp->tbl_id);
+	}
+}
+
+LOCAL void Prog_InitComp(PROG_ENC_T *enc, JPEGENC_PARAMS_T *jpegenc_params)
+{
+	PROG_COMP_T *comp;
+	uint32 max_v = (JPEGENC_YUV_420 == jpegenc_params->format) ? 2 : 1;
+	uint32 ci;
+
+	enc->mcus_x = (jpegenc_params->width + 15) / 16;
+	enc->mcus_y = (jpegenc_params->height + max_v * 8 - 1) / (max_v * 8);
+
+	for (ci = 0; ci < PROG_COMP_NUM; ci++)
+	{
+		comp = &enc->comp[ci];
+		comp->h_samp = (0 == ci) ? 2 : 1;
+		comp->v_samp = (0 == ci) ? max_v : 1;
+		comp->tbl_id = (0 == ci) ? 0 : 1;
+		comp->width = (jpegenc_params->width * comp->h_samp + 1) / 2;
+		comp->height = (jpegenc_params->height * comp->v_samp + max_v - 1) / max_v;
+		comp->blocks_w = enc->mcus_x * comp->h_samp;
+		comp->blocks_h = enc->mcus_y * comp->v_samp;
+		comp->scan_w = (comp->width + 7) / 8;
+		comp->scan_h = (comp->height + 7) / 8;
+	}
+}
+
+/*****************************************************************************
+ **	Name :			JPEGENC_Progressive_Encode
+ ** Description:	encodes one whole frame to a progressive stream in
+ **					stream_virt_buf[0], the size is returned in stream_size.
+ **	Note:			the yuv must be reachable by the CPU, it's much slower
+ **					than the hardware baseline encoder.
+ *****************************************************************************/
+PUBLIC int JPEGENC_Progressive_Encode(JPEGENC_PARAMS_T *jpegenc_params)
+{
+	PROG_ENC_T *enc = PNULL;
+	JPEG_RET_E ret = JPEG_SUCCESS;
+	uint32 level, ci, i, blocks = 0;
+	int16 *coef = PNULL;
+	const PROG_SCAN_T *scan;
+
+	if (PNULL == jpegenc_params->yuv_virt_buf || PNULL == jpegenc_params->yuv_u_virt_buf
+		|| PNULL == jpegenc_params->stream_virt_buf[0] || jpegenc_params->format >= JPEGENC_YUV_MAX
+		|| 0 == jpegenc_params->width || 0 == jpegenc_params->height)
+	{
+		SCI_TRACE_LOW("JPEGENC_Progressive_Encode, invalid param.");
+		return JPEGE_INVALID_ARGUMENT;
+	}
+
+	enc = (PROG_ENC_T *)malloc(sizeof(PROG_ENC_T));
+	if (PNULL == enc)
+	{
+		return JPEG_MEMORY_MALLOC_FAILED;
+	}
+	memset(enc, 0, sizeof(PROG_ENC_T));
+
+	enc->buf = (uint8 *)jpegenc_params->stream_virt_buf[0];
+	enc->buf_len = jpegenc_params->stream_buf_len;
+
+	level = (jpegenc_params->quality >= JPEGENC_QUALITY_MAX) ? JPEGENC_QUALITY_HIGH : jpegenc_params->quality;
+	enc->quant_tbl[0] = jpeg_fw_lum_quant_tbl_default[level];
+	enc->quant_tbl[1] = jpeg_fw_chr_quant_tbl_default[level];
+
+	Prog_InitComp(enc, jpegenc_params);
+	for (ci = 0; ci < PROG_COMP_NUM; ci++)
+	{
+		blocks += enc->comp[ci].blocks_w * enc->comp[ci].blocks_h;
+	}
+
+	coef = (int16 *)malloc(blocks * 64 * sizeof(int16));
+	if (PNULL == coef)
+	{
+		SCI_TRACE_LOW("JPEGENC_Progressive_Encode, no memory for %d blocks.", blocks);
+		free(enc);
+		return JPEG_MEMORY_MALLOC_FAILED;
+	}
+	for (ci = 0, blocks = 0; ci < PROG_COMP_NUM; ci++)
+	{
+		enc->comp[ci].coef = coef + blocks * 64;
+		blocks += enc->comp[ci].blocks_w * enc->comp[ci].blocks_h;
+	}
+
+	Prog_TransformFrame(enc, jpegenc_params);
+	Prog_PutHead(enc, jpegenc_params);
+
+	for (i = 0; i < sizeof(s_prog_scan) / sizeof(s_prog_scan[0]); i++)
+	{
+		scan = &s_prog_scan[i];
+
+		//DC refinement has no huffman code
+		if (!(0 == scan->Ss && 0 != scan->Ah))
+		{
+			memset(enc->count, 0, sizeof(enc->count));
+			enc->gather = TRUE;
+			Prog_EncodeScan(enc, scan);
+			enc->gather = FALSE;
+			if (!Prog_PutHuffTbl(enc, (0 == scan->Ss && scan->comps_in_scan > 1) ? PROG_TBL_NUM : 1, (0 == scan->Ss)))
+			{
+				ret = JPEG_FAILED;
+				break;
+			}
+		}
+
+		Prog_PutSOS(enc, scan);
+		Prog_EncodeScan(enc, scan);
+	}
+
+	Prog_EmitMarker(enc, M_EOI);
+
+	if (JPEG_SUCCESS != ret)
+	{
+		SCI_TRACE_LOW("JPEGENC_Progressive_Encode, failed to build the huffman tables.");
+	}else if (enc->overflow)
+	{
+		SCI_TRACE_LOW("JPEGENC_Progressive_Encode, stream buffer %d is too small.", enc->buf_len);
+		ret = JPEG_OUTPUT_BUFFER_OVERFLOW;
+	}else
+	{
+		jpegenc_params->stream_size = enc->pos;
+		SCI_TRACE_LOW("JPEGENC_Progressive_Encode, %dx%d, stream size %d.",
+			jpegenc_params->width, jpegenc_params->height, enc->pos);
+	}
+
+	free(coef);
+	free(enc);
+
+	return ret;
+}
+#endif //JPEG_ENC
+
+/**---------------------------------------------------------------------------*
+**                         Compiler Flag                                      *
+**---------------------------------------------------------------------------*/
+#ifdef   __cplusplus
+    }
+#endif
+/**---------------------------------------------------------------------------*/
+// End
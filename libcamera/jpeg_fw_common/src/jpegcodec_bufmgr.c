@@ -17,7 +17,7 @@
 //#include "jpegcodec_global.h"
 //#include "vsp_drv_sc8800s4.h"
 //#include "video_common.h"		//remove by shan.he
-#include "sc8825_video_header.h"
+#include "jpeg_fw_soc.h"
 
 PUBLIC void JPEG_HWSet_BSM_Buf_ReadOnly(uint8 buf_id)
 {
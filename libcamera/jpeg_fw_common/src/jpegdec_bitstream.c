@@ -15,7 +15,7 @@
 /*----------------------------------------------------------------------------*
 **                        Dependencies                                        *
 **---------------------------------------------------------------------------*/
-#include "sc8810_video_header.h"
+#include "jpeg_fw_soc.h"
 /**---------------------------------------------------------------------------*
 **                        Compiler Flag                                       *
 **---------------------------------------------------------------------------*/
@@ -155,6 +155,10 @@ PUBLIC JPEG_RET_E  JpegDec_InitBitream(JPEG_DEC_INPUT_PARA_T  *jpeg_dec_input)
 
 	s_file_offset = 0;
 
+	//the scans of a progressive stream start from these, not from the last decode
+	s_jstream_words = 0;
+	s_jremain_bit_num = 0;
+
 	if(PNULL != jpeg_dec_input->read_bitstream)
 	{
 		JPEG_CODEC_T *jpeg_fw_codec = Get_JPEGDecCodec();
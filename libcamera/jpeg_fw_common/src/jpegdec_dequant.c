@@ -15,7 +15,7 @@
 /*----------------------------------------------------------------------------*
 **                        Dependencies                                        *
 **---------------------------------------------------------------------------*/
-#include "sc8825_video_header.h"
+#include "jpeg_fw_soc.h"
 
 #if !defined(_SIMULATION_)
 //#include "os_api.h"
@@ -566,7 +566,7 @@ void JpedDec_Update_SOS(uint8 scan_index)
 JPEG_RET_E JPEG_DecodeMCULine_Progressive()
 {
 	uint8 i = 0;
-	uint8 yoffset, xoffset;
+	uint16 yoffset, xoffset;	//MCU_per_row reaches 256 from 2048 pixels wide
 	int16 *block;
 	int16 **org_mcu = NULL;
 	uint16 block_id;
@@ -716,7 +716,10 @@ PUBLIC JPEG_RET_E START_SW_DECODE_PROGRESSIVE(JPEG_CODEC_T *jpeg_fw_codec, uint3
 
 		JPEG_TRACE("MCU_Num_Y:%d\n", y);
 
-		JPEG_DecodeMCULine_Progressive();
+		if(JPEG_DecodeMCULine_Progressive() != JPEG_SUCCESS)
+		{
+			return JPEG_FAILED;
+		}
 
 		for(x = 0; x < mcu_num_x; x++)
 		{
@@ -45,6 +45,20 @@ struct cmr_cap_mem {
 	struct img_frm  isp_tmp;
 };
 
+struct cmr_cap_plan_param {
+	uint32_t        camera_id;
+	uint32_t        orig_fmt;
+	struct img_size sn_size;
+	struct img_rect sn_trim;
+	struct img_size image_size;
+	struct img_size cap_size;
+	struct img_size thum_size;
+	uint32_t        need_rot;
+	uint32_t        thum_from_cap;
+	uint32_t        jpeg_quality;
+	uint32_t        image_cnt;
+};
+
 int camera_capture_buf_size(uint32_t camera_id,
 					uint32_t        sn_fmt,
 								struct img_size *image_size,
@@ -60,6 +74,12 @@ int camera_arrange_capture_buf(struct cmr_cap_2_frm *cap_2_frm,
 						struct cmr_cap_mem *capture_mem,
 						uint32_t need_rot,
 						uint32_t image_cnt);
+int camera_capture_plan_buf_size(struct cmr_cap_plan_param *param,
+						uint32_t *size_major,
+						uint32_t *size_minor);
+int camera_arrange_capture_buf_plan(struct cmr_cap_2_frm *cap_2_frm,
+						struct cmr_cap_plan_param *param,
+						struct cmr_cap_mem *capture_mem);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _CMR_TRACE_H_
+#define _CMR_TRACE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cmr_common.h"
+
+#define CMR_TRACE_PROPERTY                 "persist.sys.camera.trace"
+#define CMR_TRACE_FILE                     "/data/camera_trace.json"
+#define CMR_TRACE_THREAD_MAX               8
+#define CMR_TRACE_RING_SIZE                1024 /* must be power of 2 */
+#define CMR_TRACE_MARK_NUM                 16   /* must be power of 2 */
+
+enum cmr_trace_stage {
+	CMR_TRACE_V4L2_DQ = 0,
+	CMR_TRACE_ISP,
+	CMR_TRACE_SCALE,
+	CMR_TRACE_ROTATE,
+	CMR_TRACE_JPEG_ENC,
+	CMR_TRACE_JPEG_DEC,
+	CMR_TRACE_EXIF,
+	CMR_TRACE_CALLBACK,
+	CMR_TRACE_STAGE_MAX
+};
+
+int cmr_trace_init(void);
+int cmr_trace_deinit(void);
+/* returns 0 when the tracing is off, then cmr_trace_end drops the event */
+uint64_t cmr_trace_begin(void);
+void cmr_trace_end(uint32_t stage, uint32_t id, uint64_t begin);
+/*
+  for the stages started in one thread and completed in another one, the mark
+  and the done of one stage must pass the same frame id
+*/
+void cmr_trace_mark(uint32_t stage, uint32_t id);
+void cmr_trace_done(uint32_t stage, uint32_t id);
+int cmr_trace_dump(const char *file_name);
+void cmr_trace_summary(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //for _CMR_TRACE_H_
@@ -116,7 +116,8 @@ struct jpeg_enc_in_param{
 	uint32_t      temp_buf_vir;	
 	uint32_t      temp_buf_size;  //bytes	
 
-	
+	//1: progressive stream by the software encoder, only in the frame mode
+	uint32_t      is_progressive;
 };
 
 
@@ -147,8 +148,10 @@ struct jpeg_dec_in_param{
 	uint32_t      stream_buf_size;  //bytes
 
 	struct img_size                     size;
-	uint32_t    slice_height;   //slice height must be  8X
+	uint32_t    slice_height;   //slice height must be  8X, in the output lines
 	uint32_t    slice_mod;   //JPEG_YUV_SLICE_MODE
+	uint32_t    scale_down;   //0: 1/1, 1: 1/2, 2: 1/4, 3: 1/8, the EXIF thumbnail is decoded if it is large enough
+	struct img_size                     dst_size;   //what dst holds when scale_down is set, see jpeg_dec_get_out_size
 
 	struct img_addr                     dst_addr_phy;
 	struct img_addr                     dst_addr_vir;
@@ -169,6 +172,7 @@ struct jpeg_dec_in_param{
 struct jpeg_dec_out_param
 {
 	 uint32_t	handle;
+	 struct img_size	out_size;   //as given by jpeg_dec_get_out_size
 };
 
 
@@ -200,6 +204,13 @@ int jpeg_enc_start(struct jpeg_enc_in_param *start_in_parm_ptr, struct jpeg_enc_
 
 int jpeg_enc_next(struct jpeg_enc_next_param *nxt_param_ptr);
 
+/*
+  The scaled decode may give more than (size >> scale_down), the MBC stops at
+  1/4 and a larger EXIF thumbnail can be picked. The caller sizes dst from
+  this before jpeg_dec_start, which fails if the output does not fit dst_size.
+*/
+int jpeg_dec_get_out_size(struct jpeg_dec_in_param *in_parm_ptr, struct img_size *out_size_ptr);
+
 int jpeg_dec_start(struct jpeg_dec_in_param *start_in_parm_ptr, struct jpeg_dec_out_param *start_out_parm_ptr);
 
 int jpeg_dec_next(struct jpeg_dec_next_param *next_param_ptr);
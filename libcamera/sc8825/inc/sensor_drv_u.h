@@ -130,6 +130,8 @@
 #define SENSOR_I2C_REG_8BIT			(0x00 << 1)
 #define SENSOR_I2C_REG_16BIT			(0x01 << 1)
 #define SENSOR_I2C_CUSTOM 			(0x01 << 2)
+/*sub address auto increments, consecutive registers may be written in one burst*/
+#define SENSOR_I2C_BURST_WRITE		(0x01 << 4)
 
 /*I2C ACK/STOP BIT count*/
 #define SNESOR_I2C_ACK_BIT (0x00 << 3)
@@ -526,6 +528,12 @@ typedef struct sensor_reg_tab_tag {
 	uint32_t burst_mode;
 } SENSOR_REG_TAB_T, *SENSOR_REG_TAB_PTR;
 
+/*registers which change by themselves or on write, never skipped by the delta upload*/
+typedef struct sensor_reg_range_tag {
+	uint16_t start;
+	uint16_t end;
+} SENSOR_REG_RANGE_T, *SENSOR_REG_RANGE_T_PTR;
+
 typedef struct sensor_reg_bits_tag {
 	uint16_t reg_addr;
 	uint16_t reg_value;
@@ -660,6 +668,8 @@ typedef struct sensor_info_tag {
 	uint16_t threshold_end;
 	int32_t i2c_dev_handler;
 	SENSOR_INF_T sensor_interface;
+	SENSOR_REG_RANGE_T_PTR volatile_reg_ptr;	/*NULL: the register tables are always uploaded in full*/
+	uint32_t volatile_reg_count;
 } SENSOR_INFO_T;
 
 typedef enum {
@@ -752,8 +762,6 @@ struct i2c_client *Sensor_GetI2CClien(void);
 int Sensor_SetSensorParam(uint8_t *buf);
 int Sensor_GetSensorParam(uint8_t *buf,uint8_t *is_saved_ptr);
 int Sensor_GetRawSettings(void **raw_setting, uint32_t *length);
-int Sensor_SetMark(uint8_t *buf);
-int Sensor_GetMark(uint8_t *buf,uint8_t *is_saved_ptr);
 int _Sensor_Device_WriteRegTab(SENSOR_REG_TAB_PTR reg_tab);
 int Sensor_AutoFocusInit(void);
 
@@ -20,9 +20,11 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <math.h>
+#include <cutils/properties.h>
 #include "SprdOEMCamera.h"
 #include "cmr_oem.h"
 #include "sprd_rot_k.h"
+#include "cmr_trace.h"
 
 struct camera_context        cmr_cxt;
 struct camera_context        *g_cxt = &cmr_cxt;
@@ -41,6 +43,7 @@ struct camera_context        *g_cxt = &cmr_cxt;
 				(g_cxt->cap_orig_size.height == g_cxt->picture_size.height))
 #define NO_SCALING           (YUV_NO_SCALING || RAW_NO_SCALING)
 #define IMAGE_FORMAT		 "YVU420_SEMIPLANAR"
+#define JPEG_PROGRESSIVE_PROPERTY "persist.sys.camera.jpeg.prog"
 
 static void camera_sensor_evt_cb(int evt, void* data);
 static int  camera_isp_evt_cb(int evt, void* data);
@@ -82,6 +85,10 @@ static int  camera_alloc_preview_buf(struct buffer_cfg *buffer, uint32_t format)
 static int  camera_capture_ability(SENSOR_MODE_INFO_T *sn_mode,
 			struct img_frm_cap *img_cap,
 			struct img_size *cap_size);
+static void camera_capture_plan_param(struct cmr_cap_plan_param *param,
+			uint32_t camera_id,
+			uint32_t orig_fmt,
+			struct img_size *image_size);
 static int  camera_alloc_capture_buf0(struct buffer_cfg *buffer, uint32_t cap_index);
 static int  camera_alloc_capture_buf1(struct buffer_cfg *buffer, uint32_t cap_index);
 static int  camera_start_isp_process(struct frm_info *data);
@@ -142,7 +149,6 @@ int camera_sensor_init(int32_t camera_id)
 		goto exit;
 	}
 
-//	camera_set_sensormark();
 	sensor_ret = Sensor_Init(camera_id, &sensor_num);
 	if (SENSOR_SUCCESS != sensor_ret) {
 		CMR_LOGE("No sensor %d", sensor_num);
@@ -202,7 +208,6 @@ sensor_exit:
 	Sensor_Close();
 exit:
 
-	//camera_save_sensormark();
 	return ret;
 }
 
@@ -547,6 +552,7 @@ int camera_init_internal(uint32_t camera_id)
 	int                      ret = CAMERA_SUCCESS;
 
 	CMR_PRINT_TIME;
+	cmr_trace_init();
 	ret = camera_sensor_init(camera_id);
 	if (ret) {
 		CMR_LOGE("Failed to init sensor %d", ret);
@@ -638,6 +644,8 @@ int camera_stop_internal(void)
 
 	camera_sensor_deinit();
 
+	cmr_trace_deinit();
+
 	camera_call_cb(CAMERA_EXIT_CB_DONE,
 			camera_get_client_data(),
 			CAMERA_FUNC_STOP,
@@ -1605,7 +1613,7 @@ void *camera_main_routine(void *client_data)
 			break;
 		}
 
-		CMR_LOGE("message.msg_type 0x%x, sub-type 0x%x",
+		CMR_LOGV("message.msg_type 0x%x, sub-type 0x%x",
 			message.msg_type,
 			message.sub_msg_type);
 		evt = (uint32_t)(message.msg_type & CMR_EVT_MASK_BITS);
@@ -1958,6 +1966,8 @@ int camera_v4l2_handle(uint32_t evt_type, uint32_t sub_type, struct frm_info *da
 		return -CAMERA_INVALID_PARM;
 	}
 
+	cmr_trace_done(CMR_TRACE_V4L2_DQ, data->frame_id);
+
 	if (CMR_IDLE == g_cxt->camera_status || CMR_ERR == g_cxt->camera_status) {
 		CMR_LOGE("Status error, %d", g_cxt->camera_status);
 		return -CAMERA_INVALID_STATE;
@@ -2498,11 +2508,14 @@ void camera_call_cb(camera_cb_type cb,
                  camera_func_type func,
                  int32_t parm4)
 {
+	uint64_t                 trace_begin = cmr_trace_begin();
+
 	pthread_mutex_lock(&g_cxt->cb_mutex);
 	if (g_cxt->camera_cb) {
 		(*g_cxt->camera_cb)(cb, client_data, func, parm4);
 	}
 	pthread_mutex_unlock(&g_cxt->cb_mutex);
+	cmr_trace_end(CMR_TRACE_CALLBACK, (uint32_t)func, trace_begin);
 	return;
 }
 
@@ -2902,6 +2915,8 @@ int camera_capture_ability(SENSOR_MODE_INFO_T *sn_mode,
 	struct img_frm           *rot_frm;
 	struct img_size          sensor_size;
 	struct img_rect          sn_trim_rect;
+	struct cmr_cap_plan_param plan_param;
+	uint32_t                 tab_major = 0, tab_minor = 0;
 
 	img_cap->need_isp = 0;
 	if (SENSOR_IMAGE_FORMAT_YUV422 == sn_mode->image_format) {
@@ -3010,17 +3025,46 @@ int camera_capture_ability(SENSOR_MODE_INFO_T *sn_mode,
 
 	sensor_size.width  = sn_mode->width;
 	sensor_size.height = sn_mode->height;
-	ret = camera_arrange_capture_buf(&g_cxt->cap_2_mems,
-					&sensor_size,
-					&sn_trim_rect,
+	camera_capture_plan_param(&plan_param, g_cxt->sn_cxt.cur_id, g_cxt->cap_original_fmt, &g_cxt->max_size);
+	plan_param.sn_size  = sensor_size;
+	plan_param.sn_trim  = sn_trim_rect;
+	plan_param.cap_size = g_cxt->cap_orig_size;
+	ret = camera_arrange_capture_buf_plan(&g_cxt->cap_2_mems,
+					&plan_param,
+					g_cxt->cap_mem);
+	if (ret) {
+		/*
+		  The frames are only sized for the legacy layout when the size query
+		  fell back to the size table, a plan-sized major frame with no minor
+		  frame would be overrun by it.
+		*/
+		if (camera_capture_buf_size(g_cxt->sn_cxt.cur_id,
+					g_cxt->sn_cxt.sensor_info->image_format,
 					&g_cxt->max_size,
-					g_cxt->cap_original_fmt,
-					&g_cxt->cap_orig_size,
-					&g_cxt->thum_size,
-					g_cxt->cap_mem,
-					(IMG_ROT_0 != g_cxt->cap_rot),
-					1);
-					/*g_cxt->total_cap_num);*/
+					&tab_major,
+					&tab_minor) ||
+			g_cxt->cap_2_mems.major_frm.buf_size < tab_major ||
+			g_cxt->cap_2_mems.minor_frm.buf_size < tab_minor) {
+			CMR_LOGE("Capture frames 0x%x 0x%x fit neither the plan nor the table 0x%x 0x%x",
+				g_cxt->cap_2_mems.major_frm.buf_size,
+				g_cxt->cap_2_mems.minor_frm.buf_size,
+				tab_major,
+				tab_minor);
+			return -CAMERA_NO_MEMORY;
+		}
+		CMR_LOGI("Planned layout unavailable, use the legacy one");
+		ret = camera_arrange_capture_buf(&g_cxt->cap_2_mems,
+						&sensor_size,
+						&sn_trim_rect,
+						&g_cxt->max_size,
+						g_cxt->cap_original_fmt,
+						&g_cxt->cap_orig_size,
+						&g_cxt->thum_size,
+						g_cxt->cap_mem,
+						(IMG_ROT_0 != g_cxt->cap_rot),
+						1);
+						/*g_cxt->total_cap_num);*/
+	}
 
 	if (0 == ret) {
 		if (IMG_ROT_0 != g_cxt->cap_rot) {
@@ -3166,6 +3210,9 @@ int camera_capture_get_buffer_size(uint32_t camera_id,
 						uint32_t *size1)
 {
 	struct img_size          local_size;
+	struct cmr_cap_plan_param plan_param;
+	SENSOR_MODE_INFO_T       *sn_mode;
+	uint32_t                 orig_fmt;
 	int                      ret = CAMERA_SUCCESS;
 
 	if (0 == width || 0 == height) {
@@ -3175,15 +3222,53 @@ int camera_capture_get_buffer_size(uint32_t camera_id,
 	local_size.width  = width;
 	local_size.height = height;
 
-	ret = camera_capture_buf_size(camera_id,
-					g_cxt->sn_cxt.sensor_info->image_format,
-					&local_size,
-					size0,
-					size1);
+	sn_mode = &g_cxt->sn_cxt.sensor_info->sensor_mode_info[g_cxt->sn_cxt.capture_mode];
+	if (SENSOR_IMAGE_FORMAT_RAW == sn_mode->image_format) {
+		orig_fmt = IMG_DATA_TYPE_RAW;
+	} else if (SENSOR_IMAGE_FORMAT_JPEG == sn_mode->image_format) {
+		orig_fmt = IMG_DATA_TYPE_JPEG;
+	} else {
+		orig_fmt = IMG_DATA_TYPE_YUV420;
+	}
+
+	camera_capture_plan_param(&plan_param, camera_id, orig_fmt, &local_size);
+	ret = camera_capture_plan_buf_size(&plan_param, size0, size1);
+	if (ret) {
+		CMR_LOGI("Failed to plan capture buffer, use the size table");
+		ret = camera_capture_buf_size(camera_id,
+						g_cxt->sn_cxt.sensor_info->image_format,
+						&local_size,
+						size0,
+						size1);
+	}
 
 	return ret;
 }
 
+/*
+  The parameters of the capture memory plan. The size query before the shot
+  plans for the largest rotation, thumbnail and quality setting, the buffers are
+  arranged with the settings of the shot. The thumbnail is assumed to come from
+  the capture channel since it is not known until the capture is configured.
+*/
+static void camera_capture_plan_param(struct cmr_cap_plan_param *param,
+					uint32_t camera_id,
+					uint32_t orig_fmt,
+					struct img_size *image_size)
+{
+	bzero(param, sizeof(struct cmr_cap_plan_param));
+	param->camera_id     = camera_id;
+	param->orig_fmt      = orig_fmt;
+	param->sn_size       = *image_size;
+	param->image_size    = *image_size;
+	param->cap_size      = *image_size;
+	param->thum_size     = g_cxt->thum_size;
+	param->need_rot      = (IMG_ROT_0 != g_cxt->cap_rot);
+	param->thum_from_cap = 1;
+	param->jpeg_quality  = g_cxt->jpeg_cxt.quality;
+	param->image_cnt     = 1;
+}
+
 int camerea_set_preview_format(uint32_t pre_format)
 {
 	if (IS_PREVIEW)	{
@@ -3609,6 +3694,7 @@ int camera_start_isp_process(struct frm_info *data)
 			&g_cxt->cap_mem[frm_id].cap_raw.addr_vir);
 #endif
 
+	cmr_trace_mark(CMR_TRACE_ISP, data->frame_id);
 	ret = isp_proc_start(&ips_in, &ips_out);
 	if (0 == ret) {
 		CMR_LOGV("ISP post-process started");
@@ -3680,6 +3766,8 @@ int camera_start_jpeg_decode(struct frm_info *data)
 	dec_in.temp_buf_vir         = g_cxt->cap_mem[frm_id].jpeg_tmp.addr_vir.addr_y;
 	dec_in.temp_buf_size        = g_cxt->cap_mem[frm_id].jpeg_tmp.buf_size;
 	dec_in.slice_mod 			= JPEG_YUV_SLICE_ONE_BUF;
+	dec_in.scale_down           = 0;
+	dec_in.dst_size             = dec_in.size;
 	ret = jpeg_dec_start(&dec_in, &dec_out);
 	if (0 == ret) {
 		CMR_LOGV("OK, handle 0x%x", dec_out.handle);
@@ -3772,6 +3860,7 @@ int camera_start_jpeg_encode(struct frm_info *data)
 	int                      ret = CAMERA_SUCCESS;
 	struct jpeg_enc_in_param  in_parm;
 	struct jpeg_enc_out_param    out_parm;
+	char                     value[PROPERTY_VALUE_MAX];
 
 	if (camera_capture_need_exit()) {
 		ret = CAMERA_INVALID_STATE;
@@ -3829,6 +3918,9 @@ int camera_start_jpeg_encode(struct frm_info *data)
 	in_parm.temp_buf_phy         = tmp_frm->addr_phy.addr_y;
 	in_parm.temp_buf_vir         = tmp_frm->addr_vir.addr_y;
 	in_parm.temp_buf_size        = tmp_frm->buf_size;
+	property_get(JPEG_PROGRESSIVE_PROPERTY, value, "0");
+	/*the thumbnail in the EXIF is always baseline*/
+	in_parm.is_progressive       = (0 == data->channel_id) ? (uint32_t)atoi(value) : 0;
 
 	CMR_LOGI("w h, %d %d, quality level %d", in_parm.size.width, in_parm.size.height,
 		in_parm.quality_level);
@@ -4361,6 +4453,7 @@ static int camera_jpeg_encode_thumb(uint32_t *stream_size_ptr)
 	in_parm.size.width = g_cxt->thum_size.width;
 	in_parm.size.height = g_cxt->thum_size.height;
 	in_parm.stream_buf_size = target_frm->buf_size;
+	in_parm.is_progressive = 0;
 	ret = jpeg_enc_thumbnail(&in_parm, &sream_size);
 	*stream_size_ptr = sream_size;
 	CMR_LOGI("encode thumbnail return %d,stream size %d.",ret,sream_size);
@@ -4459,6 +4552,7 @@ int camera_isp_proc_handle(struct ips_out_param *isp_out)
 	struct jpeg_enc_next_param enc_nxt_param;
 	int                        ret = CAMERA_SUCCESS;
 
+	cmr_trace_done(CMR_TRACE_ISP, process->frame_info.frame_id);
 	CMR_LOGV("total processed height %d", process->slice_height_out);
 
 #if 0
@@ -4544,6 +4638,7 @@ int camera_isp_proc_handle(struct ips_out_param *isp_out)
 		in_param.dst_addr_phy.chn0,
 		in_param.dst_addr_phy.chn1);
 
+	cmr_trace_mark(CMR_TRACE_ISP, process->frame_info.frame_id);
 	ret = isp_proc_next(&in_param, &out_param);
 
 	return ret;
@@ -24,6 +24,7 @@
 #include "img_scale_u.h"
 #include "cmr_cvt.h"
 #include "sprd_rot_k.h"
+#include "cmr_trace.h"
 
 #define CVT_EXIT_IF_ERR(n)                                             \
 		do {                                                   \
@@ -212,6 +213,8 @@ int cmr_rot(enum img_rot_angle  angle,
 		return -EINVAL;
 	}
 
+	/* the driver rotates one image at a time */
+	cmr_trace_mark(CMR_TRACE_ROTATE, 0);
 	ret = ioctl(rot_fd, ROT_IO_START, 1);
 	pthread_mutex_lock(&rot_status_mutex);
 	rot_running = 1;
@@ -394,6 +397,7 @@ static void* cmr_rot_thread_proc(void* data)
 			break;
 		} else {
 			CMR_LOGV("rot done OK. 0x%x", rot_evt_cb);
+			cmr_trace_done(CMR_TRACE_ROTATE, 0);
 			frame.reserved = rot_user_data;
 			evt_id = CMR_IMG_CVT_ROT_DONE;
 			pthread_mutex_lock(&rot_cb_mutex);
@@ -680,6 +684,7 @@ int  cmr_scale_start(uint32_t slice_height,
 	CVT_EXIT_IF_ERR(ret);
 
 	if (sc_cxt->is_started) {
+		cmr_trace_mark(CMR_TRACE_SCALE, 0);
 		ret = ioctl(scaler_fd, SCALE_IO_START, NULL);
 		CVT_EXIT_IF_ERR(ret);
 		pthread_mutex_lock(&scaler_cb_mutex);
@@ -852,6 +857,7 @@ int  cmr_scale_next(uint32_t     slice_height,
 			dst_addr.addr_u,
 			sc_cxt->tmp_slice.addr_vir.addr_y,
 			sc_cxt->tmp_slice.addr_vir.addr_u);
+		cmr_trace_mark(CMR_TRACE_SCALE, 0);
 		ret = ioctl(scaler_fd, SCALE_IO_CONTINUE, NULL);
 		sc_cxt->total_height += sc_cxt->slice_height;
 	}
@@ -980,6 +986,8 @@ static void* cmr_scale_thread_proc(void* data)
 			CMR_LOGV("To exit scaler thread");
 			break;
 		} else {
+			/* one scaling runs at a time, slice by slice */
+			cmr_trace_done(CMR_TRACE_SCALE, 0);
 			pthread_mutex_lock(&scaler_cb_mutex);
 			if (NULL == scaler_evt_cb) {
 				pthread_cond_signal(&scaler_cond);
@@ -64,6 +64,58 @@ enum {
 };
 
 
+/*
+  Stages of one shot, used by the capture planner to describe buffer lifetimes.
+  ISP, scaling and the main JPEG encode work slice by slice and may interleave,
+  so a buffer used by any of them is kept live over all of them.
+*/
+enum {
+	CAP_STAGE_SNAPSHOT = 0,
+	CAP_STAGE_ISP,
+	CAP_STAGE_SCALE,
+	CAP_STAGE_ROTATE,
+	CAP_STAGE_ENCODE,
+	CAP_STAGE_THUMB,
+	CAP_STAGE_EXIF,
+	CAP_STAGE_NUM
+};
+
+#define CAP_LIVE_SPAN(a, b)       (uint32_t)(((1 << ((b) + 1)) - 1) & ~((1 << (a)) - 1))
+#define CAP_LIVE_ALL              CAP_LIVE_SPAN(CAP_STAGE_SNAPSHOT, CAP_STAGE_EXIF)
+#define CAP_PLAN_ALIGN(a)         (((a) + 255) & (~255))
+#define CAP_JPEG_QUALITY_LOW      60
+#define CAP_JPEG_QUALITY_MID      80
+#define CAP_THUM_WIDTH_MAX        640  /* the largest thumbnail the size query makes room for */
+#define CAP_THUM_HEIGHT_MAX       480
+
+enum {
+	CAP_PLAN_YUV = 0,  /* target_yuv Y, cap_yuv and cap_raw, processed in place */
+	CAP_PLAN_UV,       /* target_yuv/cap_yuv UV, only used by RawRGB sensor */
+	CAP_PLAN_JPEG,     /* EXIF header, then target_jpeg */
+	CAP_PLAN_THUM_YUV,
+	CAP_PLAN_THUM_JPEG,
+	CAP_PLAN_JPEG_TMP,
+	CAP_PLAN_SCALE_TMP,
+	CAP_PLAN_ROT,
+	CAP_PLAN_ISP_TMP,
+	CAP_PLAN_FIXED_NUM
+};
+
+/* every additional image of a burst takes one YUV and one UV block */
+#define CAP_PLAN_BUF_MAX          (CAP_PLAN_FIXED_NUM + 2 * (CMR_IMG_CNT_MAX - 1))
+
+struct cap_plan_buf {
+	uint32_t    size;
+	uint32_t    live;
+	uint32_t    offset;
+};
+
+struct cap_plan {
+	uint32_t            buf_num;
+	uint32_t            total;
+	struct cap_plan_buf buf[CAP_PLAN_BUF_MAX];
+};
+
 typedef uint32_t (*cmr_get_size)(uint32_t width, uint32_t height, uint32_t thum_width, uint32_t thum_height);
 
 struct cap_size_to_mem {
@@ -157,6 +209,11 @@ static uint32_t get_jpg_tmp_size(uint32_t width, uint32_t height, uint32_t thum_
 static uint32_t get_scaler_tmp_size(uint32_t width, uint32_t height, uint32_t thum_width, uint32_t thum_height);
 static uint32_t get_isp_tmp_size(uint32_t width, uint32_t height, uint32_t thum_width, uint32_t thum_height);
 
+static uint32_t cap_plan_jpeg_size(uint32_t width, uint32_t height, uint32_t quality);
+static int cap_plan_build(struct cmr_cap_plan_param *param, struct cap_plan *plan);
+static int cap_plan_place(struct cap_plan *plan);
+static int cap_plan_check(struct cap_plan *plan);
+
 static const cmr_get_size get_size[BUF_TYPE_NUM] = {
 	get_jpeg_size,
 	get_thum_yuv_size,
@@ -701,6 +758,414 @@ int camera_arrange_capture_buf(struct cmr_cap_2_frm *cap_2_frm,
 	return 0;
 }
 
+int camera_capture_plan_buf_size(struct cmr_cap_plan_param *param,
+					uint32_t *size_major,
+					uint32_t *size_minor)
+{
+	struct cmr_cap_plan_param worst;
+	struct cap_plan        plan;
+	uint32_t               tab_major = 0, tab_minor = 0;
+	uint32_t               sn_fmt;
+	int                    ret = 0;
+
+	if (NULL == param || NULL == size_major || NULL == size_minor) {
+		CMR_LOGE("Parameter error 0x%x 0x%x 0x%x",
+			(uint32_t)param,
+			(uint32_t)size_major,
+			(uint32_t)size_minor);
+		return -1;
+	}
+
+	/*
+	  Rotation, thumbnail and quality may still change before the shot, so the
+	  size is planned for their largest setting and the plan arranged with the
+	  real ones at the shot always fits.
+	*/
+	worst = *param;
+	worst.need_rot         = 1;
+	worst.jpeg_quality     = 0;
+	worst.thum_size.width  = MAX(worst.thum_size.width, CAP_THUM_WIDTH_MAX);
+	worst.thum_size.height = MAX(worst.thum_size.height, CAP_THUM_HEIGHT_MAX);
+
+	ret = cap_plan_build(&worst, &plan);
+	if (ret)
+		return ret;
+
+	ret = cap_plan_place(&plan);
+	if (ret)
+		return ret;
+
+	*size_major = plan.total;
+	*size_minor = 0;
+
+	sn_fmt = (IMG_DATA_TYPE_RAW == param->orig_fmt) ? SENSOR_IMAGE_FORMAT_RAW : SENSOR_IMAGE_FORMAT_YUV422;
+	if (0 == camera_capture_buf_size(param->camera_id,
+					sn_fmt,
+					&param->image_size,
+					&tab_major,
+					&tab_minor)) {
+		CMR_LOGI("plan 0x%x, table 0x%x 0x%x, saved 0x%x",
+			plan.total,
+			tab_major,
+			tab_minor,
+			(tab_major + tab_minor) > plan.total ? (tab_major + tab_minor - plan.total) : 0);
+	}
+
+	return 0;
+}
+
+int camera_arrange_capture_buf_plan(struct cmr_cap_2_frm *cap_2_frm,
+					struct cmr_cap_plan_param *param,
+					struct cmr_cap_mem *capture_mem)
+{
+	struct cap_plan        plan;
+	struct cmr_cap_mem     *cap_mem;
+	struct img_frm         *frm;
+	uint32_t               phy_base, vir_base;
+	uint32_t               channel_size, raw_size = 0, y_to_raw = 0, yy_to_y = 0;
+	uint32_t               uv_size, useless_raw = 0, tmp, i;
+	uint32_t               y_off, uv_off;
+	int                    ret = 0;
+
+	if (NULL == cap_2_frm || NULL == param || NULL == capture_mem) {
+		CMR_LOGE("Parameter error 0x%x 0x%x 0x%x",
+			(uint32_t)cap_2_frm,
+			(uint32_t)param,
+			(uint32_t)capture_mem);
+		return -1;
+	}
+
+	ret = cap_plan_build(param, &plan);
+	if (ret)
+		return ret;
+
+	ret = cap_plan_place(&plan);
+	if (ret)
+		return ret;
+
+	if (plan.total > cap_2_frm->major_frm.buf_size) {
+		CMR_LOGI("plan 0x%x does not fit in major frame 0x%x",
+			plan.total,
+			cap_2_frm->major_frm.buf_size);
+		return -1;
+	}
+
+	/* the in-place RawRGB/YUV geometry, same as camera_arrange_capture_buf */
+	if (IMG_DATA_TYPE_RAW == param->orig_fmt) {
+		channel_size = (uint32_t)(param->sn_size.width * param->sn_size.height);
+		raw_size = (uint32_t)(channel_size * RAWRGB_BIT_WIDTH / 8);
+		y_to_raw = (uint32_t)(ISP_YUV_TO_RAW_GAP * param->sn_size.width);
+		if (param->image_size.width != param->sn_size.width ||
+			param->image_size.height != param->sn_size.height) {
+			yy_to_y = (uint32_t)(ISP_YUV_TO_RAW_GAP * param->sn_size.width);
+		} else if (param->sn_trim.start_y) {
+			tmp = param->sn_size.height - param->sn_trim.height - param->sn_trim.start_y;
+			yy_to_y = (uint32_t)(tmp * param->sn_size.width);
+		}
+		useless_raw = (uint32_t)(yy_to_y * RAWRGB_BIT_WIDTH / 8);
+		uv_size = (channel_size >> 1) + (yy_to_y >> 1);
+		CMR_NO_MEM(raw_size + y_to_raw + yy_to_y - useless_raw, plan.buf[CAP_PLAN_YUV].size);
+		CMR_NO_MEM(uv_size, plan.buf[CAP_PLAN_UV].size);
+	} else {
+		channel_size = (uint32_t)(param->image_size.width * param->image_size.height);
+		tmp = (uint32_t)(param->cap_size.width * param->cap_size.height);
+		yy_to_y = channel_size - tmp;
+	}
+
+	memset((void*)capture_mem, 0, sizeof(struct cmr_cap_mem) * param->image_cnt);
+	phy_base = cap_2_frm->major_frm.addr_phy.addr_y;
+	vir_base = cap_2_frm->major_frm.addr_vir.addr_y;
+
+	for (i = 0; i < param->image_cnt; i++) {
+		cap_mem = &capture_mem[i];
+		if (0 == i) {
+			y_off = plan.buf[CAP_PLAN_YUV].offset;
+			uv_off = plan.buf[CAP_PLAN_UV].offset;
+		} else {
+			y_off = plan.buf[CAP_PLAN_FIXED_NUM + 2 * (i - 1)].offset;
+			uv_off = plan.buf[CAP_PLAN_FIXED_NUM + 2 * (i - 1) + 1].offset;
+		}
+		if (IMG_DATA_TYPE_RAW != param->orig_fmt) {
+			uv_off = y_off + channel_size;
+		}
+
+		cap_mem->target_yuv.addr_phy.addr_y = phy_base + y_off;
+		cap_mem->target_yuv.addr_vir.addr_y = vir_base + y_off;
+		cap_mem->target_yuv.addr_phy.addr_u = phy_base + uv_off;
+		cap_mem->target_yuv.addr_vir.addr_u = vir_base + uv_off;
+		cap_mem->target_yuv.buf_size        = (channel_size * 3) >> 1;
+		cap_mem->target_yuv.size.width      = param->image_size.width;
+		cap_mem->target_yuv.size.height     = param->image_size.height;
+		cap_mem->target_yuv.fmt             = IMG_DATA_TYPE_YUV420;
+
+		cap_mem->cap_yuv.addr_phy.addr_y = cap_mem->target_yuv.addr_phy.addr_y + yy_to_y;
+		cap_mem->cap_yuv.addr_vir.addr_y = cap_mem->target_yuv.addr_vir.addr_y + yy_to_y;
+		cap_mem->cap_yuv.addr_phy.addr_u = cap_mem->target_yuv.addr_phy.addr_u + (yy_to_y >> 1);
+		cap_mem->cap_yuv.addr_vir.addr_u = cap_mem->target_yuv.addr_vir.addr_u + (yy_to_y >> 1);
+		cap_mem->cap_yuv.buf_size        = (channel_size * 3) >> 1;
+		cap_mem->cap_yuv.fmt             = IMG_DATA_TYPE_YUV420;
+
+		if (IMG_DATA_TYPE_RAW == param->orig_fmt) {
+			cap_mem->cap_yuv.size.width  = param->sn_size.width;
+			cap_mem->cap_yuv.size.height = param->sn_size.height;
+			cap_mem->cap_raw.addr_phy.addr_y = cap_mem->cap_yuv.addr_phy.addr_y + y_to_raw;
+			cap_mem->cap_raw.addr_vir.addr_y = cap_mem->cap_yuv.addr_vir.addr_y + y_to_raw;
+		} else {
+			cap_mem->cap_yuv.size.width  = param->cap_size.width;
+			cap_mem->cap_yuv.size.height = param->cap_size.height;
+			if (i) {
+				cap_mem->cap_raw.addr_phy.addr_y = cap_mem->cap_yuv.addr_phy.addr_y;
+				cap_mem->cap_raw.addr_vir.addr_y = cap_mem->cap_yuv.addr_vir.addr_y;
+			}
+		}
+		cap_mem->cap_raw.buf_size        = raw_size;
+		cap_mem->cap_raw.size.width      = param->sn_size.width;
+		cap_mem->cap_raw.size.height     = param->sn_size.height;
+		cap_mem->cap_raw.fmt             = IMG_DATA_TYPE_RAW;
+	}
+
+	/* camera_jpeg_encode_done writes the EXIF header just before target_jpeg */
+	cap_mem = &capture_mem[0];
+	frm = &cap_mem->target_jpeg;
+	frm->buf_size = plan.buf[CAP_PLAN_JPEG].size - JPEG_EXIF_SIZE;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_JPEG].offset + JPEG_EXIF_SIZE;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_JPEG].offset + JPEG_EXIF_SIZE;
+
+	frm = &cap_mem->thum_yuv;
+	frm->buf_size = plan.buf[CAP_PLAN_THUM_YUV].size;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_THUM_YUV].offset;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_THUM_YUV].offset;
+	frm->addr_phy.addr_u = frm->addr_phy.addr_y + frm->buf_size * 2 / 3;
+	frm->addr_vir.addr_u = frm->addr_vir.addr_y + frm->buf_size * 2 / 3;
+	frm->size.width      = param->thum_size.width;
+	frm->size.height     = param->thum_size.height;
+
+	frm = &cap_mem->thum_jpeg;
+	frm->buf_size = plan.buf[CAP_PLAN_THUM_JPEG].size;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_THUM_JPEG].offset;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_THUM_JPEG].offset;
+
+	frm = &cap_mem->jpeg_tmp;
+	frm->buf_size = plan.buf[CAP_PLAN_JPEG_TMP].size;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_JPEG_TMP].offset;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_JPEG_TMP].offset;
+
+	frm = &cap_mem->scale_tmp;
+	frm->buf_size = plan.buf[CAP_PLAN_SCALE_TMP].size;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_SCALE_TMP].offset;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_SCALE_TMP].offset;
+
+#if CMR_ISP_YUV422
+	frm = &cap_mem->isp_tmp;
+	frm->buf_size = plan.buf[CAP_PLAN_ISP_TMP].size;
+	frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_ISP_TMP].offset;
+	frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_ISP_TMP].offset;
+#endif
+
+	if (param->need_rot) {
+		frm = &cap_mem->cap_yuv_rot;
+		frm->buf_size = plan.buf[CAP_PLAN_ROT].size;
+		frm->addr_phy.addr_y = phy_base + plan.buf[CAP_PLAN_ROT].offset;
+		frm->addr_vir.addr_y = vir_base + plan.buf[CAP_PLAN_ROT].offset;
+		frm->addr_phy.addr_u = frm->addr_phy.addr_y + channel_size;
+		frm->addr_vir.addr_u = frm->addr_vir.addr_y + channel_size;
+		frm->size.width      = param->image_size.height;
+		frm->size.height     = param->image_size.width;
+		frm->fmt             = IMG_DATA_TYPE_YUV420;
+	}
+
+	for (i = 0; i < plan.buf_num; i++) {
+		CMR_LOGV("plan buf %d, offset 0x%x size 0x%x live 0x%x",
+			i,
+			plan.buf[i].offset,
+			plan.buf[i].size,
+			plan.buf[i].live);
+	}
+	CMR_LOGI("plan total 0x%x, major frame 0x%x", plan.total, cap_2_frm->major_frm.buf_size);
+
+	return 0;
+}
+
+static uint32_t cap_plan_jpeg_size(uint32_t width, uint32_t height, uint32_t quality)
+{
+	uint32_t       factor = CMR_JPEG_COMPRESS_FACTOR;
+	uint32_t       size;
+
+	/* quality 0 means not set yet, keep the legacy estimation */
+	if (quality && quality <= CAP_JPEG_QUALITY_LOW) {
+		factor = CMR_JPEG_COMPRESS_FACTOR << 1;
+	} else if (quality && quality <= CAP_JPEG_QUALITY_MID) {
+		factor = CMR_JPEG_COMPRESS_FACTOR + 1;
+	}
+
+	size = (uint32_t)(width * height / factor) + JPEG_EXIF_SIZE;
+
+	return ADDR_BY_WORD(size);
+}
+
+static int cap_plan_build(struct cmr_cap_plan_param *param, struct cap_plan *plan)
+{
+	struct cap_plan_buf    *buf;
+	uint32_t               width, height, thum_w, thum_h;
+	uint32_t               channel_size, yy_to_y, i;
+
+	if (0 == param->image_cnt || param->image_cnt > CMR_IMG_CNT_MAX ||
+		0 == param->image_size.width || 0 == param->image_size.height) {
+		CMR_LOGE("Parameter error %d %d %d",
+			param->image_cnt,
+			param->image_size.width,
+			param->image_size.height);
+		return -1;
+	}
+
+	memset((void*)plan, 0, sizeof(struct cap_plan));
+	buf = &plan->buf[0];
+	width = param->image_size.width;
+	height = param->image_size.height;
+	thum_w = param->thum_size.width;
+	thum_h = param->thum_size.height;
+	channel_size = width * height;
+
+	/*
+	  The blocks are sized from image_size which is never smaller than the sensor
+	  mode, so the plan doesn't depend on the zoom trim and the size reported
+	  before the shot always holds the layout arranged at the shot.
+	*/
+	if (IMG_DATA_TYPE_RAW == param->orig_fmt) {
+		yy_to_y = MAX(ISP_YUV_TO_RAW_GAP, (height - height / CMR_ZOOM_FACTOR) >> 1) * width;
+		buf[CAP_PLAN_YUV].size = ADDR_BY_WORD(channel_size * RAWRGB_BIT_WIDTH / 8 +
+						ISP_YUV_TO_RAW_GAP * width);
+		buf[CAP_PLAN_UV].size  = ADDR_BY_WORD((channel_size >> 1) + (yy_to_y >> 1));
+	} else {
+		buf[CAP_PLAN_YUV].size = ADDR_BY_WORD((channel_size * 3) >> 1);
+		buf[CAP_PLAN_UV].size  = 0;
+	}
+	buf[CAP_PLAN_YUV].live = CAP_LIVE_ALL;
+	buf[CAP_PLAN_UV].live  = CAP_LIVE_ALL;
+
+	/*
+	  The EXIF header is written in front of the stream, so it is reserved at the
+	  head of the block, the stream itself keeps the legacy target_jpeg size.
+	*/
+	buf[CAP_PLAN_JPEG].size = JPEG_EXIF_SIZE + cap_plan_jpeg_size(width, height, param->jpeg_quality);
+	if (IMG_DATA_TYPE_JPEG == param->orig_fmt) {
+		/* the sensor writes JPEG stream which is decoded at the scaling stage */
+		buf[CAP_PLAN_JPEG].live = CAP_LIVE_ALL;
+	} else {
+		buf[CAP_PLAN_JPEG].live = CAP_LIVE_SPAN(CAP_STAGE_SCALE, CAP_STAGE_EXIF);
+	}
+
+	buf[CAP_PLAN_THUM_YUV].size = get_thum_yuv_size(width, height, thum_w, thum_h);
+	if (param->thum_from_cap) {
+		buf[CAP_PLAN_THUM_YUV].live = CAP_LIVE_SPAN(CAP_STAGE_SNAPSHOT, CAP_STAGE_THUMB);
+	} else {
+		buf[CAP_PLAN_THUM_YUV].live = CAP_LIVE_SPAN(CAP_STAGE_SCALE, CAP_STAGE_THUMB);
+	}
+
+	buf[CAP_PLAN_THUM_JPEG].size = get_thum_jpeg_size(width, height, thum_w, thum_h);
+	buf[CAP_PLAN_THUM_JPEG].live = CAP_LIVE_SPAN(CAP_STAGE_THUMB, CAP_STAGE_EXIF);
+
+	buf[CAP_PLAN_JPEG_TMP].size = get_jpg_tmp_size(width, height, thum_w, thum_h);
+	buf[CAP_PLAN_JPEG_TMP].live = CAP_LIVE_SPAN(CAP_STAGE_SCALE, CAP_STAGE_THUMB);
+
+	buf[CAP_PLAN_SCALE_TMP].size = get_scaler_tmp_size(width, height, thum_w, thum_h);
+	buf[CAP_PLAN_SCALE_TMP].live = CAP_LIVE_SPAN(CAP_STAGE_ISP, CAP_STAGE_THUMB);
+
+	if (param->need_rot) {
+		buf[CAP_PLAN_ROT].size = ADDR_BY_WORD((channel_size * 3) >> 1);
+		buf[CAP_PLAN_ROT].live = CAP_LIVE_SPAN(CAP_STAGE_ROTATE, CAP_STAGE_ENCODE);
+	}
+
+#if CMR_ISP_YUV422
+	if (IMG_DATA_TYPE_RAW == param->orig_fmt) {
+		buf[CAP_PLAN_ISP_TMP].size = get_isp_tmp_size(width, height, thum_w, thum_h);
+		buf[CAP_PLAN_ISP_TMP].live = CAP_LIVE_SPAN(CAP_STAGE_ISP, CAP_STAGE_ENCODE);
+	}
+#endif
+
+	plan->buf_num = CAP_PLAN_FIXED_NUM;
+	for (i = 1; i < param->image_cnt; i++) {
+		buf[plan->buf_num] = buf[CAP_PLAN_YUV];
+		buf[plan->buf_num + 1] = buf[CAP_PLAN_UV];
+		plan->buf_num += 2;
+	}
+
+	return 0;
+}
+
+/*
+  Greedy offset assignment, the largest block first. Each block takes the lowest
+  offset which doesn't collide with a placed block whose lifetime overlaps it,
+  so blocks never live at the same time share the same memory.
+*/
+static int cap_plan_place(struct cap_plan *plan)
+{
+	struct cap_plan_buf    *buf = &plan->buf[0];
+	struct cap_plan_buf    *cur, *pl;
+	uint32_t               order[CAP_PLAN_BUF_MAX];
+	uint32_t               i, j, tmp, offset, moved;
+
+	for (i = 0; i < plan->buf_num; i++) {
+		order[i] = i;
+	}
+	for (i = 1; i < plan->buf_num; i++) {
+		tmp = order[i];
+		for (j = i; j > 0 && buf[order[j - 1]].size < buf[tmp].size; j--) {
+			order[j] = order[j - 1];
+		}
+		order[j] = tmp;
+	}
+
+	plan->total = 0;
+	for (i = 0; i < plan->buf_num; i++) {
+		cur = &buf[order[i]];
+		offset = 0;
+		if (0 == cur->size) {
+			cur->offset = 0;
+			continue;
+		}
+		do {
+			moved = 0;
+			for (j = 0; j < i; j++) {
+				pl = &buf[order[j]];
+				if (0 == pl->size || 0 == (pl->live & cur->live))
+					continue;
+				if (offset < pl->offset + pl->size && pl->offset < offset + cur->size) {
+					offset = CAP_PLAN_ALIGN(pl->offset + pl->size);
+					moved = 1;
+				}
+			}
+		} while (moved);
+		cur->offset = offset;
+		plan->total = MAX(plan->total, offset + cur->size);
+	}
+
+	return cap_plan_check(plan);
+}
+
+static int cap_plan_check(struct cap_plan *plan)
+{
+	struct cap_plan_buf    *a, *b;
+	uint32_t               i, j;
+
+	for (i = 0; i < plan->buf_num; i++) {
+		a = &plan->buf[i];
+		if (0 == a->size)
+			continue;
+		for (j = i + 1; j < plan->buf_num; j++) {
+			b = &plan->buf[j];
+			if (0 == b->size || 0 == (a->live & b->live))
+				continue;
+			if (a->offset < b->offset + b->size && b->offset < a->offset + a->size) {
+				CMR_LOGE("live buffers overlap, %d 0x%x 0x%x, %d 0x%x 0x%x",
+					i, a->offset, a->size, j, b->offset, b->size);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
 
 uint32_t get_jpeg_size(uint32_t width, uint32_t height, uint32_t thum_width, uint32_t thum_height)
 {
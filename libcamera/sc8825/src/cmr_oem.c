@@ -20,9 +20,6 @@
 #include "dc_cfg.h"
 #include "sensor_drv_u.h"
 
-#define SENSOR_PARAM_NUM  8
-#define SENSOR_PARA	  "/data/misc/sensors/sensor.file"
-
 static camera_position_type  s_position;
 
 const char image_desc[] = "Exif_JPEG_420";
@@ -600,66 +597,3 @@ void camera_sensor_inf(struct sensor_if *cam_inf_ptr, SENSOR_INF_T *inf_ptr)
 	return;
 
 }
-
-int camera_set_sensormark(void)
-{
-	FILE                     *fp;
-	uint32_t                 i = 0;
-	uint32_t                 len = 0;
-	uint8_t                  sensor_param[SENSOR_PARAM_NUM];
-	int                      ret = CAMERA_SUCCESS;
-
-	bzero(&sensor_param[0], sizeof(sensor_param));
-	fp = fopen(SENSOR_PARA, "rb+");
-	if (NULL == fp) {
-		fp = fopen(SENSOR_PARA,"wb+");
-		if (NULL == fp) {
-			CMR_LOGE("open file error: %s",SENSOR_PARA);
-		}
-		memset(&sensor_param[0], 0xFF, SENSOR_PARAM_NUM);
-	}
-
-	if(NULL != fp) {
-		len = fread(sensor_param, 1, SENSOR_PARAM_NUM, fp);
-		CMR_LOGV(":param len %d", len);
-		CMR_LOGV("sensor param: %d, %d, %d, %d, %d, %d, %d, %d",
-			sensor_param[0], sensor_param[1], sensor_param[2], sensor_param[3],
-			sensor_param[4], sensor_param[5], sensor_param[6], sensor_param[7]);
-	}
-
-	fclose(fp);
-	Sensor_SetMark(sensor_param);
-
-	return CAMERA_SUCCESS;
-}
-
-int camera_save_sensormark(void)
-{
-	FILE                     *fp;
-	uint32_t                 i = 0;
-	uint8_t                  is_saving= 0;
-	uint8_t                  sensor_param[SENSOR_PARAM_NUM];
-	int                      ret = CAMERA_SUCCESS;
-
-	memset(&sensor_param[0], 0, SENSOR_PARAM_NUM);
-
-	Sensor_GetMark(sensor_param, &is_saving);
-
-	if (is_saving) {
-		fp = fopen(SENSOR_PARA,"wb+");
-		if (NULL != fp) {
-			fwrite(sensor_param, 1, SENSOR_PARAM_NUM, fp);
-			CMR_LOGV("sensor param: %d, %d, %d, %d, %d, %d, %d, %d",
-				sensor_param[0], sensor_param[1], sensor_param[2], sensor_param[3],
-				sensor_param[4], sensor_param[5], sensor_param[6], sensor_param[7]);
-
-		} else {
-			CMR_LOGE("can not create SENSOR_PARA");
-		}
-		fclose(fp);
-	}
-
-	return ret;
-}
-
-
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cutils/properties.h>
+#include "cmr_trace.h"
+
+/*
+  Every thread which records events owns one ring, only the owner advances
+  the write index so recording needs neither lock nor atomic RMW. The rings
+  are read when the camera is closed, the oldest events of a ring being
+  written at that moment may be torn.
+*/
+#define CMR_TRACE_RING_MASK               (CMR_TRACE_RING_SIZE - 1)
+#define CMR_TRACE_MARK_MASK               (CMR_TRACE_MARK_NUM - 1)
+#define CMR_TRACE_NS_TO_US(t)             ((t) / 1000)
+
+struct cmr_trace_evt {
+	uint64_t                 begin;
+	uint32_t                 dur;
+	uint32_t                 stage;
+	uint32_t                 id;
+	uint32_t                 tid;
+};
+
+struct cmr_trace_ring {
+	volatile uint32_t        owner;
+	volatile uint32_t        write;
+	struct cmr_trace_evt     evt[CMR_TRACE_RING_SIZE];
+};
+
+static const char *trace_stage_name[CMR_TRACE_STAGE_MAX] = {
+	"v4l2_dq",
+	"isp",
+	"scale",
+	"rotate",
+	"jpeg_enc",
+	"jpeg_dec",
+	"exif",
+	"callback"
+};
+
+static struct cmr_trace_ring     trace_ring[CMR_TRACE_THREAD_MAX];
+static volatile uint32_t         trace_on = 0;
+/*
+  The start time of the stages completed by another thread, one slot per frame
+  id so the frames in flight at the same time don't overwrite each other. The
+  starter and the completer of one frame are always ordered by a message queue
+  or a driver ioctl, which acts as the barrier between them.
+*/
+static uint64_t                  trace_mark[CMR_TRACE_STAGE_MAX][CMR_TRACE_MARK_NUM];
+static pthread_key_t             trace_key;
+static pthread_once_t            trace_key_once = PTHREAD_ONCE_INIT;
+
+static void cmr_trace_ring_release(void *data);
+static void cmr_trace_key_create(void);
+static struct cmr_trace_ring *cmr_trace_get_ring(void);
+static int cmr_trace_cmp(const void *a, const void *b);
+
+int cmr_trace_init(void)
+{
+	char                     value[PROPERTY_VALUE_MAX];
+	uint32_t                 on, i;
+
+	property_get(CMR_TRACE_PROPERTY, value, "0");
+	on = (uint32_t)atoi(value);
+	if (on) {
+		pthread_once(&trace_key_once, cmr_trace_key_create);
+		bzero((void*)trace_mark, sizeof(trace_mark));
+		/*
+		  Drop the events of the previous session, the owners are kept since a
+		  thread still alive keeps its ring in the thread specific data.
+		*/
+		for (i = 0; i < CMR_TRACE_THREAD_MAX; i++) {
+			trace_ring[i].write = 0;
+		}
+		__sync_synchronize();
+	}
+	trace_on = on;
+
+	CMR_LOGI("trace %d", trace_on);
+
+	return 0;
+}
+
+int cmr_trace_deinit(void)
+{
+	if (0 == trace_on)
+		return 0;
+
+	cmr_trace_summary();
+	cmr_trace_dump(CMR_TRACE_FILE);
+	trace_on = 0;
+
+	return 0;
+}
+
+uint64_t cmr_trace_begin(void)
+{
+	if (0 == trace_on)
+		return 0;
+
+	return (uint64_t)systemTime(CLOCK_MONOTONIC);
+}
+
+void cmr_trace_end(uint32_t stage, uint32_t id, uint64_t begin)
+{
+	struct cmr_trace_ring    *ring;
+	struct cmr_trace_evt     *evt;
+	uint64_t                 now;
+
+	if (0 == trace_on || 0 == begin || stage >= CMR_TRACE_STAGE_MAX)
+		return;
+
+	now = (uint64_t)systemTime(CLOCK_MONOTONIC);
+	ring = cmr_trace_get_ring();
+	if (NULL == ring)
+		return;
+
+	evt = &ring->evt[ring->write & CMR_TRACE_RING_MASK];
+	evt->begin = CMR_TRACE_NS_TO_US(begin);
+	evt->dur   = (uint32_t)CMR_TRACE_NS_TO_US(now - begin);
+	evt->stage = stage;
+	evt->id    = id;
+	evt->tid   = ring->owner;
+	__sync_synchronize();
+	ring->write++;
+}
+
+void cmr_trace_mark(uint32_t stage, uint32_t id)
+{
+	if (0 == trace_on || stage >= CMR_TRACE_STAGE_MAX)
+		return;
+
+	trace_mark[stage][id & CMR_TRACE_MARK_MASK] = (uint64_t)systemTime(CLOCK_MONOTONIC);
+}
+
+void cmr_trace_done(uint32_t stage, uint32_t id)
+{
+	uint64_t                 *mark;
+
+	if (0 == trace_on || stage >= CMR_TRACE_STAGE_MAX)
+		return;
+
+	mark = &trace_mark[stage][id & CMR_TRACE_MARK_MASK];
+	cmr_trace_end(stage, id, *mark);
+	*mark = 0;
+}
+
+/*
+  Chrome trace format, it can be loaded by chrome://tracing or systrace viewer.
+*/
+int cmr_trace_dump(const char *file_name)
+{
+	FILE                     *fp;
+	struct cmr_trace_ring    *ring;
+	struct cmr_trace_evt     *evt;
+	uint32_t                 i, j, write, start, first = 1;
+	pid_t                    pid = getpid();
+
+	fp = fopen(file_name, "w");
+	if (NULL == fp) {
+		CMR_LOGE("Failed to open %s", file_name);
+		return -1;
+	}
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (i = 0; i < CMR_TRACE_THREAD_MAX; i++) {
+		ring = &trace_ring[i];
+		write = ring->write;
+		__sync_synchronize();
+		start = write > CMR_TRACE_RING_SIZE ? write - CMR_TRACE_RING_SIZE : 0;
+		for (j = start; j < write; j++) {
+			evt = &ring->evt[j & CMR_TRACE_RING_MASK];
+			fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"camera\",\"ph\":\"X\","
+				"\"ts\":%llu,\"dur\":%u,\"pid\":%d,\"tid\":%u,\"args\":{\"id\":%u}}",
+				first ? "" : ",\n",
+				trace_stage_name[evt->stage],
+				(unsigned long long)evt->begin,
+				evt->dur,
+				(int)pid,
+				evt->tid,
+				evt->id);
+			first = 0;
+		}
+	}
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+
+	CMR_LOGI("trace saved to %s", file_name);
+
+	return 0;
+}
+
+void cmr_trace_summary(void)
+{
+	struct cmr_trace_ring    *ring;
+	struct cmr_trace_evt     *evt;
+	uint32_t                 *dur;
+	uint32_t                 stage, i, j, write, start, cnt;
+
+	dur = (uint32_t*)malloc(CMR_TRACE_THREAD_MAX * CMR_TRACE_RING_SIZE * sizeof(uint32_t));
+	if (NULL == dur) {
+		CMR_LOGE("No memory");
+		return;
+	}
+
+	for (stage = 0; stage < CMR_TRACE_STAGE_MAX; stage++) {
+		cnt = 0;
+		for (i = 0; i < CMR_TRACE_THREAD_MAX; i++) {
+			ring = &trace_ring[i];
+			write = ring->write;
+			__sync_synchronize();
+			start = write > CMR_TRACE_RING_SIZE ? write - CMR_TRACE_RING_SIZE : 0;
+			for (j = start; j < write; j++) {
+				evt = &ring->evt[j & CMR_TRACE_RING_MASK];
+				if (stage == evt->stage) {
+					dur[cnt++] = evt->dur;
+				}
+			}
+		}
+		if (0 == cnt)
+			continue;
+
+		qsort(dur, cnt, sizeof(uint32_t), cmr_trace_cmp);
+		CMR_LOGI("%s: cnt %d, p50 %d us, p99 %d us, max %d us",
+			trace_stage_name[stage],
+			cnt,
+			dur[cnt * 50 / 100],
+			dur[cnt * 99 / 100],
+			dur[cnt - 1]);
+	}
+
+	free(dur);
+}
+
+static void cmr_trace_ring_release(void *data)
+{
+	struct cmr_trace_ring    *ring = (struct cmr_trace_ring*)data;
+
+	/* the events are kept, the next owner appends after them */
+	if (ring) {
+		ring->owner = 0;
+	}
+}
+
+static void cmr_trace_key_create(void)
+{
+	pthread_key_create(&trace_key, cmr_trace_ring_release);
+}
+
+static struct cmr_trace_ring *cmr_trace_get_ring(void)
+{
+	struct cmr_trace_ring    *ring;
+	uint32_t                 tid, i;
+
+	ring = (struct cmr_trace_ring*)pthread_getspecific(trace_key);
+	if (ring)
+		return ring;
+
+	tid = (uint32_t)gettid();
+	for (i = 0; i < CMR_TRACE_THREAD_MAX; i++) {
+		if (__sync_bool_compare_and_swap(&trace_ring[i].owner, 0, tid)) {
+			ring = &trace_ring[i];
+			pthread_setspecific(trace_key, ring);
+			break;
+		}
+	}
+
+	return ring;
+}
+
+static int cmr_trace_cmp(const void *a, const void *b)
+{
+	uint32_t                 x = *(const uint32_t*)a;
+	uint32_t                 y = *(const uint32_t*)b;
+
+	return (x > y) - (x < y);
+}
@@ -22,6 +22,7 @@
 #include <pthread.h>
 #include <unistd.h>
 #include "cmr_v4l2.h"
+#include "cmr_trace.h"
 
 #define CMR_TIMING_LEN                   16
 
@@ -607,6 +608,7 @@ static void* cmr_v4l2_thread_proc(void* data)
 				continue;
 			} else {
 				// normal irq
+				cmr_trace_mark(CMR_TRACE_V4L2_DQ, buf.index);
 				evt_id = cmr_v4l2_evt_id(buf.flags);
 				if (CMR_V4L2_MAX == evt_id) {
 					continue;
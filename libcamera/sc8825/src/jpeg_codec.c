@@ -19,6 +19,7 @@
 #include "cmr_common.h"
 #include "jpegdec_api.h"
 #include "jpegenc_api.h"
+#include "cmr_trace.h"
 
 
 #define JPEG_MSG_QUEUE_SIZE		  40
@@ -66,7 +67,9 @@ typedef struct
 	uint32_t    stream_buf_vir;
 	uint32_t	stream_buf_size;
 
-	struct img_size	size;
+	struct img_size	size;/*of the output*/
+	struct img_size	src_size;
+	uint32_t    scale_down;
 	uint32_t    slice_height;/*slice height must be  8X*/
 	uint32_t    set_slice_height;
 	uint32_t    slice_mod;/*PEG_YUV_SLICE_MODE*/
@@ -125,6 +128,7 @@ typedef struct
 	uint32_t    cur_id; /*0: ping; 1: pang*/
 	uint32_t	is_finish;   /*0: on going; 1: finished*/
 	uint32_t    is_thumbnail;
+	uint32_t    is_progressive;
 }JPEG_ENC_T;
 
 static struct jpeg_wexif_cb_param s_exif_output;
@@ -329,6 +333,20 @@ static  int  _enc_start(uint32_t handle)
 	jenc_parm_ptr->stream_buf_len = jpeg_enc_buf_len;
 	jenc_parm_ptr->stream_size = 0;
 
+	/*the whole frame is ready only in the frame mode, or it falls back to the baseline*/
+	if(enc_cxt_ptr->is_progressive && 0 == enc_cxt_ptr->is_thumbnail
+		&& enc_cxt_ptr->slice_height == enc_cxt_ptr->size.height) {
+		if(JPEG_SUCCESS == JPEGENC_Progressive_Encode(jenc_parm_ptr)) {
+			enc_cxt_ptr->is_finish = 1;
+			enc_cxt_ptr->stream_real_size = jenc_parm_ptr->stream_size;
+			enc_cxt_ptr->cur_line_num = enc_cxt_ptr->size.height;
+			enc_cxt_ptr->cur_id = 0;
+			CMR_LOGI("jpeg: progressive size: %d", enc_cxt_ptr->stream_real_size);
+			goto enc_start_end;
+		}
+		CMR_LOGE("jpeg: progressive encode failed, baseline instead.");
+	}
+
 	//start jpeg enc for both slice and frame
 	if(0 != JPEGENC_Slice_Start(jenc_parm_ptr, &slice_out)){
 		ret =  JPEG_CODEC_ERROR;
@@ -537,8 +555,9 @@ static int _dec_start(uint32_t handle)
 	dec_cxt_ptr->fw_decode_buf = jcontext.fw_decode_buf;
 
 	jpegdec_params.format = JPEGDEC_YUV_422;
-	jpegdec_params.width  =   dec_cxt_ptr->size.width;
-	jpegdec_params.height = dec_cxt_ptr->size.height;
+	jpegdec_params.width  =   dec_cxt_ptr->src_size.width;
+	jpegdec_params.height = dec_cxt_ptr->src_size.height;
+	jpegdec_params.scale_down = dec_cxt_ptr->scale_down;
 	jpegdec_params.stream_size = dec_cxt_ptr->stream_buf_size;
 	jpegdec_params.src_buf = (void *)dec_cxt_ptr->stream_buf_vir;
 	jpegdec_params.src_phy_buf = dec_cxt_ptr->stream_buf_phy;
@@ -557,11 +576,12 @@ static int _dec_start(uint32_t handle)
 	jpegdec_params.stream_buf_len = jpegdec_params.stream_size;
 	jpegdec_params.yuv_virt_buf   = jpegdec_params.target_buf_Y;
 	jpegdec_params.yuv_phy_buf    = jpegdec_params.target_phy_buf_Y;
-	jpegdec_params.set_slice_height = dec_cxt_ptr->slice_height;
+	/*the firmware counts the slice in the source lines*/
+	jpegdec_params.set_slice_height = dec_cxt_ptr->slice_height << dec_cxt_ptr->scale_down;
 	dec_cxt_ptr->set_slice_height = dec_cxt_ptr->slice_height;
 	if(dec_cxt_ptr->slice_height == dec_cxt_ptr->size.height) {
 		jpegdec_params.set_slice_height = JPEG_SLICE_HEIGHT;
-		dec_cxt_ptr->set_slice_height = JPEG_SLICE_HEIGHT;
+		dec_cxt_ptr->set_slice_height = JPEG_SLICE_HEIGHT >> dec_cxt_ptr->scale_down;
 	}
 
 	memset(&slice_out,0,sizeof(JPEGDEC_SLICE_OUT_T));
@@ -737,6 +757,7 @@ static void* _thread_proc(void* data)
 	struct jpeg_dec_next_param *dec_param_ptr = NULL;
 	JPEG_ENC_T *enc_cxt_ptr = NULL;
 	struct jpeg_wexif_cb_param wexif_out_param;
+	uint64_t trace_begin;
 	CMR_MSG_INIT(message);
 	CMR_LOGV("JPEG Thread In \n");
 
@@ -749,7 +770,7 @@ static void* _thread_proc(void* data)
 			break;
 		}
 
-		CMR_LOGE("jpeg: message.msg_type 0x%x", message.msg_type);
+		CMR_LOGV("jpeg: message.msg_type 0x%x", message.msg_type);
 		evt = (uint32_t)(message.msg_type & JPEG_EVT_MASK_BITS);
 		if((1 == jcontext.is_stop) &&(JPEG_EVT_STOP != evt)) {
 			CMR_LOGI("discard message 0x%x.",evt);
@@ -758,7 +779,9 @@ static void* _thread_proc(void* data)
 		switch(evt){
 		case  JPEG_EVT_ENC_START:
 			handle = (uint32_t )message.data;
+			trace_begin = cmr_trace_begin();
 			ret = _enc_start(handle);
+			cmr_trace_end(CMR_TRACE_JPEG_ENC, 0, trace_begin);
 
 			if(JPEG_CODEC_SUCCESS == ret){
 				JPEG_ENC_CB_PARAM_T param;
@@ -777,6 +800,7 @@ static void* _thread_proc(void* data)
 			handle = handle_ptr->handle;
 			enc_cxt_ptr = (JPEG_ENC_T * )handle;
 
+			trace_begin = cmr_trace_begin();
 			do {
 				ret = _enc_next( handle, param_ptr);
 				if(JPEG_CODEC_SUCCESS != ret) {
@@ -784,6 +808,7 @@ static void* _thread_proc(void* data)
 					break;
 				}
 			}while((param_ptr->ready_line_num >= enc_cxt_ptr->size.height) && (enc_cxt_ptr->cur_line_num<enc_cxt_ptr->size.height));
+			cmr_trace_end(CMR_TRACE_JPEG_ENC, enc_cxt_ptr->cur_line_num, trace_begin);
 
 			if(JPEG_CODEC_ENC_WAIT_SRC != ret) {
 				if(JPEG_CODEC_SUCCESS == ret){
@@ -799,7 +824,9 @@ static void* _thread_proc(void* data)
 			break;
 		case  JPEG_EVT_DEC_START:
 			handle = (uint32_t )message.data;
+			trace_begin = cmr_trace_begin();
 			ret = _dec_start(handle);
+			cmr_trace_end(CMR_TRACE_JPEG_DEC, 0, trace_begin);
 			if(JPEG_CODEC_SUCCESS == ret){
 				_dec_callback(0,0,0);
 			} else{
@@ -812,7 +839,9 @@ static void* _thread_proc(void* data)
 			handle_ptr = (JPEG_HANDLE_T*)dec_param_ptr->handle;
 			handle = handle_ptr->handle;
 			if(0 != message.data) {
+				trace_begin = cmr_trace_begin();
 				ret = _dec_next( handle, (struct jpeg_dec_next_param *)message.data);
+				cmr_trace_end(CMR_TRACE_JPEG_DEC, 1, trace_begin);
 			}
 
 			if(JPEG_CODEC_SUCCESS == ret){
@@ -833,7 +862,9 @@ static void* _thread_proc(void* data)
 			break;
 
 		case JPEG_EVT_ENC_EXIF:
+			trace_begin = cmr_trace_begin();
 			ret = _jpeg_enc_wexif((struct jpeg_enc_exif_param*)message.data,&wexif_out_param);
+			cmr_trace_end(CMR_TRACE_EXIF, 0, trace_begin);
 			if(JPEG_CODEC_SUCCESS == ret){
 				s_exif_output = wexif_out_param;
 			} else {
@@ -853,7 +884,9 @@ static void* _thread_proc(void* data)
 			break;
 		case JPEG_EVT_ENC_THUMB:
 			handle = (uint32_t )message.data;
+			trace_begin = cmr_trace_begin();
 			ret = _enc_start(handle);
+			cmr_trace_end(CMR_TRACE_JPEG_ENC, 1, trace_begin);
 			memset((void*)&s_thumbnail,0,sizeof(JPEG_ENC_CB_PARAM_T));
 			if(JPEG_CODEC_SUCCESS == ret){
 				_prc_enc_cbparam(handle, &s_thumbnail);
@@ -965,6 +998,7 @@ static int _get_enc_start_param(JPEG_ENC_T *cxt_ptr, struct jpeg_enc_in_param *i
 
 	cxt_ptr->slice_height = in_parm_ptr->slice_height;
 	cxt_ptr->slice_mod = in_parm_ptr->slice_mod;
+	cxt_ptr->is_progressive = in_parm_ptr->is_progressive;
 
 	return ret;
 
@@ -985,6 +1019,7 @@ static int _check_dec_start_param(struct jpeg_dec_in_param *start_in_parm_ptr, s
 static int _get_dec_start_param(JPEG_DEC_T *cxt_ptr, struct jpeg_dec_in_param *in_parm_ptr, struct jpeg_dec_out_param *out_parm_ptr)
 {
 	int ret = JPEG_CODEC_SUCCESS;
+	JPEGDEC_SCALE_PLAN_T plan;
 
 	cxt_ptr->stream_buf_phy = in_parm_ptr->stream_buf_phy;
 	cxt_ptr->stream_buf_vir =  in_parm_ptr->stream_buf_vir;
@@ -1001,10 +1036,45 @@ static int _get_dec_start_param(JPEG_DEC_T *cxt_ptr, struct jpeg_dec_in_param *i
 	cxt_ptr->dst_fmt = in_parm_ptr->dst_fmt;
 
 	cxt_ptr->size = in_parm_ptr->size;
+	cxt_ptr->src_size = in_parm_ptr->size;
+	cxt_ptr->scale_down = 0;
 
 	cxt_ptr->slice_height = in_parm_ptr->slice_height;
 	cxt_ptr->slice_mod = in_parm_ptr->slice_mod;
 
+	if (0 != in_parm_ptr->scale_down) {
+		if (0 != JPEGDEC_Scale_Plan((void*)in_parm_ptr->stream_buf_vir,
+			in_parm_ptr->stream_buf_size,
+			in_parm_ptr->scale_down,
+			&plan)) {
+			CMR_LOGE("failed to plan the scaled decode");
+			return JPEG_CODEC_PARAM_ERR;
+		}
+		cxt_ptr->stream_buf_phy += plan.stream_offset;
+		cxt_ptr->stream_buf_vir += plan.stream_offset;
+		cxt_ptr->stream_buf_size = plan.stream_size;
+		cxt_ptr->src_size.width = plan.width;
+		cxt_ptr->src_size.height = plan.height;
+		cxt_ptr->size.width = plan.out_width;
+		cxt_ptr->size.height = plan.out_height;
+		cxt_ptr->scale_down = plan.scale_down;
+		if (plan.out_width > in_parm_ptr->dst_size.width
+			|| plan.out_height > in_parm_ptr->dst_size.height) {
+			CMR_LOGE("the scaled output %dx%d does not fit the dst %dx%d",
+				plan.out_width, plan.out_height,
+				in_parm_ptr->dst_size.width, in_parm_ptr->dst_size.height);
+			return JPEG_CODEC_PARAM_ERR;
+		}
+		if (in_parm_ptr->slice_height == in_parm_ptr->size.height) {
+			cxt_ptr->slice_height = cxt_ptr->size.height;
+		}
+		CMR_LOGI("scale 1/%d, thumbnail %d, src %dx%d, out %dx%d",
+			1 << cxt_ptr->scale_down, plan.is_thumbnail,
+			cxt_ptr->src_size.width, cxt_ptr->src_size.height,
+			cxt_ptr->size.width, cxt_ptr->size.height);
+	}
+	out_parm_ptr->out_size = cxt_ptr->size;
+
 	CMR_LOGV("stream phy 0x%x vir 0x%x, temp_buf phy 0x%x vir 0x%x",
 		cxt_ptr->stream_buf_phy, cxt_ptr->stream_buf_vir,
 		cxt_ptr->temp_buf_phy, cxt_ptr->temp_buf_vir);
@@ -1149,6 +1219,32 @@ int jpeg_enc_next(struct jpeg_enc_next_param *param_ptr)
 }
 
 
+int jpeg_dec_get_out_size(struct jpeg_dec_in_param *in_parm_ptr, struct img_size *out_size_ptr)
+{
+	JPEGDEC_SCALE_PLAN_T plan;
+
+	if (NULL == in_parm_ptr || NULL == out_size_ptr) {
+		return JPEG_CODEC_PARAM_ERR;
+	}
+
+	if (0 == in_parm_ptr->scale_down) {
+		*out_size_ptr = in_parm_ptr->size;
+		return JPEG_CODEC_SUCCESS;
+	}
+
+	if (0 != JPEGDEC_Scale_Plan((void*)in_parm_ptr->stream_buf_vir,
+		in_parm_ptr->stream_buf_size,
+		in_parm_ptr->scale_down,
+		&plan)) {
+		CMR_LOGE("failed to plan the scaled decode");
+		return JPEG_CODEC_PARAM_ERR;
+	}
+	out_size_ptr->width = plan.out_width;
+	out_size_ptr->height = plan.out_height;
+
+	return JPEG_CODEC_SUCCESS;
+}
+
 int jpeg_dec_start(struct jpeg_dec_in_param  *in_parm_ptr, struct jpeg_dec_out_param *out_parm_ptr)
 {
 	int ret = JPEG_CODEC_SUCCESS;
@@ -1177,6 +1273,8 @@ int jpeg_dec_start(struct jpeg_dec_in_param  *in_parm_ptr, struct jpeg_dec_out_p
 	}
 
 	if(JPEG_CODEC_SUCCESS != _get_dec_start_param(dec_cxt_ptr,in_parm_ptr, out_parm_ptr )) {
+		free(handle_ptr);
+		free(dec_cxt_ptr);
 		return JPEG_CODEC_PARAM_ERR;
 	}
 
@@ -1300,6 +1398,7 @@ int jpeg_deinit(void)
 		free(jcontext.fw_decode_buf);
 		jcontext.fw_decode_buf = PNULL;
 	}
+	IMGJPEG_ResetExifTemplate();
 	sem_destroy(&jcontext.stop_sem);
 	sem_destroy(&jcontext.sync_sem);
 	cmr_msg_queue_destroy(jcontext.msg_queue_handle);
@@ -24,6 +24,7 @@
 #include <fcntl.h>              /* low-level i/o */
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <stddef.h>
 
 #include "sensor_cfg.h"
 #include "sensor_drv_u.h"
@@ -126,6 +127,39 @@ LOCAL volatile uint32_t           s_exit_monitor_flag = 0;
 #define SENSOR_IO_SET_I2CCLOCK		_IOW(SENSOR_IOC_MAGIC, 16,  uint32_t)
 
 #define SENSOR_MSG_QUEUE_SIZE           10
+#define SENSOR_BURST_MIN_REGS           4
+#define SENSOR_BURST_MAX_SIZE           256
+/* start, address byte and stop of one i2c message, in bits */
+#define SENSOR_I2C_MSG_OVERHEAD         11
+#define SENSOR_I2C_BYTE_BITS            9
+
+enum {
+	SENSOR_REG_OP_REGS = 0,
+	SENSOR_REG_OP_BURST,
+	SENSOR_REG_OP_DELAY
+};
+
+typedef struct sensor_reg_op_tag {
+	uint32_t type;
+	uint32_t start;
+	uint32_t count;
+} SENSOR_REG_OP_T;
+
+#define SENSOR_SHADOW_REG_NUM           0x10000
+#define SENSOR_SHADOW_VALID_WORDS       (SENSOR_SHADOW_REG_NUM / 32)
+
+/*
+  What the sensor registers hold, as far as this driver wrote them since the
+  last power or reset. It is kept only for the sensors which list their
+  volatile registers.
+*/
+typedef struct sensor_shadow_tag {
+	SENSOR_INFO_T *sensor_ptr;
+	uint16_t *value_ptr;
+	uint32_t *valid_ptr;
+} SENSOR_SHADOW_T;
+
+LOCAL SENSOR_SHADOW_T s_sensor_shadow = {PNULL, PNULL, PNULL};
 
 enum {
 	SENSOR_EVT_INIT = CMR_EVT_SENSOR_BASE,
@@ -149,6 +183,9 @@ LOCAL void* _Sensor_ThreadProc(void* data);
 LOCAL int   _Sensor_CreateMonitorThread(void);
 LOCAL int   _Sensor_KillMonitorThread(void);
 LOCAL int _Sensor_AutoFocusInit(void);
+LOCAL void _Sensor_ProbeCacheRecord(SENSOR_ID_E sensor_id, uint32_t index);
+LOCAL void _Sensor_ProbeCacheDrop(SENSOR_ID_E sensor_id);
+LOCAL int _Sensor_ProbeCacheVerify(SENSOR_ID_E sensor_id);
 
 static int xioctl(int fd, int request, void * arg) {   
     int r;   
@@ -158,6 +195,109 @@ static int xioctl(int fd, int request, void * arg) {
     return r;   
 } 
 
+LOCAL void _Sensor_ShadowInvalidateAll(void)
+{
+	if (PNULL != s_sensor_shadow.valid_ptr) {
+		bzero(s_sensor_shadow.valid_ptr, SENSOR_SHADOW_VALID_WORDS * sizeof(uint32_t));
+	}
+}
+
+LOCAL void _Sensor_ShadowFree(void)
+{
+	if (PNULL != s_sensor_shadow.value_ptr) {
+		free(s_sensor_shadow.value_ptr);
+	}
+	if (PNULL != s_sensor_shadow.valid_ptr) {
+		free(s_sensor_shadow.valid_ptr);
+	}
+	s_sensor_shadow.sensor_ptr = PNULL;
+	s_sensor_shadow.value_ptr  = PNULL;
+	s_sensor_shadow.valid_ptr  = PNULL;
+}
+
+/* returns SENSOR_TRUE if the shadow is kept for the current sensor */
+LOCAL BOOLEAN _Sensor_ShadowEnabled(void)
+{
+	if (PNULL == s_sensor_info_ptr || PNULL == s_sensor_info_ptr->volatile_reg_ptr) {
+		return SENSOR_FALSE;
+	}
+
+	if (s_sensor_shadow.sensor_ptr != s_sensor_info_ptr) {
+		if (PNULL == s_sensor_shadow.value_ptr) {
+			s_sensor_shadow.value_ptr = (uint16_t*)malloc(SENSOR_SHADOW_REG_NUM * sizeof(uint16_t));
+			s_sensor_shadow.valid_ptr = (uint32_t*)malloc(SENSOR_SHADOW_VALID_WORDS * sizeof(uint32_t));
+			if (PNULL == s_sensor_shadow.value_ptr || PNULL == s_sensor_shadow.valid_ptr) {
+				SENSOR_PRINT_ERR("_Sensor_ShadowEnabled: no memory \n");
+				_Sensor_ShadowFree();
+				return SENSOR_FALSE;
+			}
+		}
+		_Sensor_ShadowInvalidateAll();
+		s_sensor_shadow.sensor_ptr = s_sensor_info_ptr;
+	}
+
+	return SENSOR_TRUE;
+}
+
+LOCAL BOOLEAN _Sensor_ShadowIsVolatile(uint16_t addr)
+{
+	SENSOR_REG_RANGE_T_PTR range_ptr = s_sensor_info_ptr->volatile_reg_ptr;
+	uint32_t i;
+
+	for (i = 0; i < s_sensor_info_ptr->volatile_reg_count; i++) {
+		if (addr >= range_ptr[i].start && addr <= range_ptr[i].end) {
+			return SENSOR_TRUE;
+		}
+	}
+
+	return SENSOR_FALSE;
+}
+
+/* returns SENSOR_TRUE if the register is known to hold the value already */
+LOCAL BOOLEAN _Sensor_ShadowMatch(uint16_t addr, uint16_t value)
+{
+	if (0 == (s_sensor_shadow.valid_ptr[addr >> 5] & (1 << (addr & 0x1f)))) {
+		return SENSOR_FALSE;
+	}
+
+	return (s_sensor_shadow.value_ptr[addr] == value) && !_Sensor_ShadowIsVolatile(addr);
+}
+
+LOCAL void _Sensor_ShadowSet(uint16_t addr, uint16_t value)
+{
+	s_sensor_shadow.value_ptr[addr] = value;
+	s_sensor_shadow.valid_ptr[addr >> 5] |= (1 << (addr & 0x1f));
+}
+
+LOCAL void _Sensor_ShadowInvalidate(uint16_t addr, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++, addr++) {
+		s_sensor_shadow.valid_ptr[addr >> 5] &= ~(1 << (addr & 0x1f));
+	}
+}
+
+LOCAL void _Sensor_ShadowUpdateTab(SENSOR_REG_T_PTR reg_ptr, uint32_t reg_count, BOOLEAN is_written)
+{
+	uint32_t i;
+
+	if (!_Sensor_ShadowEnabled()) {
+		return;
+	}
+
+	for (i = 0; i < reg_count; i++) {
+		if (SENSOR_WRITE_DELAY == reg_ptr[i].reg_addr) {
+			continue;
+		}
+		if (is_written) {
+			_Sensor_ShadowSet(reg_ptr[i].reg_addr, reg_ptr[i].reg_value);
+		} else {
+			_Sensor_ShadowInvalidate(reg_ptr[i].reg_addr, 1);
+		}
+	}
+}
+
 
 /* This function is to set power down */
 LOCAL int _Sensor_Device_PowerDown(BOOLEAN power_level)
@@ -165,6 +305,7 @@ LOCAL int _Sensor_Device_PowerDown(BOOLEAN power_level)
 	int ret = SENSOR_SUCCESS;
 
 	ret = xioctl(g_fd_sensor, SENSOR_IO_PD, &power_level);
+	_Sensor_ShadowInvalidateAll();
 	
 	if (0 != ret)
 	{
@@ -279,6 +420,7 @@ LOCAL int _Sensor_Device_Reset(uint32_t *reset_val)
 	SENSOR_PRINT_ERR("level %d, width %d",reset_val[0],reset_val[1]);
 
 	ret = xioctl(g_fd_sensor, SENSOR_IO_RST, reset_val);
+	_Sensor_ShadowInvalidateAll();
 	if (ret) {
 		ret = -1;
 	}
@@ -392,6 +534,7 @@ int _Sensor_Device_WriteRegTab(SENSOR_REG_TAB_PTR reg_tab)
 	int ret = SENSOR_SUCCESS;
 
 	ret = xioctl(g_fd_sensor, SENSOR_IO_I2C_WRITE_REGS, reg_tab);
+	_Sensor_ShadowUpdateTab(reg_tab->sensor_reg_tab_ptr, reg_tab->reg_count, 0 == ret);
 	if (0 != ret)
 	{
 		SENSOR_PRINT_ERR("_Sensor_Device_SetRegTab failed,  ptr=%x, count=%d, bits=%d, burst=%d \n",
@@ -417,18 +560,12 @@ LOCAL int _Sensor_Device_SetI2CClock(uint32_t clock)
 	return ret;
 }
 
-LOCAL int Sensor_SetI2CClock(void)
+LOCAL uint32_t _Sensor_GetI2CClock(uint32_t reg_bits)
 {
 	uint32_t freq;
 	uint32_t clock;
-	int ret;
-	
-	if(NULL == s_sensor_info_ptr){
-		SENSOR_PRINT("Sensor_SetI2CClock: No sensor info \n");
-		return -1;
-	}
 
-	freq = s_sensor_info_ptr->reg_addr_value_bits & SENSOR_I2C_CLOCK_MASK;
+	freq = reg_bits & SENSOR_I2C_CLOCK_MASK;
 
 	switch(freq)
 	{
@@ -458,6 +595,21 @@ LOCAL int Sensor_SetI2CClock(void)
 			break;
 	}
 
+	return clock;
+}
+
+LOCAL int Sensor_SetI2CClock(void)
+{
+	uint32_t clock;
+	int ret;
+	
+	if(NULL == s_sensor_info_ptr){
+		SENSOR_PRINT("Sensor_SetI2CClock: No sensor info \n");
+		return -1;
+	}
+
+	clock = _Sensor_GetI2CClock(s_sensor_info_ptr->reg_addr_value_bits);
+
 	SENSOR_PRINT("Sensor_SetI2CClock: clock = %d \n", clock);
 
 	ret = _Sensor_Device_SetI2CClock(clock);
@@ -791,11 +943,22 @@ int32_t Sensor_WriteReg(uint16_t subaddr, uint16_t data)
 
 		SENSOR_REG_BITS_T reg;
 
+		if (_Sensor_ShadowEnabled() && _Sensor_ShadowMatch(subaddr, data)) {
+			return SENSOR_SUCCESS;
+		}
+
 		reg.reg_addr = subaddr;
 		reg.reg_value = data;
 		reg.reg_bits = s_sensor_info_ptr->reg_addr_value_bits;
 
 		ret = _Sensor_Device_WriteReg(&reg);
+		if (_Sensor_ShadowEnabled()) {
+			if (SENSOR_SUCCESS == ret) {
+				_Sensor_ShadowSet(subaddr, data);
+			} else {
+				_Sensor_ShadowInvalidate(subaddr, 1);
+			}
+		}
 	}
 
 	return ret;
@@ -849,6 +1012,13 @@ int32_t Sensor_WriteReg_8bits(uint16_t reg_addr, uint8_t value)
 	reg.reg_bits = SENSOR_I2C_REG_8BIT | SENSOR_I2C_VAL_8BIT;
 
 	ret = _Sensor_Device_WriteReg(&reg);
+	/*
+	  The shadow holds values at the sensor's own register width, so an
+	  8 bit write only tells it the register changed.
+	*/
+	if (_Sensor_ShadowEnabled()) {
+		_Sensor_ShadowInvalidate(reg_addr, 1);
+	}
 
 	return 0;
 }
@@ -871,6 +1041,210 @@ int32_t Sensor_ReadReg_8bits(uint8_t reg_addr, uint8_t * reg_val)
 	return ret;
 }
 
+LOCAL uint32_t _Sensor_RegTabRunLen(SENSOR_REG_T_PTR reg_ptr,
+					uint32_t reg_count,
+					uint32_t pos,
+					uint32_t step,
+					uint32_t max_regs)
+{
+	uint32_t i = pos + 1;
+
+	while (i < reg_count && (i - pos) < max_regs
+		&& SENSOR_WRITE_DELAY != reg_ptr[i].reg_addr
+		&& reg_ptr[i].reg_addr == (uint16_t)(reg_ptr[i - 1].reg_addr + step)) {
+		i++;
+	}
+
+	return i - pos;
+}
+
+/*
+  Compiles the register table into operations kept in the table order. A
+  SENSOR_WRITE_DELAY entry is a barrier, a run of at least SENSOR_BURST_MIN_REGS
+  consecutive sub addresses is written by one i2c message, and the registers in
+  between are sent by one SENSOR_IO_I2C_WRITE_REGS pointing into the table.
+  Returns the position of the next operation.
+*/
+LOCAL uint32_t _Sensor_RegTabNextOp(SENSOR_REG_T_PTR reg_ptr,
+					uint32_t reg_count,
+					uint32_t pos,
+					uint32_t reg_bits,
+					SENSOR_REG_OP_T *op)
+{
+	uint32_t step = (reg_bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1;
+	uint32_t max_regs = (SENSOR_BURST_MAX_SIZE - 2) / step;
+	uint32_t i, run;
+
+	op->start = pos;
+	if (SENSOR_WRITE_DELAY == reg_ptr[pos].reg_addr) {
+		op->type  = SENSOR_REG_OP_DELAY;
+		op->count = 1;
+		return pos + 1;
+	}
+
+	op->type = SENSOR_REG_OP_REGS;
+	for (i = pos; i < reg_count && SENSOR_WRITE_DELAY != reg_ptr[i].reg_addr; i += run) {
+		run = _Sensor_RegTabRunLen(reg_ptr, reg_count, i, step, max_regs);
+		if (run >= SENSOR_BURST_MIN_REGS) {
+			if (i == pos) {
+				op->type  = SENSOR_REG_OP_BURST;
+				op->count = run;
+				return pos + run;
+			}
+			break;
+		}
+	}
+	op->count = i - pos;
+
+	return i;
+}
+
+LOCAL int _Sensor_WriteRegBurst(SENSOR_REG_T_PTR reg_ptr, uint32_t count, uint32_t reg_bits)
+{
+	uint8_t buf[SENSOR_BURST_MAX_SIZE];
+	uint32_t i, len = 0;
+	int ret;
+
+	if (reg_bits & SENSOR_I2C_REG_16BIT) {
+		buf[len++] = (uint8_t)(reg_ptr[0].reg_addr >> 8);
+	}
+	buf[len++] = (uint8_t)(reg_ptr[0].reg_addr & 0xff);
+
+	for (i = 0; i < count; i++) {
+		if (reg_bits & SENSOR_I2C_VAL_16BIT) {
+			buf[len++] = (uint8_t)(reg_ptr[i].reg_value >> 8);
+		}
+		buf[len++] = (uint8_t)(reg_ptr[i].reg_value & 0xff);
+	}
+
+	/* the driver sends the buffer as one i2c message */
+	ret = _Sensor_Device_Write(buf, len);
+	_Sensor_ShadowUpdateTab(reg_ptr, count, SENSOR_SUCCESS == ret);
+	if (SENSOR_SUCCESS != ret) {
+		SENSOR_PRINT_ERR("_Sensor_WriteRegBurst failed, addr 0x%x, count %d \n",
+			reg_ptr[0].reg_addr, count);
+		return -1;
+	}
+
+	return SENSOR_SUCCESS;
+}
+
+LOCAL uint32_t _Sensor_RegOpBusBits(SENSOR_REG_OP_T *op, uint32_t reg_bits)
+{
+	uint32_t addr_bytes = (reg_bits & SENSOR_I2C_REG_16BIT) ? 2 : 1;
+	uint32_t val_bytes = (reg_bits & SENSOR_I2C_VAL_16BIT) ? 2 : 1;
+
+	if (SENSOR_REG_OP_BURST == op->type) {
+		return SENSOR_I2C_MSG_OVERHEAD
+			+ (addr_bytes + op->count * val_bytes) * SENSOR_I2C_BYTE_BITS;
+	}
+
+	return op->count * (SENSOR_I2C_MSG_OVERHEAD
+			+ (addr_bytes + val_bytes) * SENSOR_I2C_BYTE_BITS);
+}
+
+LOCAL int _Sensor_SendRegTabBurst(SENSOR_REG_TAB_INFO_T *sensor_reg_tab_info_ptr)
+{
+	SENSOR_REG_T_PTR reg_ptr = sensor_reg_tab_info_ptr->sensor_reg_tab_ptr;
+	uint32_t reg_count = sensor_reg_tab_info_ptr->reg_count;
+	uint32_t reg_bits = s_sensor_info_ptr->reg_addr_value_bits & ~SENSOR_I2C_BURST_WRITE;
+	uint32_t clock = _Sensor_GetI2CClock(reg_bits);
+	uint32_t pos = 0, io_cnt = 0, bus_bits = 0, delay_ms = 0;
+	SENSOR_REG_OP_T op;
+	SENSOR_REG_TAB_T regTab;
+	int ret = SENSOR_SUCCESS;
+
+	while (pos < reg_count) {
+		pos = _Sensor_RegTabNextOp(reg_ptr, reg_count, pos, reg_bits, &op);
+
+		if (SENSOR_REG_OP_DELAY == op.type) {
+			delay_ms += reg_ptr[op.start].reg_value;
+			SENSOR_Sleep(reg_ptr[op.start].reg_value);
+			continue;
+		}
+
+		if (SENSOR_REG_OP_BURST == op.type
+			&& SENSOR_SUCCESS == _Sensor_WriteRegBurst(&reg_ptr[op.start], op.count, reg_bits)) {
+			io_cnt++;
+			bus_bits += _Sensor_RegOpBusBits(&op, reg_bits);
+			continue;
+		}
+
+		/* the bursts the driver refused go out register by register */
+		op.type = SENSOR_REG_OP_REGS;
+		regTab.reg_count          = op.count;
+		regTab.reg_bits           = reg_bits;
+		regTab.burst_mode         = 0;
+		regTab.sensor_reg_tab_ptr = &reg_ptr[op.start];
+		if (_Sensor_Device_WriteRegTab(&regTab)) {
+			ret = SENSOR_FAIL;
+		}
+		io_cnt++;
+		bus_bits += _Sensor_RegOpBusBits(&op, reg_bits);
+	}
+
+	SENSOR_PRINT("SENSOR: _Sensor_SendRegTabBurst -> reg_count %d, io %d, bus %d us, delay %d ms.\n",
+		reg_count, io_cnt, (uint32_t)((uint64_t)bus_bits * 1000000 / clock), delay_ms);
+
+	return ret;
+}
+
+/*
+  Drops the registers which already hold their target value. The shadow is
+  updated while scanning so a register written twice in one table compares
+  against its earlier entry. A delay is kept only if a register before it, back
+  to the previous delay, is still written. Returns the table to be freed, or
+  PNULL if the full table has to be sent.
+*/
+LOCAL SENSOR_REG_T_PTR _Sensor_ShadowDelta(SENSOR_REG_TAB_INFO_T *tab_info_ptr,
+					SENSOR_REG_TAB_INFO_T *delta_info_ptr)
+{
+	SENSOR_REG_T_PTR reg_ptr = tab_info_ptr->sensor_reg_tab_ptr;
+	SENSOR_REG_T_PTR delta_ptr;
+	SENSOR_REG_OP_T op = {SENSOR_REG_OP_REGS, 0, 1};
+	uint32_t reg_bits = s_sensor_info_ptr->reg_addr_value_bits;
+	uint32_t i, cnt = 0, skip_cnt = 0, skip_ms = 0, seg_written = 0;
+
+	if (!_Sensor_ShadowEnabled()) {
+		return PNULL;
+	}
+
+	delta_ptr = (SENSOR_REG_T_PTR)malloc(tab_info_ptr->reg_count * sizeof(SENSOR_REG_T));
+	if (PNULL == delta_ptr) {
+		SENSOR_PRINT_ERR("_Sensor_ShadowDelta: no memory \n");
+		return PNULL;
+	}
+
+	for (i = 0; i < tab_info_ptr->reg_count; i++) {
+		if (SENSOR_WRITE_DELAY == reg_ptr[i].reg_addr) {
+			if (seg_written) {
+				delta_ptr[cnt++] = reg_ptr[i];
+			} else {
+				skip_ms += reg_ptr[i].reg_value;
+			}
+			seg_written = 0;
+		} else if (_Sensor_ShadowMatch(reg_ptr[i].reg_addr, reg_ptr[i].reg_value)) {
+			skip_cnt++;
+		} else {
+			_Sensor_ShadowSet(reg_ptr[i].reg_addr, reg_ptr[i].reg_value);
+			delta_ptr[cnt++] = reg_ptr[i];
+			seg_written = 1;
+		}
+	}
+
+	*delta_info_ptr = *tab_info_ptr;
+	delta_info_ptr->sensor_reg_tab_ptr = delta_ptr;
+	delta_info_ptr->reg_count = cnt;
+
+	op.count = skip_cnt;
+	SENSOR_PRINT("SENSOR: _Sensor_ShadowDelta -> reg_count %d, skipped %d, saved %d us bus and %d ms delay.\n",
+		tab_info_ptr->reg_count, skip_cnt,
+		(uint32_t)((uint64_t)_Sensor_RegOpBusBits(&op, reg_bits) * 1000000 / _Sensor_GetI2CClock(reg_bits)),
+		skip_ms);
+
+	return delta_ptr;
+}
+
 ERR_SENSOR_E Sensor_SendRegTabToSensor(SENSOR_REG_TAB_INFO_T *
 				       sensor_reg_tab_info_ptr)
 {
@@ -879,11 +1253,24 @@ ERR_SENSOR_E Sensor_SendRegTabToSensor(SENSOR_REG_TAB_INFO_T *
 	uint16_t subaddr;
 	uint16_t data;
 	int32_t ret = -1;
+	SENSOR_REG_TAB_INFO_T delta_tab_info;
+	SENSOR_REG_T_PTR delta_ptr = PNULL;
 
 	SENSOR_PRINT("SENSOR: Sensor_SendRegTabToSensor E.\n");
 
 	write_reg_func = s_sensor_info_ptr->ioctl_func_tab_ptr->write_reg;
 
+	if (PNULL == write_reg_func) {
+		delta_ptr = _Sensor_ShadowDelta(sensor_reg_tab_info_ptr, &delta_tab_info);
+		if (PNULL != delta_ptr) {
+			sensor_reg_tab_info_ptr = &delta_tab_info;
+			if (0 == delta_tab_info.reg_count) {
+				free(delta_ptr);
+				return SENSOR_SUCCESS;
+			}
+		}
+	}
+
 	if (PNULL != write_reg_func) {
 		for (i = 0; i < sensor_reg_tab_info_ptr->reg_count; i++) {
 			subaddr = sensor_reg_tab_info_ptr->sensor_reg_tab_ptr[i].reg_addr;
@@ -891,6 +1278,8 @@ ERR_SENSOR_E Sensor_SendRegTabToSensor(SENSOR_REG_TAB_INFO_T *
 			if (SENSOR_OP_SUCCESS != write_reg_func((subaddr << S_BIT_4) + data))
 				SENSOR_PRINT("SENSOR: IIC write : reg:0x%04x, val:0x%04x error\n", subaddr, data);
 		}
+	} else if (s_sensor_info_ptr->reg_addr_value_bits & SENSOR_I2C_BURST_WRITE) {
+		ret = _Sensor_SendRegTabBurst(sensor_reg_tab_info_ptr);
 	}else{
 #if 1
 		SENSOR_REG_TAB_T regTab;
@@ -908,6 +1297,10 @@ ERR_SENSOR_E Sensor_SendRegTabToSensor(SENSOR_REG_TAB_INFO_T *
 #endif
 	}
 
+	if (PNULL != delta_ptr) {
+		free(delta_ptr);
+	}
+
 	SENSOR_PRINT("SENSOR: Sensor_SendRegValueToSensor -> reg_count = %d, g_is_main_sensor: %d.\n",
 	     			sensor_reg_tab_info_ptr->reg_count, g_is_main_sensor);
 
@@ -1165,8 +1558,10 @@ IDENTIFY_SEARCH:
 			{			         
 				s_sensor_list_ptr[sensor_id]=sensor_info_ptr; 
 				s_sensor_register_info_ptr->is_register[sensor_id]=SCI_TRUE;
-				if(5 != Sensor_GetCurId())//test by wang bonnie
+				if(5 != Sensor_GetCurId()) {//test by wang bonnie
 					s_sensor_index[sensor_id] = sensor_index;
+					_Sensor_ProbeCacheRecord(sensor_id, sensor_index);
+				}
 				s_sensor_register_info_ptr->img_sensor_num++;
 				Sensor_PowerOn(SCI_FALSE);	
 				retValue = SCI_TRUE;
@@ -1380,61 +1775,231 @@ LOCAL uint32_t _Sensor_Register(SENSOR_ID_E sensor_id)
 }
 
 
-#define SENSOR_PARAM_NUM  8
-#define SENSOR_PARA	"/data/misc/sensors/sensor.file"
+#define SENSOR_PROBE_CACHE              "/data/misc/sensors/sensor_probe.cache"
+#define SENSOR_PROBE_CACHE_TMP          "/data/misc/sensors/sensor_probe.cache.tmp"
+#define SENSOR_PROBE_CACHE_MAGIC        ((SIGN_3 << 24) | (SIGN_2 << 16) | (SIGN_1 << 8) | SIGN_0)
+#define SENSOR_PROBE_CACHE_VERSION      1
+#define SENSOR_PROBE_ID_NUM             2
+#define SENSOR_PROBE_NAME_LEN           16
+#define SENSOR_PROBE_ID_INVALID         0xFFFF
+
+/*
+  What the last successful probe found for one sensor id. The power sequence
+  is the part of SENSOR_INFO_T Sensor_PowerOn works from, an entry whose table
+  slot no longer matches it is dropped.
+*/
+typedef struct sensor_probe_entry_tag {
+	uint8_t index;
+	uint8_t i2c_addr;
+	uint16_t id_addr;
+	uint16_t id_value;
+	uint16_t reset_pulse_level;
+	uint32_t power_down_level;
+	uint32_t avdd_val;
+	uint32_t dvdd_val;
+	uint32_t iovdd_val;
+	char name[SENSOR_PROBE_NAME_LEN];
+} SENSOR_PROBE_ENTRY_T;
+
+typedef struct sensor_probe_cache_tag {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	SENSOR_PROBE_ENTRY_T entry[SENSOR_PROBE_ID_NUM];
+	uint32_t check_sum;
+} SENSOR_PROBE_CACHE_T;
+
+LOCAL SENSOR_PROBE_CACHE_T s_sensor_probe_cache;
+
+LOCAL uint32_t _Sensor_ProbeCacheSum(SENSOR_PROBE_CACHE_T *cache_ptr)
+{
+	uint8_t *ptr = (uint8_t*)cache_ptr;
+	uint32_t i, sum = 0;
+
+	for (i = 0; i < offsetof(SENSOR_PROBE_CACHE_T, check_sum); i++) {
+		sum = (sum << 1 | sum >> 31) + ptr[i];
+	}
+
+	return sum;
+}
+
+LOCAL void _Sensor_ProbeEntryFill(SENSOR_PROBE_ENTRY_T *entry_ptr,
+					SENSOR_INFO_T *sensor_info_ptr,
+					uint32_t index)
+{
+	bzero(entry_ptr, sizeof(SENSOR_PROBE_ENTRY_T));
+	entry_ptr->index             = (uint8_t)index;
+	entry_ptr->i2c_addr          = sensor_info_ptr->salve_i2c_addr_w;
+	entry_ptr->reset_pulse_level = sensor_info_ptr->reset_pulse_level;
+	entry_ptr->power_down_level  = sensor_info_ptr->power_down_level;
+	entry_ptr->avdd_val          = sensor_info_ptr->avdd_val;
+	entry_ptr->dvdd_val          = sensor_info_ptr->dvdd_val;
+	entry_ptr->iovdd_val         = sensor_info_ptr->iovdd_val;
+	entry_ptr->id_addr           = sensor_info_ptr->identify_code[0].reg_addr;
+	entry_ptr->id_value          = SENSOR_PROBE_ID_INVALID;
+	if (sensor_info_ptr->name) {
+		strncpy(entry_ptr->name, sensor_info_ptr->name, SENSOR_PROBE_NAME_LEN - 1);
+	}
+}
+
+/* returns SCI_TRUE if the entry still describes the sensor in its table slot */
+LOCAL BOOLEAN _Sensor_ProbeEntryCheck(SENSOR_ID_E sensor_id, SENSOR_PROBE_ENTRY_T *entry_ptr)
+{
+	SENSOR_INFO_T **sensor_info_tab_ptr;
+	SENSOR_PROBE_ENTRY_T cur_entry;
+
+	if (0xFF == entry_ptr->index
+		|| entry_ptr->index >= Sensor_GetInforTabLenght(sensor_id) - SENSOR_ONE_I2C) {
+		return SCI_FALSE;
+	}
+
+	sensor_info_tab_ptr = (SENSOR_INFO_T**)Sensor_GetInforTab(sensor_id);
+	if (PNULL == sensor_info_tab_ptr[entry_ptr->index]) {
+		return SCI_FALSE;
+	}
+
+	_Sensor_ProbeEntryFill(&cur_entry, sensor_info_tab_ptr[entry_ptr->index], entry_ptr->index);
+	cur_entry.id_value = entry_ptr->id_value;
+
+	return 0 == memcmp(&cur_entry, entry_ptr, sizeof(SENSOR_PROBE_ENTRY_T));
+}
+
+/* called with the sensor powered on, right after its identify succeeded */
+LOCAL void _Sensor_ProbeCacheRecord(SENSOR_ID_E sensor_id, uint32_t index)
+{
+	SENSOR_PROBE_ENTRY_T *entry_ptr;
+
+	if (sensor_id >= SENSOR_PROBE_ID_NUM) {
+		return;
+	}
+
+	entry_ptr = &s_sensor_probe_cache.entry[sensor_id];
+	_Sensor_ProbeEntryFill(entry_ptr, s_sensor_info_ptr, index);
+	if (s_sensor_info_ptr->identify_count) {
+		entry_ptr->id_value = Sensor_ReadReg(entry_ptr->id_addr);
+	}
+	SENSOR_PRINT_HIGH("_Sensor_ProbeCacheRecord: id %d, index %d, %s, 0x%x = 0x%x.\n",
+		sensor_id, index, entry_ptr->name, entry_ptr->id_addr, entry_ptr->id_value);
+}
+
+LOCAL void _Sensor_ProbeCacheDrop(SENSOR_ID_E sensor_id)
+{
+	if (sensor_id >= SENSOR_PROBE_ID_NUM) {
+		return;
+	}
+
+	s_sensor_probe_cache.entry[sensor_id].index = 0xFF;
+	s_sensor_index[sensor_id] = 0xFF;
+	s_sensor_param_saved = SCI_TRUE;
+}
+
+/*
+  Verifies the cached sensor by reading its chip id once instead of running
+  the full identify. Returns SENSOR_FAIL if there is nothing cached to check.
+*/
+LOCAL int _Sensor_ProbeCacheVerify(SENSOR_ID_E sensor_id)
+{
+	SENSOR_PROBE_ENTRY_T *entry_ptr;
+	uint16_t id_value;
+
+	if (sensor_id >= SENSOR_PROBE_ID_NUM) {
+		return SENSOR_FAIL;
+	}
+
+	entry_ptr = &s_sensor_probe_cache.entry[sensor_id];
+	if (entry_ptr->index != s_sensor_index[sensor_id]
+		|| SENSOR_PROBE_ID_INVALID == entry_ptr->id_value) {
+		return SENSOR_FAIL;
+	}
+
+	id_value = Sensor_ReadReg(entry_ptr->id_addr);
+	if (id_value != entry_ptr->id_value) {
+		SENSOR_PRINT_HIGH("_Sensor_ProbeCacheVerify: id %d, 0x%x = 0x%x, expect 0x%x.\n",
+			sensor_id, entry_ptr->id_addr, id_value, entry_ptr->id_value);
+		return SENSOR_FAIL;
+	}
+
+	return SENSOR_SUCCESS;
+}
+
 void _Sensor_load_sensor_type(void)
 {
 	FILE 		*fp;
-	uint8_t 	sensor_param[SENSOR_PARAM_NUM];
 	uint32_t 	len = 0;
+	uint32_t	i;
 
-	memset(&sensor_param[0],0,SENSOR_PARAM_NUM);
+	s_sensor_identified = SCI_FALSE;
+	memset(&s_sensor_probe_cache, 0xFF, sizeof(s_sensor_probe_cache));
 
-	fp = fopen(SENSOR_PARA,"rb+");
-	if(NULL == fp){
-		fp = fopen(SENSOR_PARA,"wb+");
-		if(NULL == fp){
-			CMR_LOGE("_Sensor_load_sensor_type: file %s open error:%s\n",SENSOR_PARA,strerror(errno));
-		}
-		memset(&sensor_param[0],0xFF,SENSOR_PARAM_NUM);
-	}else{
-		len = fread(sensor_param, 1, SENSOR_PARAM_NUM, fp);
-		CMR_LOGV("_Sensor_load_sensor_type:read sensor param len is %d \n",len);
-		CMR_LOGV("_Sensor_load_sensor_type:read sensor param  is %x,%x,%x,%x,%x,%x,%x,%x \n",
-			sensor_param[0], sensor_param[1], sensor_param[2], sensor_param[3],
-			sensor_param[4], sensor_param[5], sensor_param[6], sensor_param[7]);
+	fp = fopen(SENSOR_PROBE_CACHE, "rb");
+	if (NULL == fp) {
+		CMR_LOGV("_Sensor_load_sensor_type: no cache %s\n", SENSOR_PROBE_CACHE);
+		return;
 	}
+	len = fread(&s_sensor_probe_cache, 1, sizeof(s_sensor_probe_cache), fp);
+	fclose(fp);
 
-	if(NULL != fp)
-		fclose(fp);
+	if (sizeof(s_sensor_probe_cache) != len
+		|| SENSOR_PROBE_CACHE_MAGIC != s_sensor_probe_cache.magic
+		|| SENSOR_PROBE_CACHE_VERSION != s_sensor_probe_cache.version
+		|| sizeof(s_sensor_probe_cache) != s_sensor_probe_cache.size
+		|| _Sensor_ProbeCacheSum(&s_sensor_probe_cache) != s_sensor_probe_cache.check_sum) {
+		CMR_LOGE("_Sensor_load_sensor_type: cache %s is stale, len %d\n", SENSOR_PROBE_CACHE, len);
+		memset(&s_sensor_probe_cache, 0xFF, sizeof(s_sensor_probe_cache));
+		return;
+	}
 
-	Sensor_SetMark(sensor_param);
+	for (i = 0; i < SENSOR_PROBE_ID_NUM; i++) {
+		if (_Sensor_ProbeEntryCheck((SENSOR_ID_E)i, &s_sensor_probe_cache.entry[i])) {
+			s_sensor_index[i] = s_sensor_probe_cache.entry[i].index;
+			s_sensor_identified = SCI_TRUE;
+		} else {
+			s_sensor_probe_cache.entry[i].index = 0xFF;
+			s_sensor_index[i] = 0xFF;
+		}
+		CMR_LOGV("_Sensor_load_sensor_type: id %d, index %d, %s\n",
+			i, s_sensor_index[i], s_sensor_probe_cache.entry[i].name);
+	}
 }
 
 void _Sensor_save_sensor_type(void)
 {
 	FILE 	*fp;
-	uint8_t is_saved;
-	uint8_t sensor_param[SENSOR_PARAM_NUM];
+	uint32_t len;
+
+	if (SCI_FALSE == s_sensor_param_saved) {
+		return;
+	}
 
-	memset(&sensor_param[0], 0, SENSOR_PARAM_NUM);
-	Sensor_GetMark(sensor_param, &is_saved);
+	s_sensor_probe_cache.magic     = SENSOR_PROBE_CACHE_MAGIC;
+	s_sensor_probe_cache.version   = SENSOR_PROBE_CACHE_VERSION;
+	s_sensor_probe_cache.size      = sizeof(s_sensor_probe_cache);
+	s_sensor_probe_cache.check_sum = _Sensor_ProbeCacheSum(&s_sensor_probe_cache);
 
-	if(is_saved){
-		fp = fopen(SENSOR_PARA,"wb+");
-		if(NULL == fp){
-			CMR_LOGV("_Sensor_save_sensor_type: file %s open error:%s \n",SENSOR_PARA,strerror(errno));
-		}else{
-            fwrite(sensor_param, 1, SENSOR_PARAM_NUM, fp);
-            fclose(fp);
-		}
+	/* a camera killed while saving leaves the old cache, never a torn one */
+	fp = fopen(SENSOR_PROBE_CACHE_TMP, "wb");
+	if (NULL == fp) {
+		CMR_LOGV("_Sensor_save_sensor_type: file %s open error:%s \n", SENSOR_PROBE_CACHE_TMP, strerror(errno));
+		return;
 	}
+	len = fwrite(&s_sensor_probe_cache, 1, sizeof(s_sensor_probe_cache), fp);
+	fclose(fp);
+
+	if (sizeof(s_sensor_probe_cache) != len
+		|| rename(SENSOR_PROBE_CACHE_TMP, SENSOR_PROBE_CACHE)) {
+		CMR_LOGE("_Sensor_save_sensor_type: failed to save %s:%s \n", SENSOR_PROBE_CACHE, strerror(errno));
+		unlink(SENSOR_PROBE_CACHE_TMP);
+		return;
+	}
+	s_sensor_param_saved = SCI_FALSE;
 }
 
 int Sensor_Init(uint32_t sensor_id, uint32_t *sensor_num_ptr)
 {
 	int ret_val = SENSOR_FAIL;
 	uint32_t sensor_num = 0;
+	BOOLEAN is_probed = SCI_FALSE;
+	nsecs_t timestamp = systemTime(CLOCK_MONOTONIC);
 
 	SENSOR_PRINT("0");
 
@@ -1473,6 +2038,7 @@ int Sensor_Init(uint32_t sensor_id, uint32_t *sensor_num_ptr)
 		if (ret_val != SENSOR_SUCCESS ) {
 			sensor_num = 0;
 			SENSOR_PRINT("Sensor_Init: register sesnor fail, start identify \n");
+			is_probed = SCI_TRUE;
 			if (_Sensor_Identify(SENSOR_MAIN))
 				sensor_num++;
 			if (_Sensor_Identify(SENSOR_SUB))
@@ -1493,6 +2059,10 @@ int Sensor_Init(uint32_t sensor_id, uint32_t *sensor_num_ptr)
 
 	*sensor_num_ptr = sensor_num;
 
+	SENSOR_PRINT_HIGH("Sensor_Init: %s, ret %d, %d ms\n",
+		is_probed ? "full probe" : "probe cache hit", ret_val,
+		(uint32_t)((systemTime(CLOCK_MONOTONIC) - timestamp) / 1000000));
+
 	SENSOR_PRINT("2");
 	return ret_val;
 }
@@ -1530,9 +2100,14 @@ int Sensor_Open(uint32_t sensor_id)
 		
 		Sensor_SetI2CClock();
 
-		//confirm camera identify OK
-		if(SENSOR_SUCCESS != s_sensor_info_ptr->ioctl_func_tab_ptr->identify(SENSOR_ZERO_I2C)){
+		//confirm camera identify OK, the sensor found by the last probe only needs one id read
+		ret_val = _Sensor_ProbeCacheVerify(sensor_id);
+		if (SENSOR_SUCCESS != ret_val) {
+			ret_val = s_sensor_info_ptr->ioctl_func_tab_ptr->identify(SENSOR_ZERO_I2C);
+		}
+		if(SENSOR_SUCCESS != ret_val){
 			sensor_register_info_ptr->is_register[sensor_id] = SENSOR_FALSE;
+			_Sensor_ProbeCacheDrop(sensor_id);
 			SENSOR_PRINT("SENSOR: Sensor_Open: sensor identify not correct!!");
 			return SENSOR_FAIL;
 		}
@@ -1575,6 +2150,11 @@ int _Sensor_SetMode(uint32_t mode)
 		Sensor_SetMCLK(mclk);
 		s_sensor_exp_info.image_format = s_sensor_exp_info.sensor_mode_info[mode].image_format;
 
+		/* the init table resets the sensor, nothing written before is trusted */
+		if (SENSOR_MODE_COMMON_INIT == mode) {
+			_Sensor_ShadowInvalidateAll();
+		}
+
 		if((SENSOR_MODE_COMMON_INIT == mode) && set_reg_tab_func){
 			set_reg_tab_func(SENSOR_MODE_COMMON_INIT);
 		}else{
@@ -1824,6 +2404,7 @@ ERR_SENSOR_E Sensor_Close(void)
 	SENSOR_PRINT_HIGH("SENSOR: Sensor_close 9.\n");
 
 	_Sensor_DeviceDeInit();
+	_Sensor_ShadowFree();
 	s_sensor_init = SENSOR_FALSE;
 	s_sensor_mode[SENSOR_MAIN] = SENSOR_MODE_MAX;
 	s_sensor_mode[SENSOR_SUB] = SENSOR_MODE_MAX;
@@ -1849,6 +2430,9 @@ ERR_SENSOR_E Sensor_SetTiming(SENSOR_MODE_E mode)
 	    s_sensor_info_ptr->
 	    resolution_tab_info_ptr[mode].sensor_reg_tab_ptr) {
 		/*send register value to sensor */
+		if (SENSOR_MODE_COMMON_INIT == mode) {
+			_Sensor_ShadowInvalidateAll();
+		}
 		Sensor_SendRegTabToSensor
 		    (&s_sensor_info_ptr->resolution_tab_info_ptr[mode]);
 		s_sensor_mode[Sensor_GetCurId()] = mode;
@@ -2239,48 +2823,20 @@ EXIF_SPEC_PIC_TAKING_COND_T *Sensor_GetSensorExifInfo(void)
 	return sensor_exif_info_ptr;
 }
 
-int Sensor_SetMark(uint8_t *buf)
-{
-	uint32_t i;
-
-	if((SIGN_0 != buf[0]) && (SIGN_1 != buf[1])
-	   && (SIGN_2 != buf[2]) && (SIGN_3 != buf[3])) {
-		s_sensor_identified = SCI_FALSE;
-	} else {
-		s_sensor_identified = SCI_TRUE;
-		for( i=0 ; i<2 ; i++) {
-			s_sensor_index[i] = buf[4+i];
-		}
-	}
-	SENSOR_PRINT_HIGH("Sensor_SetSensorParam:s_sensor_identified=%d,idex is %d,%d.\n",
-		    s_sensor_identified,s_sensor_index[0],s_sensor_index[1]);
-	return 0;
-}
-
-int Sensor_GetMark(uint8_t *buf,uint8_t *is_saved_ptr)
-{
-	uint32_t i,j=0;
-	uint8_t *ptr=buf;
-
-	if(SCI_TRUE == s_sensor_param_saved) {
-		*is_saved_ptr = 1;
-		*ptr++ = SIGN_0;
-		*ptr++ = SIGN_1;
-		*ptr++ = SIGN_2;
-		*ptr++ = SIGN_3;
-		for( i=0 ; i<2 ; i++) {
-			*ptr++ = s_sensor_index[i];
-		}
-		SENSOR_PRINT_HIGH("Sensor_GetSensorParam:index is %d,%d.\n",s_sensor_index[0],s_sensor_index[1]);
-	} else {
-		*is_saved_ptr = 0;
-	}
-	return 0;
-}
-
 int Sensor_WriteData(uint8_t *regPtr, uint32_t length)
 {
 	int ret;
+	uint32_t addr_bytes;
+	uint16_t addr;
+
+	/* the data is not decoded, so whatever it may cover is forgotten */
+	if (_Sensor_ShadowEnabled()) {
+		addr_bytes = (s_sensor_info_ptr->reg_addr_value_bits & SENSOR_I2C_REG_16BIT) ? 2 : 1;
+		if (length > addr_bytes) {
+			addr = (2 == addr_bytes) ? ((regPtr[0] << 8) | regPtr[1]) : regPtr[0];
+			_Sensor_ShadowInvalidate(addr, length - addr_bytes);
+		}
+	}
 	ret = _Sensor_Device_Write(regPtr, length);
 	
 	return ret;
@@ -1117,6 +1117,18 @@ LOCAL SENSOR_TRIM_T s_ov5640_Resolution_Trim_Tab[] = {
 LOCAL EXIF_SPEC_PIC_TAKING_COND_T s_ov5640_exif;
 
 
+LOCAL SENSOR_REG_RANGE_T s_ov5640_volatile_reg[] = {
+	{0x3000, 0x3008},	/*system reset and power down*/
+	{0x3022, 0x3029},	/*af mcu command and status*/
+	{0x3212, 0x3212},	/*group hold, self clearing*/
+	{0x3400, 0x3406},	/*awb gain, updated by awb*/
+	{0x3500, 0x350b},	/*exposure and gain, updated by aec*/
+	{0x3c00, 0x3c0c},	/*50/60hz detection*/
+	{0x4202, 0x4202},	/*frame control*/
+	{0x56a0, 0x56a1},	/*average luminance*/
+	{0x8000, 0x8fff}	/*af mcu firmware*/
+};
+
 LOCAL SENSOR_IOCTL_FUNC_TAB_T s_ov5640_ioctl_func_tab = {
 	PNULL,
 	_ov5640_PowerOn,
@@ -1172,7 +1184,7 @@ SENSOR_INFO_T g_ov5640_mipi_yuv_info = {
 	ov5640_I2C_ADDR_W,	// salve i2c write address
 	ov5640_I2C_ADDR_R,	// salve i2c read address
 
-	SENSOR_I2C_REG_16BIT | SENSOR_I2C_REG_8BIT | SENSOR_I2C_FREQ_400,	// bit0: 0: i2c register value is 8 bit, 1: i2c register value is 16 bit
+	SENSOR_I2C_REG_16BIT | SENSOR_I2C_REG_8BIT | SENSOR_I2C_FREQ_400 | SENSOR_I2C_BURST_WRITE,	// bit0: 0: i2c register value is 8 bit, 1: i2c register value is 16 bit
 	// bit1: 0: i2c register addr  is 8 bit, 1: i2c register addr  is 16 bit
 	// other bit: reseved
 	SENSOR_HW_SIGNAL_PCLK_N | SENSOR_HW_SIGNAL_VSYNC_N | SENSOR_HW_SIGNAL_HSYNC_P,	// bit0: 0:negative; 1:positive -> polarily of pixel clock
@@ -1204,8 +1216,8 @@ SENSOR_INFO_T g_ov5640_mipi_yuv_info = {
 	SENSOR_HIGH_LEVEL_PWDN,	// 1: high level valid; 0: low level valid
 
 	1,			// count of identify code
-	{{0x0A, 0x56},		// supply two code to identify sensor.
-	 {0x0B, 0x40}},		// for Example: index = 0-> Device id, index = 1 -> version id
+	{{0x300A, 0x56},	// supply two code to identify sensor.
+	 {0x300B, 0x40}},	// for Example: index = 0-> Device id, index = 1 -> version id
 
 	SENSOR_AVDD_2800MV,	// voltage of avdd
 
@@ -1234,7 +1246,9 @@ SENSOR_INFO_T g_ov5640_mipi_yuv_info = {
 	0,
 	0,
 	0,
-	{SENSOR_INTERFACE_TYPE_CSI2, 2, 8, 1}
+	{SENSOR_INTERFACE_TYPE_CSI2, 2, 8, 1},
+	s_ov5640_volatile_reg,	// registers never skipped by the delta upload
+	NUMBER_OF_ARRAY(s_ov5640_volatile_reg)
 };
 
 LOCAL uint32_t _ov5640_GetExifInfo(uint32_t param)
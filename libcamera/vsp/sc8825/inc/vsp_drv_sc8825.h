@@ -113,6 +113,8 @@ extern uint32 g_vsp_Vaddr_base;
 typedef int (*FunctionType_ResetVSP)(int fd);
 PUBLIC void  VSP_reg_reset_callback(FunctionType_ResetVSP p_cb,int fd);
 void  VSP_SetVirtualBaseAddr(uint32 vsp_Vaddr_base);
+PUBLIC int32 VSP_WaitInt(uint32 int_msk, uint32 time, uint32 *int_raw_ptr);
+PUBLIC int32 VSP_WaitReg(uint32 reg_addr, uint32 msk, uint32 exp_value, uint32 time);
 #endif
 
 
@@ -18,6 +18,13 @@
 **---------------------------------------------------------------------------*/
 #include "sci_types.h"
 #include "vsp_drv_sc8825.h"
+#ifdef _VSP_LINUX_
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 #if !defined(_VSP_)
 #include "common_global.h"
 #include "bsm_global.h"
@@ -45,6 +52,139 @@ PUBLIC void  VSP_reg_reset_callback(FunctionType_ResetVSP cb,int fd)
 	g_vsp_dev_fd = fd;
 }
 
+/*
+  The waits sleep in poll() on the vsp device, which the driver wakes up from
+  the vsp interrupt. A driver without poll support reports the device ready
+  at once, it is found out on the first waits and then the register is polled
+  instead: spinning a little since most stages end soon after the first
+  check, then sleeping with a doubling interval up to the former 1 ms.
+  The interrupt is only trusted once poll() has really slept, and a driver
+  which then keeps waking up early is polled again.
+*/
+#define VSP_WAIT_SPIN_US		20
+#define VSP_WAIT_SLEEP_MIN_US		50
+#define VSP_WAIT_SLEEP_MAX_US		1000
+#define VSP_WAIT_IRQ_SLICE_MS		10	//recheck the register in case an interrupt is missed
+#define VSP_WAIT_SPURIOUS_MAX		2
+
+typedef enum
+{
+	VSP_WAIT_PROBE = 0,
+	VSP_WAIT_IRQ,
+	VSP_WAIT_POLL
+}VSP_WAIT_MODE_E;
+
+LOCAL VSP_WAIT_MODE_E s_vsp_wait_mode = VSP_WAIT_PROBE;
+
+LOCAL uint64_t vsp_wait_now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+LOCAL BOOLEAN vsp_wait_check(uint32 reg_addr, uint32 msk, uint32 exp_value, BOOLEAN any, uint32 *value_ptr)
+{
+	uint32 value = vsp_read_register(reg_addr);
+
+	if (PNULL != value_ptr)
+	{
+		*value_ptr = value;
+	}
+
+	return any ? (0 != (value & msk)) : ((value & msk) == exp_value);
+}
+
+LOCAL int32 vsp_wait_reg(uint32 reg_addr, uint32 msk, uint32 exp_value, BOOLEAN any,
+								uint32 time, BOOLEAN irq, uint32 *value_ptr)
+{
+	uint64_t start, now, deadline, slept;
+	uint32 sleep_us = VSP_WAIT_SLEEP_MIN_US;
+	uint32 spurious = 0;
+	struct pollfd fds;
+	int32 timeout, ret;
+
+	if (vsp_wait_check(reg_addr, msk, exp_value, any, value_ptr))
+	{
+		return NOT_TIME_OUT;
+	}
+
+	irq = irq && (g_vsp_dev_fd > 0) && (VSP_WAIT_POLL != s_vsp_wait_mode);
+	start = now = vsp_wait_now_us();
+	deadline = start + (uint64_t)time * 1000;
+
+	do
+	{
+		if (irq)
+		{
+			timeout = (int32)((deadline - now + 999) / 1000);
+			timeout = (timeout > VSP_WAIT_IRQ_SLICE_MS) ? VSP_WAIT_IRQ_SLICE_MS : timeout;
+			fds.fd = g_vsp_dev_fd;
+			fds.events = POLLIN | POLLPRI;
+			fds.revents = 0;
+			ret = poll(&fds, 1, timeout);
+			slept = vsp_wait_now_us() - now;
+			if (vsp_wait_check(reg_addr, msk, exp_value, any, value_ptr))
+			{
+				if ((ret > 0) && (slept >= VSP_WAIT_SPIN_US))
+				{
+					s_vsp_wait_mode = VSP_WAIT_IRQ;
+				}
+				return NOT_TIME_OUT;
+			}
+
+			if (((ret < 0) && (EINTR != errno)) ||
+				(fds.revents & (POLLERR | POLLNVAL)) ||
+				((ret > 0) && (++spurious > VSP_WAIT_SPURIOUS_MAX)))
+			{
+				//a driver which keeps reporting ready is polled from now on
+				irq = FALSE;
+				if (VSP_WAIT_POLL != s_vsp_wait_mode)
+				{
+					s_vsp_wait_mode = VSP_WAIT_POLL;
+					SCI_TRACE_LOW("VSP wait: no interrupt from the device, polling, ret %d, revents 0x%x.", ret, fds.revents);
+				}
+			}
+		}
+		else
+		{
+			if (now - start >= VSP_WAIT_SPIN_US)
+			{
+				usleep(sleep_us);
+				sleep_us = (sleep_us * 2 > VSP_WAIT_SLEEP_MAX_US) ? VSP_WAIT_SLEEP_MAX_US : sleep_us * 2;
+			}
+
+			if (vsp_wait_check(reg_addr, msk, exp_value, any, value_ptr))
+			{
+				return NOT_TIME_OUT;
+			}
+		}
+		now = vsp_wait_now_us();
+	} while (now < deadline);
+
+	return IS_TIME_OUT;
+}
+
+/*
+  Waits until any bit of int_msk is raised in DCAM_INT_RAW, the time is in ms.
+  The raw interrupt status is returned in int_raw_ptr even on time out.
+*/
+PUBLIC int32 VSP_WaitInt(uint32 int_msk, uint32 time, uint32 *int_raw_ptr)
+{
+	return vsp_wait_reg(VSP_DCAM_REG_BASE+DCAM_INT_RAW_OFF, int_msk, 0, TRUE, time, TRUE, int_raw_ptr);
+}
+
+/*
+  Waits until (reg & msk) == exp_value for the status without interrupt,
+  the time is in ms.
+*/
+PUBLIC int32 VSP_WaitReg(uint32 reg_addr, uint32 msk, uint32 exp_value, uint32 time)
+{
+	return vsp_wait_reg(reg_addr, msk, exp_value, FALSE, time, FALSE, PNULL);
+}
+
 #endif
 
 